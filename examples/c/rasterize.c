@@ -0,0 +1,110 @@
+#include "tinyspline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+/*
+ * Benchmarks ts_bspline_rasterize on a fixed set of synthetic glyphs.
+ *
+ * Each glyph has an outer contour and, for every other glyph, an inner
+ * contour (a counter, like in 'o' or 'e') running in the opposite
+ * direction. The contours are wavy closed curves interpolated with
+ * ts_bspline_interpolate_cubic, i.e., sequences of cubic Bezier curves.
+ * The glyphs are rasterized at several sizes into 8-bit and float alpha
+ * buffers and the time per glyph is printed. The checksum (the total
+ * coverage of all glyphs) allows to compare the output of different
+ * builds.
+ *
+ * Usage: rasterize [rounds]
+ */
+
+#define N_GLYPHS 64
+#define N_POINTS 12 /* interpolated points per contour */
+#define PI 3.14159265358979323846
+
+/* Interpolates a closed wavy contour around the center of the unit
+ * square. */
+static tsError contour(double radius, double wave, int lobes,
+	double phase, int reverse, tsBSpline *spline)
+{
+	tsReal points[(N_POINTS+1) * 2];
+	double a, r;
+	int i;
+
+	for (i = 0; i <= N_POINTS; i++) {
+		a = 2 * PI * (reverse ? N_POINTS-i : i) / N_POINTS;
+		r = radius * (1 + wave * sin(lobes*a + phase));
+		points[i*2]     = (tsReal) (0.5 + r * cos(a));
+		points[i*2 + 1] = (tsReal) (0.5 + r * sin(a));
+	}
+	return ts_bspline_interpolate_cubic(points, N_POINTS+1, 2, spline);
+}
+
+int main(int argc, char **argv)
+{
+	const size_t sizes[3] = { 16, 48, 256 };
+	const tsAlphaType types[2] = { TS_ALPHA_UINT8, TS_ALPHA_FLOAT };
+	const char *names[2] = { "uint8", "float" };
+	const int rounds = argc > 1 ? atoi(argv[1]) : 50;
+	tsBSpline glyphs[N_GLYPHS][2];
+	size_t n_contours[N_GLYPHS];
+	tsReal origin[2] = { 0.f, 0.f };
+	void *alpha;
+	size_t s, t, g, i, n;
+	double checksum, us;
+	clock_t start;
+	int r;
+
+	/* Create the glyph set. */
+	for (g = 0; g < N_GLYPHS; g++) {
+		n_contours[g] = g % 2 ? 2 : 1;
+		if (contour(0.42, 0.1, 2 + (int) (g % 5), 0.37 * g, 0,
+				&glyphs[g][0]) != TS_SUCCESS)
+			return 1;
+		if (n_contours[g] > 1 && contour(0.2, 0.15, 3 + (int) (g % 3),
+				0.11 * g, 1, &glyphs[g][1]) != TS_SUCCESS)
+			return 1;
+	}
+
+	alpha = malloc(sizes[2] * sizes[2] * sizeof(float));
+	if (alpha == NULL)
+		return 1;
+	printf("%d glyphs, %d rounds\n", N_GLYPHS, rounds);
+	for (s = 0; s < 3; s++) {
+		for (t = 0; t < 2; t++) {
+			n = sizes[s] * sizes[s];
+			checksum = 0;
+			start = clock();
+			for (r = 0; r < rounds; r++) {
+				for (g = 0; g < N_GLYPHS; g++) {
+					ts_bspline_rasterize(glyphs[g],
+						n_contours[g], origin,
+						1.f / sizes[s], sizes[s],
+						sizes[s], types[t], alpha);
+					if (r > 0)
+						continue;
+					for (i = 0; i < n; i++) {
+						checksum += types[t] ==
+							TS_ALPHA_FLOAT ?
+							((float *) alpha)[i] :
+							((unsigned char *)
+							alpha)[i] / 255.0;
+					}
+				}
+			}
+			us = (double) (clock() - start) / CLOCKS_PER_SEC *
+				1e6 / ((double) rounds * N_GLYPHS);
+			printf("%3dx%-3d %-5s %9.2f us/glyph  checksum %.2f\n",
+				(int) sizes[s], (int) sizes[s], names[t], us,
+				checksum);
+		}
+	}
+
+	free(alpha);
+	for (g = 0; g < N_GLYPHS; g++) {
+		for (i = 0; i < n_contours[g]; i++)
+			ts_bspline_free(&glyphs[g][i]);
+	}
+	return 0;
+}
@@ -1,9 +1,13 @@
 #include "tinyspline.h"
 
-#include <stdlib.h> /* malloc, free */
-#include <math.h> /* fabs, sqrt */
-#include <string.h> /* memcpy, memmove, strcmp */
+#include <stdlib.h> /* malloc, free, qsort */
+#include <math.h> /* fabs, sqrt, acos, asin, atan2, ldexp */
+#include <string.h> /* memcpy, memmove, memcmp, strcmp */
 #include <setjmp.h> /* setjmp, longjmp */
+#include <float.h> /* FLT_EPSILON, DBL_EPSILON, FLT_MAX */
+#ifdef _OPENMP
+#include <omp.h> /* omp_get_max_threads, omp_get_thread_num */
+#endif
 
 
 /********************************************************
@@ -15,6 +19,13 @@
 #define CATCH } else {
 #define ETRY }
 
+/* The difference between 1 and the least tsReal greater than 1. */
+#ifdef TINYSPLINE_DOUBLE_PRECISION
+#define TS_REAL_EPSILON DBL_EPSILON
+#else
+#define TS_REAL_EPSILON FLT_EPSILON
+#endif
+
 
 /********************************************************
 *                                                       *
@@ -79,6 +90,75 @@ void ts_internal_bspline_find_u(
     (*k)--; /* k+1 - 1 will never underflow */
 }
 
+/* Allocates \size bytes starting at a TS_ALIGNMENT byte boundary. The
+ * address returned by malloc is stored right before the aligned block and
+ * is restored by ::ts_internal_aligned_free. */
+void* ts_internal_aligned_malloc(const size_t size)
+{
+    char* raw = (char*) malloc(size + sizeof(void*) + TS_ALIGNMENT-1);
+    char* aligned;
+
+    if (raw == NULL)
+        return NULL;
+    aligned = raw + sizeof(void*);
+    aligned += (TS_ALIGNMENT - (size_t) aligned % TS_ALIGNMENT) %
+            TS_ALIGNMENT;
+    ((void**) aligned)[-1] = raw;
+    return aligned;
+}
+
+void ts_internal_aligned_free(void* aligned)
+{
+    if (aligned != NULL)
+        free(((void**) aligned)[-1]);
+}
+
+/* Returns the offset (number of tsReal values) of the knots of a spline
+ * with \n_ctrlp control points of dimension \dim whose buffer is laid out
+ * according to \flags (see tsLayoutFlag). */
+size_t ts_internal_bspline_knots_offset(
+    const size_t n_ctrlp, const size_t dim, const int flags
+)
+{
+    /* The number of tsReal values per TS_ALIGNMENT bytes. */
+    const size_t per = TS_ALIGNMENT / sizeof(tsReal);
+
+    if (flags & TS_ALIGNED)
+        return (n_ctrlp*dim + per-1) / per * per;
+    return n_ctrlp*dim;
+}
+
+/* Allocates the buffer of a spline with \n_ctrlp control points of
+ * dimension \dim and \n_knots knots laid out according to \flags. With
+ * TS_ALIGNED, the buffer is padded to a multiple of TS_ALIGNMENT bytes so
+ * that no two splines share a cache line. Returns NULL if allocating
+ * memory failed. */
+tsReal* ts_internal_bspline_malloc(
+    const size_t n_ctrlp, const size_t dim, const size_t n_knots,
+    const int flags
+)
+{
+    const size_t per = TS_ALIGNMENT / sizeof(tsReal);
+    const size_t n = ts_internal_bspline_knots_offset(n_ctrlp, dim, flags) +
+            n_knots;
+
+    if (flags & TS_ALIGNED) {
+        return (tsReal*) ts_internal_aligned_malloc(
+                (n + per-1) / per * per * sizeof(tsReal));
+    }
+    return (tsReal*) malloc(n * sizeof(tsReal));
+}
+
+/* Frees the buffer \ctrlp allocated by ::ts_internal_bspline_malloc with
+ * \flags. */
+void ts_internal_bspline_release(tsReal* ctrlp, const int flags)
+{
+    if (flags & TS_ALIGNED)
+        ts_internal_aligned_free(ctrlp);
+    else
+        free(ctrlp);
+}
+
 void ts_internal_bspline_copy(
     const tsBSpline* original,
     tsBSpline* copy, jmp_buf buf
@@ -88,7 +168,7 @@ void ts_internal_bspline_copy(
     const size_t sof_f = sizeof(tsReal);
     const size_t n_ctrlp = original->n_ctrlp;
     const size_t n_knots = original->n_knots;
-    const size_t sof_ck = (n_ctrlp*dim + n_knots) * sof_f;
+    const int flags = original->flags;
 
     /* Nothing to do here. */
     if (original == copy)
@@ -99,11 +179,17 @@ void ts_internal_bspline_copy(
     copy->dim = original->dim;
     copy->n_ctrlp = original->n_ctrlp;
     copy->n_knots = original->n_knots;
-    copy->ctrlp = (tsReal*) malloc(sof_ck);
+    copy->generation = original->generation;
+    copy->dirty_first = original->dirty_first;
+    copy->dirty_last = original->dirty_last;
+    copy->flags = flags;
+    copy->ctrlp = ts_internal_bspline_malloc(n_ctrlp, dim, n_knots, flags);
     if (copy->ctrlp == NULL)
         longjmp(buf, TS_MALLOC);
-    memcpy(copy->ctrlp, original->ctrlp, sof_ck);
-    copy->knots = copy->ctrlp + n_ctrlp*dim;
+    copy->knots = copy->ctrlp +
+            ts_internal_bspline_knots_offset(n_ctrlp, dim, flags);
+    memcpy(copy->ctrlp, original->ctrlp, n_ctrlp*dim * sof_f);
+    memcpy(copy->knots, original->knots, n_knots * sof_f);
 }
 
 void ts_internal_bspline_fill_knots(
@@ -161,13 +247,12 @@ void ts_internal_bspline_fill_knots(
 
 void ts_internal_bspline_new(
     const size_t n_ctrlp, const size_t dim, const size_t deg,
-    const tsBSplineType type, tsBSpline *bspline, jmp_buf buf
+    const tsBSplineType type, const int flags, tsBSpline *bspline,
+    jmp_buf buf
 )
 {
     const size_t order = deg + 1;
     const size_t n_knots = n_ctrlp + order;
-    const size_t sof_f = sizeof(tsReal);
-    const size_t sof_ck = (n_ctrlp*dim + n_knots) * sof_f;
     tsError e;
     jmp_buf b;
 
@@ -181,15 +266,20 @@ void ts_internal_bspline_new(
     bspline->dim = dim;
     bspline->n_ctrlp = n_ctrlp;
     bspline->n_knots = n_knots;
-    bspline->ctrlp = (tsReal*) malloc(sof_ck);
+    bspline->generation = 0;
+    bspline->dirty_first = 1;
+    bspline->dirty_last = 0;
+    bspline->flags = flags;
+    bspline->ctrlp = ts_internal_bspline_malloc(n_ctrlp, dim, n_knots, flags);
     if (bspline->ctrlp == NULL)
         longjmp(buf, TS_MALLOC);
-    bspline->knots = bspline->ctrlp + n_ctrlp*dim;
+    bspline->knots = bspline->ctrlp +
+            ts_internal_bspline_knots_offset(n_ctrlp, dim, flags);
 
     TRY(b, e)
         ts_internal_bspline_fill_knots(bspline, type, 0.f, 1.f, bspline, b);
     CATCH
-        free(bspline->ctrlp);
+        ts_internal_bspline_release(bspline->ctrlp, flags);
         longjmp(buf, e);
     ETRY
 }
@@ -208,7 +298,7 @@ void ts_internal_bspline_resize(
     const size_t n_knots = bspline->n_knots;
     const size_t nn_ctrlp = n_ctrlp + n; /* The new length of ctrlp. */
     const size_t nn_knots = n_knots + n; /* The new length of knots. */
-    const size_t sof_ncnk = (nn_ctrlp*dim + nn_knots) * sof_f;
+    const int flags = bspline->flags;
     const size_t min_n_ctrlp = n < 0 ? nn_ctrlp : n_ctrlp; /* The minimum of
  * the control points old and new size. */
     const size_t min_n_knots = n < 0 ? nn_knots : n_knots; /* the minimum of
@@ -226,16 +316,18 @@ void ts_internal_bspline_resize(
     }
 
     if (bspline != resized) {
-        ts_internal_bspline_new(nn_ctrlp, dim, deg, TS_NONE, resized, buf);
+        ts_internal_bspline_new(nn_ctrlp, dim, deg, TS_NONE, flags, resized,
+                buf);
         to_ctrlp = resized->ctrlp;
         to_knots = resized->knots;
     } else {
         if (nn_ctrlp <= deg)
             longjmp(buf, TS_DEG_GE_NCTRLP);
-        to_ctrlp = (tsReal*) malloc(sof_ncnk);
+        to_ctrlp = ts_internal_bspline_malloc(nn_ctrlp, dim, nn_knots, flags);
         if (to_ctrlp == NULL)
             longjmp(buf, TS_MALLOC);
-        to_knots = to_ctrlp + nn_ctrlp*dim;
+        to_knots = to_ctrlp +
+                ts_internal_bspline_knots_offset(nn_ctrlp, dim, flags);
     }
 
     /* Copy control points and knots. */
@@ -254,7 +346,7 @@ void ts_internal_bspline_resize(
     /* Cleanup if necessary. */
     if (bspline == resized) {
         /* free old memory */
-        free(from_ctrlp);
+        ts_internal_bspline_release(from_ctrlp, flags);
         /* assign new values */
         resized->ctrlp = to_ctrlp;
         resized->knots = to_knots;
@@ -355,8 +447,11 @@ void ts_internal_bspline_insert_knot(
     }
 }
 
-void ts_internal_bspline_evaluate(
-    const tsBSpline* bspline, const tsReal u,
+/* Computes the de Boor net of \bspline at \u. If \inv is not NULL, the
+ * reciprocal knot differences \inv (see tsSealedBSpline) are used instead
+ * of dividing by the knot differences. */
+void ts_internal_bspline_evaluate_inv(
+    const tsBSpline* bspline, const tsReal* inv, const tsReal u,
     tsDeBoorNet* deBoorNet, jmp_buf buf
 )
 {
@@ -448,7 +543,9 @@ void ts_internal_bspline_evaluate(
             i = fst + r;
             for (; i <= lst; i++) {
                 ui = bspline->knots[i];
-                a = (deBoorNet->u - ui) / (bspline->knots[i+deg-r+1] - ui);
+                a = inv ? (deBoorNet->u - ui) * inv[i*deg + deg-r]
+                        : (deBoorNet->u - ui) /
+                        (bspline->knots[i+deg-r+1] - ui);
                 a_hat = 1.f-a;
 
                 for (d = 0; d < dim; d++) {
@@ -463,6 +560,14 @@ void ts_internal_bspline_evaluate(
     }
 }
 
+void ts_internal_bspline_evaluate(
+    const tsBSpline* bspline, const tsReal u,
+    tsDeBoorNet* deBoorNet, jmp_buf buf
+)
+{
+    ts_internal_bspline_evaluate_inv(bspline, NULL, u, deBoorNet, buf);
+}
+
 void ts_internal_bspline_split(
     const tsBSpline* bspline, const tsReal u,
     tsBSpline* split, size_t* k, jmp_buf buf
@@ -491,57 +596,57 @@ void ts_internal_bspline_split(
         longjmp(buf, e);
 }
 
-void ts_internal_bspline_thomas_algorithm(
+void ts_internal_bspline_thomas_weights(const size_t n, tsReal* m)
+{
+    size_t i; /* Used in for loops. */
+
+    /* m_0 = 1/4, m_{k+1} = 1/(4-m_k), for k = 0,...,n-2 */
+    if (n < 3)
+        return;
+    m[0] = 0.25f;
+    for (i = 1; i < n-2; i++)
+        m[i] = 1.f/(4 - m[i-1]);
+}
+
+void ts_internal_bspline_thomas_solve_strided(
         const tsReal* points, const size_t n, const size_t dim,
-        tsReal* output, jmp_buf buf
+        const size_t stride_in, const size_t stride_out,
+        const tsReal* m, tsReal* output
 )
 {
-    const size_t sof_f = sizeof(tsReal); /* The size of a tsReal. */
-    const size_t sof_c = dim * sof_f; /* The size of a single control point. */
-    size_t len_m; /* The length m. */
-    tsReal* m; /* The array of weights. */
-    size_t lst; /* The index of the last control point in \points. */
     size_t i, d; /* Used in for loops. */
     size_t j, k, l; /* Used as temporary indices. */
-
-    /* input validation */
-    if (dim == 0)
-        longjmp(buf, TS_DIM_ZERO);
-    if (n == 0)
-        longjmp(buf, TS_DEG_GE_NCTRLP);
+    size_t fst, lst; /* The first and last index of the current point. */
 
     if (n <= 2) {
-        memcpy(output, points, n * sof_c);
+        for (i = 0; i < n; i++)
+            memcpy(output + i*stride_out, points + i*stride_in,
+                    dim * sizeof(tsReal));
         return;
     }
 
     /* In the following n >= 3 applies... */
-    len_m = n-2; /* ... len_m >= 1 */
-    lst = (n-1)*dim; /* ... lst >= 2*dim */
-
-    /* m_0 = 1/4, m_{k+1} = 1/(4-m_k), for k = 0,...,n-2 */
-    m = (tsReal*) malloc(len_m * sof_f);
-    if (m == NULL)
-        longjmp(buf, TS_MALLOC);
-    m[0] = 0.25f;
-    for (i = 1; i < len_m; i++)
-        m[i] = 1.f/(4 - m[i-1]);
+    lst = (n-1)*stride_out; /* ... lst >= 2*stride_out */
 
     /* forward sweep */
-    ts_arr_fill(output, n*dim, 0.f);
-    memcpy(output, points, sof_c);
-    memcpy(output+lst, points+lst, sof_c);
+    for (i = 0; i < n; i++)
+        ts_arr_fill(output + i*stride_out, dim, 0.f);
+    for (d = 0; d < dim; d++) {
+        output[d] = points[d];
+        output[lst+d] = points[(n-1)*stride_in + d];
+    }
     for (d = 0; d < dim; d++) {
-        k = dim+d;
-        output[k] = 6*points[k];
+        k = stride_out+d;
+        output[k] = 6*points[stride_in+d];
         output[k] -= points[d];
     }
     for (i = 2; i <= n-2; i++) {
+        fst = i*stride_out;
         for (d = 0; d < dim; d++) {
-            j = (i-1)*dim+d;
-            k = i*dim+d;
-            l = (i+1)*dim+d;
-            output[k] = 6*points[k];
+            j = fst-stride_out+d;
+            k = fst+d;
+            l = fst+stride_out+d;
+            output[k] = 6*points[i*stride_in+d];
             output[k] -= output[l];
             output[k] -= m[i-2]*output[j]; /* i >= 2 */
         }
@@ -551,9 +656,10 @@ void ts_internal_bspline_thomas_algorithm(
     if (n > 3)
         ts_arr_fill(output+lst, dim, 0.f);
     for (i = n-2; i >= 1; i--) {
+        fst = i*stride_out;
         for (d = 0; d < dim; d++) {
-            k = i*dim+d;
-            l = (i+1)*dim+d;
+            k = fst+d;
+            l = fst+stride_out+d;
             /* The following line is the reason why it's important to not fill
              * output with 0 if n = 3. On the other hand, if n > 3 subtracting
              * 0 is exactly what we want. */
@@ -561,8 +667,44 @@ void ts_internal_bspline_thomas_algorithm(
             output[k] *= m[i-1]; /* i >= 1 */
         }
     }
-    if (n > 3)
-        memcpy(output+lst, points+lst, sof_c);
+    if (n > 3) {
+        for (d = 0; d < dim; d++)
+            output[lst+d] = points[(n-1)*stride_in + d];
+    }
+}
+
+void ts_internal_bspline_thomas_solve(
+        const tsReal* points, const size_t n, const size_t dim,
+        const tsReal* m, tsReal* output
+)
+{
+    ts_internal_bspline_thomas_solve_strided(
+            points, n, dim, dim, dim, m, output);
+}
+
+void ts_internal_bspline_thomas_algorithm(
+        const tsReal* points, const size_t n, const size_t dim,
+        tsReal* output, jmp_buf buf
+)
+{
+    tsReal* m; /* The array of weights. */
+
+    /* input validation */
+    if (dim == 0)
+        longjmp(buf, TS_DIM_ZERO);
+    if (n == 0)
+        longjmp(buf, TS_DEG_GE_NCTRLP);
+
+    if (n <= 2) {
+        ts_internal_bspline_thomas_solve(points, n, dim, NULL, output);
+        return;
+    }
+
+    m = (tsReal*) malloc((n-2) * sizeof(tsReal));
+    if (m == NULL)
+        longjmp(buf, TS_MALLOC);
+    ts_internal_bspline_thomas_weights(n, m);
+    ts_internal_bspline_thomas_solve(points, n, dim, m, output);
 
     /* we are done */
     free(m);
@@ -595,7 +737,8 @@ void ts_internal_relaxed_uniform_cubic_bspline(
     sof_c = dim * sizeof(tsReal); /* dim > 0 implies sof_c > 0 */
 
     /* n >= 2 implies n-1 >= 1 implies (n-1)*4 >= 4 */
-    ts_internal_bspline_new((n-1)*4, dim, order-1, TS_BEZIERS, bspline, buf);
+    ts_internal_bspline_new((n-1)*4, dim, order-1, TS_BEZIERS, TS_PACKED,
+            bspline, buf);
 
     TRY(b_, e_)
         s = (tsReal*) malloc(n * sof_c);
@@ -659,8 +802,11 @@ void ts_internal_bspline_interpolate_cubic(
         longjmp(buf, e);
 }
 
-void ts_internal_bspline_derive(
-    const tsBSpline* original,
+/* Derives \original. If \inv is not NULL, the reciprocal knot differences
+ * \inv (see tsSealedBSpline) are used instead of dividing by the knot
+ * differences. */
+void ts_internal_bspline_derive_inv(
+    const tsBSpline* original, const tsReal* inv,
     tsBSpline* derivative, jmp_buf buf
 )
 {
@@ -669,44 +815,50 @@ void ts_internal_bspline_derive(
     const size_t deg = original->deg;
     const size_t nc = original->n_ctrlp;
     const size_t nk = original->n_knots;
+    const int flags = original->flags;
     tsReal* from_ctrlp = original->ctrlp;
     tsReal* from_knots = original->knots;
     tsReal* to_ctrlp = NULL;
     tsReal* to_knots = NULL;
+    tsReal fac; /* deg / (from_knots[i+deg+1] - from_knots[i+1]) */
     size_t i, j, k;
 
     if (deg < 1 || nc < 2)
         longjmp(buf, TS_UNDERIVABLE);
 
     if (original != derivative) {
-        ts_internal_bspline_new(nc-1, dim, deg-1, TS_NONE, derivative, buf);
+        ts_internal_bspline_new(nc-1, dim, deg-1, TS_NONE, flags, derivative,
+                buf);
         to_ctrlp = derivative->ctrlp;
         to_knots = derivative->knots;
     } else {
-        to_ctrlp = (tsReal*) malloc( ((nc-1)*dim + (nk-2)) * sof_f );
+        to_ctrlp = ts_internal_bspline_malloc(nc-1, dim, nk-2, flags);
         if (to_ctrlp == NULL)
             longjmp(buf, TS_MALLOC);
-        to_knots = to_ctrlp + (nc-1)*dim;
+        to_knots = to_ctrlp +
+                ts_internal_bspline_knots_offset(nc-1, dim, flags);
     }
 
     for (i = 0; i < nc-1; i++) {
+        /* The reciprocal is computed once per control point. Knots are
+         * compared with ::ts_fequals on both paths (like the validation
+         * of sealed splines), \inv is used for the factor only. */
+        if (ts_fequals(from_knots[i+deg+1], from_knots[i+1])) {
+            ts_internal_bspline_release(to_ctrlp, flags);
+            longjmp(buf, TS_UNDERIVABLE);
+        }
+        fac = inv ? deg * inv[(i+1)*deg + deg-1]
+                : deg / (from_knots[i+deg+1] - from_knots[i+1]);
         for (j = 0; j < dim; j++) {
-            if (ts_fequals(from_knots[i+deg+1], from_knots[i+1])) {
-                free(to_ctrlp);
-                longjmp(buf, TS_UNDERIVABLE);
-            } else {
-                k = i*dim + j;
-                to_ctrlp[k] = from_ctrlp[(i+1)*dim + j] - from_ctrlp[k];
-                to_ctrlp[k] *= deg;
-                to_ctrlp[k] /= from_knots[i+deg+1] - from_knots[i+1];
-            }
+            k = i*dim + j;
+            to_ctrlp[k] = (from_ctrlp[(i+1)*dim + j] - from_ctrlp[k]) * fac;
         }
     }
     memcpy(to_knots, from_knots+1, (nk-2)*sof_f);
 
     if (original == derivative) {
         /* free old memory */
-        free(from_ctrlp);
+        ts_internal_bspline_release(from_ctrlp, flags);
         /* assign new values */
         derivative->deg = deg-1;
         derivative->order = deg;
@@ -717,6 +869,14 @@ void ts_internal_bspline_derive(
     }
 }
 
+void ts_internal_bspline_derive(
+    const tsBSpline* original,
+    tsBSpline* derivative, jmp_buf buf
+)
+{
+    ts_internal_bspline_derive_inv(original, NULL, derivative, buf);
+}
+
 void ts_internal_bspline_buckle(
     const tsBSpline* bspline, const tsReal b,
     tsBSpline* buckled, jmp_buf buf
@@ -725,21 +885,62 @@ void ts_internal_bspline_buckle(
     const tsReal b_hat  = 1.f-b; /* The straightening factor. */
     const size_t dim = bspline->dim;
     const size_t N = bspline->n_ctrlp;
-    const tsReal* p0 = bspline->ctrlp; /* Pointer to first ctrlp. */
-    const tsReal* pn_1 = p0 + (N-1)*dim; /* Pointer to the last ctrlp. */
+    const tsReal inv = N > 1 ? 1.f / (N-1) : 0.f; /* Hoisted reciprocal. */
+    tsReal* ctrlp;
+    const tsReal* p0; /* Pointer to first ctrlp. */
+    const tsReal* pn_1; /* Pointer to the last ctrlp. */
+    tsReal s, t; /* The weights of p0 and pn_1 (including b_hat). */
     size_t i, d; /* Used in for loops. */
 
     ts_internal_bspline_copy(bspline, buckled, buf);
+    ctrlp = buckled->ctrlp;
+    p0 = ctrlp;
+    pn_1 = ctrlp + (N-1)*dim;
 
-    for (i = 0; i < N; i++) {
+    /* The first and the last control point are fixed points. Hence, the
+     * inner control points can be blended in place. */
+    for (i = 1; i+1 < N; i++) {
+        t = b_hat * (i*inv);
+        s = b_hat - t;
         for (d = 0; d < dim; d++) {
-            buckled->ctrlp[i*dim + d] =
-                b * buckled->ctrlp[i*dim + d] +
-                b_hat * (p0[d] + ((tsReal)i / (N-1)) * (pn_1[d] - p0[d]));
+            ctrlp[i*dim + d] = b * ctrlp[i*dim + d] +
+                s * p0[d] + t * pn_1[d];
         }
     }
 }
 
+/* Stores a + t * (b-a) in \out (which may be \a or \b) for \n values. */
+void ts_internal_lerp(
+    const tsReal* a, const tsReal* b, const size_t n, const tsReal t,
+    tsReal* out
+)
+{
+    size_t i; /* Used in for loops. */
+    for (i = 0; i < n; i++)
+        out[i] = a[i] + t * (b[i]-a[i]);
+}
+
+void ts_internal_bspline_lerp(
+    const tsBSpline* a, const tsBSpline* b, const tsReal t,
+    tsBSpline* lerped, jmp_buf buf
+)
+{
+    size_t i; /* Used in for loops. */
+
+    if (a->deg != b->deg || a->dim != b->dim || a->n_ctrlp != b->n_ctrlp)
+        longjmp(buf, TS_INCOMPATIBLE);
+    /* The knots of \a are used for the result, i.e., the knots of \b must
+     * be equal, not just close. */
+    for (i = 0; i < a->n_knots; i++) {
+        if (a->knots[i] < b->knots[i] || b->knots[i] < a->knots[i])
+            longjmp(buf, TS_INCOMPATIBLE);
+    }
+    if (lerped != b)
+        ts_internal_bspline_copy(a, lerped, buf);
+    ts_internal_lerp(a->ctrlp, b->ctrlp, a->n_ctrlp * a->dim, t,
+            lerped->ctrlp);
+}
+
 void ts_internal_bspline_to_beziers(
     const tsBSpline* bspline,
     tsBSpline* beziers, jmp_buf buf
@@ -790,6 +991,45 @@ void ts_internal_bspline_to_beziers(
         longjmp(buf, e);
 }
 
+/* Increments the generation counter of \bspline and adds the knot
+ * intervals [\k0, \k1] (clamped to the domain) to its dirty range. */
+void ts_internal_bspline_touch(
+    tsBSpline* bspline, size_t k0, size_t k1
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t last = bspline->n_ctrlp-1; /* The last interval. */
+
+    k0 = k0 < deg ? deg : k0 > last ? last : k0;
+    k1 = k1 < deg ? deg : k1 > last ? last : k1;
+    if (bspline->dirty_first > bspline->dirty_last) {
+        bspline->dirty_first = k0;
+        bspline->dirty_last = k1;
+    } else {
+        if (k0 < bspline->dirty_first)
+            bspline->dirty_first = k0;
+        if (k1 > bspline->dirty_last)
+            bspline->dirty_last = k1;
+    }
+    bspline->generation++;
+}
+
+/* Marks \result, which has been computed from splines whose generation
+ * counters are at most \generation (possibly \result itself), as entirely
+ * modified: its generation counter becomes \generation+1 and its dirty
+ * range the whole domain. The previous dirty range of \result is
+ * discarded as its knot intervals may not correspond to the ones of
+ * \result (e.g., after inserting knots). */
+void ts_internal_bspline_replaced(
+    tsBSpline* result, const size_t generation
+)
+{
+    result->generation = generation;
+    result->dirty_first = 1;
+    result->dirty_last = 0;
+    ts_internal_bspline_touch(result, 0, result->n_knots);
+}
+
 void ts_internal_bspline_set_ctrlp(
     const tsBSpline* bspline, const tsReal* ctrlp,
     tsBSpline* result, jmp_buf buf
@@ -798,6 +1038,7 @@ void ts_internal_bspline_set_ctrlp(
     const size_t s = bspline->n_ctrlp * bspline->dim * sizeof(tsReal);
     ts_internal_bspline_copy(bspline, result, buf);
     memmove(result->ctrlp, ctrlp, s);
+    ts_internal_bspline_touch(result, 0, result->n_knots);
 }
 
 void ts_internal_bspline_set_knots(
@@ -808,304 +1049,7034 @@ void ts_internal_bspline_set_knots(
     const size_t s = bspline->n_knots * sizeof(tsReal);
     ts_internal_bspline_copy(bspline, result, buf);
     memmove(result->knots, knots, s);
+    ts_internal_bspline_touch(result, 0, result->n_knots);
 }
 
+void ts_internal_bspline_set_ctrlp_range(
+    tsBSpline* bspline, const size_t first, const size_t count,
+    const tsReal* values, jmp_buf buf
+)
+{
+    const size_t dim = bspline->dim;
 
-/********************************************************
-*                                                       *
-* Interface implementation                              *
-*                                                       *
-********************************************************/
-void ts_deboornet_default(tsDeBoorNet* deBoorNet)
+    if (count > bspline->n_ctrlp || first > bspline->n_ctrlp - count)
+        longjmp(buf, TS_INDEX_ERROR);
+    if (count == 0)
+        return;
+    memmove(bspline->ctrlp + first*dim, values, count*dim * sizeof(tsReal));
+    /* control point i affects the knot intervals i..i+deg */
+    ts_internal_bspline_touch(bspline, first, first + count-1 + bspline->deg);
+}
+
+void ts_internal_bspline_set_knot(
+    tsBSpline* bspline, const size_t index, const tsReal value, jmp_buf buf
+)
 {
-    deBoorNet->u        = 0.f;
-    deBoorNet->k        = 0;
-    deBoorNet->s        = 0;
-    deBoorNet->h        = 0;
-    deBoorNet->dim      = 0;
-    deBoorNet->n_points = 0;
-    deBoorNet->points   = NULL;
-    deBoorNet->result   = NULL;
+    const size_t order = bspline->order;
+    const size_t n_knots = bspline->n_knots;
+    const tsReal* knots = bspline->knots;
+    size_t mult = 1; /* The multiplicity of \value after modification. */
+    size_t i; /* Used in for loops. */
+
+    if (index >= n_knots)
+        longjmp(buf, TS_INDEX_ERROR);
+    if ((index > 0 && value < knots[index-1]) ||
+            (index+1 < n_knots && value > knots[index+1]))
+        longjmp(buf, TS_KNOTS_DECR);
+    for (i = index; i > 0 && ts_fequals(knots[i-1], value); i--)
+        mult++;
+    for (i = index+1; i < n_knots && ts_fequals(knots[i], value); i++)
+        mult++;
+    if (mult > order)
+        longjmp(buf, TS_MULTIPLICITY);
+
+    bspline->knots[index] = value;
+    /* knot j affects the knot intervals j-deg-1..j+deg */
+    ts_internal_bspline_touch(bspline, index >= order ? index-order : 0,
+            index + bspline->deg);
 }
 
-void ts_deboornet_move(tsDeBoorNet *from, tsDeBoorNet *to)
+void ts_internal_bspline_eval_point(
+    const tsBSpline* bspline, const tsReal u,
+    tsReal* scratch, tsReal* point, jmp_buf buf
+)
 {
-    if (from == to)
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t dim = bspline->dim;
+    const size_t sof_c = dim * sizeof(tsReal);
+    const tsReal* knots = bspline->knots;
+    size_t k, s;
+    size_t fst, lst; /* The first and last affected control point. */
+    size_t from; /* An offset used to copy values. */
+    size_t r, i, d; /* Used in for loops. */
+    tsReal uk, ui, a, a_hat;
+    tsReal* pi; /* The current point of the net. */
+    const tsReal* pl; /* The left neighbour of \pi. */
+
+    ts_internal_bspline_find_u(bspline, u, &k, &s, buf);
+    uk = knots[k];
+    uk = ts_fequals(u, uk) ? uk : u;
+
+    if (s == order) {
+        /* Same semantic as 'result' of ::ts_internal_bspline_evaluate. */
+        if (k == deg)
+            from = 0;
+        else if (k == bspline->n_knots - 1)
+            from = (k-s) * dim;
+        else
+            from = (k-s+1) * dim;
+        memcpy(point, bspline->ctrlp + from, sof_c);
         return;
-    to->u = from->u;
-    to->k = from->k;
-    to->s = from->s;
-    to->h = from->h;
-    to->dim = from->dim;
-    to->n_points = from->n_points;
-    to->points = from->points;
-    to->result = from->result;
-    ts_deboornet_default(from);
+    }
+
+    /* De Boor's algorithm in place. Iterating from right to left ensures
+     * that the points of level r-1 are still available when level r is
+     * calculated. */
+    fst = k-deg;
+    lst = k-s;
+    memcpy(scratch, bspline->ctrlp + fst*dim, (lst-fst+1) * sof_c);
+    for (r = 1; r <= deg-s; r++) {
+        for (i = lst; i >= fst+r; i--) {
+            ui = knots[i];
+            a = (uk - ui) / (knots[i+deg-r+1] - ui);
+            a_hat = 1.f-a;
+            pi = scratch + (i-fst)*dim;
+            pl = pi - dim;
+            for (d = 0; d < dim; d++)
+                pi[d] = a_hat * pl[d] + a * pi[d];
+        }
+    }
+    memcpy(point, scratch + (lst-fst)*dim, sof_c);
 }
 
-void ts_deboornet_free(tsDeBoorNet* deBoorNet)
+void ts_internal_bspline_evaluate_many(
+    const tsBSpline* bspline, const tsReal* us, const size_t n,
+    tsReal* points, jmp_buf buf
+)
 {
-    if (deBoorNet->points != NULL)
-        free(deBoorNet->points);/* automatically frees the field result */
-    ts_deboornet_default(deBoorNet);
+    const size_t dim = bspline->dim;
+    tsReal* scratch; /* Storage of the in place de Boor net. */
+    size_t i; /* Used in for loops. */
+    tsError e;
+    jmp_buf b;
+
+    scratch = (tsReal*) malloc(bspline->order * dim * sizeof(tsReal));
+    if (scratch == NULL)
+        longjmp(buf, TS_MALLOC);
+
+    TRY(b, e)
+        for (i = 0; i < n; i++) {
+            ts_internal_bspline_eval_point(
+                    bspline, us[i], scratch, points + i*dim, b);
+        }
+    ETRY
+
+    free(scratch);
+    if (e < 0)
+        longjmp(buf, e);
 }
 
-void ts_bspline_default(tsBSpline* bspline)
+void ts_internal_bspline_sample(
+    const tsBSpline* bspline, const size_t n,
+    tsReal* points, jmp_buf buf
+)
 {
-    bspline->deg     = 0;
-    bspline->order   = 0;
-    bspline->dim     = 0;
-    bspline->n_ctrlp = 0;
-    bspline->n_knots = 0;
-    bspline->ctrlp   = NULL;
-    bspline->knots   = NULL;
+    const size_t dim = bspline->dim;
+    tsReal* scratch; /* Storage of the in place de Boor net. */
+    tsReal min, max; /* The domain of \bspline. */
+    tsReal fac; /* The distance of two consecutive knot values. */
+    size_t i; /* Used in for loops. */
+    tsError e;
+    jmp_buf b;
+
+    if (n == 0)
+        return;
+    ts_bspline_domain(bspline, &min, &max);
+    fac = n > 1 ? (max-min) / (n-1) : 0.f;
+
+    scratch = (tsReal*) malloc(bspline->order * dim * sizeof(tsReal));
+    if (scratch == NULL)
+        longjmp(buf, TS_MALLOC);
+
+    TRY(b, e)
+        for (i = 0; i < n-1; i++) {
+            ts_internal_bspline_eval_point(
+                    bspline, min + i*fac, scratch, points + i*dim, b);
+        }
+        /* ensures that the last point is evaluated exactly at \max */
+        ts_internal_bspline_eval_point(
+                bspline, n > 1 ? max : min, scratch, points + i*dim, b);
+    ETRY
+
+    free(scratch);
+    if (e < 0)
+        longjmp(buf, e);
 }
 
-void ts_bspline_free(tsBSpline* bspline)
+#define TS_SERIAL_MAGIC "TSBS"
+#define TS_SERIAL_HEADER_SIZE 24
+
+void ts_internal_write_u32(unsigned char* buf, const size_t val)
 {
-    if (bspline->ctrlp != NULL)
-        free(bspline->ctrlp);
-    ts_bspline_default(bspline);
+    buf[0] = (unsigned char) (val & 0xFF);
+    buf[1] = (unsigned char) ((val >> 8) & 0xFF);
+    buf[2] = (unsigned char) ((val >> 16) & 0xFF);
+    buf[3] = (unsigned char) ((val >> 24) & 0xFF);
 }
 
-void ts_bspline_move(tsBSpline* from, tsBSpline* to)
+/* Returns 1 if \val can be stored with ::ts_internal_write_u32, 0 otherwise.
+ * The shift is split to stay defined if size_t has only 32 bits. */
+int ts_internal_fits_u32(const size_t val)
 {
-    if (from == to)
-        return;
-    to->deg = from->deg;
-    to->order = from->order;
-    to->dim = from->dim;
-    to->n_ctrlp = from->n_ctrlp;
-    to->n_knots = from->n_knots;
-    to->ctrlp = from->ctrlp;
-    to->knots = from->knots;
-    ts_bspline_default(from);
+    return ((val >> 16) >> 16) == 0;
 }
 
-tsError ts_bspline_new(
-    const size_t n_ctrlp, const size_t dim, const size_t deg,
-    const tsBSplineType type, tsBSpline *bspline
+size_t ts_internal_read_u32(const unsigned char* buf)
+{
+    return  (size_t) buf[0] |
+           ((size_t) buf[1] << 8) |
+           ((size_t) buf[2] << 16) |
+           ((size_t) buf[3] << 24);
+}
+
+void ts_internal_bspline_serialize(
+    const tsBSpline* bspline,
+    unsigned char* buf, const size_t len, jmp_buf b
 )
 {
-    tsError err;
-    jmp_buf buf;
-    TRY(buf, err)
-        ts_internal_bspline_new(n_ctrlp, dim, deg, type, bspline, buf);
-    CATCH
-        ts_bspline_default(bspline);
-    ETRY
-    return err;
+    const size_t sof_c = bspline->n_ctrlp*bspline->dim * sizeof(tsReal);
+    const size_t sof_ck = sof_c + bspline->n_knots * sizeof(tsReal);
+
+    if (!ts_internal_fits_u32(bspline->deg) ||
+            !ts_internal_fits_u32(bspline->dim) ||
+            !ts_internal_fits_u32(bspline->n_ctrlp))
+        longjmp(b, TS_PARSE_ERROR);
+    if (len < TS_SERIAL_HEADER_SIZE + sof_ck)
+        longjmp(b, TS_BUFFER_SIZE);
+
+    memcpy(buf, TS_SERIAL_MAGIC, 4);
+    ts_internal_write_u32(buf + 4, TINYSPLINE_ABI_VERSION);
+    ts_internal_write_u32(buf + 8, sizeof(tsReal));
+    ts_internal_write_u32(buf + 12, bspline->deg);
+    ts_internal_write_u32(buf + 16, bspline->dim);
+    ts_internal_write_u32(buf + 20, bspline->n_ctrlp);
+    /* the knots of aligned splines do not follow the control points */
+    memcpy(buf + TS_SERIAL_HEADER_SIZE, bspline->ctrlp, sof_c);
+    memcpy(buf + TS_SERIAL_HEADER_SIZE + sof_c, bspline->knots,
+            sof_ck - sof_c);
 }
 
-tsError ts_bspline_interpolate_cubic(
-    const tsReal* points, const size_t n, const size_t dim,
-    tsBSpline* bspline
+void ts_internal_bspline_deserialize(
+    const unsigned char* buf, const size_t len,
+    tsBSpline* bspline, jmp_buf b
 )
 {
-    tsError err;
-    jmp_buf buf;
-    TRY(buf, err)
+    const size_t max = (size_t) -1;
+    size_t deg, dim, n_ctrlp, n_knots, sof_ck, i;
+
+    if (len < TS_SERIAL_HEADER_SIZE)
+        longjmp(b, TS_PARSE_ERROR);
+    if (memcmp(buf, TS_SERIAL_MAGIC, 4) != 0)
+        longjmp(b, TS_PARSE_ERROR);
+    if (ts_internal_read_u32(buf + 4) > TINYSPLINE_ABI_VERSION)
+        longjmp(b, TS_PARSE_ERROR);
+    if (ts_internal_read_u32(buf + 8) != sizeof(tsReal))
+        longjmp(b, TS_PARSE_ERROR);
+    deg = ts_internal_read_u32(buf + 12);
+    dim = ts_internal_read_u32(buf + 16);
+    n_ctrlp = ts_internal_read_u32(buf + 20);
+    if (dim < 1)
+        longjmp(b, TS_DIM_ZERO);
+    if (deg >= n_ctrlp)
+        longjmp(b, TS_DEG_GE_NCTRLP);
+    /* The header is untrusted, thus, the size of the data must not
+     * overflow. n_knots does not because deg < n_ctrlp < 2^32. */
+    n_knots = n_ctrlp+deg+1;
+    if (n_ctrlp > max / dim || n_ctrlp*dim > max - n_knots)
+        longjmp(b, TS_PARSE_ERROR);
+    sof_ck = n_ctrlp*dim + n_knots;
+    if (sof_ck > (max - TS_SERIAL_HEADER_SIZE) / sizeof(tsReal))
+        longjmp(b, TS_PARSE_ERROR);
+    sof_ck *= sizeof(tsReal);
+    if (len < TS_SERIAL_HEADER_SIZE + sof_ck)
+        longjmp(b, TS_BUFFER_SIZE);
+
+    ts_internal_bspline_new(n_ctrlp, dim, deg, TS_NONE, TS_PACKED, bspline,
+            b);
+    memcpy(bspline->ctrlp, buf + TS_SERIAL_HEADER_SIZE, sof_ck);
+    for (i = 1; i < bspline->n_knots; i++) {
+        if (bspline->knots[i] < bspline->knots[i-1]) {
+            ts_bspline_free(bspline);
+            longjmp(b, TS_KNOTS_DECR);
+        }
+    }
+}
+
+size_t ts_internal_find_span(
+    const tsReal* knots, const size_t deg, const size_t n_ctrlp,
+    tsReal* u, jmp_buf buf
+)
+{
+    const tsReal min = knots[deg];
+    const tsReal max = knots[n_ctrlp];
+    size_t low, high, mid;
+
+    /* Snap \u to the domain if it is slightly out of range. */
+    if (*u < min || *u > max) {
+        if (ts_fequals(*u, min))
+            *u = min;
+        else if (ts_fequals(*u, max))
+            *u = max;
+        else
+            longjmp(buf, TS_U_UNDEFINED);
+    }
+
+    /* The upper bound belongs to the last non-empty span. */
+    if (*u >= max) {
+        mid = n_ctrlp-1;
+        while (mid > deg && !(knots[mid] < max))
+            mid--;
+        return mid;
+    }
+
+    /* binary search with invariant knots[low] <= u < knots[high] */
+    low = deg;
+    high = n_ctrlp;
+    while (high-low > 1) {
+        mid = (low+high) / 2;
+        if (*u < knots[mid])
+            high = mid;
+        else
+            low = mid;
+    }
+    return low;
+}
+
+void ts_internal_bspline_basis(
+    const tsReal* knots, const size_t deg, const size_t span, const tsReal u,
+    tsReal* N, tsReal* work
+)
+{
+    tsReal* left = work; /* deg+1 values */
+    tsReal* right = work + deg+1; /* deg+1 values */
+    tsReal saved, tmp;
+    size_t j, r; /* Used in for loops. */
+
+    N[0] = 1.f;
+    for (j = 1; j <= deg; j++) {
+        left[j] = u - knots[span+1-j];
+        right[j] = knots[span+j] - u;
+        saved = 0.f;
+        for (r = 0; r < j; r++) {
+            tmp = N[r] / (right[r+1] + left[j-r]);
+            N[r] = saved + right[r+1]*tmp;
+            saved = left[j-r]*tmp;
+        }
+        N[j] = saved;
+    }
+}
+
+/* Computes the non-vanishing basis functions of knot interval \span and
+ * their derivatives up to \n (The NURBS Book, A2.3). If \inv is not NULL,
+ * the knot differences are multiplied with their reciprocals \inv (see
+ * tsSealedBSpline) instead of being divided by. */
+void ts_internal_bspline_basis_ders_inv(
+    const tsReal* knots, const tsReal* inv, const size_t deg,
+    const size_t span, const tsReal u, const size_t n, tsReal* ders,
+    tsReal* work
+)
+{
+    const size_t order = deg+1;
+    tsReal* ndu = work; /* order*order values */
+    tsReal* a = ndu + order*order; /* 2*order values */
+    tsReal* left = a + 2*order; /* order values */
+    tsReal* right = left + order; /* order values */
+    tsReal saved, tmp, d;
+    size_t s1, s2; /* Alternating rows of \a. */
+    int rk, pk, j1, j2; /* Signed indices of the recurrence. */
+    int k, r, j; /* Used in for loops. */
+    const int p = (int) deg;
+
+    /* ndu[j*order + r]: upper triangle stores basis functions, lower
+     * triangle stores knot differences. */
+    ndu[0] = 1.f;
+    for (j = 1; j <= p; j++) {
+        left[j] = u - knots[span+1-j];
+        right[j] = knots[span+j] - u;
+        saved = 0.f;
+        for (r = 0; r < j; r++) {
+            ndu[j*order + r] = right[r+1] + left[j-r];
+            tmp = inv ? ndu[r*order + j-1] * inv[(span+1 + r-j)*deg + j-1]
+                    : ndu[r*order + j-1] / ndu[j*order + r];
+            ndu[r*order + j] = saved + right[r+1]*tmp;
+            saved = left[j-r]*tmp;
+        }
+        ndu[j*order + j] = saved;
+    }
+    ts_arr_fill(ders, (n+1)*order, 0.f);
+    for (j = 0; j <= p; j++)
+        ders[j] = ndu[j*order + p];
+
+    for (r = 0; r <= p; r++) {
+        s1 = 0;
+        s2 = order;
+        a[0] = 1.f;
+        for (k = 1; k <= (int)n && k <= p; k++) {
+            d = 0.f;
+            rk = r-k;
+            pk = p-k;
+            if (r >= k) {
+                a[s2] = inv ? a[s1] * inv[(span + rk-pk)*deg + pk]
+                        : a[s1] / ndu[(pk+1)*order + rk];
+                d = a[s2] * ndu[rk*order + pk];
+            }
+            j1 = rk >= -1 ? 1 : -rk;
+            j2 = r-1 <= pk ? k-1 : p-r;
+            for (j = j1; j <= j2; j++) {
+                a[s2+j] = inv ? (a[s1+j] - a[s1+j-1]) *
+                        inv[(span + rk+j-pk)*deg + pk]
+                        : (a[s1+j] - a[s1+j-1]) / ndu[(pk+1)*order + rk+j];
+                d += a[s2+j] * ndu[(rk+j)*order + pk];
+            }
+            if (r <= pk) {
+                a[s2+k] = inv ? -a[s1+k-1] * inv[(span + r-pk)*deg + pk]
+                        : -a[s1+k-1] / ndu[(pk+1)*order + r];
+                d += a[s2+k] * ndu[r*order + pk];
+            }
+            ders[k*order + r] = d;
+            s1 = order-s1; /* swap rows */
+            s2 = order-s2;
+        }
+    }
+
+    /* multiply by the correct factors p!/(p-k)! */
+    r = p;
+    for (k = 1; k <= (int)n && k <= p; k++) {
+        for (j = 0; j <= p; j++)
+            ders[k*order + j] *= r;
+        r *= p-k;
+    }
+}
+
+void ts_internal_bspline_basis_ders(
+    const tsReal* knots, const size_t deg, const size_t span, const tsReal u,
+    const size_t n, tsReal* ders, tsReal* work
+)
+{
+    ts_internal_bspline_basis_ders_inv(knots, NULL, deg, span, u, n, ders,
+            work);
+}
+
+/* Fills the \n_ctrlp+deg+1 knots \knots of a single direction of a surface
+ * or volume like ::ts_internal_bspline_fill_knots. */
+void ts_internal_bspline_fill_axis_knots(
+    tsReal* knots, const size_t deg, const size_t n_ctrlp,
+    const tsBSplineType type, const tsReal min, const tsReal max,
+    jmp_buf buf
+)
+{
+    tsBSpline view; /* Used to fill \knots with tsBSpline functions. */
+
+    view.dim = 1;
+    view.ctrlp = NULL;
+    view.deg = deg;
+    view.order = deg+1;
+    view.n_ctrlp = n_ctrlp;
+    view.n_knots = n_ctrlp+deg+1;
+    view.knots = knots;
+    ts_internal_bspline_fill_knots(&view, type, min, max, &view, buf);
+}
+
+void ts_internal_bsplinesurface_new(
+    const size_t n_ctrlp_u, const size_t n_ctrlp_v, const size_t dim,
+    const size_t deg_u, const size_t deg_v, const tsBSplineType type,
+    tsBSplineSurface* surface, jmp_buf buf
+)
+{
+    const size_t n_knots_u = n_ctrlp_u + deg_u + 1;
+    const size_t n_knots_v = n_ctrlp_v + deg_v + 1;
+    const size_t n_ctrlp = n_ctrlp_u * n_ctrlp_v;
+    const size_t sof_ck = (n_ctrlp*dim + n_knots_u + n_knots_v)
+            * sizeof(tsReal);
+    tsError e;
+    jmp_buf b;
+
+    if (dim < 1)
+        longjmp(buf, TS_DIM_ZERO);
+    if (deg_u >= n_ctrlp_u || deg_v >= n_ctrlp_v)
+        longjmp(buf, TS_DEG_GE_NCTRLP);
+
+    surface->deg_u = deg_u;
+    surface->deg_v = deg_v;
+    surface->order_u = deg_u + 1;
+    surface->order_v = deg_v + 1;
+    surface->dim = dim;
+    surface->n_ctrlp_u = n_ctrlp_u;
+    surface->n_ctrlp_v = n_ctrlp_v;
+    surface->n_knots_u = n_knots_u;
+    surface->n_knots_v = n_knots_v;
+    surface->ctrlp = (tsReal*) malloc(sof_ck);
+    if (surface->ctrlp == NULL)
+        longjmp(buf, TS_MALLOC);
+    surface->knots_u = surface->ctrlp + n_ctrlp*dim;
+    surface->knots_v = surface->knots_u + n_knots_u;
+
+    TRY(b, e)
+        ts_internal_bspline_fill_axis_knots(surface->knots_u, deg_u,
+                n_ctrlp_u, type, 0.f, 1.f, b);
+        ts_internal_bspline_fill_axis_knots(surface->knots_v, deg_v,
+                n_ctrlp_v, type, 0.f, 1.f, b);
+    CATCH
+        free(surface->ctrlp);
+        longjmp(buf, e);
+    ETRY
+}
+
+void ts_internal_bsplinesurface_copy(
+    const tsBSplineSurface* original,
+    tsBSplineSurface* copy, jmp_buf buf
+)
+{
+    const size_t n_ctrlp = original->n_ctrlp_u * original->n_ctrlp_v;
+    const size_t sof_ck = (n_ctrlp*original->dim + original->n_knots_u +
+            original->n_knots_v) * sizeof(tsReal);
+
+    if (original == copy)
+        return;
+
+    *copy = *original;
+    copy->ctrlp = (tsReal*) malloc(sof_ck);
+    if (copy->ctrlp == NULL)
+        longjmp(buf, TS_MALLOC);
+    memcpy(copy->ctrlp, original->ctrlp, sof_ck);
+    copy->knots_u = copy->ctrlp + n_ctrlp*original->dim;
+    copy->knots_v = copy->knots_u + original->n_knots_u;
+}
+
+void ts_internal_bsplinesurface_evaluate(
+    const tsBSplineSurface* surface, tsReal u, tsReal v,
+    tsReal* point, jmp_buf buf
+)
+{
+    const size_t dim = surface->dim;
+    const size_t p = surface->deg_u;
+    const size_t q = surface->deg_v;
+    const size_t n_v = surface->n_ctrlp_v;
+    const size_t max_order = p > q ? p+1 : q+1;
+    size_t su, sv; /* The spans of \u and \v. */
+    tsReal* Nu; /* Basis functions in u-direction. */
+    tsReal* Nv; /* Basis functions in v-direction. */
+    tsReal* tmp; /* Intermediate point of a row. */
+    tsReal* work; /* Workspace of the basis functions. */
+    const tsReal* row; /* The first affected control point of a row. */
+    size_t k, l, d; /* Used in for loops. */
+
+    su = ts_internal_find_span(surface->knots_u, p, surface->n_ctrlp_u,
+            &u, buf);
+    sv = ts_internal_find_span(surface->knots_v, q, n_v, &v, buf);
+
+    Nu = (tsReal*) malloc((p+1 + q+1 + dim + 2*max_order) * sizeof(tsReal));
+    if (Nu == NULL)
+        longjmp(buf, TS_MALLOC);
+    Nv = Nu + p+1;
+    tmp = Nv + q+1;
+    work = tmp + dim;
+    ts_internal_bspline_basis(surface->knots_u, p, su, u, Nu, work);
+    ts_internal_bspline_basis(surface->knots_v, q, sv, v, Nv, work);
+
+    ts_arr_fill(point, dim, 0.f);
+    for (k = 0; k <= p; k++) {
+        row = surface->ctrlp + ((su-p+k)*n_v + sv-q) * dim;
+        ts_arr_fill(tmp, dim, 0.f);
+        for (l = 0; l <= q; l++) {
+            for (d = 0; d < dim; d++)
+                tmp[d] += Nv[l] * row[l*dim + d];
+        }
+        for (d = 0; d < dim; d++)
+            point[d] += Nu[k] * tmp[d];
+    }
+    free(Nu);
+}
+
+void ts_internal_bsplinesurface_derivatives(
+    const tsBSplineSurface* surface, tsReal u, tsReal v, const size_t n,
+    tsReal* ders, jmp_buf buf
+)
+{
+    const size_t dim = surface->dim;
+    const size_t p = surface->deg_u;
+    const size_t q = surface->deg_v;
+    const size_t n_v = surface->n_ctrlp_v;
+    const size_t du = n < p ? n : p; /* Derivatives above the degree */
+    const size_t dv = n < q ? n : q; /* vanish. */
+    const size_t max_order = p > q ? p+1 : q+1;
+    size_t su, sv; /* The spans of \u and \v. */
+    tsReal* Nu; /* Basis functions and derivatives in u-direction. */
+    tsReal* Nv; /* Basis functions and derivatives in v-direction. */
+    tsReal* tmp; /* Intermediate points of a row. */
+    tsReal* work; /* Workspace of the basis functions. */
+    tsReal* skl; /* The current derivative. */
+    const tsReal* cp; /* The current control point. */
+    size_t k, l, r, s, d, dd; /* Used in for loops. */
+
+    su = ts_internal_find_span(surface->knots_u, p, surface->n_ctrlp_u,
+            &u, buf);
+    sv = ts_internal_find_span(surface->knots_v, q, n_v, &v, buf);
+
+    Nu = (tsReal*) malloc(((du+1)*(p+1) + (dv+1)*(q+1) + (q+1)*dim +
+            max_order*max_order + 4*max_order) * sizeof(tsReal));
+    if (Nu == NULL)
+        longjmp(buf, TS_MALLOC);
+    Nv = Nu + (du+1)*(p+1);
+    tmp = Nv + (dv+1)*(q+1);
+    work = tmp + (q+1)*dim;
+    ts_internal_bspline_basis_ders(surface->knots_u, p, su, u, du, Nu, work);
+    ts_internal_bspline_basis_ders(surface->knots_v, q, sv, v, dv, Nv, work);
+
+    ts_arr_fill(ders, (n+1)*(n+1)*dim, 0.f);
+    for (k = 0; k <= du; k++) {
+        /* collapse the rows using the k'th derivative in u-direction */
+        ts_arr_fill(tmp, (q+1)*dim, 0.f);
+        for (r = 0; r <= p; r++) {
+            cp = surface->ctrlp + ((su-p+r)*n_v + sv-q) * dim;
+            for (s = 0; s <= q; s++) {
+                for (d = 0; d < dim; d++)
+                    tmp[s*dim + d] += Nu[k*(p+1) + r] * cp[s*dim + d];
+            }
+        }
+        dd = n-k < dv ? n-k : dv;
+        for (l = 0; l <= dd; l++) {
+            skl = ders + (k*(n+1) + l) * dim;
+            for (s = 0; s <= q; s++) {
+                for (d = 0; d < dim; d++)
+                    skl[d] += Nv[l*(q+1) + s] * tmp[s*dim + d];
+            }
+        }
+    }
+    free(Nu);
+}
+
+void ts_internal_bsplinesurface_evaluate_grid(
+    const tsBSplineSurface* surface,
+    const tsReal* us, const size_t m, const tsReal* vs, const size_t n,
+    tsReal* points, jmp_buf buf
+)
+{
+    const size_t dim = surface->dim;
+    const size_t p = surface->deg_u;
+    const size_t q = surface->deg_v;
+    const size_t n_v = surface->n_ctrlp_v;
+    const size_t max_order = p > q ? p+1 : q+1;
+    size_t* spans; /* The spans of \us followed by the spans of \vs. */
+    tsReal* Nu; /* Basis functions of all values of \us. */
+    tsReal* Nv; /* Basis functions of all values of \vs. */
+    tsReal* Q; /* Row i collapsed to a curve in v-direction. */
+    tsReal* work; /* Workspace of the basis functions. */
+    tsReal* pt; /* The current output point. */
+    const tsReal* cp; /* The current control point. */
+    const tsReal* qp; /* The current point of \Q. */
+    size_t col_min, col_max; /* The columns of \Q that are required. */
+    size_t i, j, k, l, d; /* Used in for loops. */
+    tsReal val;
+    tsError e;
+    jmp_buf b;
+
+    if (m == 0 || n == 0)
+        return;
+
+    spans = (size_t*) malloc((m+n) * sizeof(size_t));
+    if (spans == NULL)
+        longjmp(buf, TS_MALLOC);
+    Nu = (tsReal*) malloc((m*(p+1) + n*(q+1) + n_v*dim + 2*max_order)
+            * sizeof(tsReal));
+    if (Nu == NULL) {
+        free(spans);
+        longjmp(buf, TS_MALLOC);
+    }
+    Nv = Nu + m*(p+1);
+    Q = Nv + n*(q+1);
+    work = Q + n_v*dim;
+
+    TRY(b, e)
+        /* 1. Basis functions of each row and column (calculated once). */
+        for (i = 0; i < m; i++) {
+            val = us[i];
+            spans[i] = ts_internal_find_span(surface->knots_u, p,
+                    surface->n_ctrlp_u, &val, b);
+            ts_internal_bspline_basis(surface->knots_u, p, spans[i], val,
+                    Nu + i*(p+1), work);
+        }
+        col_min = n_v;
+        col_max = 0;
+        for (j = 0; j < n; j++) {
+            val = vs[j];
+            spans[m+j] = ts_internal_find_span(surface->knots_v, q, n_v,
+                    &val, b);
+            ts_internal_bspline_basis(surface->knots_v, q, spans[m+j], val,
+                    Nv + j*(q+1), work);
+            if (spans[m+j]-q < col_min)
+                col_min = spans[m+j]-q;
+            if (spans[m+j] > col_max)
+                col_max = spans[m+j];
+        }
+
+        /* 2. Collapse each row into a curve and evaluate the curve at the
+         *    columns. */
+        for (i = 0; i < m; i++) {
+            ts_arr_fill(Q + col_min*dim, (col_max-col_min+1)*dim, 0.f);
+            for (k = 0; k <= p; k++) {
+                val = Nu[i*(p+1) + k];
+                cp = surface->ctrlp + (spans[i]-p+k)*n_v*dim;
+                for (l = col_min*dim; l < (col_max+1)*dim; l++)
+                    Q[l] += val * cp[l];
+            }
+            for (j = 0; j < n; j++) {
+                pt = points + (i*n + j) * dim;
+                qp = Q + (spans[m+j]-q) * dim;
+                ts_arr_fill(pt, dim, 0.f);
+                for (l = 0; l <= q; l++) {
+                    val = Nv[j*(q+1) + l];
+                    for (d = 0; d < dim; d++)
+                        pt[d] += val * qp[l*dim + d];
+                }
+            }
+        }
+    ETRY
+
+    free(spans);
+    free(Nu);
+    if (e < 0)
+        longjmp(buf, e);
+}
+
+
+/* Modes of ::ts_internal_axis_basis. */
+#define TS_AXIS_GENERIC 0 /* binary search and Cox-de Boor recursion */
+#define TS_AXIS_UNIFORM 1 /* O(1) span and Cox-de Boor recursion */
+#define TS_AXIS_UNIFORM_CUBIC 2 /* O(1) span and closed-form basis */
+
+/* The minimum number of values a grid interpolation must process before it is
+ * split across threads (if compiled with OpenMP). */
+#define TS_OPENMP_MIN_WORK 65536
+
+int ts_internal_knots_uniform(
+    const tsReal* knots, const size_t fst, const size_t lst
+)
+{
+    const tsReal h = knots[fst+1] - knots[fst];
+    size_t i; /* Used in for loops. */
+
+    if (h <= 0.f || ts_fequals(h, 0.f))
+        return 0;
+    for (i = fst+1; i < lst; i++) {
+        if (!ts_fequals(knots[i+1] - knots[i], h))
+            return 0;
+    }
+    return 1;
+}
+
+int ts_internal_axis_mode(
+    const tsReal* knots, const size_t deg, const size_t n_ctrlp
+)
+{
+    if (deg == 3 && ts_internal_knots_uniform(knots, 0, n_ctrlp+deg))
+        return TS_AXIS_UNIFORM_CUBIC;
+    if (ts_internal_knots_uniform(knots, deg, n_ctrlp))
+        return TS_AXIS_UNIFORM;
+    return TS_AXIS_GENERIC;
+}
+
+size_t ts_internal_axis_span(
+    const tsReal* knots, const size_t deg, const size_t n_ctrlp,
+    const int mode, tsReal* u, jmp_buf buf
+)
+{
+    const tsReal min = knots[deg];
+    const tsReal max = knots[n_ctrlp];
+    size_t idx;
+
+    if (mode == TS_AXIS_GENERIC)
+        return ts_internal_find_span(knots, deg, n_ctrlp, u, buf);
+    if (*u < min || *u > max) {
+        if (ts_fequals(*u, min))
+            *u = min;
+        else if (ts_fequals(*u, max))
+            *u = max;
+        else
+            longjmp(buf, TS_U_UNDEFINED);
+    }
+    idx = (size_t) ((*u - min) * (n_ctrlp-deg) / (max - min));
+    if (idx >= n_ctrlp-deg)
+        idx = n_ctrlp-deg-1;
+    return deg + idx;
+}
+
+void ts_internal_uniform_cubic_basis(
+    const tsReal t, tsReal* N
+)
+{
+    const tsReal as = 1.f/6.f; /* The value 'a sixth'. */
+    const tsReal t2 = t*t;
+    const tsReal t3 = t2*t;
+    const tsReal it = 1.f-t;
+
+    N[0] = as * it*it*it;
+    N[1] = as * (3.f*t3 - 6.f*t2 + 4.f);
+    N[2] = as * (-3.f*t3 + 3.f*t2 + 3.f*t + 1.f);
+    N[3] = as * t3;
+}
+
+void ts_internal_bsplinevolume_new(
+    const size_t n_ctrlp_u, const size_t n_ctrlp_v, const size_t n_ctrlp_w,
+    const size_t dim, const size_t deg_u, const size_t deg_v,
+    const size_t deg_w, const tsBSplineType type,
+    tsBSplineVolume* volume, jmp_buf buf
+)
+{
+    const size_t n_knots_u = n_ctrlp_u + deg_u + 1;
+    const size_t n_knots_v = n_ctrlp_v + deg_v + 1;
+    const size_t n_knots_w = n_ctrlp_w + deg_w + 1;
+    const size_t n_ctrlp = n_ctrlp_u * n_ctrlp_v * n_ctrlp_w;
+    const size_t sof_ck = (n_ctrlp*dim + n_knots_u + n_knots_v + n_knots_w)
+            * sizeof(tsReal);
+    tsError e;
+    jmp_buf b;
+
+    if (dim < 1)
+        longjmp(buf, TS_DIM_ZERO);
+    if (deg_u >= n_ctrlp_u || deg_v >= n_ctrlp_v || deg_w >= n_ctrlp_w)
+        longjmp(buf, TS_DEG_GE_NCTRLP);
+
+    volume->deg_u = deg_u;
+    volume->deg_v = deg_v;
+    volume->deg_w = deg_w;
+    volume->dim = dim;
+    volume->n_ctrlp_u = n_ctrlp_u;
+    volume->n_ctrlp_v = n_ctrlp_v;
+    volume->n_ctrlp_w = n_ctrlp_w;
+    volume->ctrlp = (tsReal*) malloc(sof_ck);
+    if (volume->ctrlp == NULL)
+        longjmp(buf, TS_MALLOC);
+    volume->knots_u = volume->ctrlp + n_ctrlp*dim;
+    volume->knots_v = volume->knots_u + n_knots_u;
+    volume->knots_w = volume->knots_v + n_knots_v;
+
+    TRY(b, e)
+        ts_internal_bspline_fill_axis_knots(volume->knots_u, deg_u,
+                n_ctrlp_u, type, 0.f, 1.f, b);
+        ts_internal_bspline_fill_axis_knots(volume->knots_v, deg_v,
+                n_ctrlp_v, type, 0.f, 1.f, b);
+        ts_internal_bspline_fill_axis_knots(volume->knots_w, deg_w,
+                n_ctrlp_w, type, 0.f, 1.f, b);
+    CATCH
+        free(volume->ctrlp);
+        longjmp(buf, e);
+    ETRY
+}
+
+void ts_internal_bsplinevolume_copy(
+    const tsBSplineVolume* original,
+    tsBSplineVolume* copy, jmp_buf buf
+)
+{
+    const size_t n_ctrlp = original->n_ctrlp_u * original->n_ctrlp_v *
+            original->n_ctrlp_w;
+    const size_t n_knots = original->n_ctrlp_u + original->deg_u + 1 +
+            original->n_ctrlp_v + original->deg_v + 1 +
+            original->n_ctrlp_w + original->deg_w + 1;
+    const size_t sof_ck = (n_ctrlp*original->dim + n_knots) * sizeof(tsReal);
+
+    if (original == copy)
+        return;
+
+    *copy = *original;
+    copy->ctrlp = (tsReal*) malloc(sof_ck);
+    if (copy->ctrlp == NULL)
+        longjmp(buf, TS_MALLOC);
+    memcpy(copy->ctrlp, original->ctrlp, sof_ck);
+    copy->knots_u = copy->ctrlp + n_ctrlp*original->dim;
+    copy->knots_v = copy->knots_u + original->n_ctrlp_u + original->deg_u + 1;
+    copy->knots_w = copy->knots_v + original->n_ctrlp_v + original->deg_v + 1;
+}
+
+void ts_internal_bsplinevolume_accumulate(
+    const tsBSplineVolume* volume, const size_t* spans,
+    const tsReal* Nu, const tsReal* Nv, const tsReal* Nw,
+    tsReal* point
+)
+{
+    const size_t dim = volume->dim;
+    const size_t p = volume->deg_u;
+    const size_t q = volume->deg_v;
+    const size_t r = volume->deg_w;
+    const size_t n_v = volume->n_ctrlp_v;
+    const size_t n_w = volume->n_ctrlp_w;
+    const tsReal* cp; /* The current control point. */
+    tsReal wab, wabc; /* The products of the basis functions. */
+    size_t a, b, c, d; /* Used in for loops. */
+
+    ts_arr_fill(point, dim, 0.f);
+    for (a = 0; a <= p; a++) {
+        for (b = 0; b <= q; b++) {
+            wab = Nu[a] * Nv[b];
+            cp = volume->ctrlp + (((spans[0]-p+a)*n_v + spans[1]-q+b)*n_w +
+                    spans[2]-r) * dim;
+            for (c = 0; c <= r; c++) {
+                wabc = wab * Nw[c];
+                for (d = 0; d < dim; d++)
+                    point[d] += wabc * cp[c*dim + d];
+            }
+        }
+    }
+}
+
+void ts_internal_bsplinevolume_evaluate(
+    const tsBSplineVolume* volume, tsReal u, tsReal v, tsReal w,
+    tsReal* point, jmp_buf buf
+)
+{
+    const size_t p = volume->deg_u;
+    const size_t q = volume->deg_v;
+    const size_t r = volume->deg_w;
+    size_t max_order = p > q ? p+1 : q+1;
+    size_t spans[3];
+    tsReal* Nu; /* Basis functions in u-direction. */
+    tsReal* Nv; /* Basis functions in v-direction. */
+    tsReal* Nw; /* Basis functions in w-direction. */
+    tsReal* work; /* Workspace of the basis functions. */
+
+    if (r+1 > max_order)
+        max_order = r+1;
+    spans[0] = ts_internal_find_span(volume->knots_u, p, volume->n_ctrlp_u,
+            &u, buf);
+    spans[1] = ts_internal_find_span(volume->knots_v, q, volume->n_ctrlp_v,
+            &v, buf);
+    spans[2] = ts_internal_find_span(volume->knots_w, r, volume->n_ctrlp_w,
+            &w, buf);
+
+    Nu = (tsReal*) malloc((p+q+r+3 + 2*max_order) * sizeof(tsReal));
+    if (Nu == NULL)
+        longjmp(buf, TS_MALLOC);
+    Nv = Nu + p+1;
+    Nw = Nv + q+1;
+    work = Nw + r+1;
+    ts_internal_bspline_basis(volume->knots_u, p, spans[0], u, Nu, work);
+    ts_internal_bspline_basis(volume->knots_v, q, spans[1], v, Nv, work);
+    ts_internal_bspline_basis(volume->knots_w, r, spans[2], w, Nw, work);
+    ts_internal_bsplinevolume_accumulate(volume, spans, Nu, Nv, Nw, point);
+    free(Nu);
+}
+
+void ts_internal_bsplinevolume_evaluate_many(
+    const tsBSplineVolume* volume, const tsReal* uvw, const size_t n,
+    tsReal* points, jmp_buf buf
+)
+{
+    const size_t B = TS_VOLUME_BLOCK_SIZE;
+    const size_t dim = volume->dim;
+    const tsReal* knots[3];
+    size_t degs[3], n_ctrlps[3], orders[3];
+    int modes[3];
+    tsReal inv_h[3]; /* Reciprocal knot distance of uniform directions. */
+    size_t* spans; /* B*3 spans of the current block. */
+    tsReal* basis; /* The basis functions of the current block. */
+    tsReal* N[3]; /* The basis functions of a direction (lane major). */
+    tsReal* t; /* B local parameters of the current direction. */
+    tsReal* work; /* Workspace of the basis functions. */
+    tsReal val;
+    size_t max_order = 0;
+    size_t blk, cnt, lane, x; /* Used in for loops. */
+    size_t sp[3]; /* The spans of a single lane. */
+    tsError e;
+    jmp_buf b;
+
+    knots[0] = volume->knots_u;
+    knots[1] = volume->knots_v;
+    knots[2] = volume->knots_w;
+    degs[0] = volume->deg_u;
+    degs[1] = volume->deg_v;
+    degs[2] = volume->deg_w;
+    n_ctrlps[0] = volume->n_ctrlp_u;
+    n_ctrlps[1] = volume->n_ctrlp_v;
+    n_ctrlps[2] = volume->n_ctrlp_w;
+    for (x = 0; x < 3; x++) {
+        orders[x] = degs[x]+1;
+        if (orders[x] > max_order)
+            max_order = orders[x];
+        modes[x] = ts_internal_axis_mode(knots[x], degs[x], n_ctrlps[x]);
+        inv_h[x] = 1.f / (knots[x][degs[x]+1] - knots[x][degs[x]]);
+    }
+
+    spans = (size_t*) malloc(3*B * sizeof(size_t));
+    if (spans == NULL)
+        longjmp(buf, TS_MALLOC);
+    basis = (tsReal*) malloc(((orders[0] + orders[1] + orders[2])*B + B +
+            2*max_order) * sizeof(tsReal));
+    if (basis == NULL) {
+        free(spans);
+        longjmp(buf, TS_MALLOC);
+    }
+    N[0] = basis;
+    N[1] = N[0] + orders[0]*B;
+    N[2] = N[1] + orders[1]*B;
+    t = N[2] + orders[2]*B;
+    work = t + B;
+
+    TRY(b, e)
+        for (blk = 0; blk < n; blk += B) {
+            cnt = n-blk < B ? n-blk : B;
+            for (x = 0; x < 3; x++) {
+                /* spans (and local parameters) of all lanes */
+                for (lane = 0; lane < cnt; lane++) {
+                    val = uvw[(blk+lane)*3 + x];
+                    spans[x*B + lane] = ts_internal_axis_span(knots[x],
+                            degs[x], n_ctrlps[x], modes[x], &val, b);
+                    t[lane] = val;
+                }
+                if (modes[x] == TS_AXIS_UNIFORM_CUBIC) {
+                    for (lane = 0; lane < cnt; lane++) {
+                        t[lane] = (t[lane] - knots[x][spans[x*B + lane]]) *
+                                inv_h[x];
+                    }
+                    for (lane = 0; lane < cnt; lane++) {
+                        ts_internal_uniform_cubic_basis(t[lane],
+                                N[x] + lane*4);
+                    }
+                } else {
+                    for (lane = 0; lane < cnt; lane++) {
+                        ts_internal_bspline_basis(knots[x], degs[x],
+                                spans[x*B + lane], t[lane],
+                                N[x] + lane*orders[x], work);
+                    }
+                }
+            }
+            for (lane = 0; lane < cnt; lane++) {
+                sp[0] = spans[lane];
+                sp[1] = spans[B + lane];
+                sp[2] = spans[2*B + lane];
+                ts_internal_bsplinevolume_accumulate(volume, sp,
+                        N[0] + lane*orders[0], N[1] + lane*orders[1],
+                        N[2] + lane*orders[2], points + (blk+lane)*dim);
+            }
+        }
+    ETRY
+
+    free(spans);
+    free(basis);
+    if (e < 0)
+        longjmp(buf, e);
+}
+
+void ts_internal_interpolate_cubic_axis(
+    const tsReal* in, const size_t outer, const size_t n, const size_t row,
+    const tsReal* m, tsReal* out
+)
+{
+    const size_t B = TS_INTERPOLATION_BLOCK_SIZE;
+    const size_t n_blocks = (row + B - 1) / B; /* Blocks per row. */
+    const long n_tasks = (long) (outer * n_blocks);
+    const tsReal* src; /* The current block of \in. */
+    tsReal* dst; /* The current block of \out. */
+    tsReal* fst; /* The phantom row in front of the solution. */
+    tsReal* lst; /* The phantom row behind the solution. */
+    size_t o, c, w; /* The outer index, first column, and width of a task. */
+    size_t i; /* Used in for loops. */
+    long t; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+
+    /* Each row of \in is a point of dimension \row. Hence, all lines of this
+     * direction could be solved with a single call. However, the rows are
+     * split into column blocks of width B so that the forward sweep and the
+     * back substitution of a task stay in cache and tasks can run in
+     * parallel. Neither pass requires a transpose. */
+#ifdef _OPENMP
+    #pragma omp parallel for private(src, dst, fst, lst, o, c, w, i) \
+        schedule(static) if (outer*n*row >= TS_OPENMP_MIN_WORK)
+#endif
+    for (t = 0; t < n_tasks; t++) {
+        o = (size_t) t / n_blocks;
+        c = ((size_t) t % n_blocks) * B;
+        w = row-c < B ? row-c : B;
+        src = in + o*n*row + c;
+        dst = out + o*(n+2)*row + c;
+        ts_internal_bspline_thomas_solve_strided(
+                src, n, w, row, row, m, dst + row);
+        /* natural end conditions: b_-1 = 2b_0 - b_1, b_n = 2b_n-1 - b_n-2 */
+        fst = dst;
+        lst = dst + (n+1)*row;
+        for (i = 0; i < w; i++) {
+            fst[i] = 2.f*fst[row + i] - fst[2*row + i];
+            lst[i] = 2.f*lst[i - row] - lst[i - 2*row];
+        }
+    }
+}
+
+/* Interpolates the grid \samples of \ns[0] x ... x \ns[n_axes-1] points of
+ * dimension \dim (the last direction varies fastest) with a cubic
+ * tensor-product spline. The directions are solved one after another,
+ * starting with the last one, with ::ts_internal_interpolate_cubic_axis.
+ * The resulting (ns[0]+2) x ... control points are stored in \ctrlp and the
+ * uniform knots of direction x, which place sample i at i/(ns[x]-1), are
+ * stored in \knots[x]. */
+void ts_internal_interpolate_cubic_grid(
+    const tsReal* samples, const size_t* ns, const size_t n_axes,
+    const size_t dim, tsReal* ctrlp, tsReal** knots, jmp_buf buf
+)
+{
+    size_t outer; /* The number of lines preceding the current direction. */
+    size_t row; /* The dimension of the points of the current direction. */
+    size_t sz_tmp = 0; /* The size of the intermediate results. */
+    size_t max_n = 0; /* The maximum number of samples of a direction. */
+    const tsReal* in; /* The input of the current direction. */
+    tsReal* out; /* The output of the current direction. */
+    tsReal* tmp; /* The intermediate results of all but the first pass. */
+    tsReal* m; /* The weights of the tridiagonal system. */
+    tsReal h; /* The distance of two knots. */
+    size_t x, k; /* Used in for loops. */
+    tsError e;
+    jmp_buf b;
+
+    /* pass x writes outer(x) * (ns[x]+2) * row(x) values */
+    row = dim;
+    for (x = n_axes; x-- > 0;) {
+        for (outer = 1, k = 0; k < x; k++)
+            outer *= ns[k];
+        if (x > 0)
+            sz_tmp += outer * (ns[x]+2) * row;
+        row *= ns[x]+2;
+        max_n = ns[x] > max_n ? ns[x] : max_n;
+    }
+    tmp = (tsReal*) malloc((sz_tmp + max_n) * sizeof(tsReal));
+    if (tmp == NULL)
+        longjmp(buf, TS_MALLOC);
+    m = tmp + sz_tmp;
+
+    TRY(b, e)
+        in = samples;
+        out = tmp;
+        row = dim;
+        for (x = n_axes; x-- > 0;) {
+            for (outer = 1, k = 0; k < x; k++)
+                outer *= ns[k];
+            if (x == 0)
+                out = ctrlp;
+            ts_internal_bspline_thomas_weights(ns[x], m);
+            ts_internal_interpolate_cubic_axis(in, outer, ns[x], row, m,
+                    out);
+            in = out;
+            out += outer * (ns[x]+2) * row;
+            row *= ns[x]+2;
+
+            h = 1.f / (ns[x]-1);
+            ts_internal_bspline_fill_axis_knots(knots[x], 3, ns[x]+2,
+                    TS_OPENED, -3.f*h, (ns[x]+2)*h, b);
+        }
+    ETRY
+
+    free(tmp);
+    if (e < 0)
+        longjmp(buf, e);
+}
+
+void ts_internal_bsplinesurface_interpolate_cubic(
+    const tsReal* samples, const size_t n_u, const size_t n_v,
+    const size_t dim, tsBSplineSurface* surface, jmp_buf buf
+)
+{
+    size_t ns[2];
+    tsReal* knots[2];
+    tsError e;
+    jmp_buf b;
+
+    if (dim == 0)
+        longjmp(buf, TS_DIM_ZERO);
+    if (n_u < 2 || n_v < 2)
+        longjmp(buf, TS_DEG_GE_NCTRLP);
+
+    ts_internal_bsplinesurface_new(n_u+2, n_v+2, dim, 3, 3, TS_NONE,
+            surface, buf);
+    ns[0] = n_u;
+    ns[1] = n_v;
+    knots[0] = surface->knots_u;
+    knots[1] = surface->knots_v;
+    TRY(b, e)
+        ts_internal_interpolate_cubic_grid(samples, ns, 2, dim,
+                surface->ctrlp, knots, b);
+    CATCH
+        ts_bsplinesurface_free(surface);
+        longjmp(buf, e);
+    ETRY
+}
+
+void ts_internal_bsplinevolume_interpolate_cubic(
+    const tsReal* samples, const size_t n_u, const size_t n_v,
+    const size_t n_w, const size_t dim,
+    tsBSplineVolume* volume, jmp_buf buf
+)
+{
+    size_t ns[3];
+    tsReal* knots[3];
+    tsError e;
+    jmp_buf b;
+
+    if (dim == 0)
+        longjmp(buf, TS_DIM_ZERO);
+    if (n_u < 2 || n_v < 2 || n_w < 2)
+        longjmp(buf, TS_DEG_GE_NCTRLP);
+
+    ts_internal_bsplinevolume_new(n_u+2, n_v+2, n_w+2, dim, 3, 3, 3,
+            TS_NONE, volume, buf);
+    ns[0] = n_u;
+    ns[1] = n_v;
+    ns[2] = n_w;
+    knots[0] = volume->knots_u;
+    knots[1] = volume->knots_v;
+    knots[2] = volume->knots_w;
+    TRY(b, e)
+        ts_internal_interpolate_cubic_grid(samples, ns, 3, dim,
+                volume->ctrlp, knots, b);
+    CATCH
+        ts_bsplinevolume_free(volume);
+        longjmp(buf, e);
+    ETRY
+}
+
+/* The number of presamples per ring used to distribute the rings of a
+ * sweep. */
+#define TS_SWEEP_PRESAMPLES 4
+
+/* Evaluates the derivatives 0..\n of \bspline at \u in knot interval
+ * \span (i.e., one-sided at the bounds of \span) and stores them in \ders
+ * ((n+1)*dim values). \work must provide space for (n+1)*order +
+ * order*order + 4*order values. */
+void ts_internal_bspline_span_ders(
+    const tsBSpline* bspline, const size_t span, const tsReal u,
+    const size_t n, tsReal* work, tsReal* ders
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t dim = bspline->dim;
+    tsReal* N = work; /* (n+1)*order values */
+    const tsReal* cp; /* The first affected control point. */
+    size_t k, j, d; /* Used in for loops. */
+
+    ts_internal_bspline_basis_ders(bspline->knots, deg, span, u, n, N,
+            N + (n+1)*order);
+    cp = bspline->ctrlp + (span-deg)*dim;
+    ts_arr_fill(ders, (n+1)*dim, 0.f);
+    for (k = 0; k <= n && k <= deg; k++) {
+        for (j = 0; j < order; j++) {
+            for (d = 0; d < dim; d++)
+                ders[k*dim + d] += N[k*order + j] * cp[j*dim + d];
+        }
+    }
+}
+
+void ts_internal_bspline_eval_ders(
+    const tsBSpline* bspline, tsReal u, const size_t n,
+    tsReal* work, tsReal* ders, jmp_buf buf
+)
+{
+    const size_t span = ts_internal_find_span(bspline->knots, bspline->deg,
+            bspline->n_ctrlp, &u, buf);
+    ts_internal_bspline_span_ders(bspline, span, u, n, work, ders);
+}
+
+/* Copies the first three components of \p (padded with 0) to \v. */
+void ts_internal_vec3(const tsReal* p, const size_t dim, tsReal* v)
+{
+    v[0] = dim > 0 ? p[0] : 0.f;
+    v[1] = dim > 1 ? p[1] : 0.f;
+    v[2] = dim > 2 ? p[2] : 0.f;
+}
+
+tsReal ts_internal_dot3(const tsReal* a, const tsReal* b)
+{
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+void ts_internal_cross3(const tsReal* a, const tsReal* b, tsReal* c)
+{
+    c[0] = a[1]*b[2] - a[2]*b[1];
+    c[1] = a[2]*b[0] - a[0]*b[2];
+    c[2] = a[0]*b[1] - a[1]*b[0];
+}
+
+/* Normalizes \v and returns its original length. Returns 0 (without
+ * touching \v) if the length of \v is 0. */
+tsReal ts_internal_normalize3(tsReal* v)
+{
+    const tsReal len = (tsReal) sqrt(ts_internal_dot3(v, v));
+    if (ts_fequals(len, 0.f))
+        return 0.f;
+    v[0] /= len;
+    v[1] /= len;
+    v[2] /= len;
+    return len;
+}
+
+/* Reflects \v at the plane with normal \n, where \c = n.n. */
+void ts_internal_reflect3(
+    const tsReal* n, const tsReal c, const tsReal* v, tsReal* r
+)
+{
+    const tsReal f = 2.f * ts_internal_dot3(n, v) / c;
+    r[0] = v[0] - f*n[0];
+    r[1] = v[1] - f*n[1];
+    r[2] = v[2] - f*n[2];
+}
+
+void ts_internal_bspline_sweep_params(
+    const tsBSpline* bspline, const size_t n,
+    tsReal* work, tsReal* us, jmp_buf buf
+)
+{
+    const size_t dim = bspline->dim;
+    const size_t m = n * TS_SWEEP_PRESAMPLES;
+    const tsReal min = bspline->knots[bspline->deg];
+    const tsReal max = bspline->knots[bspline->n_knots - bspline->order];
+    tsReal* ders; /* 2*dim values */
+    tsReal* cs; /* The cumulative arc length and angle of each presample. */
+    tsReal* cl; /* The cumulative arc length of each presample. */
+    tsReal* ca; /* The cumulative turning angle of each presample. */
+    tsReal t[3], t_prev[3], speed, speed_prev, cosa, target, f;
+    size_t i, j; /* Used in for loops. */
+
+    if (n == 0)
+        return;
+    us[0] = min;
+    if (n == 1)
+        return;
+
+    cl = work;
+    ca = cl + m+1;
+    ders = ca + m+1;
+    cs = cl; /* \cl is overwritten with the combined measure */
+    cl[0] = ca[0] = 0.f;
+    t_prev[0] = t_prev[1] = t_prev[2] = 0.f;
+    speed_prev = 0.f;
+    for (j = 0; j <= m; j++) {
+        ts_internal_bspline_eval_ders(bspline, min + (max-min)*j/m, 1,
+                ders + 2*dim, ders, buf);
+        ts_internal_vec3(ders + dim, dim, t);
+        speed = ts_internal_normalize3(t);
+        if (j > 0) {
+            cl[j] = cl[j-1] + (speed_prev + speed) * .5f * (max-min) / m;
+            cosa = ts_internal_dot3(t_prev, t);
+            cosa = cosa > 1.f ? 1.f : (cosa < -1.f ? -1.f : cosa);
+            /* zero tangents do not contribute */
+            ca[j] = ca[j-1] + (speed > 0.f && speed_prev > 0.f ?
+                    (tsReal) acos(cosa) : 0.f);
+        }
+        memcpy(t_prev, t, sizeof(t));
+        speed_prev = speed;
+    }
+
+    /* combined measure: c_j = l_j/L + a_j/A */
+    f = 0.f;
+    for (j = 0; j <= m; j++) {
+        target = 0.f;
+        if (cl[m] > 0.f)
+            target += cl[j] / cl[m];
+        if (ca[m] > 0.f)
+            target += ca[j] / ca[m];
+        if (!(cl[m] > 0.f) && !(ca[m] > 0.f))
+            target = (tsReal) j; /* degenerate: uniform */
+        cs[j] = target;
+    }
+
+    /* invert the (monotone) measure piecewise linearly */
+    j = 1;
+    for (i = 1; i < n-1; i++) {
+        target = cs[m] * i / (n-1);
+        while (j < m && cs[j] < target)
+            j++;
+        f = cs[j] > cs[j-1] ? (target - cs[j-1]) / (cs[j] - cs[j-1]) : 0.f;
+        us[i] = min + (max-min) * ((j-1) + f) / m;
+    }
+    us[n-1] = max;
+}
+
+void ts_internal_bspline_sweep(
+    const tsBSpline* bspline, const size_t n, const tsReal* profile,
+    const size_t n_profile, const int closed,
+    tsReal* vertices, size_t* indices, jmp_buf buf
+)
+{
+    const size_t dim = bspline->dim;
+    const size_t order = bspline->order;
+    const size_t m = closed ? n_profile : (n_profile > 0 ? n_profile-1 : 0);
+    const size_t n_work = (n*TS_SWEEP_PRESAMPLES+1)*2 + 2*dim +
+            2*order + order*order + 4*order; /* see sweep_params */
+    tsReal* us; /* The parameters of the rings. */
+    tsReal* work; /* Workspace of the derivatives. */
+    tsReal x[3], x_prev[3]; /* The current and previous point. */
+    tsReal t[3], t_prev[3]; /* The current and previous tangent. */
+    tsReal r[3], s[3]; /* The current reference and binormal vector. */
+    tsReal v1[3], rl[3], tl[3], v2[3]; /* Double reflection. */
+    tsReal c1, c2;
+    tsReal* ring; /* The vertices of the current ring. */
+    size_t i, k, a, b; /* Used in for loops. */
+    int axis; /* The axis used to initialize the first frame. */
+    tsError e;
+    jmp_buf jb;
+
+    if (n == 0)
+        return;
+    us = (tsReal*) malloc((n + n_work) * sizeof(tsReal));
+    if (us == NULL)
+        longjmp(buf, TS_MALLOC);
+    work = us + n;
+
+    TRY(jb, e)
+        ts_internal_bspline_sweep_params(bspline, n, work, us, jb);
+        for (i = 0; i < n; i++) {
+            ts_internal_bspline_eval_ders(bspline, us[i], 1,
+                    work + 2*dim, work, jb);
+            ts_internal_vec3(work, dim, x);
+            ts_internal_vec3(work + dim, dim, t);
+            if (ts_internal_normalize3(t) <= 0.f) {
+                /* zero derivative: keep the previous tangent */
+                if (i > 0) {
+                    memcpy(t, t_prev, sizeof(t));
+                } else {
+                    t[0] = 1.f;
+                    t[1] = t[2] = 0.f;
+                }
+            }
+
+            if (i == 0) {
+                /* r: projection of the axis least aligned with t */
+                axis = 0;
+                if (fabs(t[1]) < fabs(t[axis]))
+                    axis = 1;
+                if (fabs(t[2]) < fabs(t[axis]))
+                    axis = 2;
+                r[0] = r[1] = r[2] = 0.f;
+                r[axis] = 1.f;
+                c1 = ts_internal_dot3(r, t);
+                r[0] -= c1*t[0];
+                r[1] -= c1*t[1];
+                r[2] -= c1*t[2];
+                ts_internal_normalize3(r);
+            } else {
+                /* double reflection (Wang et al., 2008) */
+                v1[0] = x[0] - x_prev[0];
+                v1[1] = x[1] - x_prev[1];
+                v1[2] = x[2] - x_prev[2];
+                c1 = ts_internal_dot3(v1, v1);
+                if (c1 > 0.f) {
+                    ts_internal_reflect3(v1, c1, r, rl);
+                    ts_internal_reflect3(v1, c1, t_prev, tl);
+                } else {
+                    memcpy(rl, r, sizeof(r));
+                    memcpy(tl, t_prev, sizeof(t_prev));
+                }
+                v2[0] = t[0] - tl[0];
+                v2[1] = t[1] - tl[1];
+                v2[2] = t[2] - tl[2];
+                c2 = ts_internal_dot3(v2, v2);
+                if (c2 > 0.f)
+                    ts_internal_reflect3(v2, c2, rl, r);
+                else
+                    memcpy(r, rl, sizeof(rl));
+            }
+            ts_internal_cross3(t, r, s);
+
+            ring = vertices + i*n_profile*3;
+            for (k = 0; k < n_profile; k++) {
+                ring[k*3]     = x[0] + profile[k*2]*r[0] + profile[k*2+1]*s[0];
+                ring[k*3 + 1] = x[1] + profile[k*2]*r[1] + profile[k*2+1]*s[1];
+                ring[k*3 + 2] = x[2] + profile[k*2]*r[2] + profile[k*2+1]*s[2];
+            }
+            memcpy(x_prev, x, sizeof(x));
+            memcpy(t_prev, t, sizeof(t));
+        }
+    ETRY
+
+    free(us);
+    if (e < 0)
+        longjmp(buf, e);
+
+    if (indices == NULL)
+        return;
+    for (i = 0; i+1 < n; i++) {
+        for (k = 0; k < m; k++) {
+            a = i*n_profile + k;
+            b = i*n_profile + (k+1) % n_profile;
+            indices[0] = a;
+            indices[1] = b;
+            indices[2] = b + n_profile;
+            indices[3] = a;
+            indices[4] = b + n_profile;
+            indices[5] = a + n_profile;
+            indices += 6;
+        }
+    }
+}
+
+/* The number of knot values processed at once by
+ * ::ts_internal_bspline_frenet_many. */
+#define TS_FRENET_BLOCK_SIZE 64
+
+/* Frenet kernel for planar splines. \D contains the first and second
+ * derivative of \cnt lanes: D[(k*3 + d)*B + lane] with k in {0, 1}. */
+void ts_internal_frenet2(
+    const tsReal* D, const size_t cnt, tsReal* T, tsReal* N, tsReal* kappa
+)
+{
+    const size_t B = TS_FRENET_BLOCK_SIZE;
+    const tsReal* ax = D;
+    const tsReal* ay = D + B;
+    const tsReal* bx = D + 3*B;
+    const tsReal* by = D + 4*B;
+    tsReal s, inv;
+    size_t i; /* Used in for loops. */
+
+    for (i = 0; i < cnt; i++) {
+        s = (tsReal) sqrt(ax[i]*ax[i] + ay[i]*ay[i]);
+        inv = s > 0.f ? 1.f/s : 0.f;
+        T[i] = ax[i]*inv;
+        T[B + i] = ay[i]*inv;
+        N[i] = -T[B + i];
+        N[B + i] = T[i];
+        kappa[i] = (ax[i]*by[i] - ay[i]*bx[i]) * inv*inv*inv;
+    }
+}
+
+/* Frenet kernel for spatial splines. \D contains the first three derivatives
+ * of \cnt lanes: D[(k*3 + d)*B + lane]. */
+void ts_internal_frenet3(
+    const tsReal* D, const size_t cnt,
+    tsReal* T, tsReal* N, tsReal* Bn, tsReal* kappa, tsReal* tau
+)
+{
+    const size_t B = TS_FRENET_BLOCK_SIZE;
+    const tsReal* ax = D;
+    const tsReal* ay = D + B;
+    const tsReal* az = D + 2*B;
+    const tsReal* bx = D + 3*B;
+    const tsReal* by = D + 4*B;
+    const tsReal* bz = D + 5*B;
+    const tsReal* cx = D + 6*B;
+    const tsReal* cy = D + 7*B;
+    const tsReal* cz = D + 8*B;
+    tsReal s, inv, x, y, z, l, invl;
+    size_t i; /* Used in for loops. */
+
+    for (i = 0; i < cnt; i++) {
+        s = (tsReal) sqrt(ax[i]*ax[i] + ay[i]*ay[i] + az[i]*az[i]);
+        inv = s > 0.f ? 1.f/s : 0.f;
+        T[i] = ax[i]*inv;
+        T[B + i] = ay[i]*inv;
+        T[2*B + i] = az[i]*inv;
+        /* C' x C'' */
+        x = ay[i]*bz[i] - az[i]*by[i];
+        y = az[i]*bx[i] - ax[i]*bz[i];
+        z = ax[i]*by[i] - ay[i]*bx[i];
+        l = (tsReal) sqrt(x*x + y*y + z*z);
+        invl = l > 0.f && s > 0.f ? 1.f/l : 0.f;
+        kappa[i] = l * inv*inv*inv;
+        Bn[i] = x*invl;
+        Bn[B + i] = y*invl;
+        Bn[2*B + i] = z*invl;
+        /* N = B x T */
+        N[i] = Bn[B + i]*T[2*B + i] - Bn[2*B + i]*T[B + i];
+        N[B + i] = Bn[2*B + i]*T[i] - Bn[i]*T[2*B + i];
+        N[2*B + i] = Bn[i]*T[B + i] - Bn[B + i]*T[i];
+        tau[i] = (x*cx[i] + y*cy[i] + z*cz[i]) * invl*invl;
+    }
+}
+
+void ts_internal_bspline_frenet_many(
+    const tsBSpline* bspline, const tsReal* us, const size_t n,
+    tsReal* tangents, tsReal* normals, tsReal* binormals,
+    tsReal* curvatures, tsReal* torsions, jmp_buf buf
+)
+{
+    const size_t B = TS_FRENET_BLOCK_SIZE;
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t dim = bspline->dim;
+    const size_t n_ders = dim == 3 && torsions != NULL ? 3 : 2;
+    const tsReal* knots = bspline->knots;
+    const tsReal* cp; /* The first affected control point. */
+    tsReal* work; /* The basis functions and their workspace. */
+    tsReal* Nd; /* The derivatives of the basis functions. */
+    tsReal* D; /* The derivatives of the current block (k, d, lane). */
+    tsReal* T; /* The tangents of the current block. */
+    tsReal* N; /* The normals of the current block. */
+    tsReal* Bn; /* The binormals of the current block. */
+    tsReal* kappa; /* The curvatures of the current block. */
+    tsReal* tau; /* The torsions of the current block. */
+    tsReal u, val;
+    size_t span = deg; /* The span of the previous knot value. */
+    size_t blk, cnt, lane, k, j, d; /* Used in for loops. */
+    tsError e;
+    jmp_buf b;
+
+    if (dim != 2 && dim != 3)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    if (n == 0)
+        return;
+
+    work = (tsReal*) malloc(((n_ders+1)*order + order*order + 4*order +
+            9*B + 3*3*B + 2*B) * sizeof(tsReal));
+    if (work == NULL)
+        longjmp(buf, TS_MALLOC);
+    Nd = work;
+    D = Nd + (n_ders+1)*order + order*order + 4*order;
+    T = D + 9*B;
+    N = T + 3*B;
+    Bn = N + 3*B;
+    kappa = Bn + 3*B;
+    tau = kappa + B;
+    ts_arr_fill(D, 9*B, 0.f);
+
+    TRY(b, e)
+        for (blk = 0; blk < n; blk += B) {
+            cnt = n-blk < B ? n-blk : B;
+            /* local derivatives of all lanes */
+            for (lane = 0; lane < cnt; lane++) {
+                u = us[blk + lane];
+                if (!(knots[span] <= u && u < knots[span+1]))
+                    span = ts_internal_find_span(knots, deg,
+                            bspline->n_ctrlp, &u, b);
+                ts_internal_bspline_basis_ders(knots, deg, span, u, n_ders,
+                        Nd, Nd + (n_ders+1)*order);
+                cp = bspline->ctrlp + (span-deg)*dim;
+                for (k = 1; k <= n_ders; k++) {
+                    for (d = 0; d < dim; d++) {
+                        val = 0.f;
+                        if (k <= deg) {
+                            for (j = 0; j < order; j++)
+                                val += Nd[k*order + j] * cp[j*dim + d];
+                        }
+                        D[((k-1)*3 + d)*B + lane] = val;
+                    }
+                }
+            }
+
+            /* geometry */
+            if (dim == 2)
+                ts_internal_frenet2(D, cnt, T, N, kappa);
+            else
+                ts_internal_frenet3(D, cnt, T, N, Bn, kappa, tau);
+
+            /* scatter into the SoA outputs */
+            for (d = 0; d < dim; d++) {
+                if (tangents != NULL)
+                    memcpy(tangents + d*n + blk, T + d*B,
+                            cnt * sizeof(tsReal));
+                if (normals != NULL)
+                    memcpy(normals + d*n + blk, N + d*B,
+                            cnt * sizeof(tsReal));
+                if (binormals != NULL && dim == 3)
+                    memcpy(binormals + d*n + blk, Bn + d*B,
+                            cnt * sizeof(tsReal));
+            }
+            if (curvatures != NULL)
+                memcpy(curvatures + blk, kappa, cnt * sizeof(tsReal));
+            if (torsions != NULL) {
+                if (dim == 3)
+                    memcpy(torsions + blk, tau, cnt * sizeof(tsReal));
+                else
+                    ts_arr_fill(torsions + blk, cnt, 0.f);
+            }
+        }
+    ETRY
+
+    free(work);
+    if (e < 0)
+        longjmp(buf, e);
+}
+
+
+/* Nodes and weights of the 5-point Gauss-Legendre rule on [-1, 1]. */
+static const tsReal ts_internal_gl_nodes[5] = {
+    -0.9061798459386640f, -0.5384693101056831f, 0.f,
+    0.5384693101056831f, 0.9061798459386640f
+};
+static const tsReal ts_internal_gl_weights[5] = {
+    0.2369268850561891f, 0.4786286704993665f, 0.5688888888888889f,
+    0.4786286704993665f, 0.2369268850561891f
+};
+
+/* The maximum number of bisections of a span. */
+#define TS_QUADRATURE_MAX_DEPTH 24
+
+/* The minimum number of spans a spline must have to be integrated in
+ * parallel (if compiled with OpenMP). */
+#define TS_QUADRATURE_PARALLEL_SPANS 64
+
+/* The number of ulps of an estimate that bound its accuracy. Intervals
+ * whose error estimate is below are not refined, no matter the tolerance. */
+#define TS_QUADRATURE_ULPS 16
+
+/* The state of the integration of a single span. */
+typedef struct
+{
+    const tsBSpline* bspline;
+    tsIntegrand f;
+    void* ctx;
+    size_t span;
+    tsReal* work; /* Basis functions (2*order), their workspace
+ * (order*order + 4*order), points and derivatives (10*dim). */
+} tsInternalQuadrature;
+
+/* Applies the 5-point rule to [\a, \b]. All nodes are evaluated at once
+ * with the basis functions of the span of \q. */
+tsReal ts_internal_quadrature_gl5(
+    const tsInternalQuadrature* q, const tsReal a, const tsReal b
+)
+{
+    const tsBSpline* bspline = q->bspline;
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t dim = bspline->dim;
+    const tsReal* cp = bspline->ctrlp + (q->span-deg)*dim;
+    const tsReal mid = (a+b) * .5f;
+    const tsReal half = (b-a) * .5f;
+    tsReal* N = q->work; /* 2*order values */
+    tsReal* pts = N + 2*order + order*order + 4*order; /* 5*dim values */
+    tsReal* ders = pts + 5*dim; /* 5*dim values */
+    tsReal us[5];
+    tsReal sum = 0.f;
+    size_t i, j, d; /* Used in for loops. */
+
+    ts_arr_fill(pts, 10*dim, 0.f);
+    for (i = 0; i < 5; i++) {
+        us[i] = mid + half*ts_internal_gl_nodes[i];
+        ts_internal_bspline_basis_ders(bspline->knots, deg, q->span, us[i],
+                1, N, N + 2*order);
+        for (j = 0; j < order; j++) {
+            for (d = 0; d < dim; d++) {
+                pts[i*dim + d] += N[j] * cp[j*dim + d];
+                ders[i*dim + d] += N[order + j] * cp[j*dim + d];
+            }
+        }
+    }
+    for (i = 0; i < 5; i++) {
+        sum += ts_internal_gl_weights[i] *
+                q->f(us[i], pts + i*dim, ders + i*dim, dim, q->ctx);
+    }
+    return sum * half;
+}
+
+/* Bisects [\a, \b] until the halves sum up to \whole within \tol. The
+ * tolerance is absolute, thus, it is raised to a few ulps of the estimate
+ * since a float can not be more accurate. The recursion stops as well if
+ * the error estimate is not less than \prev, the one of the previous level,
+ * i.e., if rounding errors prevail. */
+tsReal ts_internal_quadrature_adapt(
+    const tsInternalQuadrature* q, const tsReal a, const tsReal b,
+    const tsReal whole, const tsReal tol, const tsReal prev,
+    const size_t depth
+)
+{
+    const tsReal m = (a+b) * .5f;
+    const tsReal left = ts_internal_quadrature_gl5(q, a, m);
+    const tsReal right = ts_internal_quadrature_gl5(q, m, b);
+    const tsReal sum = left + right;
+    const tsReal err = (tsReal) fabs(sum - whole);
+    const tsReal ulps = TS_QUADRATURE_ULPS * TS_REAL_EPSILON *
+            (tsReal) fabs(sum);
+
+    if (depth == 0 || err <= tol || err <= ulps || !(err < prev))
+        return sum;
+    return ts_internal_quadrature_adapt(
+                    q, a, m, left, tol*.5f, err, depth-1) +
+            ts_internal_quadrature_adapt(
+                    q, m, b, right, tol*.5f, err, depth-1);
+}
+
+void ts_internal_bspline_integrate(
+    const tsBSpline* bspline, const tsIntegrand f, void* ctx, tsReal tol,
+    tsReal* result, jmp_buf buf
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t n_work = 2*order + order*order + 4*order + 10*bspline->dim;
+    const tsReal* knots = bspline->knots;
+    const tsReal min = knots[deg];
+    const tsReal max = knots[bspline->n_ctrlp];
+    const long n_spans = (long) (bspline->n_ctrlp - deg);
+    size_t n_threads = 1;
+    tsReal* work; /* The workspace of all threads. */
+    tsInternalQuadrature q; /* The state of the current span. */
+    tsReal sum = 0.f;
+    tsReal a, b, t; /* The current span and its tolerance. */
+    long i; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+
+    *result = 0.f;
+    if (tol <= 0.f)
+        tol = (tsReal) FLT_MAX_ABS_ERROR;
+#ifdef _OPENMP
+    n_threads = (size_t) omp_get_max_threads();
+#endif
+    work = (tsReal*) malloc(n_threads * n_work * sizeof(tsReal));
+    if (work == NULL)
+        longjmp(buf, TS_MALLOC);
+
+    q.bspline = bspline;
+    q.f = f;
+    q.ctx = ctx;
+#ifdef _OPENMP
+    #pragma omp parallel for firstprivate(q) private(a, b, t) \
+        reduction(+:sum) schedule(dynamic) \
+        if (n_spans >= TS_QUADRATURE_PARALLEL_SPANS)
+#endif
+    for (i = 0; i < n_spans; i++) {
+        q.span = deg + (size_t) i;
+        a = knots[q.span];
+        b = knots[q.span+1];
+        if (b > a) {
+#ifdef _OPENMP
+            q.work = work + (size_t) omp_get_thread_num() * n_work;
+#else
+            q.work = work;
+#endif
+            /* distribute the tolerance proportionally */
+            t = tol * (b-a) / (max-min);
+            sum += ts_internal_quadrature_adapt(&q, a, b,
+                    ts_internal_quadrature_gl5(&q, a, b), t, FLT_MAX,
+                    TS_QUADRATURE_MAX_DEPTH);
+        }
+    }
+    free(work);
+    *result = sum;
+}
+
+tsReal ts_internal_speed(
+    const tsReal u, const tsReal* point, const tsReal* derivative,
+    const size_t dim, void* ctx
+)
+{
+    tsReal sum = 0.f;
+    size_t d; /* Used in for loops. */
+    (void) u;
+    (void) point;
+    (void) ctx;
+    for (d = 0; d < dim; d++)
+        sum += derivative[d] * derivative[d];
+    return (tsReal) sqrt(sum);
+}
+
+/* The maximum number of iterations of ::ts_internal_bspline_lookup_solve.
+ * Bisection alone halves the bracket in each iteration. */
+#define TS_LOOKUP_MAX_ITER 64
+
+/* The accuracy, in ulps, of the x-values found by
+ * ::ts_internal_bspline_lookup_solve. It is relative to the x-range of a
+ * spline for x(u) and relative to the magnitude of the bracket for u. */
+#define TS_LOOKUP_ULPS 4
+
+/* The maximum order of splines looked up without allocating memory in
+ * ::ts_bspline_lookup. */
+#define TS_LOOKUP_STACK_ORDER 8
+
+/* Evaluates x(u), x'(u), and y(u) of the two-dimensional \bspline in knot
+ * interval \span. \work must provide space for 3*order + order*order +
+ * 4*order values. */
+void ts_internal_bspline_lookup_eval(
+    const tsBSpline* bspline, const size_t span, const tsReal u,
+    tsReal* work, tsReal* x, tsReal* dx, tsReal* y
+)
+{
+    const size_t order = bspline->order;
+    const tsReal* cp = bspline->ctrlp + (span-bspline->deg)*2;
+    size_t j; /* Used in for loops. */
+
+    ts_internal_bspline_basis_ders(bspline->knots, bspline->deg, span, u, 1,
+            work, work + 2*order);
+    *x = *dx = *y = 0.f;
+    for (j = 0; j < order; j++) {
+        *x += work[j] * cp[j*2];
+        *dx += work[order + j] * cp[j*2];
+        *y += work[j] * cp[j*2 + 1];
+    }
+}
+
+void ts_internal_bspline_lookup_new(
+    const tsBSpline* bspline,
+    tsBSplineLookup* lookup, jmp_buf buf
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t n_ctrlp = bspline->n_ctrlp;
+    const tsReal* knots = bspline->knots;
+    int inc = 0, dec = 0; /* Has an increasing/decreasing edge been seen? */
+    tsReal* work; /* Workspace of ::ts_internal_bspline_lookup_eval. */
+    tsReal dx, y;
+    size_t n, i, j, k; /* Used in for loops. */
+
+    if (bspline->dim != 2)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    for (i = 0; i+1 < n_ctrlp; i++) {
+        dx = bspline->ctrlp[(i+1)*2] - bspline->ctrlp[i*2];
+        if (dx > 0.f)
+            inc = 1;
+        else if (dx < 0.f)
+            dec = 1;
+    }
+    if (inc == dec) /* both or none */
+        longjmp(buf, TS_NOT_MONOTONE);
+
+    n = 0;
+    for (j = deg; j < n_ctrlp; j++) {
+        if (knots[j] < knots[j+1])
+            n++;
+    }
+    lookup->n_spans = n;
+    lookup->decreasing = dec;
+    lookup->xs = (tsReal*) malloc(2*(n+1) * sizeof(tsReal));
+    lookup->spans = (size_t*) malloc(n * sizeof(size_t));
+    work = (tsReal*) malloc((3*order + order*order + 4*order)
+            * sizeof(tsReal));
+    if (lookup->xs == NULL || lookup->spans == NULL || work == NULL) {
+        free(lookup->xs);
+        free(lookup->spans);
+        free(work);
+        longjmp(buf, TS_MALLOC);
+    }
+    lookup->us = lookup->xs + n+1;
+
+    /* i: index of the lookup span, j: knot interval */
+    i = 0;
+    for (j = deg; j < n_ctrlp; j++) {
+        if (!(knots[j] < knots[j+1]))
+            continue;
+        k = dec ? n-1-i : i;
+        lookup->spans[k] = j;
+        lookup->us[dec ? k+1 : k] = knots[j];
+        ts_internal_bspline_lookup_eval(bspline, j, knots[j], work,
+                lookup->xs + (dec ? k+1 : k), &dx, &y);
+        if (i == n-1) {
+            lookup->us[dec ? k : k+1] = knots[j+1];
+            ts_internal_bspline_lookup_eval(bspline, j, knots[j+1], work,
+                    lookup->xs + (dec ? k : k+1), &dx, &y);
+        }
+        i++;
+    }
+    free(work);
+}
+
+/* Solves x(u) = \x in span \i of \lookup and returns y(u). The iteration
+ * stops if x(u) is within \tol of \x or if the bracket of u cannot be
+ * narrowed any further. */
+tsReal ts_internal_bspline_lookup_solve(
+    const tsBSpline* bspline, const tsBSplineLookup* lookup,
+    const size_t i, const tsReal x, const tsReal tol, tsReal* work
+)
+{
+    const size_t span = lookup->spans[i];
+    const tsReal xa = lookup->xs[i];
+    const tsReal xb = lookup->xs[i+1];
+    tsReal lo = lookup->us[i]; /* x(lo) <= x */
+    tsReal hi = lookup->us[i+1]; /* x(hi) >= x */
+    tsReal u, un, xu, dxu, y, g;
+    size_t it; /* Used in for loops. */
+
+    /* initial guess: linear interpolation of the bracket */
+    u = xb > xa ? lo + (x-xa) / (xb-xa) * (hi-lo) : lo;
+    y = 0.f;
+    for (it = 0; it < TS_LOOKUP_MAX_ITER; it++) {
+        ts_internal_bspline_lookup_eval(bspline, span, u, work,
+                &xu, &dxu, &y);
+        g = xu - x;
+        if (fabs(g) <= tol)
+            break;
+        if (g < 0.f)
+            lo = u;
+        else
+            hi = u;
+        /* lo > hi if x(u) is decreasing */
+        if (fabs(hi-lo) <= TS_LOOKUP_ULPS * TS_REAL_EPSILON *
+                (fabs(lo) + fabs(hi)))
+            break;
+        /* Newton step, replaced by bisection if it leaves the bracket
+         * (which also covers dxu == 0 producing inf/nan) */
+        un = (lo+hi) * .5f;
+        if (fabs(dxu) > 0.f) {
+            u = u - g/dxu;
+            if ((u-lo) * (u-hi) < 0.f)
+                un = u;
+        }
+        u = un;
+    }
+    return y;
+}
+
+/* Returns the tolerance of ::ts_internal_bspline_lookup_solve for the
+ * x-values of \lookup. */
+tsReal ts_internal_bspline_lookup_tol(const tsBSplineLookup* lookup)
+{
+    return TS_LOOKUP_ULPS * TS_REAL_EPSILON *
+            (tsReal) fabs(lookup->xs[lookup->n_spans] - lookup->xs[0]);
+}
+
+/* Returns the lookup span of \x, which is snapped to the bounds of \lookup
+ * if it is slightly out of range. The search starts at \i, the lookup
+ * span of the previous x-value (if any). */
+size_t ts_internal_bspline_lookup_find(
+    const tsBSplineLookup* lookup, tsReal* x, const size_t i, jmp_buf buf
+)
+{
+    const size_t n_spans = lookup->n_spans;
+    const tsReal* bounds = lookup->xs;
+    size_t lo, hi, mid; /* Used in the binary search. */
+
+    if (*x < bounds[0] || *x > bounds[n_spans]) {
+        if (ts_fequals(*x, bounds[0]))
+            *x = bounds[0];
+        else if (ts_fequals(*x, bounds[n_spans]))
+            *x = bounds[n_spans];
+        else
+            longjmp(buf, TS_U_UNDEFINED);
+    }
+    if (bounds[i] <= *x && *x <= bounds[i+1])
+        return i; /* same span as the previous value */
+    if (i+2 <= n_spans && bounds[i+1] <= *x && *x <= bounds[i+2])
+        return i+1;
+    /* bounds[lo] <= x <= bounds[hi] */
+    lo = 0;
+    hi = n_spans;
+    while (hi - lo > 1) {
+        mid = (lo+hi) / 2;
+        if (bounds[mid] <= *x)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+void ts_internal_bspline_lookup(
+    const tsBSpline* bspline, const tsBSplineLookup* lookup,
+    tsReal x, tsReal* y, jmp_buf buf
+)
+{
+    const size_t order = bspline->order;
+    /* The workspace of ::ts_internal_bspline_lookup_eval. */
+    tsReal stack[3*TS_LOOKUP_STACK_ORDER +
+            TS_LOOKUP_STACK_ORDER*TS_LOOKUP_STACK_ORDER +
+            4*TS_LOOKUP_STACK_ORDER];
+    tsReal* work = stack;
+    size_t i;
+
+    i = ts_internal_bspline_lookup_find(lookup, &x, 0, buf);
+    if (order > TS_LOOKUP_STACK_ORDER) {
+        work = (tsReal*) malloc((3*order + order*order + 4*order)
+                * sizeof(tsReal));
+        if (work == NULL)
+            longjmp(buf, TS_MALLOC);
+    }
+    *y = ts_internal_bspline_lookup_solve(bspline, lookup, i, x,
+            ts_internal_bspline_lookup_tol(lookup), work);
+    if (work != stack)
+        free(work);
+}
+
+void ts_internal_bspline_lookup_many(
+    const tsBSpline* bspline, const tsBSplineLookup* lookup,
+    const tsReal* xs, const size_t n,
+    tsReal* ys, jmp_buf buf
+)
+{
+    const size_t order = bspline->order;
+    const tsReal tol = ts_internal_bspline_lookup_tol(lookup);
+    tsReal* work; /* Workspace of ::ts_internal_bspline_lookup_eval. */
+    tsReal x;
+    size_t i = 0; /* The lookup span of the previous x-value. */
+    size_t k; /* Used in for loops. */
+    tsError e;
+    jmp_buf b;
+
+    work = (tsReal*) malloc((3*order + order*order + 4*order)
+            * sizeof(tsReal));
+    if (work == NULL)
+        longjmp(buf, TS_MALLOC);
+
+    TRY(b, e)
+        for (k = 0; k < n; k++) {
+            x = xs[k];
+            i = ts_internal_bspline_lookup_find(lookup, &x, i, b);
+            ys[k] = ts_internal_bspline_lookup_solve(bspline, lookup, i, x,
+                    tol, work);
+        }
+    ETRY
+
+    free(work);
+    if (e < 0)
+        longjmp(buf, e);
+}
+
+/* The maximum order of function splines evaluated without allocating
+ * memory in ::ts_bspline_function_evaluate. */
+#define TS_FUNCTION_STACK_ORDER 16
+
+#define TS_COMBINE_ADD      0 /* a + b */
+#define TS_COMBINE_MULTIPLY 1 /* a * b */
+
+/* Evaluates the blossom (polar form) of \bspline in knot interval \span at
+ * the \bspline->deg arguments \ts and stores the result in \out. That is,
+ * De Boor's algorithm with argument ts[r-1] in level r. If all arguments
+ * are u, \out is the point at u. \scratch must provide space for
+ * order*dim values. */
+void ts_internal_bspline_blossom(
+    const tsBSpline* bspline, const size_t span, const tsReal* ts,
+    tsReal* scratch, tsReal* out
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t dim = bspline->dim;
+    const size_t first = span - deg; /* Index of the first control point. */
+    const tsReal* knots = bspline->knots;
+    tsReal a; /* The affine weight of a level. */
+    size_t r, j, d; /* Used in for loops. */
+
+    memcpy(scratch, bspline->ctrlp + first*dim,
+            (deg+1) * dim * sizeof(tsReal));
+    for (r = 1; r <= deg; r++) {
+        /* scratch[j] belongs to knot index first+j; top-down keeps the
+         * values of level r-1 that are still needed */
+        for (j = deg; j >= r; j--) {
+            a = (ts[r-1] - knots[first+j]) /
+                    (knots[first+j + deg+1-r] - knots[first+j]);
+            for (d = 0; d < dim; d++) {
+                scratch[j*dim + d] = (1.f-a) * scratch[(j-1)*dim + d] +
+                        a * scratch[j*dim + d];
+            }
+        }
+    }
+    memcpy(out, scratch + deg*dim, dim * sizeof(tsReal));
+}
+
+/* Stores the Bezier control points of \bspline in [\c, \d] (a subset of
+ * knot interval \span) in \bezier: b_j = blossom(c^(deg-j), d^j). \work
+ * must provide space for deg + order*dim values. */
+void ts_internal_bspline_bezier_piece(
+    const tsBSpline* bspline, const size_t span, const tsReal c,
+    const tsReal d, tsReal* work, tsReal* bezier
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t dim = bspline->dim;
+    tsReal* ts = work;
+    size_t j, r; /* Used in for loops. */
+
+    for (j = 0; j <= deg; j++) {
+        for (r = 0; r < deg; r++)
+            ts[r] = r < deg-j ? c : d;
+        ts_internal_bspline_blossom(bspline, span, ts, work + deg,
+                bezier + j*dim);
+    }
+}
+
+/* Raises the degree of the Bezier curve \bezier (\deg+1 control points of
+ * dimension \dim) by one in place. \bezier must provide space for deg+2
+ * control points. */
+void ts_internal_bezier_elevate(
+    tsReal* bezier, const size_t deg, const size_t dim
+)
+{
+    const tsReal inv = 1.f / (deg+1);
+    tsReal a;
+    size_t i, d; /* Used in for loops. */
+
+    /* top-down, q_i only depends on p_(i-1) and p_i */
+    memcpy(bezier + (deg+1)*dim, bezier + deg*dim, dim * sizeof(tsReal));
+    for (i = deg; i >= 1; i--) {
+        a = i * inv;
+        for (d = 0; d < dim; d++) {
+            bezier[i*dim + d] = a * bezier[(i-1)*dim + d] +
+                    (1.f-a) * bezier[i*dim + d];
+        }
+    }
+}
+
+tsReal ts_internal_binomial(const size_t n, const size_t k)
+{
+    tsReal result = 1.f;
+    size_t i; /* Used in for loops. */
+    for (i = 1; i <= k; i++)
+        result = result * (n-k+i) / i;
+    return result;
+}
+
+/* Combines \a and \b on the intersection of their domains with \op
+ * (TS_COMBINE_ADD or TS_COMBINE_MULTIPLY) and stores the result in
+ * \result. Both splines are split into Bezier segments at the union of
+ * their breakpoints, the segments are combined, and \result gets full
+ * multiplicity at each breakpoint. If the dimensions differ, one of them
+ * must be 1 and is broadcast to the other. \result may be \a or \b. */
+void ts_internal_bspline_combine(
+    const tsBSpline* a, const tsBSpline* b, const int op,
+    tsBSpline* result, jmp_buf buf
+)
+{
+    const size_t p = a->deg, q = b->deg;
+    const size_t da = a->dim, db = b->dim;
+    const size_t dim = da > db ? da : db;
+    const size_t maxdeg = p > q ? p : q;
+    const size_t deg = op == TS_COMBINE_ADD ? maxdeg : p+q;
+    const size_t order = deg+1;
+    tsReal lo = a->knots[p] > b->knots[q] ? a->knots[p] : b->knots[q];
+    tsReal hi = a->knots[a->n_ctrlp] < b->knots[b->n_ctrlp] ?
+            a->knots[a->n_ctrlp] : b->knots[b->n_ctrlp];
+    tsReal *bps, *ba, *bb, *work; /* Breakpoints, pieces, and workspace. */
+    tsReal *out; /* The control points of the current piece. */
+    tsReal u, v, fac;
+    tsBSpline tmp;
+    size_t n_bps, i, j, k, d, ia, ib;
+    size_t span_a, span_b;
+    tsError e;
+    jmp_buf bf;
+
+    if (da != db && da != 1 && db != 1)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    if (hi < lo || ts_fequals(lo, hi))
+        longjmp(buf, TS_U_UNDEFINED);
+
+    /* merge the distinct interior knots of both splines */
+    bps = (tsReal*) malloc((a->n_knots + b->n_knots + 2) * sizeof(tsReal));
+    if (bps == NULL)
+        longjmp(buf, TS_MALLOC);
+    bps[0] = lo;
+    n_bps = 1;
+    ia = ib = 0;
+    while (ia < a->n_knots || ib < b->n_knots) {
+        if (ib == b->n_knots || (ia < a->n_knots &&
+                a->knots[ia] < b->knots[ib]))
+            u = a->knots[ia++];
+        else
+            u = b->knots[ib++];
+        /* Knots are not merged if they are close, but not equal. Otherwise,
+         * the pieces would not be polynomial and the result inexact. */
+        if (u > bps[n_bps-1] && u < hi)
+            bps[n_bps++] = u;
+    }
+    bps[n_bps++] = hi;
+
+    TRY(bf, e)
+        ts_internal_bspline_new((n_bps-1) * order, dim, deg, TS_NONE,
+                a->flags, &tmp, bf);
+    ETRY
+    if (e < 0) {
+        free(bps);
+        longjmp(buf, e);
+    }
+    /* ba and bb are large enough for elevating to \deg */
+    work = (tsReal*) malloc((2*order*dim + maxdeg + (maxdeg+1)*dim)
+            * sizeof(tsReal));
+    if (work == NULL) {
+        free(bps);
+        ts_bspline_free(&tmp);
+        longjmp(buf, TS_MALLOC);
+    }
+    ba = work;
+    bb = ba + order*dim;
+
+    TRY(bf, e)
+        for (k = 0; k+1 < n_bps; k++) {
+            /* The piece starts at bps[k] and does not contain a knot of
+             * \a or \b, i.e., the spans of bps[k] contain the piece. Unlike
+             * the midpoint, bps[k] is exact even for tiny pieces. */
+            u = v = bps[k];
+            span_a = ts_internal_find_span(a->knots, p, a->n_ctrlp, &u, bf);
+            span_b = ts_internal_find_span(b->knots, q, b->n_ctrlp, &v, bf);
+            ts_internal_bspline_bezier_piece(a, span_a, bps[k], bps[k+1],
+                    bb + order*dim, ba);
+            ts_internal_bspline_bezier_piece(b, span_b, bps[k], bps[k+1],
+                    bb + order*dim, bb);
+            out = tmp.ctrlp + k*order*dim;
+            if (op == TS_COMBINE_ADD) {
+                for (i = p; i < deg; i++)
+                    ts_internal_bezier_elevate(ba, i, da);
+                for (i = q; i < deg; i++)
+                    ts_internal_bezier_elevate(bb, i, db);
+                for (i = 0; i < order; i++) {
+                    for (d = 0; d < dim; d++) {
+                        out[i*dim + d] = ba[i*da + (da == 1 ? 0 : d)] +
+                                bb[i*db + (db == 1 ? 0 : d)];
+                    }
+                }
+            } else {
+                /* c_i = sum_(j+l=i) C(p,j) C(q,l) / C(p+q,i) a_j b_l */
+                ts_arr_fill(out, order*dim, 0.f);
+                for (j = 0; j <= p; j++) {
+                    for (i = j; i <= j+q; i++) {
+                        fac = ts_internal_binomial(p, j) *
+                                ts_internal_binomial(q, i-j) /
+                                ts_internal_binomial(deg, i);
+                        for (d = 0; d < dim; d++) {
+                            out[i*dim + d] += fac *
+                                    ba[j*da + (da == 1 ? 0 : d)] *
+                                    bb[(i-j)*db + (db == 1 ? 0 : d)];
+                        }
+                    }
+                }
+            }
+        }
+    ETRY
+    free(work);
+    if (e < 0) {
+        free(bps);
+        ts_bspline_free(&tmp);
+        longjmp(buf, e);
+    }
+
+    for (k = 0; k < n_bps; k++)
+        ts_arr_fill(tmp.knots + k*order, order, bps[k]);
+    free(bps);
+
+    if (result == a || result == b)
+        ts_bspline_free(result);
+    ts_bspline_move(&tmp, result);
+}
+
+/* Computes the antiderivative F of \original with F(min) = 0, where min is
+ * the lower bound of the domain of \original. The knot vector is extended
+ * by one knot at both ends and the control points are the cumulative sums
+ * c_(i+1) = c_i + p_i * (u_(i+deg+1) - u_i) / (deg+1), with c_0 = 0.
+ * \integral may be \original. */
+void ts_internal_bspline_integral(
+    const tsBSpline* original,
+    tsBSpline* integral, jmp_buf buf
+)
+{
+    const size_t dim = original->dim;
+    const size_t deg = original->deg;
+    const size_t nc = original->n_ctrlp;
+    const size_t nk = original->n_knots;
+    const tsReal* from_ctrlp = original->ctrlp;
+    const tsReal* from_knots = original->knots;
+    tsReal* to_ctrlp;
+    tsReal* work; /* Workspace of ::ts_internal_bspline_blossom. */
+    tsReal min = from_knots[deg];
+    tsReal fac;
+    tsBSpline tmp;
+    size_t span, i, d;
+
+    ts_internal_bspline_new(nc+1, dim, deg+1, TS_NONE, original->flags, &tmp,
+            buf);
+    to_ctrlp = tmp.ctrlp;
+
+    ts_arr_fill(to_ctrlp, dim, 0.f);
+    for (i = 0; i < nc; i++) {
+        fac = (from_knots[i+deg+1] - from_knots[i]) / (deg+1);
+        for (d = 0; d < dim; d++) {
+            to_ctrlp[(i+1)*dim + d] = to_ctrlp[i*dim + d] +
+                    fac * from_ctrlp[i*dim + d];
+        }
+    }
+    tmp.knots[0] = from_knots[0];
+    memcpy(tmp.knots + 1, from_knots, nk * sizeof(tsReal));
+    tmp.knots[nk+1] = from_knots[nk-1];
+
+    /* F(min) = 0; the basis functions sum up to 1 in the domain */
+    span = ts_internal_find_span(tmp.knots, deg+1, nc+1, &min, buf);
+    work = (tsReal*) malloc((deg+1 + (deg+2)*dim + dim) * sizeof(tsReal));
+    if (work == NULL) {
+        ts_bspline_free(&tmp);
+        longjmp(buf, TS_MALLOC);
+    }
+    ts_arr_fill(work, deg+1, min);
+    ts_internal_bspline_blossom(&tmp, span, work, work + deg+1,
+            work + deg+1 + (deg+2)*dim);
+    for (i = 0; i < nc+1; i++) {
+        for (d = 0; d < dim; d++)
+            to_ctrlp[i*dim + d] -= work[deg+1 + (deg+2)*dim + d];
+    }
+    free(work);
+
+    if (original == integral)
+        ts_bspline_free(integral);
+    ts_bspline_move(&tmp, integral);
+}
+
+/* Returns 1 if \a and \b have the same degree and knot vector, 0
+ * otherwise. */
+int ts_internal_bspline_compatible(const tsBSpline* a, const tsBSpline* b)
+{
+    size_t i; /* Used in for loops. */
+
+    if (a->deg != b->deg || a->n_knots != b->n_knots)
+        return 0;
+    /* The knots must be equal, not just close, for the sums of the
+     * control points to be exact. */
+    for (i = 0; i < a->n_knots; i++) {
+        if (a->knots[i] < b->knots[i] || b->knots[i] < a->knots[i])
+            return 0;
+    }
+    return 1;
+}
+
+void ts_internal_bspline_add(
+    const tsBSpline* a, const tsBSpline* b,
+    tsBSpline* sum, jmp_buf buf
+)
+{
+    const size_t da = a->dim, db = b->dim;
+    const size_t dim = da > db ? da : db;
+    const size_t n_ctrlp = a->n_ctrlp;
+    const tsReal* pa = a->ctrlp;
+    const tsReal* pb = b->ctrlp;
+    const int in_place = (sum == a && da == dim) || (sum == b && db == dim);
+    tsBSpline tmp;
+    tsReal* out;
+    size_t i, d; /* Used in for loops. */
+
+    if (da != db && da != 1 && db != 1)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    if (!ts_internal_bspline_compatible(a, b)) {
+        ts_internal_bspline_combine(a, b, TS_COMBINE_ADD, sum, buf);
+        return;
+    }
+
+    /* reuse the control points of \sum if it is an operand of dimension
+     * \dim, otherwise allocate new ones */
+    if (in_place) {
+        out = sum->ctrlp;
+    } else {
+        ts_internal_bspline_new(n_ctrlp, dim, a->deg, TS_NONE, a->flags,
+                &tmp, buf);
+        memcpy(tmp.knots, a->knots, a->n_knots * sizeof(tsReal));
+        out = tmp.ctrlp;
+    }
+
+    if (da == db) {
+        /* a single pass without dependencies */
+        for (i = 0; i < n_ctrlp*dim; i++)
+            out[i] = pa[i] + pb[i];
+    } else if (da == 1) {
+        for (i = 0; i < n_ctrlp; i++) {
+            for (d = 0; d < dim; d++)
+                out[i*dim + d] = pa[i] + pb[i*dim + d];
+        }
+    } else {
+        for (i = 0; i < n_ctrlp; i++) {
+            for (d = 0; d < dim; d++)
+                out[i*dim + d] = pa[i*dim + d] + pb[i];
+        }
+    }
+
+    if (!in_place) {
+        if (sum == a || sum == b)
+            ts_bspline_free(sum);
+        ts_bspline_move(&tmp, sum);
+    }
+}
+
+void ts_internal_bspline_scale(
+    const tsBSpline* original, const tsReal s,
+    tsBSpline* scaled, jmp_buf buf
+)
+{
+    const size_t n = original->n_ctrlp * original->dim;
+    tsReal* ctrlp;
+    size_t i; /* Used in for loops. */
+
+    ts_internal_bspline_copy(original, scaled, buf);
+    ctrlp = scaled->ctrlp;
+    for (i = 0; i < n; i++)
+        ctrlp[i] *= s;
+}
+
+/* Transforms the \n control points \in of dimension \dim with the row-major
+ * matrix \matrix (see ::ts_bspline_transform) and stores the result in
+ * \out, which may be \in. The matrix is copied to a local array so that
+ * the compiler does not have to assume that \out aliases it, and each
+ * supported case is a single loop without dependencies between points. */
+void ts_internal_transform_ctrlp(
+    const tsReal* in, const size_t n, const size_t dim,
+    const tsReal* matrix, const tsTransformType type,
+    tsReal* out
+)
+{
+    const size_t k = type == TS_AFFINE ? dim+1 : dim; /* Matrix size. */
+    tsReal m[16];
+    tsReal x, y, z, w;
+    size_t i; /* Used in for loops. */
+
+    memcpy(m, matrix, k*k * sizeof(tsReal));
+    if (type == TS_AFFINE && dim == 2) {
+        for (i = 0; i < n; i++) {
+            x = in[i*2]; y = in[i*2 + 1];
+            out[i*2]     = m[0]*x + m[1]*y + m[2];
+            out[i*2 + 1] = m[3]*x + m[4]*y + m[5];
+        }
+    } else if (type == TS_AFFINE) { /* dim == 3 */
+        for (i = 0; i < n; i++) {
+            x = in[i*3]; y = in[i*3 + 1]; z = in[i*3 + 2];
+            out[i*3]     = m[0]*x + m[1]*y +  m[2]*z +  m[3];
+            out[i*3 + 1] = m[4]*x + m[5]*y +  m[6]*z +  m[7];
+            out[i*3 + 2] = m[8]*x + m[9]*y + m[10]*z + m[11];
+        }
+    } else if (dim == 3) { /* TS_PROJECTIVE, 2D NURBS */
+        for (i = 0; i < n; i++) {
+            x = in[i*3]; y = in[i*3 + 1]; w = in[i*3 + 2];
+            out[i*3]     = m[0]*x + m[1]*y + m[2]*w;
+            out[i*3 + 1] = m[3]*x + m[4]*y + m[5]*w;
+            out[i*3 + 2] = m[6]*x + m[7]*y + m[8]*w;
+        }
+    } else { /* TS_PROJECTIVE, 3D NURBS */
+        for (i = 0; i < n; i++) {
+            x = in[i*4]; y = in[i*4 + 1]; z = in[i*4 + 2]; w = in[i*4 + 3];
+            out[i*4]     =  m[0]*x +  m[1]*y +  m[2]*z +  m[3]*w;
+            out[i*4 + 1] =  m[4]*x +  m[5]*y +  m[6]*z +  m[7]*w;
+            out[i*4 + 2] =  m[8]*x +  m[9]*y + m[10]*z + m[11]*w;
+            out[i*4 + 3] = m[12]*x + m[13]*y + m[14]*z + m[15]*w;
+        }
+    }
+}
+
+void ts_internal_bspline_transform(
+    const tsBSpline* original, const tsReal* matrix,
+    const tsTransformType type,
+    tsBSpline* transformed, jmp_buf buf
+)
+{
+    const size_t dim = original->dim;
+
+    if (type != TS_AFFINE && type != TS_PROJECTIVE)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    if (type == TS_AFFINE && dim != 2 && dim != 3)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    if (type == TS_PROJECTIVE && dim != 3 && dim != 4)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    ts_internal_bspline_copy(original, transformed, buf);
+    ts_internal_transform_ctrlp(transformed->ctrlp, transformed->n_ctrlp,
+            dim, matrix, type, transformed->ctrlp);
+}
+
+void ts_internal_bspline_function_check(
+    const tsBSpline* function, jmp_buf buf
+)
+{
+    if (function->dim != 1)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+}
+
+void ts_internal_bspline_function_evaluate(
+    const tsBSpline* function, tsReal x,
+    tsReal* y, jmp_buf buf
+)
+{
+    const size_t order = function->order;
+    tsReal stack[2*TS_FUNCTION_STACK_ORDER];
+    tsReal* work = stack;
+    size_t span;
+
+    ts_internal_bspline_function_check(function, buf);
+    span = ts_internal_find_span(function->knots, function->deg,
+            function->n_ctrlp, &x, buf);
+    if (order > TS_FUNCTION_STACK_ORDER) {
+        work = (tsReal*) malloc(2*order * sizeof(tsReal));
+        if (work == NULL)
+            longjmp(buf, TS_MALLOC);
+    }
+    ts_arr_fill(work, function->deg, x);
+    ts_internal_bspline_blossom(function, span, work, work + order, y);
+    if (work != stack)
+        free(work);
+}
+
+void ts_internal_bspline_function_interpolate_cubic(
+    const tsReal* ys, const size_t n, const tsReal x_min, const tsReal x_max,
+    tsBSpline* function, jmp_buf buf
+)
+{
+    size_t i; /* Used in for loops. */
+
+    if (n < 2)
+        longjmp(buf, TS_DEG_GE_NCTRLP);
+    if (x_min > x_max || ts_fequals(x_min, x_max))
+        longjmp(buf, TS_KNOTS_DECR);
+    ts_internal_bspline_interpolate_cubic(ys, n, 1, function, buf);
+    /* map the knots from [0, 1] to [x_min, x_max] */
+    for (i = 0; i < function->n_knots; i++)
+        function->knots[i] = x_min + function->knots[i] * (x_max-x_min);
+    function->knots[function->n_knots-1] = x_max;
+}
+
+/* The maximum depth of the adaptive subdivision of a knot interval in
+ * ::ts_bspline_offset, i.e., a knot interval is approximated with at most
+ * 2^TS_OFFSET_MAX_DEPTH cubic pieces. */
+#define TS_OFFSET_MAX_DEPTH 12
+
+/* The number of uniformly spaced samples per piece used to measure the
+ * error of an offset piece and to detect loops. */
+#define TS_OFFSET_SAMPLES 8
+
+/* The error of an offset piece is considered to be zero if it is at most
+ * this number of ulps of the magnitude of its coordinates (which bounds
+ * the precision of the samples the error is measured with). */
+#define TS_OFFSET_ULPS 8
+
+/* The minimum number of knot intervals required to fit the offset of a
+ * spline in parallel. */
+#define TS_OFFSET_PARALLEL_SPANS 64
+
+/* Pi, used for the arcs of round joins. */
+#define TS_PI 3.14159265358979323846
+
+/* The pieces (cubic Bezier curves with 4 two-dimensional control points,
+ * i.e., 8 values each) of an offset. */
+typedef struct
+{
+    tsReal* ctrlp;
+    size_t n; /* The number of pieces. */
+    size_t cap; /* The capacity (in pieces) of ctrlp. */
+} tsInternalOffsetPieces;
+
+void ts_internal_offset_append(
+    tsInternalOffsetPieces* pieces, const tsReal* piece, jmp_buf buf
+)
+{
+    tsReal* ctrlp;
+    if (pieces->n == pieces->cap) {
+        ctrlp = (tsReal*) realloc(pieces->ctrlp,
+                (2*pieces->cap + 4) * 8 * sizeof(tsReal));
+        if (ctrlp == NULL)
+            longjmp(buf, TS_MALLOC);
+        pieces->ctrlp = ctrlp;
+        pieces->cap = 2*pieces->cap + 4;
+    }
+    memcpy(pieces->ctrlp + pieces->n*8, piece, 8 * sizeof(tsReal));
+    pieces->n++;
+}
+
+/* Evaluates the cubic Bezier curve \b (2D) at \t and stores the result in
+ * \p. */
+void ts_internal_bezier3_eval(const tsReal* b, const tsReal t, tsReal* p)
+{
+    const tsReal s = 1.f-t;
+    const tsReal b0 = s*s*s, b1 = 3*s*s*t, b2 = 3*s*t*t, b3 = t*t*t;
+    p[0] = b0*b[0] + b1*b[2] + b2*b[4] + b3*b[6];
+    p[1] = b0*b[1] + b1*b[3] + b2*b[5] + b3*b[7];
+}
+
+/* Stores the part [\t0, \t1] of the Bezier curve \b (\deg+1 control
+ * points of dimension \dim) in \out, which must not be \b (de Casteljau's
+ * algorithm applied twice). \work must provide space for (deg+1)*dim
+ * values. */
+void ts_internal_bezier_trim(
+    const tsReal* b, const size_t deg, const size_t dim, const tsReal t0,
+    const tsReal t1, tsReal* work, tsReal* out
+)
+{
+    const size_t sof_p = dim * sizeof(tsReal);
+    tsReal t;
+    size_t r, j, d; /* Used in for loops. */
+
+    /* left part [0, t1] */
+    memcpy(work, b, (deg+1) * sof_p);
+    memcpy(out, b, sof_p);
+    for (r = 1; r <= deg; r++) {
+        for (j = 0; j <= deg-r; j++) {
+            for (d = 0; d < dim; d++)
+                work[j*dim + d] += t1 *
+                        (work[(j+1)*dim + d] - work[j*dim + d]);
+        }
+        memcpy(out + r*dim, work, sof_p);
+    }
+    /* right part [t0/t1, 1] of the left part */
+    t = t1 > 0.f ? t0/t1 : 0.f;
+    memcpy(work, out, (deg+1) * sof_p);
+    for (r = 1; r <= deg; r++) {
+        for (j = 0; j <= deg-r; j++) {
+            for (d = 0; d < dim; d++)
+                work[j*dim + d] += t *
+                        (work[(j+1)*dim + d] - work[j*dim + d]);
+        }
+        memcpy(out + (deg-r)*dim, work + (deg-r)*dim, sof_p);
+    }
+}
+
+/* Evaluates the offset O(u) = C(u) + d * N(u) of the planar \bspline in
+ * knot interval \span and its derivative O'(u) = (1 - d*k(u)) * C'(u),
+ * where N is the left normal and k the signed curvature. At points with
+ * vanishing first derivative, N is taken from C'' and O' is 0. \work must
+ * provide space for 3*order + order*order + 4*order + 6 values. */
+void ts_internal_bspline_offset_eval(
+    const tsBSpline* bspline, const size_t span, const tsReal u,
+    const tsReal d, tsReal* work, tsReal* o, tsReal* o1
+)
+{
+    const size_t order = bspline->order;
+    tsReal* ders = work + 3*order + order*order + 4*order;
+    tsReal len, f;
+
+    ts_internal_bspline_span_ders(bspline, span, u, 2, work, ders);
+    len = (tsReal) sqrt(ders[2]*ders[2] + ders[3]*ders[3]);
+    if (len > FLT_MAX_ABS_ERROR) {
+        f = 1.f - d * (ders[2]*ders[5] - ders[3]*ders[4]) / (len*len*len);
+        o[0] = ders[0] - d * ders[3] / len;
+        o[1] = ders[1] + d * ders[2] / len;
+        o1[0] = f * ders[2];
+        o1[1] = f * ders[3];
+    } else {
+        len = (tsReal) sqrt(ders[4]*ders[4] + ders[5]*ders[5]);
+        o[0] = ders[0];
+        o[1] = ders[1];
+        if (len > FLT_MAX_ABS_ERROR) {
+            o[0] -= d * ders[5] / len;
+            o[1] += d * ders[4] / len;
+        }
+        o1[0] = o1[1] = 0.f;
+    }
+}
+
+/* Approximates the offset of \bspline in [\a, \b] (a subset of knot
+ * interval \span) with cubic Hermite pieces and appends them to \pieces.
+ * [\a, \b] is bisected until the error at TS_OFFSET_SAMPLES samples is at
+ * most \tol (but at least TS_OFFSET_ULPS ulps of the coordinates of the
+ * piece) or \depth reaches TS_OFFSET_MAX_DEPTH. \work: see
+ * ::ts_internal_bspline_offset_eval. */
+void ts_internal_bspline_offset_fit(
+    const tsBSpline* bspline, const size_t span, const tsReal a,
+    const tsReal b, const tsReal d, const tsReal tol, const size_t depth,
+    tsReal* work, tsInternalOffsetPieces* pieces, jmp_buf buf
+)
+{
+    const tsReal h = (b-a) / 3.f; /* Scales O' to Bezier handles. */
+    tsReal piece[8], o[2], o1[2], p[2], dx, dy, u, m;
+    tsReal err = 0.f;
+    tsReal lim = 0.f; /* The effective tolerance. */
+    size_t i; /* Used in for loops. */
+
+    ts_internal_bspline_offset_eval(bspline, span, a, d, work, piece, o1);
+    piece[2] = piece[0] + h*o1[0];
+    piece[3] = piece[1] + h*o1[1];
+    ts_internal_bspline_offset_eval(bspline, span, b, d, work, piece+6, o1);
+    piece[4] = piece[6] - h*o1[0];
+    piece[5] = piece[7] - h*o1[1];
+
+    for (i = 0; i < 8; i++) {
+        if (fabs(piece[i]) > lim)
+            lim = (tsReal) fabs(piece[i]);
+    }
+    lim *= TS_OFFSET_ULPS * TS_REAL_EPSILON;
+    if (lim < tol)
+        lim = tol;
+    for (i = 1; i < TS_OFFSET_SAMPLES && err <= lim; i++) {
+        /* Compare at the rounded knot value (instead of i/SAMPLES) as
+         * rounding errors are scaled by the speed of the spline. */
+        u = a + (b-a) * i / TS_OFFSET_SAMPLES;
+        ts_internal_bezier3_eval(piece, (u-a) / (b-a), p);
+        ts_internal_bspline_offset_eval(bspline, span, u, d, work, o, o1);
+        dx = p[0]-o[0];
+        dy = p[1]-o[1];
+        err = (tsReal) sqrt(dx*dx + dy*dy);
+    }
+    m = (a+b) / 2;
+    if (err <= lim || depth >= TS_OFFSET_MAX_DEPTH || !(a < m && m < b)) {
+        ts_internal_offset_append(pieces, piece, buf);
+    } else {
+        ts_internal_bspline_offset_fit(bspline, span, a, m, d, tol,
+                depth+1, work, pieces, buf);
+        ts_internal_bspline_offset_fit(bspline, span, m, b, d, tol,
+                depth+1, work, pieces, buf);
+    }
+}
+
+/* Appends the pieces joining the end \p of an offset piece with the start
+ * \q of the next one. If both are at distance |\d| from the corner \c of
+ * the original curve, they are joined with circular arcs (at most 90
+ * degrees per piece), otherwise with a line. */
+void ts_internal_offset_join(
+    const tsReal* p, const tsReal* q, const tsReal* c, const tsReal d,
+    const tsReal tol, tsInternalOffsetPieces* pieces, jmp_buf buf
+)
+{
+    const tsReal r = (tsReal) fabs(d);
+    const tsReal rp = (tsReal) sqrt((p[0]-c[0])*(p[0]-c[0]) +
+            (p[1]-c[1])*(p[1]-c[1]));
+    const tsReal rq = (tsReal) sqrt((q[0]-c[0])*(q[0]-c[0]) +
+            (q[1]-c[1])*(q[1]-c[1]));
+    tsReal piece[8], a0, delta, phi, a, k;
+    size_t m, i; /* Used in for loops. */
+
+    if (fabs(rp-r) > tol || fabs(rq-r) > tol || r <= tol) {
+        for (i = 0; i < 4; i++) {
+            piece[i*2]     = p[0] + (q[0]-p[0]) * i / 3.f;
+            piece[i*2 + 1] = p[1] + (q[1]-p[1]) * i / 3.f;
+        }
+        ts_internal_offset_append(pieces, piece, buf);
+        return;
+    }
+    a0 = (tsReal) atan2(p[1]-c[1], p[0]-c[0]);
+    delta = (tsReal) atan2(q[1]-c[1], q[0]-c[0]) - a0;
+    if (delta > TS_PI)
+        delta -= 2*TS_PI;
+    else if (delta < -TS_PI)
+        delta += 2*TS_PI;
+    m = (size_t) ceil(fabs(delta) / (TS_PI/2));
+    if (m == 0)
+        m = 1;
+    phi = delta / m;
+    k = r * 4.f/3.f * (tsReal) tan(phi/4);
+    for (i = 0; i < m; i++) {
+        a = a0 + i*phi;
+        piece[0] = c[0] + r * (tsReal) cos(a);
+        piece[1] = c[1] + r * (tsReal) sin(a);
+        piece[2] = piece[0] - k * (tsReal) sin(a);
+        piece[3] = piece[1] + k * (tsReal) cos(a);
+        a += phi;
+        piece[6] = c[0] + r * (tsReal) cos(a);
+        piece[7] = c[1] + r * (tsReal) sin(a);
+        piece[4] = piece[6] + k * (tsReal) sin(a);
+        piece[5] = piece[7] - k * (tsReal) cos(a);
+        ts_internal_offset_append(pieces, piece, buf);
+    }
+    /* exact end points */
+    memcpy(pieces->ctrlp + (pieces->n-m)*8, p, 2 * sizeof(tsReal));
+    memcpy(pieces->ctrlp + pieces->n*8 - 2, q, 2 * sizeof(tsReal));
+}
+
+/* Intersects the segments [\p0, \p1] and [\q0, \q1] and stores the
+ * parameters of the intersection in \s and \t. Returns 1 if the segments
+ * intersect, 0 otherwise (parallel segments never intersect). */
+int ts_internal_segment_intersect(
+    const tsReal* p0, const tsReal* p1, const tsReal* q0, const tsReal* q1,
+    tsReal* s, tsReal* t
+)
+{
+    const tsReal rx = p1[0]-p0[0], ry = p1[1]-p0[1];
+    const tsReal ux = q1[0]-q0[0], uy = q1[1]-q0[1];
+    const tsReal wx = q0[0]-p0[0], wy = q0[1]-p0[1];
+    const tsReal den = rx*uy - ry*ux;
+
+    if (!(den < 0.f) && !(den > 0.f))
+        return 0;
+    *s = (wx*uy - wy*ux) / den;
+    *t = (wx*ry - wy*rx) / den;
+    return *s >= 0.f && *s <= 1.f && *t >= 0.f && *t <= 1.f;
+}
+
+/* Builds the bounding box hierarchy of ::ts_internal_offset_search: node
+ * \node (children 2*node and 2*node+1) covers the pieces [\lo, \hi) of
+ * which at least \lo is less than \n. \box contains the bounding boxes
+ * of the pieces (min x/y, max x/y). */
+void ts_internal_offset_build(
+    tsReal* tree, const size_t node, const size_t lo, const size_t hi,
+    const size_t n, const tsReal* box
+)
+{
+    const size_t mid = (lo+hi) / 2;
+    tsReal* b = tree + node*4;
+    const tsReal* r; /* The box of the right child. */
+    size_t j; /* Used in for loops. */
+
+    if (hi-lo == 1) {
+        memcpy(b, box + lo*4, 4 * sizeof(tsReal));
+        return;
+    }
+    ts_internal_offset_build(tree, 2*node, lo, mid, n, box);
+    memcpy(b, tree + 2*node*4, 4 * sizeof(tsReal));
+    if (mid < n) {
+        ts_internal_offset_build(tree, 2*node + 1, mid, hi, n, box);
+        r = tree + (2*node + 1)*4;
+        for (j = 0; j < 2; j++) {
+            b[j] = r[j] < b[j] ? r[j] : b[j];
+            b[2+j] = r[2+j] > b[2+j] ? r[2+j] : b[2+j];
+        }
+    }
+}
+
+/* Searches the pieces [\lo, \hi) of node \node for the last segment
+ * \qs > \seg+1 (and less than \end) of the sampled offset \pts
+ * intersecting segment \seg (with bounding box \sb). Subtrees are visited
+ * from right to left and skipped if their bounding boxes do not overlap
+ * \sb. Returns 1 if such a segment was found, 0 otherwise. */
+int ts_internal_offset_search(
+    const tsReal* tree, const size_t node, const size_t lo, const size_t hi,
+    const size_t n, const tsReal* pts, const size_t seg, const size_t end,
+    const tsReal* sb, size_t* qs, tsReal* s, tsReal* t
+)
+{
+    const size_t S = TS_OFFSET_SAMPLES;
+    const size_t mid = (lo+hi) / 2;
+    const tsReal* b = tree + node*4;
+    size_t i; /* Used in for loops. */
+
+    if (lo >= n || hi*S <= seg+2 || lo*S >= end)
+        return 0;
+    if (b[0] > sb[2] || b[2] < sb[0] || b[1] > sb[3] || b[3] < sb[1])
+        return 0;
+    if (hi-lo == 1) {
+        for (i = lo*S + S < end ? lo*S + S : end;
+                i-- > lo*S && i > seg+1;) {
+            if (ts_internal_segment_intersect(pts + seg*2, pts + (seg+1)*2,
+                    pts + i*2, pts + (i+1)*2, s, t)) {
+                *qs = i;
+                return 1;
+            }
+        }
+        return 0;
+    }
+    return ts_internal_offset_search(tree, 2*node + 1, mid, hi, n, pts, seg,
+            end, sb, qs, s, t) ||
+        ts_internal_offset_search(tree, 2*node, lo, mid, n, pts, seg, end,
+            sb, qs, s, t);
+}
+
+/* Removes the loops of the joined offset pieces \pieces (the offset at
+ * distance \d) and stores the remaining pieces in \result (with uniformly
+ * spaced knots). The pieces are sampled with TS_OFFSET_SAMPLES segments
+ * each. Starting at the first segment, the last later (non-adjacent)
+ * segment intersecting the current one is searched. If found, the
+ * crossing separates the offset into the part in between and the part
+ * before and after it, and the shorter part is cut off. That is, the ends
+ * are cut off if they cross each other (e.g., closed curves), whereas the
+ * part in between is cut off only if it is a loop running opposite to the
+ * side of the offset (at concave corners or where the radius of curvature
+ * is less than |\d|); loops of the original curve are kept. The search
+ * uses a hierarchy of bounding boxes over consecutive pieces, i.e., it
+ * takes logarithmic time unless the offset is folded. */
+void ts_internal_offset_trim(
+    const tsInternalOffsetPieces* pieces, const tsReal d,
+    tsBSpline* result, jmp_buf buf
+)
+{
+    const size_t S = TS_OFFSET_SAMPLES;
+    const size_t n = pieces->n;
+    const size_t n_segs = n*S;
+    size_t size = 1; /* The number of leaves of the hierarchy. */
+    tsReal* pts; /* The sampled points (n_segs+1). */
+    tsReal* len; /* The length of the sampled points up to a point. */
+    tsReal* box; /* The bounding boxes of the pieces (min x/y, max x/y). */
+    tsReal* tree; /* The bounding box hierarchy (2*size nodes). */
+    tsReal* cuts; /* Pairs of global parameters and intersection points. */
+    tsReal sb[4]; /* The bounding box of a segment. */
+    tsReal work[8]; /* Used to trim the pieces. */
+    tsReal ends[6]; /* Global parameters and points of the ends. */
+    tsReal s, t, g0, g1, t0, t1, x, y, l, area;
+    size_t n_cuts = 0, n_out = 0, first;
+    size_t end = n_segs; /* The segments after the ends are cut off. */
+    size_t seg, p, qs, i, j, k, pass;
+    tsError e;
+    jmp_buf b;
+
+    while (size < n)
+        size *= 2;
+    pts = (tsReal*) malloc(((n_segs+1)*3 + n*4 + 2*size*4 + (n_segs+1)*4)
+            * sizeof(tsReal));
+    if (pts == NULL)
+        longjmp(buf, TS_MALLOC);
+    len = pts + (n_segs+1)*2;
+    box = len + (n_segs+1);
+    tree = box + n*4;
+    cuts = tree + 2*size*4;
+
+    for (p = 0; p < n; p++) {
+        for (i = 0; i < S; i++)
+            ts_internal_bezier3_eval(pieces->ctrlp + p*8, (tsReal) i/S,
+                    pts + (p*S + i)*2);
+        box[p*4] = box[p*4 + 2] = pieces->ctrlp[p*8];
+        box[p*4 + 1] = box[p*4 + 3] = pieces->ctrlp[p*8 + 1];
+        for (i = 1; i < 4; i++) {
+            for (j = 0; j < 2; j++) {
+                if (pieces->ctrlp[p*8 + i*2 + j] < box[p*4 + j])
+                    box[p*4 + j] = pieces->ctrlp[p*8 + i*2 + j];
+                if (pieces->ctrlp[p*8 + i*2 + j] > box[p*4 + 2 + j])
+                    box[p*4 + 2 + j] = pieces->ctrlp[p*8 + i*2 + j];
+            }
+        }
+    }
+    memcpy(pts + n_segs*2, pieces->ctrlp + n*8 - 2, 2 * sizeof(tsReal));
+    len[0] = 0.f;
+    for (seg = 0; seg < n_segs; seg++) {
+        x = pts[(seg+1)*2] - pts[seg*2];
+        y = pts[(seg+1)*2 + 1] - pts[seg*2 + 1];
+        len[seg+1] = len[seg] + (tsReal) sqrt(x*x + y*y);
+    }
+    ts_internal_offset_build(tree, 1, 0, size, n, box);
+    ends[0] = 0.f;
+    ends[3] = (tsReal) n;
+
+    /* find the loops */
+    for (seg = 0; seg < end; seg++) {
+        for (j = 0; j < 2; j++) {
+            sb[j] = pts[seg*2 + j] < pts[(seg+1)*2 + j] ?
+                    pts[seg*2 + j] : pts[(seg+1)*2 + j];
+            sb[2+j] = pts[seg*2 + j] > pts[(seg+1)*2 + j] ?
+                    pts[seg*2 + j] : pts[(seg+1)*2 + j];
+        }
+        if (!ts_internal_offset_search(tree, 1, 0, size, n, pts, seg, end,
+                sb, &qs, &s, &t))
+            continue;
+        x = pts[seg*2] + s * (pts[(seg+1)*2] - pts[seg*2]);
+        y = pts[seg*2 + 1] + s * (pts[(seg+1)*2 + 1] - pts[seg*2 + 1]);
+        /* the length of the part in between */
+        l = len[qs] + t * (len[qs+1] - len[qs]) -
+                (len[seg] + s * (len[seg+1] - len[seg]));
+        if (2*l > len[n_segs]) {
+            /* Cut off the ends. Previous cuts are part of the start. */
+            ends[0] = (seg + s) / S;
+            ends[3] = (qs + t) / S;
+            ends[1] = ends[4] = x;
+            ends[2] = ends[5] = y;
+            n_cuts = 0;
+            end = qs+1;
+            continue;
+        }
+        /* The signed area of the part in between (relative to the
+         * intersection, which closes it). */
+        area = 0.f;
+        for (i = seg+1; i < qs; i++) {
+            area += (pts[i*2] - x) * (pts[(i+1)*2 + 1] - y) -
+                    (pts[i*2 + 1] - y) * (pts[(i+1)*2] - x);
+        }
+        if (area * d < 0.f) {
+            cuts[n_cuts*4] = (seg + s) / S;
+            cuts[n_cuts*4 + 1] = (qs + t) / S;
+            cuts[n_cuts*4 + 2] = x;
+            cuts[n_cuts*4 + 3] = y;
+            n_cuts++;
+            seg = qs-1; /* continue with qs */
+        }
+    }
+
+    /* Count the remaining pieces in the first pass and copy them in the
+     * second one. */
+    TRY(b, e)
+        for (pass = 0; pass < 2; pass++) {
+            if (pass == 1) {
+                ts_internal_bspline_new(n_out*4, 2, 3, TS_BEZIERS, TS_PACKED,
+                        result, b);
+                n_out = 0;
+            }
+            for (k = 0; k <= n_cuts; k++) {
+                g0 = k == 0 ? ends[0] : cuts[(k-1)*4 + 1];
+                g1 = k == n_cuts ? ends[3] : cuts[k*4];
+                first = n_out;
+                for (p = (size_t) g0; p < n && p <= (size_t) g1; p++) {
+                    t0 = g0 > p ? g0 - p : 0.f;
+                    t1 = g1 < p+1 ? g1 - p : 1.f;
+                    if (t1 - t0 < FLT_MAX_ABS_ERROR)
+                        continue;
+                    if (pass == 1) {
+                        ts_internal_bezier_trim(pieces->ctrlp + p*8, 3, 2,
+                                t0, t1, work, result->ctrlp + n_out*8);
+                    }
+                    n_out++;
+                }
+                if (pass == 0 || n_out == first)
+                    continue;
+                /* snap the ends to the intersections */
+                if (k > 0) {
+                    memcpy(result->ctrlp + first*8, cuts + (k-1)*4 + 2,
+                            2 * sizeof(tsReal));
+                } else if (end < n_segs) {
+                    memcpy(result->ctrlp + first*8, ends + 1,
+                            2 * sizeof(tsReal));
+                }
+                if (k < n_cuts) {
+                    memcpy(result->ctrlp + n_out*8 - 2, cuts + k*4 + 2,
+                            2 * sizeof(tsReal));
+                } else if (end < n_segs) {
+                    memcpy(result->ctrlp + n_out*8 - 2, ends + 4,
+                            2 * sizeof(tsReal));
+                }
+            }
+        }
+    ETRY
+    free(pts);
+    if (e < 0)
+        longjmp(buf, e);
+}
+
+void ts_internal_bspline_offset(
+    const tsBSpline* bspline, const tsReal d, const tsReal tol,
+    tsBSpline* offset, jmp_buf buf
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t n_ctrlp = bspline->n_ctrlp;
+    const tsReal* knots = bspline->knots;
+    const size_t sof_work = (7*order + order*order + 6) * sizeof(tsReal);
+    size_t n_spans = 0;
+    size_t* spans; /* The non-empty knot intervals. */
+    tsInternalOffsetPieces* fitted; /* The pieces of each knot interval. */
+    tsInternalOffsetPieces joined;
+    tsReal* work; /* Workspace of ::ts_internal_bspline_offset_eval. */
+    tsReal* ders; /* Points into work. */
+    tsReal end[2]; /* The end of the previous knot interval. */
+    tsError err = TS_SUCCESS;
+    tsError e;
+    jmp_buf b;
+    tsBSpline tmp;
+    size_t i; /* Used in for loops. */
+    long j; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+
+    if (bspline->dim != 2)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    if (deg < 1)
+        longjmp(buf, TS_UNDERIVABLE);
+    for (i = deg; i < n_ctrlp; i++) {
+        if (knots[i] < knots[i+1])
+            n_spans++;
+    }
+    spans = (size_t*) malloc(n_spans * sizeof(size_t));
+    fitted = (tsInternalOffsetPieces*) malloc(
+            n_spans * sizeof(tsInternalOffsetPieces));
+    work = (tsReal*) malloc(sof_work);
+    if (spans == NULL || fitted == NULL || work == NULL) {
+        free(spans);
+        free(fitted);
+        free(work);
+        longjmp(buf, TS_MALLOC);
+    }
+    n_spans = 0;
+    for (i = deg; i < n_ctrlp; i++) {
+        if (knots[i] < knots[i+1]) {
+            fitted[n_spans].ctrlp = NULL;
+            fitted[n_spans].n = fitted[n_spans].cap = 0;
+            spans[n_spans++] = i;
+        }
+    }
+
+    /* Each knot interval is fitted with its own jmp_buf and workspace,
+     * i.e., longjmp never crosses thread boundaries. */
+#ifdef _OPENMP
+    #pragma omp parallel for private(e, b) schedule(dynamic) \
+        if (n_spans >= TS_OFFSET_PARALLEL_SPANS)
+#endif
+    for (j = 0; j < (long) n_spans; j++) {
+        tsReal* w = (tsReal*) malloc(sof_work);
+        if (w == NULL) {
+            e = TS_MALLOC;
+        } else {
+            TRY(b, e)
+                ts_internal_bspline_offset_fit(bspline, spans[j],
+                        knots[spans[j]], knots[spans[j]+1], d, tol, 0, w,
+                        fitted + j, b);
+            ETRY
+            free(w);
+        }
+        if (e < 0) {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            err = e;
+        }
+    }
+
+    /* join the knot intervals and remove the loops */
+    joined.ctrlp = NULL;
+    joined.n = joined.cap = 0;
+    ders = work + 7*order + order*order;
+    TRY(b, e)
+        if (err < 0)
+            longjmp(b, err);
+        for (i = 0; i < n_spans; i++) {
+            if (i > 0) {
+                /* copy, joining may reallocate joined.ctrlp */
+                memcpy(end, joined.ctrlp + joined.n*8 - 2,
+                        2 * sizeof(tsReal));
+                if ((end[0]-fitted[i].ctrlp[0])*(end[0]-fitted[i].ctrlp[0]) +
+                        (end[1]-fitted[i].ctrlp[1])*(end[1]-fitted[i].ctrlp[1])
+                        > tol*tol) {
+                    ts_internal_bspline_span_ders(bspline, spans[i-1],
+                            knots[spans[i]], 0, work, ders);
+                    ts_internal_offset_join(end, fitted[i].ctrlp, ders, d,
+                            tol, &joined, b);
+                }
+            }
+            for (j = 0; j < (long) fitted[i].n; j++) {
+                ts_internal_offset_append(&joined, fitted[i].ctrlp + j*8,
+                        b);
+            }
+        }
+        ts_internal_offset_trim(&joined, d, &tmp, b);
+    ETRY
+
+    for (i = 0; i < n_spans; i++)
+        free(fitted[i].ctrlp);
+    free(fitted);
+    free(spans);
+    free(work);
+    free(joined.ctrlp);
+    if (e < 0)
+        longjmp(buf, e);
+
+    if (offset == bspline)
+        ts_bspline_free(offset);
+    ts_bspline_move(&tmp, offset);
+}
+
+/* The maximum recursion depth of the Bezier clipping in
+ * ::ts_bspline_self_intersections. */
+#define TS_INTERSECT_MAX_DEPTH 64
+
+/* Two hits whose parameters differ by less than this fraction of the width
+ * of their knot intervals (and whose points are within a few multiples of
+ * the tolerance) are considered to be the same intersection. */
+#define TS_INTERSECT_MERGE 0.5
+
+/* The bounding box of a Bezier piece, sorted along the sweep axis. */
+typedef struct
+{
+    tsReal min[2];
+    tsReal max[2];
+    size_t piece;
+} tsInternalIntersectBox;
+
+/* The state of ::ts_bspline_self_intersections. */
+typedef struct
+{
+    size_t order;
+    tsReal tol;
+    tsReal width; /* The width of the knot intervals of the current pair. */
+    tsReal* stack; /* 6 curves per recursion level. */
+    tsReal* hits; /* u, v, x, y, width of each hit. */
+    size_t n; /* The number of hits. */
+    size_t cap; /* The capacity (in hits) of hits. */
+    int axis; /* The sweep axis. */
+} tsInternalIntersections;
+
+int ts_internal_intersect_box_cmp(const void* a, const void* b)
+{
+    const tsInternalIntersectBox* p = (const tsInternalIntersectBox*) a;
+    const tsInternalIntersectBox* q = (const tsInternalIntersectBox*) b;
+    return p->min[0] < q->min[0] ? -1 : (p->min[0] > q->min[0] ? 1 : 0);
+}
+
+/* Compares the first values of two arrays of tsReal (e.g., for qsort). */
+int ts_internal_real_cmp(const void* a, const void* b)
+{
+    const tsReal* p = (const tsReal*) a;
+    const tsReal* q = (const tsReal*) b;
+    return p[0] < q[0] ? -1 : (p[0] > q[0] ? 1 : 0);
+}
+
+/* Stores the bounding box of the control points \b (\n two-dimensional
+ * points) in \box (min x/y, max x/y). */
+void ts_internal_bezier_box(const tsReal* b, const size_t n, tsReal* box)
+{
+    size_t i, j; /* Used in for loops. */
+
+    box[0] = box[2] = b[0];
+    box[1] = box[3] = b[1];
+    for (i = 1; i < n; i++) {
+        for (j = 0; j < 2; j++) {
+            if (b[i*2 + j] < box[j])
+                box[j] = b[i*2 + j];
+            if (b[i*2 + j] > box[2 + j])
+                box[2 + j] = b[i*2 + j];
+        }
+    }
+}
+
+/* Returns the total absolute turning angle of the polygon \pts (\n
+ * two-dimensional points). A Bezier curve turns at most as much as its
+ * control polygon, and a curve needs to turn by more than pi to intersect
+ * itself. */
+tsReal ts_internal_polygon_turning(const tsReal* pts, const size_t n)
+{
+    tsReal sum = 0.f;
+    tsReal e[2], prev[2] = {0.f, 0.f};
+    int has_prev = 0;
+    size_t i; /* Used in for loops. */
+
+    for (i = 0; i+1 < n; i++) {
+        e[0] = pts[(i+1)*2] - pts[i*2];
+        e[1] = pts[(i+1)*2 + 1] - pts[i*2 + 1];
+        if (!(e[0] < 0.f) && !(e[0] > 0.f) && !(e[1] < 0.f) &&
+                !(e[1] > 0.f))
+            continue;
+        if (has_prev) {
+            sum += (tsReal) fabs(atan2(prev[0]*e[1] - prev[1]*e[0],
+                    prev[0]*e[0] + prev[1]*e[1]));
+        }
+        prev[0] = e[0];
+        prev[1] = e[1];
+        has_prev = 1;
+    }
+    return sum;
+}
+
+void ts_internal_intersect_report(
+    tsInternalIntersections* ctx, const tsReal* ra, const tsReal* rb,
+    const tsReal* box_a, const tsReal* box_b, jmp_buf buf
+)
+{
+    const tsReal u = (ra[0] + ra[1]) / 2.f;
+    const tsReal v = (rb[0] + rb[1]) / 2.f;
+    tsReal* hit;
+    tsReal* tmp;
+
+    if (ctx->n == ctx->cap) {
+        ctx->cap = ctx->cap == 0 ? 16 : ctx->cap*2;
+        tmp = (tsReal*) realloc(ctx->hits, ctx->cap*5 * sizeof(tsReal));
+        if (tmp == NULL)
+            longjmp(buf, TS_MALLOC);
+        ctx->hits = tmp;
+    }
+    hit = ctx->hits + ctx->n*5;
+    hit[0] = u < v ? u : v;
+    hit[1] = u < v ? v : u;
+    hit[2] = (box_a[0] + box_a[2] + box_b[0] + box_b[2]) / 4.f;
+    hit[3] = (box_a[1] + box_a[3] + box_b[1] + box_b[3]) / 4.f;
+    hit[4] = ctx->width;
+    ctx->n++;
+}
+
+/* Intersects the Bezier curves \a (defined on the global parameters
+ * [ra[0], ra[1]]) and \b with Bezier clipping: the parts of \a outside of
+ * the fat line of \b (the band between the control points of \b parallel
+ * to its chord) are cut off and the roles are swapped. If this removes
+ * less than 20%, the larger curve is halved instead. */
+void ts_internal_bezier_clip(
+    tsInternalIntersections* ctx, const tsReal* a, const tsReal* ra,
+    const tsReal* b, const tsReal* rb, const size_t depth, jmp_buf buf
+)
+{
+    const size_t order = ctx->order;
+    const size_t deg = order-1;
+    const size_t n_vals = order*2;
+    tsReal* clipped = ctx->stack + depth*6*n_vals;
+    tsReal* halves = clipped + n_vals;
+    tsReal* work = halves + 2*n_vals;
+    tsReal box_a[4], box_b[4], r[4];
+    tsReal ext_a, ext_b, len, nx, ny, dist, dmin, dmax, tmin, tmax, t;
+    tsReal lvl[2];
+    size_t i, j, k; /* Used in for loops. */
+
+    ts_internal_bezier_box(a, order, box_a);
+    ts_internal_bezier_box(b, order, box_b);
+    if (box_a[0] > box_b[2] + ctx->tol || box_b[0] > box_a[2] + ctx->tol ||
+            box_a[1] > box_b[3] + ctx->tol || box_b[1] > box_a[3] + ctx->tol)
+        return;
+    ext_a = box_a[2]-box_a[0] > box_a[3]-box_a[1] ?
+            box_a[2]-box_a[0] : box_a[3]-box_a[1];
+    ext_b = box_b[2]-box_b[0] > box_b[3]-box_b[1] ?
+            box_b[2]-box_b[0] : box_b[3]-box_b[1];
+    /* The parts of the curves may not get smaller than \tol if it is
+     * below the floating point precision of their coordinates. */
+    if ((ext_a <= ctx->tol && ext_b <= ctx->tol) ||
+            depth+1 >= TS_INTERSECT_MAX_DEPTH) {
+        ts_internal_intersect_report(ctx, ra, rb, box_a, box_b, buf);
+        return;
+    }
+    if (ext_a <= ctx->tol) {
+        ts_internal_bezier_clip(ctx, b, rb, a, ra, depth+1, buf);
+        return;
+    }
+
+    /* clip \a against the fat line of \b */
+    tmin = 0.f;
+    tmax = 1.f;
+    nx = b[1] - b[deg*2 + 1];
+    ny = b[deg*2] - b[0];
+    len = (tsReal) sqrt(nx*nx + ny*ny);
+    if (len > FLT_MAX_ABS_ERROR * ctx->tol) {
+        nx /= len;
+        ny /= len;
+        dmin = dmax = 0.f;
+        for (i = 1; i < deg; i++) {
+            dist = nx * (b[i*2] - b[0]) + ny * (b[i*2 + 1] - b[1]);
+            dmin = dist < dmin ? dist : dmin;
+            dmax = dist > dmax ? dist : dmax;
+        }
+        /* widened by \tol to compensate rounding errors */
+        lvl[0] = dmin - ctx->tol;
+        lvl[1] = dmax + ctx->tol;
+        /* the distances of \a form a Bezier function whose convex hull
+         * contains all of its zero crossings with the band */
+        for (i = 0; i < order; i++) {
+            work[i] = nx * (a[i*2] - b[0]) + ny * (a[i*2 + 1] - b[1]);
+        }
+        tmin = 2.f;
+        tmax = -1.f;
+        for (i = 0; i < order; i++) {
+            t = (tsReal) i / deg;
+            if (work[i] >= lvl[0] && work[i] <= lvl[1]) {
+                tmin = t < tmin ? t : tmin;
+                tmax = t > tmax ? t : tmax;
+            }
+            for (j = i+1; j < order; j++) {
+                for (k = 0; k < 2; k++) {
+                    if ((work[i] - lvl[k]) * (work[j] - lvl[k]) >= 0.f)
+                        continue;
+                    t = ((tsReal) i + (lvl[k] - work[i]) /
+                            (work[j] - work[i]) * (j-i)) / deg;
+                    tmin = t < tmin ? t : tmin;
+                    tmax = t > tmax ? t : tmax;
+                }
+            }
+        }
+        if (tmin > tmax)
+            return;
+    }
+
+    if (tmax - tmin > 0.8f) {
+        /* halve the larger curve */
+        if (ext_a >= ext_b) {
+            r[0] = ra[0];
+            r[1] = r[2] = (ra[0] + ra[1]) / 2.f;
+            r[3] = ra[1];
+            ts_internal_bezier_trim(a, deg, 2, 0.f, .5f, work, halves);
+            ts_internal_bezier_trim(a, deg, 2, .5f, 1.f, work,
+                    halves + n_vals);
+            ts_internal_bezier_clip(ctx, b, rb, halves, r, depth+1, buf);
+            ts_internal_bezier_clip(ctx, b, rb, halves + n_vals, r+2,
+                    depth+1, buf);
+        } else {
+            r[0] = rb[0];
+            r[1] = r[2] = (rb[0] + rb[1]) / 2.f;
+            r[3] = rb[1];
+            ts_internal_bezier_trim(b, deg, 2, 0.f, .5f, work, halves);
+            ts_internal_bezier_trim(b, deg, 2, .5f, 1.f, work,
+                    halves + n_vals);
+            ts_internal_bezier_clip(ctx, halves, r, a, ra, depth+1, buf);
+            ts_internal_bezier_clip(ctx, halves + n_vals, r+2, a, ra,
+                    depth+1, buf);
+        }
+        return;
+    }
+    ts_internal_bezier_trim(a, deg, 2, tmin, tmax, work, clipped);
+    r[0] = ra[0] + tmin * (ra[1]-ra[0]);
+    r[1] = ra[0] + tmax * (ra[1]-ra[0]);
+    ts_internal_bezier_clip(ctx, b, rb, clipped, r, depth+1, buf);
+}
+
+/* Intersects the Bezier curves \a and \b that are joined at the end of \a
+ * and the start of \b, ignoring the joint. Unless both turn by more than
+ * pi, there is nothing to do. Otherwise, the halves next to the joint are
+ * handled recursively and all other combinations are clipped. */
+void ts_internal_bezier_clip_adjacent(
+    tsInternalIntersections* ctx, const tsReal* a, const tsReal* ra,
+    const tsReal* b, const tsReal* rb, const size_t depth, jmp_buf buf
+)
+{
+    const size_t order = ctx->order;
+    const size_t deg = order-1;
+    const size_t n_vals = order*2;
+    tsReal* a_halves = ctx->stack + depth*6*n_vals;
+    tsReal* b_halves = a_halves + 2*n_vals;
+    tsReal* work = b_halves + 2*n_vals;
+    tsReal box_a[4], box_b[4], r[8];
+    const tsReal min = 4 * ctx->tol;
+
+    /* Parts within a few \tol of the joint can't be told apart from it
+     * (the bounding boxes are compared with tolerance). */
+    ts_internal_bezier_box(a, order, box_a);
+    ts_internal_bezier_box(b, order, box_b);
+    if ((box_a[2]-box_a[0] <= min && box_a[3]-box_a[1] <= min) ||
+            (box_b[2]-box_b[0] <= min && box_b[3]-box_b[1] <= min) ||
+            depth+1 >= TS_INTERSECT_MAX_DEPTH)
+        return;
+    memcpy(work, a, n_vals * sizeof(tsReal));
+    memcpy(work + n_vals, b + 2, (n_vals-2) * sizeof(tsReal));
+    if (ts_internal_polygon_turning(work, 2*order-1) < TS_PI)
+        return;
+    ts_internal_bezier_trim(a, deg, 2, 0.f, .5f, work, a_halves);
+    ts_internal_bezier_trim(a, deg, 2, .5f, 1.f, work, a_halves + n_vals);
+    ts_internal_bezier_trim(b, deg, 2, 0.f, .5f, work, b_halves);
+    ts_internal_bezier_trim(b, deg, 2, .5f, 1.f, work, b_halves + n_vals);
+    r[0] = ra[0];
+    r[1] = r[2] = (ra[0] + ra[1]) / 2.f;
+    r[3] = ra[1];
+    r[4] = rb[0];
+    r[5] = r[6] = (rb[0] + rb[1]) / 2.f;
+    r[7] = rb[1];
+    ts_internal_bezier_clip(ctx, a_halves, r, b, rb, depth+1, buf);
+    ts_internal_bezier_clip(ctx, a_halves + n_vals, r+2, b_halves + n_vals,
+            r+6, depth+1, buf);
+    ts_internal_bezier_clip_adjacent(ctx, a_halves + n_vals, r+2, b_halves,
+            r+4, depth+1, buf);
+}
+
+/* Finds the intersections of the Bezier curve \a with itself. */
+void ts_internal_bezier_clip_self(
+    tsInternalIntersections* ctx, const tsReal* a, const tsReal* ra,
+    jmp_buf buf
+)
+{
+    const size_t order = ctx->order;
+    const size_t n_vals = order*2;
+    tsReal* halves = ctx->stack;
+    tsReal r[4];
+
+    if (ts_internal_polygon_turning(a, order) < TS_PI)
+        return;
+    ts_internal_bezier_trim(a, order-1, 2, 0.f, .5f, halves + 2*n_vals,
+            halves);
+    ts_internal_bezier_trim(a, order-1, 2, .5f, 1.f, halves + 2*n_vals,
+            halves + n_vals);
+    r[0] = ra[0];
+    r[1] = r[2] = (ra[0] + ra[1]) / 2.f;
+    r[3] = ra[1];
+    ts_internal_bezier_clip_adjacent(ctx, halves, r, halves + n_vals, r+2,
+            1, buf);
+}
+
+/* Returns whether the end of piece \i is the start of piece \j. */
+int ts_internal_intersect_joined(
+    const tsReal* pieces, const size_t order, const size_t i,
+    const size_t j, const tsReal tol
+)
+{
+    const tsReal* p = pieces + (i*order + order-1)*2;
+    const tsReal* q = pieces + j*order*2;
+    return fabs(p[0]-q[0]) <= tol && fabs(p[1]-q[1]) <= tol;
+}
+
+void ts_internal_bspline_self_intersections(
+    const tsBSpline* bspline, const tsReal tol, tsReal** us, size_t* n,
+    jmp_buf buf
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t n_vals = order*2;
+    const tsReal* knots = bspline->knots;
+    size_t n_pieces = 0;
+    tsReal* pieces; /* The Bezier pieces of the non-empty knot intervals. */
+    tsReal* doms; /* The domains of the pieces. */
+    tsReal* work; /* Workspace of ::ts_internal_bspline_bezier_piece. */
+    tsInternalIntersectBox* boxes;
+    tsInternalIntersections ctx;
+    tsReal ext[4], tmp, slack;
+    tsReal* hit;
+    tsReal* kept;
+    size_t i, j, k, p, q, n_kept; /* Used in for loops. */
+    tsError e;
+    jmp_buf b;
+
+    *us = NULL;
+    *n = 0;
+    if (bspline->dim != 2)
+        longjmp(buf, TS_DIM_UNSUPPORTED);
+    for (i = deg; i < bspline->n_ctrlp; i++) {
+        if (knots[i] < knots[i+1])
+            n_pieces++;
+    }
+    pieces = (tsReal*) malloc((n_pieces*n_vals + n_pieces*2 +
+            TS_INTERSECT_MAX_DEPTH*6*n_vals + deg + order*2) *
+            sizeof(tsReal));
+    boxes = (tsInternalIntersectBox*) malloc(
+            n_pieces * sizeof(tsInternalIntersectBox));
+    if (pieces == NULL || boxes == NULL) {
+        free(pieces);
+        free(boxes);
+        longjmp(buf, TS_MALLOC);
+    }
+    doms = pieces + n_pieces*n_vals;
+    ctx.stack = doms + n_pieces*2;
+    work = ctx.stack + TS_INTERSECT_MAX_DEPTH*6*n_vals;
+    ctx.order = order;
+    ctx.tol = tol;
+    ctx.hits = NULL;
+    ctx.n = ctx.cap = 0;
+
+    /* decompose into Bezier pieces and sweep along the axis in which the
+     * curve extends the most */
+    p = 0;
+    for (i = deg; i < bspline->n_ctrlp; i++) {
+        if (!(knots[i] < knots[i+1]))
+            continue;
+        ts_internal_bspline_bezier_piece(bspline, i, knots[i], knots[i+1],
+                work, pieces + p*n_vals);
+        doms[p*2] = knots[i];
+        doms[p*2 + 1] = knots[i+1];
+        p++;
+    }
+    ts_internal_bezier_box(pieces, n_pieces*order, ext);
+    ctx.axis = ext[3]-ext[1] > ext[2]-ext[0] ? 1 : 0;
+    for (p = 0; p < n_pieces; p++) {
+        ts_internal_bezier_box(pieces + p*n_vals, order, ext);
+        for (j = 0; j < 2; j++) {
+            k = ctx.axis ? 1-j : j;
+            boxes[p].min[j] = ext[k];
+            boxes[p].max[j] = ext[2 + k];
+        }
+        boxes[p].piece = p;
+    }
+    qsort(boxes, n_pieces, sizeof(tsInternalIntersectBox),
+            ts_internal_intersect_box_cmp);
+
+    TRY(b, e)
+        for (p = 0; p < n_pieces; p++) {
+            ctx.width = doms[p*2 + 1] - doms[p*2];
+            ts_internal_bezier_clip_self(&ctx, pieces + p*n_vals,
+                    doms + p*2, b);
+        }
+        for (i = 0; i < n_pieces; i++) {
+            for (j = i+1; j < n_pieces &&
+                    !(boxes[j].min[0] > boxes[i].max[0]); j++) {
+                if (boxes[j].min[1] > boxes[i].max[1] ||
+                        boxes[i].min[1] > boxes[j].max[1])
+                    continue;
+                p = boxes[i].piece < boxes[j].piece ?
+                        boxes[i].piece : boxes[j].piece;
+                q = boxes[i].piece < boxes[j].piece ?
+                        boxes[j].piece : boxes[i].piece;
+                ctx.width = doms[p*2 + 1] - doms[p*2];
+                tmp = doms[q*2 + 1] - doms[q*2];
+                ctx.width = tmp > ctx.width ? tmp : ctx.width;
+                if (q == p+1 && ts_internal_intersect_joined(pieces,
+                        order, p, q, tol)) {
+                    ts_internal_bezier_clip_adjacent(&ctx,
+                            pieces + p*n_vals, doms + p*2,
+                            pieces + q*n_vals, doms + q*2, 0, b);
+                } else if (p == 0 && q == n_pieces-1 &&
+                        ts_internal_intersect_joined(pieces, order, q, p,
+                        tol)) {
+                    /* closed curve */
+                    ts_internal_bezier_clip_adjacent(&ctx,
+                            pieces + q*n_vals, doms + q*2,
+                            pieces + p*n_vals, doms + p*2, 0, b);
+                } else {
+                    ts_internal_bezier_clip(&ctx, pieces + p*n_vals,
+                            doms + p*2, pieces + q*n_vals, doms + q*2, 0,
+                            b);
+                }
+            }
+        }
+    ETRY
+    free(pieces);
+    free(boxes);
+    if (e < 0) {
+        free(ctx.hits);
+        longjmp(buf, e);
+    }
+    if (ctx.n == 0)
+        return;
+
+    /* Merge the hits of the same intersection (e.g., found in
+     * neighbouring subdivisions or knot intervals). Hits are chained, i.e.,
+     * the point of a kept hit is moved to the last hit merged into it. */
+    qsort(ctx.hits, ctx.n, 5 * sizeof(tsReal),
+            ts_internal_real_cmp);
+    n_kept = 0;
+    for (i = 0; i < ctx.n; i++) {
+        hit = ctx.hits + i*5;
+        slack = (tsReal) TS_INTERSECT_MERGE * hit[4];
+        kept = NULL;
+        for (k = n_kept; k > 0; k--) {
+            kept = ctx.hits + (k-1)*5;
+            if (hit[0] - kept[0] > slack) {
+                kept = NULL;
+                break;
+            }
+            if (fabs(hit[1] - kept[1]) <= slack &&
+                    fabs(hit[2] - kept[2]) <= 4*tol &&
+                    fabs(hit[3] - kept[3]) <= 4*tol)
+                break;
+            kept = NULL;
+        }
+        if (kept != NULL) {
+            kept[2] = hit[2];
+            kept[3] = hit[3];
+        } else {
+            memmove(ctx.hits + n_kept*5, hit, 5 * sizeof(tsReal));
+            n_kept++;
+        }
+    }
+    for (i = 0; i < n_kept; i++) {
+        ctx.hits[i*2] = ctx.hits[i*5];
+        ctx.hits[i*2 + 1] = ctx.hits[i*5 + 1];
+    }
+    *us = ctx.hits;
+    *n = n_kept;
+}
+
+/* The edge length (in cells) of the square tiles of a distance field. */
+#define TS_SDF_TILE 32
+
+/* The maximum distance (in cells) of a tessellated spline to its segments.
+ * Cells closer to a spline may have the wrong sign. */
+#define TS_SDF_FLATNESS 0.0625
+
+/* The maximum number of segments of a tessellated Bezier piece (see
+ * ::ts_internal_bezier_flatten). */
+#define TS_FLATTEN_MAX_SEGMENTS 65536
+
+/* The maximum number of Newton iterations used to refine the distance of
+ * a cell to the closest segment. */
+#define TS_SDF_NEWTON 4
+
+/* Newton's method stops if a step is shorter than this (in cells). */
+#define TS_SDF_NEWTON_TOL 1e-2
+
+/* A line segment of a tessellated Bezier piece. */
+typedef struct
+{
+    tsReal p[4]; /* x0, y0, x1, y1 */
+    tsReal t[2]; /* The parameters of the end points on the piece. */
+    size_t piece; /* The index of the tessellated piece. */
+    int closing; /* Closes a spline, i.e., belongs to no piece. */
+} tsInternalSegment;
+
+typedef struct
+{
+    tsInternalSegment* segs;
+    size_t n; /* The number of segments. */
+    size_t cap; /* The capacity (in segments) of segs. */
+} tsInternalSegments;
+
+/* The Bezier pieces (one per non-empty knot interval) of the splines of a
+ * distance field. */
+typedef struct
+{
+    tsReal* ctrlp; /* 2*max_order values per piece. */
+    size_t* splines; /* The spline of each piece. */
+    size_t max_order;
+} tsInternalSdfPieces;
+
+void ts_internal_segments_append(
+    tsInternalSegments* segments, const tsReal* p0, const tsReal* p1,
+    const tsReal t0, const tsReal t1, const size_t piece, const int closing,
+    jmp_buf buf
+)
+{
+    tsInternalSegment* tmp;
+    tsInternalSegment* seg;
+
+    if (segments->n == segments->cap) {
+        segments->cap = segments->cap == 0 ? 64 : segments->cap*2;
+        tmp = (tsInternalSegment*) realloc(segments->segs,
+                segments->cap * sizeof(tsInternalSegment));
+        if (tmp == NULL)
+            longjmp(buf, TS_MALLOC);
+        segments->segs = tmp;
+    }
+    seg = segments->segs + segments->n;
+    seg->p[0] = p0[0];
+    seg->p[1] = p0[1];
+    seg->p[2] = p1[0];
+    seg->p[3] = p1[1];
+    seg->t[0] = t0;
+    seg->t[1] = t1;
+    seg->piece = piece;
+    seg->closing = closing;
+    segments->n++;
+}
+
+/* Tessellates Bezier piece \piece, whose control points (\deg+1
+ * two-dimensional points) are \b, into uniformly spaced segments. Their
+ * number m is the minimum guaranteeing a distance of at most \tol to the
+ * curve, i.e., deg*(deg-1)/8 * max|b_i - 2*b_(i+1) + b_(i+2)| / m^2 <= tol.
+ * \work must provide space for (deg+1)*2 values. */
+void ts_internal_bezier_flatten(
+    const tsReal* b, const size_t deg, const tsReal tol, const size_t piece,
+    tsReal* work, tsInternalSegments* segments, jmp_buf buf
+)
+{
+    tsReal dx, dy, dd = 0.f, m, t, prev[2];
+    size_t n = 1, k, r, j; /* Used in for loops. */
+
+    for (j = 0; j+2 <= deg; j++) {
+        dx = b[j*2] - 2*b[(j+1)*2] + b[(j+2)*2];
+        dy = b[j*2 + 1] - 2*b[(j+1)*2 + 1] + b[(j+2)*2 + 1];
+        dd = dx*dx + dy*dy > dd ? dx*dx + dy*dy : dd;
+    }
+    if (dd > 0.f && tol > 0.f) {
+        m = (tsReal) ceil(sqrt(deg*(deg-1) / 8.f * sqrt(dd) / tol));
+        n = m < TS_FLATTEN_MAX_SEGMENTS ? (size_t) m :
+                TS_FLATTEN_MAX_SEGMENTS;
+        n = n < 1 ? 1 : n;
+    }
+    memcpy(prev, b, 2 * sizeof(tsReal));
+    for (k = 1; k <= n; k++) {
+        /* de Casteljau */
+        t = (tsReal) k / n;
+        memcpy(work, b, (deg+1)*2 * sizeof(tsReal));
+        for (r = 1; r <= deg && k < n; r++) {
+            for (j = 0; j <= deg-r; j++) {
+                work[j*2] += t * (work[(j+1)*2] - work[j*2]);
+                work[j*2 + 1] += t * (work[(j+1)*2 + 1] - work[j*2 + 1]);
+            }
+        }
+        if (k == n)
+            memcpy(work, b + deg*2, 2 * sizeof(tsReal));
+        ts_internal_segments_append(segments, prev, work, (tsReal) (k-1) / n,
+                t, piece, 0, buf);
+        memcpy(prev, work, 2 * sizeof(tsReal));
+    }
+}
+
+/* Returns the squared distance of \p to \seg and stores the position of
+ * the closest point on \seg in \t. */
+tsReal ts_internal_sdf_segment_dist2(
+    const tsInternalSegment* seg, const tsReal* p, tsReal* t
+)
+{
+    const tsReal ex = seg->p[2] - seg->p[0];
+    const tsReal ey = seg->p[3] - seg->p[1];
+    const tsReal len2 = ex*ex + ey*ey;
+    tsReal dx = p[0] - seg->p[0];
+    tsReal dy = p[1] - seg->p[1];
+
+    *t = len2 > 0.f ? (dx*ex + dy*ey) / len2 : 0.f;
+    *t = *t < 0.f ? 0.f : (*t > 1.f ? 1.f : *t);
+    dx -= *t * ex;
+    dy -= *t * ey;
+    return dx*dx + dy*dy;
+}
+
+/* Evaluates the planar Bezier curve \b (\deg+1 control points) and its
+ * first two derivatives at \t and stores them in \ders (6 values). \work
+ * must provide space for (deg+1)*2 values. */
+void ts_internal_bezier_ders2(
+    const tsReal* b, const size_t deg, const tsReal t, tsReal* work,
+    tsReal* ders
+)
+{
+    const tsReal s = 1.f-t;
+    size_t r, j, d; /* Used in for loops. */
+
+    memset(ders, 0, 6 * sizeof(tsReal));
+    memcpy(work, b, (deg+1)*2 * sizeof(tsReal));
+    /* de Casteljau down to three (or less) points */
+    for (r = 1; r+2 <= deg; r++) {
+        for (j = 0; j <= deg-r; j++) {
+            for (d = 0; d < 2; d++)
+                work[j*2 + d] = s*work[j*2 + d] + t*work[(j+1)*2 + d];
+        }
+    }
+    for (d = 0; d < 2; d++) {
+        if (deg >= 2) {
+            ders[4 + d] = deg*(deg-1) *
+                    (work[4 + d] - 2*work[2 + d] + work[d]);
+            work[d] = s*work[d] + t*work[2 + d];
+            work[2 + d] = s*work[2 + d] + t*work[4 + d];
+        }
+        if (deg >= 1) {
+            ders[2 + d] = deg * (work[2 + d] - work[d]);
+            work[d] = s*work[d] + t*work[2 + d];
+        }
+        ders[d] = work[d];
+    }
+}
+
+/* Returns the distance of \p to the Bezier piece \piece (of \pieces),
+ * whose closest point is approximately at \t, refined with Newton's method
+ * applied to (C(t) - p) . C'(t) = 0 until a step moves C(t) by less than
+ * \tol. Leaving the piece continues on the neighbouring piece of the same
+ * spline. \work must provide space for 2*max_order + 6 values. */
+tsReal ts_internal_sdf_newton(
+    const tsBSpline* splines, const tsInternalSdfPieces* pieces,
+    size_t piece, tsReal t, const tsReal* p, const tsReal tol,
+    const size_t n_pieces, tsReal* work
+)
+{
+    const size_t stride = 2*pieces->max_order;
+    const size_t spline = pieces->splines[piece];
+    const size_t deg = splines[spline].deg;
+    tsReal* ders = work + stride;
+    tsReal dx, dy, f, df, step, best = -1.f;
+    size_t i; /* Used in for loops. */
+
+    for (i = 0; i <= TS_SDF_NEWTON; i++) {
+        ts_internal_bezier_ders2(pieces->ctrlp + piece*stride, deg, t, work,
+                ders);
+        dx = ders[0] - p[0];
+        dy = ders[1] - p[1];
+        if (best < 0.f || dx*dx + dy*dy < best)
+            best = dx*dx + dy*dy;
+        f = dx*ders[2] + dy*ders[3];
+        df = ders[2]*ders[2] + ders[3]*ders[3] + dx*ders[4] + dy*ders[5];
+        if (i == TS_SDF_NEWTON || !(df > 0.f))
+            break;
+        step = f / df;
+        t -= step;
+        /* evaluate once more if converged */
+        if (step*step * (ders[2]*ders[2] + ders[3]*ders[3]) < tol*tol)
+            i = TS_SDF_NEWTON-1;
+        if (t < 0.f) {
+            t = 0.f;
+            if (piece > 0 && pieces->splines[piece-1] == spline) {
+                piece--;
+                t = 1.f;
+            }
+        } else if (t > 1.f) {
+            t = 1.f;
+            if (piece+1 < n_pieces && pieces->splines[piece+1] == spline) {
+                piece++;
+                t = 0.f;
+            }
+        }
+    }
+    return (tsReal) sqrt(best);
+}
+
+/* Computes the unsigned distances of the cells of tile (\tx, \ty) within
+ * \band using the segments \bin (\n_bin indices into \segs). Each segment
+ * only updates the cells within \band of its bounding box, the closest
+ * ones are refined afterwards. \work must provide space for
+ * 2*TS_SDF_TILE^2 values followed by the workspace of
+ * ::ts_internal_sdf_newton, \closest for TS_SDF_TILE^2 values. */
+void ts_internal_sdf_tile(
+    const tsBSpline* splines, const tsInternalSdfPieces* pieces,
+    const size_t n_pieces, const tsInternalSegment* segs,
+    const size_t* bin, const size_t n_bin, const tsReal* origin,
+    const tsReal cell, const size_t width, const size_t height,
+    const tsReal band, const size_t tx, const size_t ty, tsReal* work,
+    size_t* closest, float* grid
+)
+{
+    const size_t T = TS_SDF_TILE;
+    const size_t r0 = ty*T, c0 = tx*T;
+    const size_t r1 = r0+T < height ? r0+T : height;
+    const size_t c1 = c0+T < width ? c0+T : width;
+    const tsInternalSegment* seg;
+    tsReal* d2s = work; /* The squared distances to the closest segments. */
+    tsReal* ts = d2s + T*T; /* The closest points on these segments. */
+    tsReal p[2], d2, t, lo, hi, dist;
+    size_t rs, re, cs, ce, k;
+    size_t r, c, i; /* Used in for loops. */
+
+    for (k = 0; k < T*T; k++)
+        d2s[k] = band*band;
+    for (i = 0; i < n_bin; i++) {
+        seg = segs + bin[i];
+        /* the cells within band of the segment */
+        lo = ((seg->p[0] < seg->p[2] ? seg->p[0] : seg->p[2]) - band -
+                origin[0]) / cell - .5f;
+        hi = ((seg->p[0] < seg->p[2] ? seg->p[2] : seg->p[0]) + band -
+                origin[0]) / cell - .5f;
+        cs = lo > (tsReal) c0 ? (size_t) lo + 1 : c0;
+        ce = hi < (tsReal) c1 ? (size_t) hi + 1 : c1;
+        lo = ((seg->p[1] < seg->p[3] ? seg->p[1] : seg->p[3]) - band -
+                origin[1]) / cell - .5f;
+        hi = ((seg->p[1] < seg->p[3] ? seg->p[3] : seg->p[1]) + band -
+                origin[1]) / cell - .5f;
+        rs = lo > (tsReal) r0 ? (size_t) lo + 1 : r0;
+        re = hi < (tsReal) r1 ? (size_t) hi + 1 : r1;
+        for (r = rs; r < re; r++) {
+            p[1] = origin[1] + (r + .5f) * cell;
+            for (c = cs; c < ce; c++) {
+                p[0] = origin[0] + (c + .5f) * cell;
+                k = (r-r0)*T + (c-c0);
+                d2 = ts_internal_sdf_segment_dist2(seg, p, &t);
+                if (d2 < d2s[k]) {
+                    d2s[k] = d2;
+                    ts[k] = t;
+                    closest[k] = bin[i];
+                }
+            }
+        }
+    }
+    for (r = r0; r < r1; r++) {
+        p[1] = origin[1] + (r + .5f) * cell;
+        for (c = c0; c < c1; c++) {
+            p[0] = origin[0] + (c + .5f) * cell;
+            k = (r-r0)*T + (c-c0);
+            dist = band;
+            if (d2s[k] < band*band) {
+                seg = segs + closest[k];
+                dist = ts_internal_sdf_newton(splines, pieces, seg->piece,
+                        seg->t[0] + ts[k] * (seg->t[1] - seg->t[0]), p,
+                        (tsReal) TS_SDF_NEWTON_TOL * cell, n_pieces,
+                        work + 2*T*T);
+                dist = dist < band ? dist : band;
+            }
+            grid[r*width + c] = (float) dist;
+        }
+    }
+}
+
+/* Negates the cells of row \r that are inside of the tessellated splines
+ * (even-odd rule). \bin (\n_bin indices into \segs) contains at least all
+ * segments crossing the row, \xs must provide space for n_bin values. */
+void ts_internal_sdf_sign(
+    const tsInternalSegment* segs, const size_t* bin, const size_t n_bin,
+    const tsReal* origin, const tsReal cell, const size_t width,
+    const size_t r, tsReal* xs, float* grid
+)
+{
+    const tsReal y = origin[1] + (r + .5f) * cell;
+    const tsInternalSegment* seg;
+    size_t n_xs = 0, k = 0;
+    size_t i, c; /* Used in for loops. */
+
+    for (i = 0; i < n_bin; i++) {
+        seg = segs + bin[i];
+        if ((seg->p[1] > y) != (seg->p[3] > y)) {
+            xs[n_xs++] = seg->p[0] + (y - seg->p[1]) *
+                    (seg->p[2] - seg->p[0]) / (seg->p[3] - seg->p[1]);
+        }
+    }
+    qsort(xs, n_xs, sizeof(tsReal), ts_internal_real_cmp);
+    for (c = 0; c < width; c++) {
+        while (k < n_xs && xs[k] < origin[0] + (c + .5f) * cell)
+            k++;
+        if (k % 2)
+            grid[r*width + c] = -grid[r*width + c];
+    }
+}
+
+void ts_internal_bspline_distance_field(
+    const tsBSpline* splines, const size_t n_splines, const tsReal* origin,
+    const tsReal cell, const size_t width, const size_t height,
+    const tsReal band, float* grid, jmp_buf buf
+)
+{
+    const size_t n_tx = (width + TS_SDF_TILE-1) / TS_SDF_TILE;
+    const size_t n_ty = (height + TS_SDF_TILE-1) / TS_SDF_TILE;
+    const size_t n_bins = n_tx*n_ty + n_ty;
+    const tsReal size = TS_SDF_TILE * cell;
+    tsInternalSdfPieces pieces;
+    tsInternalSegments segments;
+    const tsInternalSegment* seg;
+    size_t* starts; /* The first entry of each bin in bins. */
+    size_t* bins; /* The segments of the tiles followed by the rows. */
+    tsReal* stack; /* Used to tessellate the splines. */
+    size_t max_order = 1, n_pieces = 0, n_stack, n_work, first, sum;
+    tsReal box[4], lo, hi;
+    size_t s, i, k, tx0, tx1, ty0, ty1, tx, ty, pass;
+    long j; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+    tsError err = TS_SUCCESS;
+    tsError e;
+    jmp_buf b;
+
+    for (s = 0; s < n_splines; s++) {
+        if (splines[s].dim != 2)
+            longjmp(buf, TS_DIM_UNSUPPORTED);
+        max_order = splines[s].order > max_order ?
+                splines[s].order : max_order;
+        for (i = splines[s].deg; i < splines[s].n_ctrlp; i++) {
+            if (splines[s].knots[i] < splines[s].knots[i+1])
+                n_pieces++;
+        }
+    }
+    n_stack = 3*max_order;
+    n_work = 2*TS_SDF_TILE*TS_SDF_TILE + 2*max_order + 6;
+    stack = (tsReal*) malloc(n_stack * sizeof(tsReal));
+    starts = (size_t*) calloc(n_bins + 1, sizeof(size_t));
+    pieces.ctrlp = (tsReal*) malloc(n_pieces*2*max_order * sizeof(tsReal));
+    pieces.splines = (size_t*) malloc(n_pieces * sizeof(size_t));
+    pieces.max_order = max_order;
+    if (stack == NULL || starts == NULL || pieces.ctrlp == NULL ||
+            pieces.splines == NULL) {
+        free(stack);
+        free(starts);
+        free(pieces.ctrlp);
+        free(pieces.splines);
+        longjmp(buf, TS_MALLOC);
+    }
+    segments.segs = NULL;
+    segments.n = segments.cap = 0;
+    bins = NULL;
+
+    TRY(b, e)
+        /* tessellate the knot intervals and close the splines */
+        for (k = 0, s = 0; s < n_splines; s++) {
+            first = segments.n;
+            for (i = splines[s].deg; i < splines[s].n_ctrlp; i++) {
+                if (!(splines[s].knots[i] < splines[s].knots[i+1]))
+                    continue;
+                ts_internal_bspline_bezier_piece(splines + s, i,
+                        splines[s].knots[i], splines[s].knots[i+1], stack,
+                        pieces.ctrlp + k*2*max_order);
+                pieces.splines[k] = s;
+                ts_internal_bezier_flatten(pieces.ctrlp + k*2*max_order,
+                        splines[s].deg, (tsReal) TS_SDF_FLATNESS * cell, k,
+                        stack, &segments, b);
+                k++;
+            }
+            if (segments.n > first) {
+                /* copy, appending may move the segments */
+                memcpy(box, segments.segs[segments.n-1].p + 2,
+                        2 * sizeof(tsReal));
+                memcpy(box + 2, segments.segs[first].p, 2 * sizeof(tsReal));
+                ts_internal_segments_append(&segments, box, box + 2, 0.f, 0.f,
+                        k-1, 1, b);
+            }
+        }
+
+        /* Bin the segments (expanded by \band) into the tiles and all
+         * segments, including the closing ones, into the rows of tiles.
+         * Count in the first pass and fill in the second one. */
+        for (pass = 0; pass < 2; pass++) {
+            for (i = 0; i < segments.n; i++) {
+                seg = segments.segs + i;
+                box[0] = seg->p[0] < seg->p[2] ? seg->p[0] : seg->p[2];
+                box[1] = seg->p[1] < seg->p[3] ? seg->p[1] : seg->p[3];
+                box[2] = seg->p[0] < seg->p[2] ? seg->p[2] : seg->p[0];
+                box[3] = seg->p[1] < seg->p[3] ? seg->p[3] : seg->p[1];
+                lo = (box[1] - origin[1]) / size;
+                hi = (box[3] - origin[1]) / size;
+                if (hi >= 0.f && lo < (tsReal) n_ty) {
+                    ty0 = lo > 0.f ? (size_t) lo : 0;
+                    ty1 = hi < (tsReal) n_ty ? (size_t) hi : n_ty-1;
+                    for (ty = ty0; ty <= ty1; ty++) {
+                        k = n_tx*n_ty + ty;
+                        if (pass == 0)
+                            starts[k]++;
+                        else
+                            bins[starts[k]++] = i;
+                    }
+                }
+                if (seg->closing)
+                    continue;
+                lo = (box[0] - band - origin[0]) / size;
+                hi = (box[2] + band - origin[0]) / size;
+                if (hi < 0.f || lo >= (tsReal) n_tx)
+                    continue;
+                tx0 = lo > 0.f ? (size_t) lo : 0;
+                tx1 = hi < (tsReal) n_tx ? (size_t) hi : n_tx-1;
+                lo = (box[1] - band - origin[1]) / size;
+                hi = (box[3] + band - origin[1]) / size;
+                if (hi < 0.f || lo >= (tsReal) n_ty)
+                    continue;
+                ty0 = lo > 0.f ? (size_t) lo : 0;
+                ty1 = hi < (tsReal) n_ty ? (size_t) hi : n_ty-1;
+                for (ty = ty0; ty <= ty1; ty++) {
+                    for (tx = tx0; tx <= tx1; tx++) {
+                        k = ty*n_tx + tx;
+                        if (pass == 0)
+                            starts[k]++;
+                        else
+                            bins[starts[k]++] = i;
+                    }
+                }
+            }
+            if (pass == 0) {
+                /* counts to starts */
+                for (sum = 0, k = 0; k < n_bins; k++) {
+                    first = starts[k];
+                    starts[k] = sum;
+                    sum += first;
+                }
+                starts[n_bins] = sum;
+                bins = (size_t*) malloc((sum+1) * sizeof(size_t));
+                if (bins == NULL)
+                    longjmp(b, TS_MALLOC);
+            } else {
+                /* the starts have been moved to the ends */
+                for (k = n_bins; k > 0; k--)
+                    starts[k] = starts[k-1];
+                starts[0] = 0;
+            }
+        }
+    ETRY
+    free(stack);
+    if (e < 0) {
+        free(pieces.ctrlp);
+        free(pieces.splines);
+        free(segments.segs);
+        free(starts);
+        free(bins);
+        longjmp(buf, e);
+    }
+
+    /* The tiles (and rows) are processed with their own workspace, i.e.,
+     * the distance field is written in parallel without conflicts. */
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) \
+        if (width*height >= TS_OPENMP_MIN_WORK)
+#endif
+    for (j = 0; j < (long) (n_tx*n_ty); j++) {
+        tsReal* w = (tsReal*) malloc(n_work * sizeof(tsReal));
+        size_t* closest = (size_t*) malloc(
+                TS_SDF_TILE*TS_SDF_TILE * sizeof(size_t));
+        if (w == NULL || closest == NULL) {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            err = TS_MALLOC;
+        } else {
+            ts_internal_sdf_tile(splines, &pieces, n_pieces, segments.segs,
+                    bins + starts[j], starts[j+1] - starts[j], origin, cell,
+                    width, height, band, (size_t) j % n_tx,
+                    (size_t) j / n_tx, w, closest, grid);
+        }
+        free(w);
+        free(closest);
+    }
+    if (err == TS_SUCCESS) {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic) \
+            if (width*height >= TS_OPENMP_MIN_WORK)
+#endif
+        for (j = 0; j < (long) height; j++) {
+            const size_t row = n_tx*n_ty + (size_t) j / TS_SDF_TILE;
+            const size_t n_bin = starts[row+1] - starts[row];
+            tsReal* xs = (tsReal*) malloc((n_bin+1) * sizeof(tsReal));
+            if (xs == NULL) {
+#ifdef _OPENMP
+                #pragma omp critical
+#endif
+                err = TS_MALLOC;
+            } else {
+                ts_internal_sdf_sign(segments.segs, bins + starts[row],
+                        n_bin, origin, cell, width, (size_t) j, xs, grid);
+                free(xs);
+            }
+        }
+    }
+    free(pieces.ctrlp);
+    free(pieces.splines);
+    free(segments.segs);
+    free(starts);
+    free(bins);
+    if (err < 0)
+        longjmp(buf, err);
+}
+
+/* The maximum distance (in pixels) of a rasterized outline to its edges. */
+#define TS_RASTER_FLATNESS 0.1
+
+/* The number of rows sharing an accumulation buffer. */
+#define TS_RASTER_BAND 16
+
+/* Adds the signed area covered by the edge from (\x0, \y0) to (\x1, \y1)
+ * (in pixels, 0 <= x <= width) within the rows [\r0, \r1) to the
+ * accumulation buffer \acc (rows of width+2 values, starting with row
+ * \r0), i.e., the coverage of a pixel is the sum of its row up to and
+ * including the pixel. \cols stores the first and last modified column of
+ * each row. */
+void ts_internal_raster_edge(
+    tsReal x0, tsReal y0, tsReal x1, tsReal y1, const size_t width,
+    const size_t r0, const size_t r1, tsReal* acc, size_t* cols
+)
+{
+    tsReal dir = 1.f, dxdy, ys, ye, x, xn, xa, xb, dy, d, s, f0, f1, a0,
+            a1, am;
+    tsReal* row;
+    size_t r, ia, ib, c; /* Used in for loops. */
+
+    if (!(y0 < y1) && !(y0 > y1))
+        return;
+    if (y0 > y1) {
+        dir = -1.f;
+        dxdy = x0; x0 = x1; x1 = dxdy;
+        dxdy = y0; y0 = y1; y1 = dxdy;
+    }
+    dxdy = (x1-x0) / (y1-y0);
+    ys = y0 < (tsReal) r0 ? (tsReal) r0 : y0;
+    ye = y1 > (tsReal) r1 ? (tsReal) r1 : y1;
+    x = x0 + (ys-y0) * dxdy;
+    for (r = (size_t) ys; (tsReal) r < ye; r++) {
+        dy = ((tsReal) r+1 < ye ? (tsReal) r+1 : ye) -
+                ((tsReal) r > ys ? (tsReal) r : ys);
+        xn = x + dxdy*dy;
+        xn = xn < 0.f ? 0.f : (xn > (tsReal) width ? (tsReal) width : xn);
+        d = dy*dir;
+        xa = x < xn ? x : xn;
+        xb = x < xn ? xn : x;
+        ia = (size_t) xa;
+        ib = (size_t) xb;
+        ib += (tsReal) ib < xb ? 1 : 0; /* ceil */
+        row = acc + (r-r0)*(width+2);
+        if (ib <= ia+1) {
+            /* within a single pixel */
+            am = (x+xn) / 2.f - ia;
+            row[ia] += d - d*am;
+            row[ia+1] += d*am;
+        } else {
+            /* the triangles at the ends, trapezoids in between */
+            s = 1.f / (xb-xa);
+            f0 = xa - ia;
+            a0 = s/2.f * (1.f-f0)*(1.f-f0);
+            f1 = xb - ib + 1.f;
+            am = s/2.f * f1*f1;
+            row[ia] += d*a0;
+            if (ib == ia+2) {
+                row[ia+1] += d * (1.f-a0-am);
+            } else {
+                a1 = s * (1.5f-f0);
+                row[ia+1] += d * (a1-a0);
+                for (c = ia+2; c+1 < ib; c++)
+                    row[c] += d*s;
+                row[ib-1] += d * (1.f - a1 - (ib-ia-3)*s - am);
+            }
+            row[ib] += d*am;
+        }
+        c = (r-r0) * 2;
+        cols[c] = ia < cols[c] ? ia : cols[c];
+        cols[c+1] = ib+1 > cols[c+1] ? ib+1 : cols[c+1];
+        x = xn;
+    }
+}
+
+/* Splits the line from \p to \q (in pixels) at the left and right border
+ * of the image and adds the parts (clamped to the border) with
+ * ::ts_internal_raster_edge. */
+void ts_internal_raster_line(
+    const tsReal* p, const tsReal* q, const size_t width, const size_t r0,
+    const size_t r1, tsReal* acc, size_t* cols
+)
+{
+    const tsReal w = (tsReal) width;
+    tsReal ts[4], a[2], b[2], t;
+    size_t n = 0, i; /* Used in for loops. */
+
+    ts[n++] = 0.f;
+    if ((p[0] < 0.f) != (q[0] < 0.f))
+        ts[n++] = (0.f - p[0]) / (q[0] - p[0]);
+    if ((p[0] > w) != (q[0] > w))
+        ts[n++] = (w - p[0]) / (q[0] - p[0]);
+    if (n == 3 && ts[2] < ts[1]) {
+        t = ts[1]; ts[1] = ts[2]; ts[2] = t;
+    }
+    ts[n++] = 1.f;
+    for (i = 0; i+1 < n; i++) {
+        a[0] = p[0] + ts[i] * (q[0]-p[0]);
+        a[1] = p[1] + ts[i] * (q[1]-p[1]);
+        b[0] = p[0] + ts[i+1] * (q[0]-p[0]);
+        b[1] = p[1] + ts[i+1] * (q[1]-p[1]);
+        a[0] = a[0] < 0.f ? 0.f : (a[0] > w ? w : a[0]);
+        b[0] = b[0] < 0.f ? 0.f : (b[0] > w ? w : b[0]);
+        ts_internal_raster_edge(a[0], a[1], b[0], b[1], width, r0, r1, acc,
+                cols);
+    }
+}
+
+/* Rasterizes the \n_edges edges \indices of \edges into the \n_rows rows
+ * of \alpha starting with row \r0. \acc (\n_rows rows of width+2 zeros,
+ * may be NULL if \n_edges is 0) and \cols (2*\n_rows values) are the
+ * workspace of the band. */
+void ts_internal_raster_band(
+    const tsInternalSegment* edges, const size_t* indices,
+    const size_t n_edges, const size_t width, const size_t r0,
+    const size_t n_rows, const tsAlphaType type, tsReal* acc, size_t* cols,
+    void* alpha
+)
+{
+    const size_t stride = width+2;
+    tsReal sum, a;
+    size_t r, c, c0, c1, i; /* Used in for loops. */
+
+    for (r = 0; r < n_rows; r++) {
+        cols[r*2] = width;
+        cols[r*2 + 1] = 0;
+    }
+    for (i = 0; i < n_edges; i++) {
+        ts_internal_raster_line(edges[indices[i]].p, edges[indices[i]].p + 2,
+                width, r0, r0 + n_rows, acc, cols);
+    }
+
+    /* Accumulate the rows, only the modified columns need to be summed
+     * up. The coverage is the absolute value, clamped to 1. */
+    for (r = 0; r < n_rows; r++) {
+        c0 = cols[r*2];
+        c1 = cols[r*2 + 1] < width ? cols[r*2 + 1] : width;
+        sum = a = 0.f;
+        for (c = 0; c < width; c++) {
+            if (c >= c0 && c < c1) {
+                sum += acc[r*stride + c];
+                a = (tsReal) fabs(sum);
+                a = a > 1.f ? 1.f : a;
+            }
+            if (type == TS_ALPHA_FLOAT) {
+                ((float*) alpha)[(r0+r)*width + c] = (float) a;
+            } else {
+                ((unsigned char*) alpha)[(r0+r)*width + c] =
+                        (unsigned char) (a*255.f + .5f);
+            }
+        }
+    }
+}
+
+void ts_internal_bspline_rasterize(
+    const tsBSpline* outlines, const size_t n_outlines, const tsReal* origin,
+    const tsReal cell, const size_t width, const size_t height,
+    const tsAlphaType type, void* alpha, jmp_buf buf
+)
+{
+    const size_t stride = width+2;
+    const size_t n_bands = (height + TS_RASTER_BAND-1) / TS_RASTER_BAND;
+    tsInternalSegments edges; /* The edge list (arena). */
+    const tsInternalSegment* seg;
+    size_t* starts; /* The first entry of each band in bins. */
+    size_t* bins; /* The edges of the bands. */
+    tsReal* stack; /* Used to flatten the outlines. */
+    tsReal* piece; /* Points into stack. */
+    tsReal p[2], q[2], lo, hi;
+    size_t max_order = 1, n_stack, first, sum;
+    size_t s, i, d, k, k0, k1, pass; /* Used in for loops. */
+    long j; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+    tsError err = TS_SUCCESS;
+    tsError e;
+    jmp_buf b;
+
+    for (s = 0; s < n_outlines; s++) {
+        if (outlines[s].dim != 2)
+            longjmp(buf, TS_DIM_UNSUPPORTED);
+        max_order = outlines[s].order > max_order ?
+                outlines[s].order : max_order;
+    }
+    n_stack = 3*max_order;
+    stack = (tsReal*) malloc((n_stack + 2*max_order) * sizeof(tsReal));
+    starts = (size_t*) calloc(n_bands + 1, sizeof(size_t));
+    if (stack == NULL || starts == NULL) {
+        free(stack);
+        free(starts);
+        longjmp(buf, TS_MALLOC);
+    }
+    piece = stack + n_stack;
+    edges.segs = NULL;
+    edges.n = edges.cap = 0;
+    bins = NULL;
+
+    TRY(b, e)
+        /* flatten the Bezier pieces of each outline (in pixels) and close
+         * the outline */
+        for (s = 0; s < n_outlines; s++) {
+            first = edges.n;
+            for (i = outlines[s].deg; i < outlines[s].n_ctrlp; i++) {
+                if (!(outlines[s].knots[i] < outlines[s].knots[i+1]))
+                    continue;
+                ts_internal_bspline_bezier_piece(outlines + s, i,
+                        outlines[s].knots[i], outlines[s].knots[i+1], stack,
+                        piece);
+                for (d = 0; d < outlines[s].order*2; d++)
+                    piece[d] = (piece[d] - origin[d%2]) / cell;
+                ts_internal_bezier_flatten(piece, outlines[s].deg,
+                        (tsReal) TS_RASTER_FLATNESS, i, stack, &edges, b);
+            }
+            if (edges.n > first) {
+                memcpy(p, edges.segs[edges.n-1].p + 2, 2 * sizeof(tsReal));
+                memcpy(q, edges.segs[first].p, 2 * sizeof(tsReal));
+                ts_internal_segments_append(&edges, p, q, 0.f, 0.f, 0, 1,
+                        b);
+            }
+        }
+
+        /* Bin the (non-horizontal) edges into the bands they cross. Count
+         * in the first pass and fill in the second one. */
+        for (pass = 0; pass < 2; pass++) {
+            for (i = 0; i < edges.n; i++) {
+                seg = edges.segs + i;
+                lo = seg->p[1] < seg->p[3] ? seg->p[1] : seg->p[3];
+                hi = seg->p[1] < seg->p[3] ? seg->p[3] : seg->p[1];
+                if (!(lo < hi) || hi < 0.f || lo >= (tsReal) height)
+                    continue;
+                k0 = lo > 0.f ? (size_t) lo / TS_RASTER_BAND : 0;
+                k1 = hi < (tsReal) height ?
+                        (size_t) hi / TS_RASTER_BAND : n_bands-1;
+                for (k = k0; k <= k1; k++) {
+                    if (pass == 0)
+                        starts[k]++;
+                    else
+                        bins[starts[k]++] = i;
+                }
+            }
+            if (pass == 0) {
+                /* counts to starts */
+                for (sum = 0, k = 0; k < n_bands; k++) {
+                    first = starts[k];
+                    starts[k] = sum;
+                    sum += first;
+                }
+                starts[n_bands] = sum;
+                bins = (size_t*) malloc((sum+1) * sizeof(size_t));
+                if (bins == NULL)
+                    longjmp(b, TS_MALLOC);
+            } else {
+                /* the starts have been moved to the ends */
+                for (k = n_bands; k > 0; k--)
+                    starts[k] = starts[k-1];
+                starts[0] = 0;
+            }
+        }
+    ETRY
+    free(stack);
+    if (e < 0) {
+        free(edges.segs);
+        free(starts);
+        free(bins);
+        longjmp(buf, e);
+    }
+
+    /* The bands are accumulated with their own workspace, i.e., memory
+     * is needed for a band of rows (per thread) rather than for the whole
+     * image, and bands without edges are not accumulated at all. The edges
+     * of a band keep their order, so the result does not depend on the
+     * height of the bands. */
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) \
+        if (width*height >= TS_OPENMP_MIN_WORK)
+#endif
+    for (j = 0; j < (long) n_bands; j++) {
+        const size_t r0 = (size_t) j * TS_RASTER_BAND;
+        const size_t n_rows = height-r0 < TS_RASTER_BAND ?
+                height-r0 : TS_RASTER_BAND;
+        const size_t n_edges = starts[j+1] - starts[j];
+        tsReal* acc = n_edges == 0 ? NULL :
+                (tsReal*) calloc(stride*n_rows, sizeof(tsReal));
+        size_t* cols = (size_t*) malloc(2*n_rows * sizeof(size_t));
+        if ((n_edges > 0 && acc == NULL) || cols == NULL) {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            err = TS_MALLOC;
+        } else {
+            ts_internal_raster_band(edges.segs, bins + starts[j], n_edges,
+                    width, r0, n_rows, type, acc, cols, alpha);
+        }
+        free(acc);
+        free(cols);
+    }
+    free(edges.segs);
+    free(starts);
+    free(bins);
+    if (err < 0)
+        longjmp(buf, err);
+}
+
+void ts_internal_simplifier_new(
+    const size_t dim, const tsReal tol,
+    tsSimplifier* simplifier, jmp_buf buf
+)
+{
+    if (dim < 1)
+        longjmp(buf, TS_DIM_ZERO);
+    ts_simplifier_default(simplifier);
+    simplifier->anchor = (tsReal*) malloc(3*dim * sizeof(tsReal));
+    if (simplifier->anchor == NULL)
+        longjmp(buf, TS_MALLOC);
+    simplifier->last = simplifier->anchor + dim;
+    simplifier->axis = simplifier->last + dim;
+    simplifier->dim = dim;
+    simplifier->tol = tol;
+}
+
+/* Starts a new segment at the last pushed point of \simplifier and extends
+ * it to \point, whose distance to the last pushed point is \r. */
+void ts_internal_simplifier_restart(
+    tsSimplifier* simplifier, const tsReal* point, const tsReal r
+)
+{
+    const size_t sof_p = simplifier->dim * sizeof(tsReal);
+    memcpy(simplifier->anchor, simplifier->last, sof_p);
+    memcpy(simplifier->last, point, sof_p);
+    simplifier->radius = r;
+    simplifier->angle = (tsReal) TS_PI;
+}
+
+/* Narrows the cone of \simplifier to the directions of segments starting
+ * at anchor and passing within tol of \point, where \r = |\point - anchor|
+ * > tol. The
+ * intersection of both cones is approximated by the largest cone it
+ * contains whose axis lies in the plane spanned by the axes of both cones.
+ * \phi is the angle between the axis of \simplifier and \point - anchor. */
+void ts_internal_simplifier_narrow(
+    tsSimplifier* simplifier, const tsReal* point, const tsReal r,
+    const tsReal phi
+)
+{
+    const size_t dim = simplifier->dim;
+    const tsReal* anchor = simplifier->anchor;
+    tsReal* axis = simplifier->axis;
+    const tsReal beta = (tsReal) asin(simplifier->tol / r);
+    tsReal lo, hi, m, c, sm, cm, len;
+    size_t d; /* Used in for loops. */
+
+    if (!(simplifier->angle < (tsReal) TS_PI)) {
+        for (d = 0; d < dim; d++)
+            axis[d] = (point[d] - anchor[d]) / r;
+        simplifier->angle = beta;
+        return;
+    }
+    /* Both cones cover an interval of angles on the great circle through
+     * both axes: [-angle, angle] and [phi-beta, phi+beta]. */
+    lo = phi-beta > -simplifier->angle ? phi-beta : -simplifier->angle;
+    hi = phi+beta < simplifier->angle ? phi+beta : simplifier->angle;
+    m = (lo+hi) / 2;
+    simplifier->angle = (hi-lo) / 2;
+    len = (tsReal) sin(phi);
+    if (!(len > 0.f))
+        return;
+    /* Rotate the axis towards v by m. */
+    c = (tsReal) cos(phi);
+    cm = (tsReal) cos(m);
+    sm = (tsReal) sin(m) / len;
+    len = 0.f;
+    for (d = 0; d < dim; d++) {
+        axis[d] = cm*axis[d] + sm*((point[d] - anchor[d])/r - c*axis[d]);
+        len += axis[d]*axis[d];
+    }
+    /* Avoids a drift of the length due to rounding errors. */
+    len = (tsReal) sqrt(len);
+    for (d = 0; d < dim; d++)
+        axis[d] /= len;
+}
+
+size_t ts_internal_simplifier_push(
+    tsSimplifier* simplifier, const tsReal* point, tsReal* out
+)
+{
+    const size_t dim = simplifier->dim;
+    const size_t sof_p = dim * sizeof(tsReal);
+    const tsReal tol = simplifier->tol;
+    tsReal r = 0.f, c = 0.f, phi = 0.f, q = 0.f, v;
+    size_t d; /* Used in for loops. */
+
+    if (simplifier->n_points++ == 0) {
+        memcpy(simplifier->last, point, sof_p);
+        ts_internal_simplifier_restart(simplifier, point, 0.f);
+        memcpy(out, point, sof_p);
+        return 1;
+    }
+    for (d = 0; d < dim; d++) {
+        v = point[d] - simplifier->anchor[d];
+        r += v*v;
+        c += v*simplifier->axis[d];
+    }
+    r = (tsReal) sqrt(r);
+    if (r > tol && simplifier->angle < (tsReal) TS_PI) {
+        /* The angle is derived from the components parallel (c) and
+         * perpendicular (q) to the axis since the arc cosine of c/r loses
+         * precision for small angles, i.e., long segments. */
+        for (d = 0; d < dim; d++) {
+            v = point[d] - simplifier->anchor[d] - c*simplifier->axis[d];
+            q += v*v;
+        }
+        phi = (tsReal) atan2(sqrt(q), c);
+    }
+    /* Points within tol of the anchor are covered by any segment. */
+    if (!(r < simplifier->radius) && (r <= tol ||
+            !(phi > simplifier->angle))) {
+        if (r > tol)
+            ts_internal_simplifier_narrow(simplifier, point, r, phi);
+        memcpy(simplifier->last, point, sof_p);
+        simplifier->radius = r;
+        return 0;
+    }
+
+    memcpy(out, simplifier->last, sof_p);
+    r = 0.f;
+    for (d = 0; d < dim; d++) {
+        v = point[d] - simplifier->last[d];
+        r += v*v;
+    }
+    r = (tsReal) sqrt(r);
+    ts_internal_simplifier_restart(simplifier, point, r);
+    if (r > tol)
+        ts_internal_simplifier_narrow(simplifier, point, r, 0.f);
+    return 1;
+}
+
+size_t ts_internal_simplifier_flush(tsSimplifier* simplifier, tsReal* out)
+{
+    const size_t n_points = simplifier->n_points;
+    simplifier->n_points = 0;
+    if (n_points < 2)
+        return 0;
+    memcpy(out, simplifier->last, simplifier->dim * sizeof(tsReal));
+    return 1;
+}
+
+void ts_internal_bspline_sample_simplified(
+    const tsBSpline* bspline, const size_t n, const tsReal tol,
+    tsReal* points, const size_t max, size_t* n_out, jmp_buf buf
+)
+{
+    const size_t dim = bspline->dim;
+    const size_t sof_p = dim * sizeof(tsReal);
+    tsSimplifier simplifier;
+    tsReal* scratch; /* Storage of the in place de Boor net and the state
+                      * of \simplifier. */
+    tsReal* point; /* The current sample. */
+    tsReal* out; /* The emitted point. */
+    tsReal min, max_u; /* The domain of \bspline. */
+    tsReal fac; /* The distance of two consecutive knot values. */
+    size_t i; /* Used in for loops. */
+    tsError e;
+    jmp_buf b;
+
+    *n_out = 0;
+    if (n == 0)
+        return;
+    ts_bspline_domain(bspline, &min, &max_u);
+    fac = n > 1 ? (max_u-min) / (n-1) : 0.f;
+
+    scratch = (tsReal*) malloc((bspline->order + 5) * sof_p);
+    if (scratch == NULL)
+        longjmp(buf, TS_MALLOC);
+    point = scratch + bspline->order*dim;
+    out = point + dim;
+    ts_simplifier_default(&simplifier);
+    simplifier.dim = dim;
+    simplifier.tol = tol;
+    simplifier.anchor = out + dim;
+    simplifier.last = simplifier.anchor + dim;
+    simplifier.axis = simplifier.last + dim;
+
+    TRY(b, e)
+        for (i = 0; i < n; i++) {
+            /* ensures that the last point is evaluated exactly at \max_u */
+            ts_internal_bspline_eval_point(bspline,
+                    i == n-1 && n > 1 ? max_u : min + i*fac, scratch,
+                    point, b);
+            if (ts_internal_simplifier_push(&simplifier, point, out)) {
+                if (*n_out < max)
+                    memcpy(points + *n_out * dim, out, sof_p);
+                (*n_out)++;
+            }
+        }
+        if (ts_internal_simplifier_flush(&simplifier, out)) {
+            if (*n_out < max)
+                memcpy(points + *n_out * dim, out, sof_p);
+            (*n_out)++;
+        }
+    ETRY
+
+    free(scratch);
+    if (e < 0)
+        longjmp(buf, e);
+    if (*n_out > max)
+        longjmp(buf, TS_BUFFER_SIZE);
+}
+
+/* Computes the bound of the deviation caused by removing the knot
+ * \knots[\r] once, where \r is the last index of a run of \s equal knots,
+ * from the spline given by \ctrlp and \knots (degree \deg, dimension \dim)
+ * (see "The NURBS Book", Algorithm A5.8). The new control points
+ * \first..\last (first = r-deg, last = r-s) are stored in \temp (with
+ * space for (deg+3)*dim values) at index i - first + 1. */
+tsReal ts_internal_remove_knot_bound(
+    const tsReal* ctrlp, const tsReal* knots, const size_t dim,
+    const size_t deg, const size_t r, const size_t s, tsReal* temp
+)
+{
+    const size_t order = deg + 1;
+    const size_t first = r - deg, last = r - s;
+    const size_t off = first - 1;
+    const tsReal u = knots[r];
+    const size_t sof_p = dim * sizeof(tsReal);
+    tsReal* blend = temp + (deg+2)*dim;
+    tsReal alfi, alfj;
+    size_t i = first, j = last, ii = 1, jj = last - off;
+    size_t d; /* Used in for loops. */
+
+    memcpy(temp, ctrlp + off*dim, sof_p);
+    memcpy(temp + (last+1-off)*dim, ctrlp + (last+1)*dim, sof_p);
+    while (j > i) {
+        alfi = (u - knots[i]) / (knots[i+order] - knots[i]);
+        alfj = (u - knots[j]) / (knots[j+order] - knots[j]);
+        for (d = 0; d < dim; d++) {
+            temp[ii*dim + d] = (ctrlp[i*dim + d] -
+                    (1.f-alfi) * temp[(ii-1)*dim + d]) / alfi;
+            temp[jj*dim + d] = (ctrlp[j*dim + d] -
+                    alfj * temp[(jj+1)*dim + d]) / (1.f-alfj);
+        }
+        i++; ii++;
+        j--; jj--;
+    }
+    if (j < i) {
+        /* two solutions for the same control point */
+        return ts_ctrlp_dist2(temp + (ii-1)*dim, temp + (jj+1)*dim, dim);
+    }
+    alfi = (u - knots[i]) / (knots[i+order] - knots[i]);
+    for (d = 0; d < dim; d++) {
+        blend[d] = alfi * temp[(ii+1)*dim + d] +
+                (1.f-alfi) * temp[(ii-1)*dim + d];
+    }
+    return ts_ctrlp_dist2(ctrlp + i*dim, blend, dim);
+}
+
+/* Removes interior knots of the spline given by \ctrlp and \knots (\n_ctrlp
+ * control points, degree \deg, dimension \dim) in place, as long as the
+ * deviation bound of each knot interval stays within \tol. \errs stores the
+ * bound of each knot interval (n_ctrlp+deg values) and is updated
+ * accordingly. Each pass over the knots removes each run at most once,
+ * which spreads the removals (and thus the deviation) over the spline.
+ * \temp must provide space for (deg+3)*dim values. Returns the remaining
+ * number of control points.
+ *
+ * Removing a value from the middle of the arrays would require shifting
+ * their tails, i.e., a pass would take quadratic time. Instead, a pass
+ * leaves a gap behind the knots being examined: index i < w is stored at
+ * i, all others at i + gap. Thus, a removal only shifts the few values in
+ * front of the gap. */
+size_t ts_internal_remove_knots(
+    tsReal* ctrlp, tsReal* knots, size_t n_ctrlp, const size_t dim,
+    const size_t deg, const tsReal tol, tsReal* errs, tsReal* temp
+)
+{
+    const size_t order = deg + 1;
+    const size_t sof_p = dim * sizeof(tsReal);
+    const size_t sof_r = sizeof(tsReal);
+    const tsReal min = knots[deg], max_u = knots[n_ctrlp]; /* domain */
+    size_t removed, gap, w, r, end, s, fout, k;
+    tsReal bound, max;
+    size_t i; /* Used in for loops. */
+
+    do {
+        removed = 0;
+        gap = 0;
+        w = 0;
+        r = deg+1;
+        while (r < n_ctrlp) {
+            /* close the gap in front of the affected values */
+            for (; w < r + 2*order + 1 && w < n_ctrlp + order; w++) {
+                if (gap == 0)
+                    continue;
+                if (w < n_ctrlp)
+                    memcpy(ctrlp + w*dim, ctrlp + (w+gap)*dim, sof_p);
+                if (w < n_ctrlp + deg)
+                    errs[w] = errs[w+gap];
+                knots[w] = knots[w+gap];
+            }
+            for (end = r; end+1 < n_ctrlp && !(knots[end+1] > knots[r]);)
+                end++;
+            s = end - r + 1;
+            if (!(knots[r] > min) || !(knots[r] < max_u)) {
+                r = end+1;
+                continue;
+            }
+            /* affected knot intervals: end-deg .. end-s+deg */
+            max = 0.f;
+            for (k = end-deg; k <= end-s+deg; k++)
+                max = errs[k] > max ? errs[k] : max;
+            bound = ts_internal_remove_knot_bound(
+                    ctrlp, knots, dim, deg, end, s, temp);
+            if (max + bound > tol) {
+                r = end+1;
+                continue;
+            }
+            for (k = end-deg; k <= end-s+deg; k++)
+                errs[k] += bound;
+            /* store the new control points (temp[1] is first) */
+            i = end-deg;
+            k = end-s;
+            while (k > i) {
+                memcpy(ctrlp + i*dim, temp + (i-end+deg+1)*dim, sof_p);
+                memcpy(ctrlp + k*dim, temp + (k-end+deg+1)*dim, sof_p);
+                i++;
+                k--;
+            }
+            fout = (2*end - s - deg) / 2;
+            k = w < n_ctrlp ? w : n_ctrlp;
+            memmove(ctrlp + fout*dim, ctrlp + (fout+1)*dim,
+                    (k-fout-1) * sof_p);
+            /* the knot intervals end-1 and end are merged */
+            errs[end-1] = errs[end] > errs[end-1] ? errs[end] : errs[end-1];
+            k = w < n_ctrlp+deg ? w : n_ctrlp+deg;
+            memmove(errs + end, errs + end+1, (k-end-1) * sof_r);
+            memmove(knots + end, knots + end+1, (w-end-1) * sof_r);
+            w--;
+            gap++;
+            n_ctrlp--;
+            removed++;
+            r = end;
+        }
+        if (gap > 0) {
+            memmove(ctrlp + w*dim, ctrlp + (w+gap)*dim,
+                    (w < n_ctrlp ? n_ctrlp-w : 0) * sof_p);
+            memmove(errs + w, errs + w+gap,
+                    (w < n_ctrlp+deg ? n_ctrlp+deg-w : 0) * sof_r);
+            memmove(knots + w, knots + w+gap, (n_ctrlp+order-w) * sof_r);
+        }
+    } while (removed > 0);
+    return n_ctrlp;
+}
+
+/* Builds the levels of a level-of-detail pyramid of \bspline, the result
+ * of each level k > 0 is stored in \works[k] (ctrlp, knots, errs, temp) and
+ * its number of control points in \sizes[k]. */
+void ts_internal_bspline_lod_levels(
+    const tsBSpline* bspline, const tsReal tol, const size_t n_levels,
+    tsReal** works, size_t* sizes
+)
+{
+    const size_t dim = bspline->dim;
+    const size_t deg = bspline->deg;
+    const size_t n_ctrlp = bspline->n_ctrlp;
+    const size_t n_knots = bspline->n_knots;
+    long j; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) \
+        if (n_levels*n_ctrlp*dim >= TS_OPENMP_MIN_WORK)
+#endif
+    for (j = 1; j < (long) n_levels; j++) {
+        tsReal* ctrlp = works[j];
+        tsReal* knots = ctrlp + n_ctrlp*dim;
+        tsReal* errs = knots + n_knots;
+        memcpy(ctrlp, bspline->ctrlp, n_ctrlp*dim * sizeof(tsReal));
+        memcpy(knots, bspline->knots, n_knots * sizeof(tsReal));
+        ts_arr_fill(errs, n_knots-1, 0.f);
+        sizes[j] = ts_internal_remove_knots(ctrlp, knots, n_ctrlp, dim, deg,
+                (tsReal) ldexp(tol, (int) j-1), errs,
+                errs + n_knots-1);
+    }
+}
+
+void ts_internal_bspline_lod_new(
+    const tsBSpline* bspline, const tsReal tol, size_t n_levels,
+    tsBSplineLOD* lod, jmp_buf buf
+)
+{
+    const size_t dim = bspline->dim;
+    const size_t deg = bspline->deg;
+    const size_t n_ctrlp = bspline->n_ctrlp;
+    const size_t n_knots = bspline->n_knots;
+    const size_t n_work = n_ctrlp*dim + 2*n_knots + (deg+3)*dim;
+    tsReal** works; /* The workspace of each level. */
+    size_t* sizes; /* The number of control points of each level. */
+    size_t n_vals, n, prev, k, e;
+    tsReal* arena;
+    tsReal* ctrlp;
+    tsReal* errs;
+    tsReal max;
+    size_t i; /* Used in for loops. */
+
+    ts_bspline_lod_default(lod);
+    n_levels = n_levels < 1 ? 1 : n_levels;
+    works = (tsReal**) malloc(n_levels * sizeof(tsReal*));
+    sizes = (size_t*) malloc(n_levels * sizeof(size_t));
+    if (works == NULL || sizes == NULL) {
+        free(works);
+        free(sizes);
+        longjmp(buf, TS_MALLOC);
+    }
+    works[0] = NULL;
+    sizes[0] = n_ctrlp;
+    for (i = 1; i < n_levels; i++) {
+        works[i] = (tsReal*) malloc(n_work * sizeof(tsReal));
+        if (works[i] == NULL)
+            break;
+    }
+    if (i < n_levels) {
+        for (k = 1; k < i; k++)
+            free(works[k]);
+        free(works);
+        free(sizes);
+        longjmp(buf, TS_MALLOC);
+    }
+    ts_internal_bspline_lod_levels(bspline, tol, n_levels, works, sizes);
+
+    /* drop levels without fewer control points than their predecessor */
+    n = 1;
+    n_vals = n_ctrlp*dim + n_knots;
+    prev = n_ctrlp;
+    for (i = 1; i < n_levels; i++) {
+        if (sizes[i] < prev) {
+            prev = sizes[i];
+            n_vals += sizes[i] * (dim+1) + deg+1;
+            n++;
+        }
+    }
+    lod->levels = (tsBSpline*) malloc(n * sizeof(tsBSpline));
+    arena = (tsReal*) malloc((n + n_vals) * sizeof(tsReal));
+    if (lod->levels == NULL || arena == NULL) {
+        for (k = 1; k < n_levels; k++)
+            free(works[k]);
+        free(works);
+        free(sizes);
+        free(lod->levels);
+        free(arena);
+        ts_bspline_lod_default(lod);
+        longjmp(buf, TS_MALLOC);
+    }
+    lod->errors = arena;
+    lod->n_levels = n;
+    lod->errors[0] = 0.f;
+    lod->levels[0] = *bspline;
+    lod->levels[0].flags = TS_PACKED;
+    lod->levels[0].ctrlp = arena + n;
+    lod->levels[0].knots = lod->levels[0].ctrlp + n_ctrlp*dim;
+    memcpy(lod->levels[0].ctrlp, bspline->ctrlp,
+            n_ctrlp*dim * sizeof(tsReal));
+    memcpy(lod->levels[0].knots, bspline->knots, n_knots * sizeof(tsReal));
+    ctrlp = lod->levels[0].knots + n_knots;
+    k = 1;
+    prev = n_ctrlp;
+    for (i = 1; i < n_levels; i++) {
+        if (sizes[i] < prev) {
+            prev = sizes[i];
+            lod->levels[k] = *bspline;
+            lod->levels[k].flags = TS_PACKED;
+            lod->levels[k].n_ctrlp = sizes[i];
+            lod->levels[k].n_knots = sizes[i] + deg+1;
+            lod->levels[k].ctrlp = ctrlp;
+            lod->levels[k].knots = ctrlp + sizes[i]*dim;
+            memcpy(ctrlp, works[i], sizes[i]*dim * sizeof(tsReal));
+            memcpy(lod->levels[k].knots, works[i] + n_ctrlp*dim,
+                    (sizes[i] + deg+1) * sizeof(tsReal));
+            errs = works[i] + n_ctrlp*dim + n_knots;
+            max = 0.f;
+            for (e = 0; e < sizes[i] + deg; e++)
+                max = errs[e] > max ? errs[e] : max;
+            lod->errors[k] = max;
+            ctrlp = lod->levels[k].knots + sizes[i] + deg+1;
+            k++;
+        }
+        free(works[i]);
+    }
+    free(works);
+    free(sizes);
+}
+
+/* Evaluates the points of the non-empty knot intervals \from..\to-1
+ * (indices of tess->spans) of \bspline and stores them in tess->points.
+ * \work must provide space for order*order + 5*order values. */
+void ts_internal_tessellation_eval(
+    const tsBSpline* bspline, const size_t from, const size_t to,
+    tsReal* work, tsTessellation* tess
+)
+{
+    const size_t dim = tess->dim;
+    const size_t n_seg = tess->n_segments;
+    const tsReal* knots = bspline->knots;
+    tsReal lo, hi;
+    size_t i, j, k; /* Used in for loops. */
+
+    for (i = from; i < to; i++) {
+        k = tess->spans[i];
+        lo = knots[k];
+        hi = knots[k+1];
+        for (j = 0; j < n_seg; j++) {
+            ts_internal_bspline_span_ders(bspline, k,
+                    lo + (hi-lo) * ((tsReal) j / n_seg), 0, work,
+                    tess->points + (i*n_seg + j)*dim);
+        }
+        if (i+1 == tess->n_spans) {
+            ts_internal_bspline_span_ders(bspline, k, hi, 0, work,
+                    tess->points + (tess->n_points-1)*dim);
+        }
+    }
+}
+
+void ts_internal_tessellation_new(
+    const tsBSpline* bspline, size_t n_segments,
+    tsTessellation* tess, jmp_buf buf
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t order = bspline->order;
+    const size_t dim = bspline->dim;
+    const size_t n_ctrlp = bspline->n_ctrlp;
+    const size_t n_work = order*order + 5*order;
+    const tsReal* knots = bspline->knots;
+    tsError err = TS_SUCCESS;
+    size_t n = 0, k;
+    long j; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+
+    ts_tessellation_default(tess);
+    n_segments = n_segments < 1 ? 1 : n_segments;
+    for (k = deg; k < n_ctrlp; k++) {
+        if (knots[k] < knots[k+1])
+            n++;
+    }
+    tess->spans = (size_t*) malloc(n * sizeof(size_t));
+    tess->points = (tsReal*) malloc((n*n_segments + 1) * dim *
+            sizeof(tsReal));
+    if ((n > 0 && tess->spans == NULL) || tess->points == NULL) {
+        free(tess->spans);
+        free(tess->points);
+        ts_tessellation_default(tess);
+        longjmp(buf, TS_MALLOC);
+    }
+    tess->deg = deg;
+    tess->dim = dim;
+    tess->n_ctrlp = n_ctrlp;
+    tess->n_segments = n_segments;
+    tess->n_spans = n;
+    tess->n_points = n*n_segments + 1;
+    n = 0;
+    for (k = deg; k < n_ctrlp; k++) {
+        if (knots[k] < knots[k+1])
+            tess->spans[n++] = k;
+    }
+    if (n == 0) {
+        /* all knots of the domain are equal */
+        memcpy(tess->points, bspline->ctrlp + deg*dim, dim * sizeof(tsReal));
+        return;
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) \
+        if (n*n_segments*order >= TS_OPENMP_MIN_WORK)
+#endif
+    for (j = 0; j < (long) n; j++) {
+        tsReal* w = (tsReal*) malloc(n_work * sizeof(tsReal));
+        if (w == NULL) {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            err = TS_MALLOC;
+        } else {
+            ts_internal_tessellation_eval(bspline, (size_t) j,
+                    (size_t) j+1, w, tess);
+            free(w);
+        }
+    }
+    if (err < 0) {
+        ts_tessellation_free(tess);
+        longjmp(buf, err);
+    }
+}
+
+/* Re-evaluates the non-empty knot intervals of \tess whose first knot lies
+ * within [\k0, \k1] and stores the range of patched points in \from and
+ * \count. */
+void ts_internal_tessellation_patch(
+    tsTessellation* tess, const tsBSpline* bspline, const size_t k0,
+    const size_t k1, size_t* from, size_t* count, jmp_buf buf
+)
+{
+    const size_t order = bspline->order;
+    size_t lo = 0, hi = tess->n_spans, mid, s0;
+    tsReal* work;
+
+    /* binary search for the first span >= k0 */
+    while (lo < hi) {
+        mid = (lo+hi) / 2;
+        if (tess->spans[mid] < k0)
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    s0 = lo;
+    hi = s0;
+    while (hi < tess->n_spans && tess->spans[hi] <= k1)
+        hi++;
+    *from = s0 * tess->n_segments;
+    *count = (hi-s0) * tess->n_segments + (hi == tess->n_spans &&
+            hi > s0 ? 1 : 0);
+    if (hi == s0)
+        return;
+
+    work = (tsReal*) malloc((order*order + 5*order) * sizeof(tsReal));
+    if (work == NULL)
+        longjmp(buf, TS_MALLOC);
+    ts_internal_tessellation_eval(bspline, s0, hi, work, tess);
+    free(work);
+}
+
+void ts_internal_tessellation_check(
+    const tsTessellation* tess, const tsBSpline* bspline, jmp_buf buf
+)
+{
+    if (tess->deg != bspline->deg || tess->dim != bspline->dim ||
+            tess->n_ctrlp != bspline->n_ctrlp)
+        longjmp(buf, TS_INCOMPATIBLE);
+}
+
+void ts_internal_tessellation_ctrlp_changed(
+    tsTessellation* tess, const tsBSpline* bspline, const size_t first,
+    const size_t n, size_t* from, size_t* count, jmp_buf buf
+)
+{
+    ts_internal_tessellation_check(tess, bspline, buf);
+    *from = *count = 0;
+    if (n == 0 || first >= bspline->n_ctrlp)
+        return;
+    /* control point i affects the knot intervals i..i+deg */
+    ts_internal_tessellation_patch(tess, bspline, first,
+            first + n-1 + bspline->deg, from, count, buf);
+}
+
+/* Re-evaluates the knot intervals [\k0, \k1] of \tess, or tessellates
+ * \bspline again if one of them became empty or non-empty. */
+void ts_internal_tessellation_intervals_changed(
+    tsTessellation* tess, const tsBSpline* bspline, const size_t k0,
+    const size_t k1, size_t* from, size_t* count, jmp_buf buf
+)
+{
+    const tsReal* knots = bspline->knots;
+    tsTessellation rebuilt;
+    size_t k, s = 0;
+
+    while (s < tess->n_spans && tess->spans[s] < k0)
+        s++;
+    for (k = k0; k <= k1; k++) {
+        if (knots[k] < knots[k+1]) {
+            if (s == tess->n_spans || tess->spans[s] != k)
+                break;
+            s++;
+        } else if (s < tess->n_spans && tess->spans[s] == k) {
+            break;
+        }
+    }
+    if (k <= k1) {
+        ts_internal_tessellation_new(bspline, tess->n_segments, &rebuilt,
+                buf);
+        ts_tessellation_free(tess);
+        *tess = rebuilt;
+        *from = 0;
+        *count = tess->n_points;
+        return;
+    }
+    ts_internal_tessellation_patch(tess, bspline, k0, k1, from, count, buf);
+}
+
+void ts_internal_tessellation_knots_changed(
+    tsTessellation* tess, const tsBSpline* bspline, const size_t first,
+    const size_t n, size_t* from, size_t* count, jmp_buf buf
+)
+{
+    const size_t deg = bspline->deg;
+    size_t k0, k1;
+
+    ts_internal_tessellation_check(tess, bspline, buf);
+    *from = *count = 0;
+    if (n == 0 || first >= bspline->n_knots)
+        return;
+    /* knot j affects the knot intervals j-deg-1..j+deg */
+    k0 = first >= 2*deg+1 ? first-deg-1 : deg;
+    k1 = first + n-1 + deg;
+    k1 = k1 < bspline->n_ctrlp-1 ? k1 : bspline->n_ctrlp-1;
+    ts_internal_tessellation_intervals_changed(
+            tess, bspline, k0, k1, from, count, buf);
+}
+
+void ts_internal_tessellation_update(
+    tsTessellation* tess, const tsBSpline* bspline, size_t* from,
+    size_t* count, jmp_buf buf
+)
+{
+    size_t first, n;
+
+    ts_internal_tessellation_check(tess, bspline, buf);
+    *from = *count = 0;
+    /* The range is not taken, other observers may need it as well. */
+    n = ts_bspline_dirty(bspline, &first);
+    if (n == 0)
+        return;
+    ts_internal_tessellation_intervals_changed(
+            tess, bspline, first, first + n-1, from, count, buf);
+}
+
+/* Checks that \bspline has a valid structure, a non-decreasing knot
+ * vector without knot values of multiplicity > order, and a non-empty
+ * domain (see ::ts_bspline_seal). */
+void ts_internal_bspline_validate(const tsBSpline* bspline, jmp_buf buf)
+{
+    const size_t deg = bspline->deg;
+    const size_t n_ctrlp = bspline->n_ctrlp;
+    const tsReal* knots = bspline->knots;
+    size_t mult = 1; /* The multiplicity of the current knot value. */
+    size_t i; /* Used in for loops. */
+
+    if (bspline->dim < 1)
+        longjmp(buf, TS_DIM_ZERO);
+    if (deg >= n_ctrlp)
+        longjmp(buf, TS_DEG_GE_NCTRLP);
+    for (i = 1; i < bspline->n_knots; i++) {
+        if (knots[i] < knots[i-1])
+            longjmp(buf, TS_KNOTS_DECR);
+        mult = ts_fequals(knots[i], knots[i-1]) ? mult+1 : 1;
+        if (mult > bspline->order)
+            longjmp(buf, TS_MULTIPLICITY);
+    }
+    if (!(knots[deg] < knots[n_ctrlp]) || ts_fequals(knots[deg],
+            knots[n_ctrlp]))
+        longjmp(buf, TS_KNOTS_DECR);
+}
+
+void ts_internal_bspline_seal(
+    const tsBSpline* bspline, tsSealedBSpline* sealed, jmp_buf buf
+)
+{
+    const size_t deg = bspline->deg;
+    const size_t dim = bspline->dim;
+    const size_t n_ctrlp = bspline->n_ctrlp;
+    const size_t n_knots = bspline->n_knots;
+    const tsReal* knots = bspline->knots;
+    tsReal* arena; /* ctrlp, knots, and inv */
+    tsReal diff;
+    size_t i, j; /* Used in for loops. */
+
+    ts_internal_bspline_validate(bspline, buf);
+
+    arena = (tsReal*) malloc((n_ctrlp*dim + n_knots + n_knots*deg) *
+            sizeof(tsReal));
+    if (arena == NULL)
+        longjmp(buf, TS_MALLOC);
+    sealed->bspline = *bspline;
+    sealed->bspline.flags = TS_PACKED;
+    sealed->bspline.ctrlp = arena;
+    sealed->bspline.knots = arena + n_ctrlp*dim;
+    sealed->inv = sealed->bspline.knots + n_knots;
+    memcpy(arena, bspline->ctrlp, n_ctrlp*dim * sizeof(tsReal));
+    memcpy(sealed->bspline.knots, knots, n_knots * sizeof(tsReal));
+
+    for (i = 0; i < n_knots; i++) {
+        for (j = 1; j <= deg; j++) {
+            diff = i+j < n_knots ? knots[i+j] - knots[i] : 0.f;
+            sealed->inv[i*deg + j-1] = diff > 0.f ? 1.f / diff : 0.f;
+        }
+    }
+    /* the domain is not empty, hence, there is a non-empty interval */
+    sealed->first_span = deg;
+    while (!(knots[sealed->first_span] < knots[sealed->first_span+1]))
+        sealed->first_span++;
+    sealed->last_span = n_ctrlp-1;
+    while (!(knots[sealed->last_span] < knots[sealed->last_span+1]))
+        sealed->last_span--;
+}
+
+/* Clamps \u to the domain of \sealed and returns the non-empty knot
+ * interval containing it. */
+size_t ts_internal_sealed_bspline_span(
+    const tsSealedBSpline* sealed, tsReal* u
+)
+{
+    const tsReal* knots = sealed->bspline.knots;
+    size_t lo = sealed->first_span, hi = sealed->last_span, mid;
+
+    *u = *u < knots[lo] ? knots[lo] :
+            *u > knots[hi+1] ? knots[hi+1] : *u;
+    while (lo < hi) {
+        mid = (lo+hi+1) / 2;
+        if (knots[mid] <= *u)
+            lo = mid;
+        else
+            hi = mid-1;
+    }
+    return lo;
+}
+
+void ts_internal_sealed_bspline_evaluate_many(
+    const tsSealedBSpline* sealed, const tsReal* us, const size_t n,
+    tsReal* points, jmp_buf buf
+)
+{
+    const size_t deg = sealed->bspline.deg;
+    const size_t dim = sealed->bspline.dim;
+    const tsReal* knots = sealed->bspline.knots;
+    const tsReal* inv = sealed->inv;
+    tsReal* scratch; /* Storage of the in place de Boor net. */
+    tsReal u, a, a_hat;
+    tsReal* pi; /* The current point of the net. */
+    const tsReal* pl; /* The left neighbour of \pi. */
+    size_t p, k, r, i, d; /* Used in for loops. */
+
+    scratch = (tsReal*) malloc(sealed->bspline.order * dim * sizeof(tsReal));
+    if (scratch == NULL)
+        longjmp(buf, TS_MALLOC);
+
+    for (p = 0; p < n; p++) {
+        u = us[p];
+        k = ts_internal_sealed_bspline_span(sealed, &u);
+        /* See ::ts_internal_bspline_eval_point. As u lies within the
+         * non-empty interval k, all deg levels of the net are required. */
+        memcpy(scratch, sealed->bspline.ctrlp + (k-deg)*dim,
+                (deg+1) * dim * sizeof(tsReal));
+        for (r = 1; r <= deg; r++) {
+            for (i = k; i >= k-deg+r; i--) {
+                a = (u - knots[i]) * inv[i*deg + deg-r];
+                a_hat = 1.f-a;
+                pi = scratch + (i+deg-k)*dim;
+                pl = pi - dim;
+                for (d = 0; d < dim; d++)
+                    pi[d] = a_hat * pl[d] + a * pi[d];
+            }
+        }
+        memcpy(points + p*dim, scratch + deg*dim, dim * sizeof(tsReal));
+    }
+    free(scratch);
+}
+
+void ts_internal_sealed_bspline_derivatives_many(
+    const tsSealedBSpline* sealed, const tsReal* us, const size_t n,
+    const size_t n_ders, tsReal* ders, jmp_buf buf
+)
+{
+    const size_t deg = sealed->bspline.deg;
+    const size_t order = sealed->bspline.order;
+    const size_t dim = sealed->bspline.dim;
+    const size_t n_out = (n_ders+1) * dim; /* The values per knot value. */
+    tsReal* N; /* (n_ders+1)*order basis functions and their derivatives */
+    const tsReal* cp; /* The first affected control point. */
+    tsReal u;
+    size_t p, span, k, j, d; /* Used in for loops. */
+
+    N = (tsReal*) malloc(((n_ders+1)*order + order*order + 4*order) *
+            sizeof(tsReal));
+    if (N == NULL)
+        longjmp(buf, TS_MALLOC);
+
+    for (p = 0; p < n; p++) {
+        u = us[p];
+        span = ts_internal_sealed_bspline_span(sealed, &u);
+        ts_internal_bspline_basis_ders_inv(sealed->bspline.knots,
+                sealed->inv, deg, span, u, n_ders, N, N + (n_ders+1)*order);
+        cp = sealed->bspline.ctrlp + (span-deg)*dim;
+        ts_arr_fill(ders + p*n_out, n_out, 0.f);
+        for (k = 0; k <= n_ders && k <= deg; k++) {
+            for (j = 0; j < order; j++) {
+                for (d = 0; d < dim; d++) {
+                    ders[p*n_out + k*dim + d] +=
+                            N[k*order + j] * cp[j*dim + d];
+                }
+            }
+        }
+    }
+    free(N);
+}
+
+void ts_internal_bspline_group_new(
+    const tsBSpline* splines, const size_t n_lanes, const int flags,
+    tsBSplineGroup* group, jmp_buf buf
+)
+{
+    /* The number of tsReal values per TS_ALIGNMENT bytes. */
+    const size_t per = TS_ALIGNMENT / sizeof(tsReal);
+    size_t deg, dim, n_ctrlp, n_knots, pitch;
+    size_t w, i, d; /* Used in for loops. */
+    const tsBSpline* src; /* The spline of the current (padding) lane. */
+
+    if (n_lanes == 0)
+        longjmp(buf, TS_DIM_ZERO);
+    deg = splines[0].deg;
+    dim = splines[0].dim;
+    n_ctrlp = splines[0].n_ctrlp;
+    n_knots = splines[0].n_knots;
+    for (w = 0; w < n_lanes; w++) {
+        if (splines[w].deg != deg || splines[w].dim != dim ||
+                splines[w].n_ctrlp != n_ctrlp)
+            longjmp(buf, TS_INCOMPATIBLE);
+        ts_internal_bspline_validate(splines + w, buf);
+    }
+
+    pitch = flags & TS_ALIGNED ? (n_lanes + per-1) / per * per : n_lanes;
+    group->ctrlp = (tsReal*) ts_internal_aligned_malloc(
+            (n_ctrlp*dim + n_knots) * pitch * sizeof(tsReal));
+    if (group->ctrlp == NULL)
+        longjmp(buf, TS_MALLOC);
+    group->knots = group->ctrlp + n_ctrlp*dim*pitch;
+    group->deg = deg;
+    group->order = deg+1;
+    group->dim = dim;
+    group->n_ctrlp = n_ctrlp;
+    group->n_knots = n_knots;
+    group->n_lanes = n_lanes;
+    group->pitch = pitch;
+    group->flags = flags;
+    for (w = 0; w < pitch; w++) {
+        src = splines + (w < n_lanes ? w : n_lanes-1);
+        for (i = 0; i < n_ctrlp; i++) {
+            for (d = 0; d < dim; d++) {
+                group->ctrlp[(i*dim + d)*pitch + w] =
+                        src->ctrlp[i*dim + d];
+            }
+        }
+        for (i = 0; i < n_knots; i++)
+            group->knots[i*pitch + w] = src->knots[i];
+    }
+}
+
+void ts_internal_bspline_group_lane(
+    const tsBSplineGroup* group, const size_t lane,
+    tsBSpline* bspline, jmp_buf buf
+)
+{
+    const size_t dim = group->dim;
+    const size_t pitch = group->pitch;
+    size_t i, d; /* Used in for loops. */
+
+    if (lane >= group->n_lanes)
+        longjmp(buf, TS_INDEX_ERROR);
+    ts_internal_bspline_new(group->n_ctrlp, dim, group->deg, TS_NONE,
+            group->flags, bspline, buf);
+    for (i = 0; i < group->n_ctrlp; i++) {
+        for (d = 0; d < dim; d++) {
+            bspline->ctrlp[i*dim + d] =
+                    group->ctrlp[(i*dim + d)*pitch + lane];
+        }
+    }
+    for (i = 0; i < group->n_knots; i++)
+        bspline->knots[i] = group->knots[i*pitch + lane];
+}
+
+void ts_internal_bspline_group_evaluate(
+    const tsBSplineGroup* group, const tsReal* us,
+    tsReal* points, jmp_buf buf
+)
+{
+    const size_t deg = group->deg;
+    const size_t dim = group->dim;
+    const size_t W = group->n_lanes;
+    const size_t pitch = group->pitch;
+    const tsReal* knots = group->knots;
+    tsReal* net; /* The de Boor nets of all lanes (order * dim rows). */
+    tsReal* t; /* The knots of the spans of all lanes (2*deg rows). */
+    tsReal* u; /* The clamped knot values (one row). */
+    tsReal* a; /* The weighting factors of the current level (one row). */
+    tsReal* pi; /* The current point of the nets. */
+    const tsReal* pl; /* The left neighbour of \pi. */
+    tsReal x;
+    size_t lo, hi, mid;
+    size_t w, j, r, d; /* Used in for loops. */
+
+    /* The workspace has the layout of the group, i.e., its rows have
+     * \pitch values and, with TS_ALIGNED, start at aligned addresses. The
+     * padding lanes repeat the last lane and are evaluated as well so that
+     * all loops run over full rows. */
+    net = (tsReal*) ts_internal_aligned_malloc(
+            ((deg+1)*dim + 2*deg + 2) * pitch * sizeof(tsReal));
+    if (net == NULL)
+        longjmp(buf, TS_MALLOC);
+    t = net + (deg+1)*dim*pitch;
+    u = t + 2*deg*pitch;
+    a = u + pitch;
+
+    /* Find the span of each lane (see ::ts_internal_sealed_bspline_span)
+     * and gather its control points and knots. */
+    for (w = 0; w < pitch; w++) {
+        x = us[w < W ? w : W-1];
+        x = x < knots[deg*pitch + w] ? knots[deg*pitch + w] :
+                x > knots[group->n_ctrlp*pitch + w] ?
+                knots[group->n_ctrlp*pitch + w] : x;
+        u[w] = x;
+        lo = deg;
+        hi = group->n_ctrlp-1;
+        while (lo < hi) {
+            mid = (lo+hi+1) / 2;
+            if (knots[mid*pitch + w] <= x)
+                lo = mid;
+            else
+                hi = mid-1;
+        }
+        /* skip empty knot intervals at the end of the domain */
+        while (!(knots[lo*pitch + w] < knots[(lo+1)*pitch + w]))
+            lo--;
+        for (j = 0; j <= deg; j++) {
+            for (d = 0; d < dim; d++) {
+                net[(j*dim + d)*pitch + w] =
+                        group->ctrlp[((lo-deg+j)*dim + d)*pitch + w];
+            }
+        }
+        for (j = 0; j < 2*deg; j++)
+            t[j*pitch + w] = knots[(lo-deg+1 + j)*pitch + w];
+    }
+
+    /* De Boor's algorithm in place (see ::ts_internal_bspline_eval_point).
+     * The innermost loops run over contiguous lanes. Point j of the nets
+     * corresponds to control point span-deg+j, t[j] to knot span-deg+1+j. */
+    for (r = 1; r <= deg; r++) {
+        for (j = deg; j >= r; j--) {
+            for (w = 0; w < pitch; w++) {
+                a[w] = (u[w] - t[(j-1)*pitch + w]) /
+                        (t[(j+deg-r)*pitch + w] - t[(j-1)*pitch + w]);
+            }
+            for (d = 0; d < dim; d++) {
+                pi = net + (j*dim + d)*pitch;
+                pl = net + ((j-1)*dim + d)*pitch;
+                for (w = 0; w < pitch; w++)
+                    pi[w] = (1.f-a[w]) * pl[w] + a[w] * pi[w];
+            }
+        }
+    }
+    for (d = 0; d < dim; d++) {
+        memcpy(points + d*W, net + (deg*dim + d)*pitch,
+                W * sizeof(tsReal));
+    }
+    ts_internal_aligned_free(net);
+}
+
+/********************************************************
+*                                                       *
+* Interface implementation                              *
+*                                                       *
+********************************************************/
+void ts_deboornet_default(tsDeBoorNet* deBoorNet)
+{
+    deBoorNet->u        = 0.f;
+    deBoorNet->k        = 0;
+    deBoorNet->s        = 0;
+    deBoorNet->h        = 0;
+    deBoorNet->dim      = 0;
+    deBoorNet->n_points = 0;
+    deBoorNet->points   = NULL;
+    deBoorNet->result   = NULL;
+}
+
+void ts_deboornet_move(tsDeBoorNet *from, tsDeBoorNet *to)
+{
+    if (from == to)
+        return;
+    to->u = from->u;
+    to->k = from->k;
+    to->s = from->s;
+    to->h = from->h;
+    to->dim = from->dim;
+    to->n_points = from->n_points;
+    to->points = from->points;
+    to->result = from->result;
+    ts_deboornet_default(from);
+}
+
+void ts_deboornet_free(tsDeBoorNet* deBoorNet)
+{
+    if (deBoorNet->points != NULL)
+        free(deBoorNet->points);/* automatically frees the field result */
+    ts_deboornet_default(deBoorNet);
+}
+
+void ts_bspline_default(tsBSpline* bspline)
+{
+    bspline->deg         = 0;
+    bspline->order       = 0;
+    bspline->dim         = 0;
+    bspline->n_ctrlp     = 0;
+    bspline->n_knots     = 0;
+    bspline->ctrlp       = NULL;
+    bspline->knots       = NULL;
+    bspline->generation  = 0;
+    bspline->dirty_first = 1;
+    bspline->dirty_last  = 0;
+    bspline->flags       = TS_PACKED;
+}
+
+void ts_bspline_free(tsBSpline* bspline)
+{
+    if (bspline->ctrlp != NULL)
+        ts_internal_bspline_release(bspline->ctrlp, bspline->flags);
+    ts_bspline_default(bspline);
+}
+
+void ts_bspline_move(tsBSpline* from, tsBSpline* to)
+{
+    if (from == to)
+        return;
+    to->deg = from->deg;
+    to->order = from->order;
+    to->dim = from->dim;
+    to->n_ctrlp = from->n_ctrlp;
+    to->n_knots = from->n_knots;
+    to->ctrlp = from->ctrlp;
+    to->knots = from->knots;
+    to->generation = from->generation;
+    to->dirty_first = from->dirty_first;
+    to->dirty_last = from->dirty_last;
+    to->flags = from->flags;
+    ts_bspline_default(from);
+}
+
+tsError ts_bspline_new(
+    const size_t n_ctrlp, const size_t dim, const size_t deg,
+    const tsBSplineType type, tsBSpline *bspline
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_new(n_ctrlp, dim, deg, type, TS_PACKED, bspline,
+                buf);
+    CATCH
+        ts_bspline_default(bspline);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_new_layout(
+    const size_t n_ctrlp, const size_t dim, const size_t deg,
+    const tsBSplineType type, const int flags, tsBSpline *bspline
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_new(n_ctrlp, dim, deg, type, flags, bspline,
+                buf);
+    CATCH
+        ts_bspline_default(bspline);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_interpolate_cubic(
+    const tsReal* points, const size_t n, const size_t dim,
+    tsBSpline* bspline
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
         ts_internal_bspline_interpolate_cubic(points, n, dim, bspline, buf);
     CATCH
-        ts_bspline_default(bspline);
+        ts_bspline_default(bspline);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_derive(
+    const tsBSpline* original,
+    tsBSpline* derivative
+)
+{
+    const size_t generation = original->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_derive(original, derivative, buf);
+        ts_internal_bspline_replaced(derivative, generation);
+    CATCH
+        if (original != derivative)
+            ts_bspline_default(derivative);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_integral(
+    const tsBSpline* original,
+    tsBSpline* integral
+)
+{
+    const size_t generation = original->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_integral(original, integral, buf);
+        ts_internal_bspline_replaced(integral, generation);
+    CATCH
+        if (original != integral)
+            ts_bspline_default(integral);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_add(
+    const tsBSpline* a, const tsBSpline* b,
+    tsBSpline* sum
+)
+{
+    const size_t generation = a->generation > b->generation ?
+            a->generation : b->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_add(a, b, sum, buf);
+        ts_internal_bspline_replaced(sum, generation);
+    CATCH
+        if (a != sum && b != sum)
+            ts_bspline_default(sum);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_scale(
+    const tsBSpline* original, const tsReal s,
+    tsBSpline* scaled
+)
+{
+    const size_t generation = original->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_scale(original, s, scaled, buf);
+        ts_internal_bspline_replaced(scaled, generation);
+    CATCH
+        if (original != scaled)
+            ts_bspline_default(scaled);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_multiply(
+    const tsBSpline* a, const tsBSpline* b,
+    tsBSpline* product
+)
+{
+    const size_t generation = a->generation > b->generation ?
+            a->generation : b->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_combine(a, b, TS_COMBINE_MULTIPLY, product, buf);
+        ts_internal_bspline_replaced(product, generation);
+    CATCH
+        if (a != product && b != product)
+            ts_bspline_default(product);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_transform(
+    const tsBSpline* original, const tsReal* matrix,
+    const tsTransformType type,
+    tsBSpline* transformed
+)
+{
+    const size_t generation = original->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_transform(original, matrix, type, transformed,
+                buf);
+        ts_internal_bspline_replaced(transformed, generation);
+    CATCH
+        if (original != transformed)
+            ts_bspline_default(transformed);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_transform_many(
+    const tsBSpline* splines, const size_t n_splines, const tsReal* matrix,
+    const tsTransformType type,
+    tsBSpline* transformed
+)
+{
+    tsError err = TS_SUCCESS;
+    tsError e; /* The error of a single spline. */
+    size_t n_ctrlp = 0; /* The total number of control points. */
+    size_t i; /* Used in for loops. */
+    long j; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+
+    /* The size of \matrix depends on the dimension. */
+    for (i = 0; i < n_splines; i++) {
+        if (splines[i].dim != splines[0].dim) {
+            if (transformed != splines) {
+                for (i = 0; i < n_splines; i++)
+                    ts_bspline_default(transformed + i);
+            }
+            return TS_INCOMPATIBLE;
+        }
+        n_ctrlp += splines[i].n_ctrlp;
+    }
+
+    /* Each spline is transformed with its own jmp_buf, i.e., longjmp never
+     * crosses thread boundaries. */
+#ifdef _OPENMP
+    #pragma omp parallel for private(e) schedule(dynamic) \
+        if (n_ctrlp >= TS_OPENMP_MIN_WORK)
+#endif
+    for (j = 0; j < (long) n_splines; j++) {
+        e = ts_bspline_transform(splines + j, matrix, type, transformed + j);
+        if (e < 0) {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            err = e;
+        }
+    }
+    return err;
+}
+
+tsError ts_bspline_offset(
+    const tsBSpline* bspline, const tsReal d, const tsReal tol,
+    tsBSpline* offset
+)
+{
+    const size_t generation = bspline->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_offset(bspline, d, tol, offset, buf);
+        ts_internal_bspline_replaced(offset, generation);
+    CATCH
+        if (bspline != offset)
+            ts_bspline_default(offset);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_self_intersections(
+    const tsBSpline* bspline, const tsReal tol, tsReal** us, size_t* n
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_self_intersections(bspline, tol, us, n, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_distance_field(
+    const tsBSpline* splines, const size_t n_splines, const tsReal* origin,
+    const tsReal cell, const size_t width, const size_t height,
+    const tsReal band, float* grid
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_distance_field(splines, n_splines, origin, cell,
+                width, height, band, grid, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_rasterize(
+    const tsBSpline* outlines, const size_t n_outlines, const tsReal* origin,
+    const tsReal cell, const size_t width, const size_t height,
+    const tsAlphaType type, void* alpha
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_rasterize(outlines, n_outlines, origin, cell,
+                width, height, type, alpha, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_deboornet_copy(
+    const tsDeBoorNet* original,
+    tsDeBoorNet* copy
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_deboornet_copy(original, copy, buf);
+    CATCH
+        if (original != copy)
+            ts_deboornet_default(copy);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_copy(
+    const tsBSpline* original,
+    tsBSpline* copy
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_copy(original, copy, buf);
+    CATCH
+        if (original != copy)
+            ts_bspline_default(copy);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_set_ctrlp(
+    const tsBSpline* bspline, const tsReal* ctrlp,
+    tsBSpline* result
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_set_ctrlp(bspline, ctrlp, result, buf);
+    CATCH
+        if (bspline != result)
+            ts_bspline_default(result);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_set_knots(
+    const tsBSpline* bspline, const tsReal* knots,
+    tsBSpline* result
+)
+{
+    tsError err;
+    jmp_buf  buf;
+    TRY(buf, err)
+        ts_internal_bspline_set_knots(bspline, knots, result, buf);
+    CATCH
+        if (bspline != result)
+            ts_bspline_default(result);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_set_ctrlp_range(
+    tsBSpline* bspline, const size_t first, const size_t count,
+    const tsReal* values
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_set_ctrlp_range(bspline, first, count, values,
+                buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_set_knot(
+    tsBSpline* bspline, const size_t index, const tsReal value
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_set_knot(bspline, index, value, buf);
+    ETRY
+    return err;
+}
+
+size_t ts_bspline_dirty(const tsBSpline* bspline, size_t* first)
+{
+    if (bspline->dirty_first > bspline->dirty_last) {
+        *first = 0;
+        return 0;
+    }
+    *first = bspline->dirty_first;
+    return bspline->dirty_last - bspline->dirty_first + 1;
+}
+
+size_t ts_bspline_take_dirty(tsBSpline* bspline, size_t* first)
+{
+    const size_t n = ts_bspline_dirty(bspline, first);
+    bspline->dirty_first = 1;
+    bspline->dirty_last = 0;
+    return n;
+}
+
+tsError ts_bspline_fill_knots(
+    const tsBSpline* original, const tsBSplineType type,
+    const tsReal min, const tsReal max,
+    tsBSpline* result
+)
+{
+    const size_t generation = original->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_fill_knots(original, type, min, max, result, buf);
+        ts_internal_bspline_replaced(result, generation);
+    CATCH
+        if (original != result)
+            ts_bspline_default(result);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_evaluate(
+    const tsBSpline* bspline, const tsReal u,
+    tsDeBoorNet* deBoorNet
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_evaluate(bspline, u, deBoorNet, buf);
+    CATCH
+        ts_deboornet_default(deBoorNet);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_insert_knot(
+    const tsBSpline* bspline, const tsReal u, const size_t n,
+    tsBSpline* result, size_t* k
+)
+{
+    const size_t generation = bspline->generation;
+    tsDeBoorNet net;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_evaluate(bspline, u, &net, buf);
+        ts_internal_bspline_insert_knot(bspline, &net, n, result, buf);
+        ts_internal_bspline_replaced(result, generation);
+        *k = net.k+n;
+    CATCH
+        if (bspline != result)
+            ts_bspline_default(result);
+        *k = 0;
+    ETRY
+
+    ts_deboornet_free(&net);
+    return err;
+}
+
+tsError ts_bspline_resize(
+    const tsBSpline* bspline, const int n, const int back,
+    tsBSpline* resized
+)
+{
+    const size_t generation = bspline->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_resize(bspline, n, back, resized, buf);
+        ts_internal_bspline_replaced(resized, generation);
+    CATCH
+        if (bspline != resized)
+            ts_bspline_default(resized);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_split(
+    const tsBSpline* bspline, const tsReal u,
+    tsBSpline* split, size_t* k
+)
+{
+    const size_t generation = bspline->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_split(bspline, u, split, k, buf);
+        ts_internal_bspline_replaced(split, generation);
+    CATCH
+        if (bspline != split)
+            ts_bspline_default(split);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_buckle(
+    const tsBSpline* bspline, const tsReal b,
+    tsBSpline* buckled
+)
+{
+    const size_t generation = bspline->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_buckle(bspline, b, buckled, buf);
+        ts_internal_bspline_replaced(buckled, generation);
+    CATCH
+        if (bspline != buckled)
+            ts_bspline_default(buckled);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_lerp(
+    const tsBSpline* a, const tsBSpline* b, const tsReal t,
+    tsBSpline* lerped
+)
+{
+    const size_t generation = a->generation > b->generation ?
+            a->generation : b->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_lerp(a, b, t, lerped, buf);
+        ts_internal_bspline_replaced(lerped, generation);
+    CATCH
+        if (a != lerped && b != lerped)
+            ts_bspline_default(lerped);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_to_beziers(
+    const tsBSpline* bspline,
+    tsBSpline* beziers
+)
+{
+    const size_t generation = bspline->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_to_beziers(bspline, beziers, buf);
+        ts_internal_bspline_replaced(beziers, generation);
+    CATCH
+        if (bspline != beziers)
+            ts_bspline_default(beziers);
+    ETRY
+    return err;
+}
+
+unsigned int ts_abi_version(void)
+{
+    return TINYSPLINE_ABI_VERSION;
+}
+
+void ts_bspline_domain(
+    const tsBSpline* bspline,
+    tsReal* min, tsReal* max
+)
+{
+    *min = bspline->knots[bspline->deg];
+    *max = bspline->knots[bspline->n_knots - bspline->order];
+}
+
+tsError ts_bspline_evaluate_many(
+    const tsBSpline* bspline, const tsReal* us, const size_t n,
+    tsReal* points
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_evaluate_many(bspline, us, n, points, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_sample(
+    const tsBSpline* bspline, const size_t n,
+    tsReal* points
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_sample(bspline, n, points, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_sample_simplified(
+    const tsBSpline* bspline, const size_t n, const tsReal tol,
+    tsReal* points, const size_t max, size_t* n_out
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_sample_simplified(
+                bspline, n, tol, points, max, n_out, buf);
+    ETRY
+    return err;
+}
+
+size_t ts_bspline_serialized_size(const tsBSpline* bspline)
+{
+    return TS_SERIAL_HEADER_SIZE +
+            (bspline->n_ctrlp*bspline->dim + bspline->n_knots) *
+            sizeof(tsReal);
+}
+
+tsError ts_bspline_serialize(
+    const tsBSpline* bspline,
+    unsigned char* buf, const size_t len
+)
+{
+    tsError err;
+    jmp_buf b;
+    TRY(b, err)
+        ts_internal_bspline_serialize(bspline, buf, len, b);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_deserialize(
+    const unsigned char* buf, const size_t len,
+    tsBSpline* bspline
+)
+{
+    tsError err;
+    jmp_buf b;
+    TRY(b, err)
+        ts_internal_bspline_deserialize(buf, len, bspline, b);
+    CATCH
+        ts_bspline_default(bspline);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_sweep(
+    const tsBSpline* bspline, const size_t n, const tsReal* profile,
+    const size_t n_profile, const int closed,
+    tsReal* vertices, size_t* indices
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_sweep(bspline, n, profile, n_profile, closed,
+                vertices, indices, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_sweep_many(
+    const tsBSpline* splines, const size_t n_splines, const size_t n,
+    const tsReal* profile, const size_t n_profile, const int closed,
+    tsReal* vertices, size_t* indices
+)
+{
+    const size_t n_verts = n * n_profile; /* Vertices per spline. */
+    const size_t m = closed ? n_profile : (n_profile > 0 ? n_profile-1 : 0);
+    const size_t n_idx = n > 0 ? 6 * (n-1) * m : 0; /* Indices per spline. */
+    tsError err = TS_SUCCESS;
+    tsError e; /* The error of a single spline. */
+    size_t* idx; /* The indices of a single spline. */
+    size_t i; /* Used in for loops. */
+    long j; /* Used in for loops (OpenMP 2.0 requires a signed index). */
+
+    /* Each spline is swept with its own jmp_buf, i.e., longjmp never
+     * crosses thread boundaries. */
+#ifdef _OPENMP
+    #pragma omp parallel for private(e, idx, i) schedule(dynamic)
+#endif
+    for (j = 0; j < (long) n_splines; j++) {
+        idx = indices == NULL ? NULL : indices + j*n_idx;
+        e = ts_bspline_sweep(splines + j, n, profile, n_profile, closed,
+                vertices + j*n_verts*3, idx);
+        if (e < 0) {
+#ifdef _OPENMP
+            #pragma omp critical
+#endif
+            err = e;
+        } else if (idx != NULL) {
+            for (i = 0; i < n_idx; i++)
+                idx[i] += j*n_verts;
+        }
+    }
+    return err;
+}
+
+tsError ts_bspline_frenet_many(
+    const tsBSpline* bspline, const tsReal* us, const size_t n,
+    tsReal* tangents, tsReal* normals, tsReal* binormals,
+    tsReal* curvatures, tsReal* torsions
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_frenet_many(bspline, us, n, tangents, normals,
+                binormals, curvatures, torsions, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_curvature_many(
+    const tsBSpline* bspline, const tsReal* us, const size_t n,
+    tsReal* curvatures
+)
+{
+    return ts_bspline_frenet_many(bspline, us, n, NULL, NULL, NULL,
+            curvatures, NULL);
+}
+
+tsError ts_bspline_integrate(
+    const tsBSpline* bspline, const tsIntegrand f, void* ctx,
+    const tsReal tol, tsReal* result
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_integrate(bspline, f, ctx, tol, result, buf);
+    CATCH
+        *result = 0.f;
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_length(
+    const tsBSpline* bspline, const tsReal tol,
+    tsReal* length
+)
+{
+    return ts_bspline_integrate(bspline, ts_internal_speed, NULL, tol,
+            length);
+}
+
+void ts_bspline_lookup_default(tsBSplineLookup* lookup)
+{
+    lookup->n_spans    = 0;
+    lookup->decreasing = 0;
+    lookup->xs         = NULL;
+    lookup->us         = NULL;
+    lookup->spans      = NULL;
+}
+
+tsError ts_bspline_lookup_new(
+    const tsBSpline* bspline,
+    tsBSplineLookup* lookup
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_lookup_new(bspline, lookup, buf);
+    CATCH
+        ts_bspline_lookup_default(lookup);
+    ETRY
+    return err;
+}
+
+void ts_bspline_lookup_free(tsBSplineLookup* lookup)
+{
+    if (lookup->xs != NULL)
+        free(lookup->xs);
+    if (lookup->spans != NULL)
+        free(lookup->spans);
+    ts_bspline_lookup_default(lookup);
+}
+
+tsError ts_bspline_lookup(
+    const tsBSpline* bspline, const tsBSplineLookup* lookup,
+    const tsReal x, tsReal* y
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_lookup(bspline, lookup, x, y, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_lookup_many(
+    const tsBSpline* bspline, const tsBSplineLookup* lookup,
+    const tsReal* xs, const size_t n,
+    tsReal* ys
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_lookup_many(bspline, lookup, xs, n, ys, buf);
+    ETRY
+    return err;
+}
+
+void ts_simplifier_default(tsSimplifier* simplifier)
+{
+    simplifier->dim      = 0;
+    simplifier->tol      = 0.f;
+    simplifier->n_points = 0;
+    simplifier->radius   = 0.f;
+    simplifier->angle    = 0.f;
+    simplifier->anchor   = NULL;
+    simplifier->last     = NULL;
+    simplifier->axis     = NULL;
+}
+
+tsError ts_simplifier_new(
+    const size_t dim, const tsReal tol,
+    tsSimplifier* simplifier
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_simplifier_new(dim, tol, simplifier, buf);
+    CATCH
+        ts_simplifier_default(simplifier);
+    ETRY
+    return err;
+}
+
+void ts_simplifier_free(tsSimplifier* simplifier)
+{
+    if (simplifier->anchor != NULL)
+        free(simplifier->anchor);
+    ts_simplifier_default(simplifier);
+}
+
+size_t ts_simplifier_push(
+    tsSimplifier* simplifier, const tsReal* point,
+    tsReal* out
+)
+{
+    return ts_internal_simplifier_push(simplifier, point, out);
+}
+
+size_t ts_simplifier_flush(
+    tsSimplifier* simplifier,
+    tsReal* out
+)
+{
+    return ts_internal_simplifier_flush(simplifier, out);
+}
+
+void ts_bspline_lod_default(tsBSplineLOD* lod)
+{
+    lod->n_levels = 0;
+    lod->errors   = NULL;
+    lod->levels   = NULL;
+}
+
+tsError ts_bspline_lod_new(
+    const tsBSpline* bspline, const tsReal tol, const size_t n_levels,
+    tsBSplineLOD* lod
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_lod_new(bspline, tol, n_levels, lod, buf);
+    CATCH
+        ts_bspline_lod_default(lod);
+    ETRY
+    return err;
+}
+
+void ts_bspline_lod_free(tsBSplineLOD* lod)
+{
+    if (lod->errors != NULL)
+        free(lod->errors);
+    if (lod->levels != NULL)
+        free(lod->levels);
+    ts_bspline_lod_default(lod);
+}
+
+size_t ts_bspline_lod_select(
+    const tsBSplineLOD* lod, const tsReal scale, const tsReal max_error
+)
+{
+    size_t k = lod->n_levels;
+    while (k > 1 && lod->errors[k-1] * scale > max_error)
+        k--;
+    return k > 0 ? k-1 : 0;
+}
+
+void ts_tessellation_default(tsTessellation* tess)
+{
+    tess->deg        = 0;
+    tess->dim        = 0;
+    tess->n_ctrlp    = 0;
+    tess->n_segments = 0;
+    tess->n_spans    = 0;
+    tess->n_points   = 0;
+    tess->spans      = NULL;
+    tess->points     = NULL;
+}
+
+tsError ts_tessellation_new(
+    const tsBSpline* bspline, const size_t n_segments,
+    tsTessellation* tess
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_tessellation_new(bspline, n_segments, tess, buf);
+    CATCH
+        ts_tessellation_default(tess);
+    ETRY
+    return err;
+}
+
+void ts_tessellation_free(tsTessellation* tess)
+{
+    if (tess->spans != NULL)
+        free(tess->spans);
+    if (tess->points != NULL)
+        free(tess->points);
+    ts_tessellation_default(tess);
+}
+
+tsError ts_tessellation_ctrlp_changed(
+    tsTessellation* tess, const tsBSpline* bspline, const size_t first,
+    const size_t n, size_t* from, size_t* count
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_tessellation_ctrlp_changed(
+                tess, bspline, first, n, from, count, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_tessellation_knots_changed(
+    tsTessellation* tess, const tsBSpline* bspline, const size_t first,
+    const size_t n, size_t* from, size_t* count
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_tessellation_knots_changed(
+                tess, bspline, first, n, from, count, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_tessellation_update(
+    tsTessellation* tess, const tsBSpline* bspline, size_t* from,
+    size_t* count
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_tessellation_update(tess, bspline, from, count, buf);
+    ETRY
+    return err;
+}
+
+void ts_sealed_bspline_default(tsSealedBSpline* sealed)
+{
+    ts_bspline_default(&sealed->bspline);
+    sealed->inv        = NULL;
+    sealed->first_span = 0;
+    sealed->last_span  = 0;
+}
+
+tsError ts_bspline_seal(
+    const tsBSpline* bspline,
+    tsSealedBSpline* sealed
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_seal(bspline, sealed, buf);
+    CATCH
+        ts_sealed_bspline_default(sealed);
     ETRY
     return err;
 }
 
-tsError ts_bspline_derive(
-    const tsBSpline* original,
+void ts_sealed_bspline_free(tsSealedBSpline* sealed)
+{
+    if (sealed->bspline.ctrlp != NULL)
+        free(sealed->bspline.ctrlp);
+    ts_sealed_bspline_default(sealed);
+}
+
+tsError ts_sealed_bspline_evaluate_many(
+    const tsSealedBSpline* sealed, const tsReal* us, const size_t n,
+    tsReal* points
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_sealed_bspline_evaluate_many(sealed, us, n, points,
+                buf);
+    ETRY
+    return err;
+}
+
+tsError ts_sealed_bspline_derivatives_many(
+    const tsSealedBSpline* sealed, const tsReal* us, const size_t n,
+    const size_t n_ders, tsReal* ders
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_sealed_bspline_derivatives_many(sealed, us, n, n_ders,
+                ders, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_sealed_bspline_derive(
+    const tsSealedBSpline* sealed,
     tsBSpline* derivative
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_derive(original, derivative, buf);
+        ts_internal_bspline_derive_inv(&sealed->bspline, sealed->inv,
+                derivative, buf);
     CATCH
-        if (original != derivative)
-            ts_bspline_default(derivative);
+        ts_bspline_default(derivative);
     ETRY
     return err;
 }
 
-tsError ts_deboornet_copy(
-    const tsDeBoorNet* original,
-    tsDeBoorNet* copy
+tsError ts_sealed_bspline_insert_knot(
+    const tsSealedBSpline* sealed, const tsReal u, const size_t n,
+    tsBSpline* result, size_t* k
 )
 {
+    tsDeBoorNet net;
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_deboornet_copy(original, copy, buf);
+        ts_internal_bspline_evaluate_inv(&sealed->bspline, sealed->inv, u,
+                &net, buf);
+        ts_internal_bspline_insert_knot(&sealed->bspline, &net, n, result,
+                buf);
+        *k = net.k+n;
     CATCH
-        if (original != copy)
-            ts_deboornet_default(copy);
+        ts_bspline_default(result);
+        *k = 0;
     ETRY
+
+    ts_deboornet_free(&net);
     return err;
 }
 
-tsError ts_bspline_copy(
-    const tsBSpline* original,
-    tsBSpline* copy
+void ts_bspline_group_default(tsBSplineGroup* group)
+{
+    group->deg     = 0;
+    group->order   = 0;
+    group->dim     = 0;
+    group->n_ctrlp = 0;
+    group->n_knots = 0;
+    group->n_lanes = 0;
+    group->pitch   = 0;
+    group->flags   = TS_PACKED;
+    group->ctrlp   = NULL;
+    group->knots   = NULL;
+}
+
+tsError ts_bspline_group_new(
+    const tsBSpline* splines, const size_t n_lanes, const int flags,
+    tsBSplineGroup* group
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_copy(original, copy, buf);
+        ts_internal_bspline_group_new(splines, n_lanes, flags, group, buf);
     CATCH
-        if (original != copy)
-            ts_bspline_default(copy);
+        ts_bspline_group_default(group);
     ETRY
     return err;
 }
 
-tsError ts_bspline_set_ctrlp(
-    const tsBSpline* bspline, const tsReal* ctrlp,
-    tsBSpline* result
+void ts_bspline_group_free(tsBSplineGroup* group)
+{
+    ts_internal_aligned_free(group->ctrlp);
+    ts_bspline_group_default(group);
+}
+
+tsError ts_bspline_group_lane(
+    const tsBSplineGroup* group, const size_t lane,
+    tsBSpline* bspline
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_set_ctrlp(bspline, ctrlp, result, buf);
+        ts_internal_bspline_group_lane(group, lane, bspline, buf);
     CATCH
-        if (bspline != result)
-            ts_bspline_default(result);
+        ts_bspline_default(bspline);
     ETRY
     return err;
 }
 
-tsError ts_bspline_set_knots(
-    const tsBSpline* bspline, const tsReal* knots,
-    tsBSpline* result
+tsError ts_bspline_group_evaluate(
+    const tsBSplineGroup* group, const tsReal* us,
+    tsReal* points
 )
 {
     tsError err;
-    jmp_buf  buf;
+    jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_set_knots(bspline, knots, result, buf);
+        ts_internal_bspline_group_evaluate(group, us, points, buf);
+    ETRY
+    return err;
+}
+
+void ts_bsplinesurface_default(tsBSplineSurface* surface)
+{
+    surface->deg_u     = 0;
+    surface->deg_v     = 0;
+    surface->order_u   = 0;
+    surface->order_v   = 0;
+    surface->dim       = 0;
+    surface->n_ctrlp_u = 0;
+    surface->n_ctrlp_v = 0;
+    surface->n_knots_u = 0;
+    surface->n_knots_v = 0;
+    surface->ctrlp     = NULL;
+    surface->knots_u   = NULL;
+    surface->knots_v   = NULL;
+}
+
+tsError ts_bsplinesurface_new(
+    const size_t n_ctrlp_u, const size_t n_ctrlp_v, const size_t dim,
+    const size_t deg_u, const size_t deg_v, const tsBSplineType type,
+    tsBSplineSurface* surface
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bsplinesurface_new(n_ctrlp_u, n_ctrlp_v, dim,
+                deg_u, deg_v, type, surface, buf);
     CATCH
-        if (bspline != result)
-            ts_bspline_default(result);
+        ts_bsplinesurface_default(surface);
     ETRY
     return err;
 }
 
-tsError ts_bspline_fill_knots(
-    const tsBSpline* original, const tsBSplineType type,
-    const tsReal min, const tsReal max,
-    tsBSpline* result
+tsError ts_bsplinesurface_copy(
+    const tsBSplineSurface* original,
+    tsBSplineSurface* copy
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_fill_knots(original, type, min, max, result, buf);
+        ts_internal_bsplinesurface_copy(original, copy, buf);
     CATCH
-        if (original != result)
-            ts_bspline_default(result);
+        if (original != copy)
+            ts_bsplinesurface_default(copy);
     ETRY
     return err;
 }
 
-tsError ts_bspline_evaluate(
-    const tsBSpline* bspline, const tsReal u,
-    tsDeBoorNet* deBoorNet
+void ts_bsplinesurface_move(
+    tsBSplineSurface* from,
+    tsBSplineSurface* to
+)
+{
+    if (from == to)
+        return;
+    *to = *from;
+    ts_bsplinesurface_default(from);
+}
+
+void ts_bsplinesurface_free(tsBSplineSurface* surface)
+{
+    if (surface->ctrlp != NULL)
+        free(surface->ctrlp);
+    ts_bsplinesurface_default(surface);
+}
+
+void ts_bsplinesurface_domain(
+    const tsBSplineSurface* surface,
+    tsReal* min_u, tsReal* max_u, tsReal* min_v, tsReal* max_v
+)
+{
+    *min_u = surface->knots_u[surface->deg_u];
+    *max_u = surface->knots_u[surface->n_ctrlp_u];
+    *min_v = surface->knots_v[surface->deg_v];
+    *max_v = surface->knots_v[surface->n_ctrlp_v];
+}
+
+tsError ts_bsplinesurface_evaluate(
+    const tsBSplineSurface* surface, const tsReal u, const tsReal v,
+    tsReal* point
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_evaluate(bspline, u, deBoorNet, buf);
+        ts_internal_bsplinesurface_evaluate(surface, u, v, point, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bsplinesurface_derivatives(
+    const tsBSplineSurface* surface, const tsReal u, const tsReal v,
+    const size_t d, tsReal* ders
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bsplinesurface_derivatives(surface, u, v, d, ders, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bsplinesurface_evaluate_grid(
+    const tsBSplineSurface* surface,
+    const tsReal* us, const size_t m, const tsReal* vs, const size_t n,
+    tsReal* points
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bsplinesurface_evaluate_grid(
+                surface, us, m, vs, n, points, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bsplinesurface_interpolate_cubic(
+    const tsReal* samples, const size_t n_u, const size_t n_v,
+    const size_t dim, tsBSplineSurface* surface
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bsplinesurface_interpolate_cubic(samples, n_u, n_v, dim,
+                surface, buf);
     CATCH
-        ts_deboornet_default(deBoorNet);
+        ts_bsplinesurface_default(surface);
     ETRY
     return err;
 }
 
-tsError ts_bspline_insert_knot(
-    const tsBSpline* bspline, const tsReal u, const size_t n,
-    tsBSpline* result, size_t* k
+void ts_bsplinevolume_default(tsBSplineVolume* volume)
+{
+    volume->deg_u     = 0;
+    volume->deg_v     = 0;
+    volume->deg_w     = 0;
+    volume->dim       = 0;
+    volume->n_ctrlp_u = 0;
+    volume->n_ctrlp_v = 0;
+    volume->n_ctrlp_w = 0;
+    volume->ctrlp     = NULL;
+    volume->knots_u   = NULL;
+    volume->knots_v   = NULL;
+    volume->knots_w   = NULL;
+}
+
+tsError ts_bsplinevolume_new(
+    const size_t n_ctrlp_u, const size_t n_ctrlp_v, const size_t n_ctrlp_w,
+    const size_t dim, const size_t deg_u, const size_t deg_v,
+    const size_t deg_w, const tsBSplineType type,
+    tsBSplineVolume* volume
 )
 {
-    tsDeBoorNet net;
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_evaluate(bspline, u, &net, buf);
-        ts_internal_bspline_insert_knot(bspline, &net, n, result, buf);
-        *k = net.k+n;
+        ts_internal_bsplinevolume_new(n_ctrlp_u, n_ctrlp_v, n_ctrlp_w, dim,
+                deg_u, deg_v, deg_w, type, volume, buf);
     CATCH
-        if (bspline != result)
-            ts_bspline_default(result);
-        *k = 0;
+        ts_bsplinevolume_default(volume);
     ETRY
+    return err;
+}
 
-    ts_deboornet_free(&net);
+tsError ts_bsplinevolume_copy(
+    const tsBSplineVolume* original,
+    tsBSplineVolume* copy
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bsplinevolume_copy(original, copy, buf);
+    CATCH
+        if (original != copy)
+            ts_bsplinevolume_default(copy);
+    ETRY
     return err;
 }
 
-tsError ts_bspline_resize(
-    const tsBSpline* bspline, const int n, const int back,
-    tsBSpline* resized
+void ts_bsplinevolume_move(
+    tsBSplineVolume* from,
+    tsBSplineVolume* to
+)
+{
+    if (from == to)
+        return;
+    *to = *from;
+    ts_bsplinevolume_default(from);
+}
+
+void ts_bsplinevolume_free(tsBSplineVolume* volume)
+{
+    if (volume->ctrlp != NULL)
+        free(volume->ctrlp);
+    ts_bsplinevolume_default(volume);
+}
+
+tsError ts_bsplinevolume_evaluate(
+    const tsBSplineVolume* volume, const tsReal u, const tsReal v,
+    const tsReal w, tsReal* point
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_resize(bspline, n, back, resized, buf);
+        ts_internal_bsplinevolume_evaluate(volume, u, v, w, point, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bsplinevolume_evaluate_many(
+    const tsBSplineVolume* volume, const tsReal* uvw, const size_t n,
+    tsReal* points
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bsplinevolume_evaluate_many(volume, uvw, n, points, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bsplinevolume_interpolate_cubic(
+    const tsReal* samples, const size_t n_u, const size_t n_v,
+    const size_t n_w, const size_t dim,
+    tsBSplineVolume* volume
+)
+{
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bsplinevolume_interpolate_cubic(samples, n_u, n_v, n_w,
+                dim, volume, buf);
     CATCH
-        if (bspline != resized)
-            ts_bspline_default(resized);
+        ts_bsplinevolume_default(volume);
     ETRY
     return err;
 }
 
-tsError ts_bspline_split(
-    const tsBSpline* bspline, const tsReal u,
-    tsBSpline* split, size_t* k
+tsError ts_bspline_function_interpolate_cubic(
+    const tsReal* ys, const size_t n, const tsReal x_min, const tsReal x_max,
+    tsBSpline* function
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_split(bspline, u, split, k, buf);
+        ts_internal_bspline_function_interpolate_cubic(ys, n, x_min, x_max,
+                function, buf);
     CATCH
-        if (bspline != split)
-            ts_bspline_default(split);
+        ts_bspline_default(function);
     ETRY
     return err;
 }
 
-tsError ts_bspline_buckle(
-    const tsBSpline* bspline, const tsReal b,
-    tsBSpline* buckled
+tsError ts_bspline_function_evaluate(
+    const tsBSpline* function, const tsReal x,
+    tsReal* y
 )
 {
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_buckle(bspline, b, buckled, buf);
+        ts_internal_bspline_function_evaluate(function, x, y, buf);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_function_add(
+    const tsBSpline* a, const tsBSpline* b,
+    tsBSpline* sum
+)
+{
+    const size_t generation = a->generation > b->generation ?
+            a->generation : b->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_function_check(a, buf);
+        ts_internal_bspline_function_check(b, buf);
+        ts_internal_bspline_combine(a, b, TS_COMBINE_ADD, sum, buf);
+        ts_internal_bspline_replaced(sum, generation);
     CATCH
-        if (bspline != buckled)
-            ts_bspline_default(buckled);
+        if (a != sum && b != sum)
+            ts_bspline_default(sum);
     ETRY
     return err;
 }
 
-tsError ts_bspline_to_beziers(
-    const tsBSpline* bspline,
-    tsBSpline* beziers
+tsError ts_bspline_function_multiply(
+    const tsBSpline* a, const tsBSpline* b,
+    tsBSpline* product
 )
 {
+    const size_t generation = a->generation > b->generation ?
+            a->generation : b->generation;
     tsError err;
     jmp_buf buf;
     TRY(buf, err)
-        ts_internal_bspline_to_beziers(bspline, beziers, buf);
+        ts_internal_bspline_function_check(a, buf);
+        ts_internal_bspline_function_check(b, buf);
+        ts_internal_bspline_combine(a, b, TS_COMBINE_MULTIPLY, product, buf);
+        ts_internal_bspline_replaced(product, generation);
     CATCH
-        if (bspline != beziers)
-            ts_bspline_default(beziers);
+        if (a != product && b != product)
+            ts_bspline_default(product);
+    ETRY
+    return err;
+}
+
+tsError ts_bspline_function_antiderivative(
+    const tsBSpline* function,
+    tsBSpline* antiderivative
+)
+{
+    const size_t generation = function->generation;
+    tsError err;
+    jmp_buf buf;
+    TRY(buf, err)
+        ts_internal_bspline_function_check(function, buf);
+        ts_internal_bspline_integral(function, antiderivative, buf);
+        ts_internal_bspline_replaced(antiderivative, generation);
+    CATCH
+        if (function != antiderivative)
+            ts_bspline_default(antiderivative);
     ETRY
     return err;
 }
@@ -1139,6 +8110,18 @@ const char* ts_enum_str(const tsError err)
         return "unexpected number of knots";
     else if (err == TS_UNDERIVABLE)
         return "spline is not derivable";
+    else if (err == TS_PARSE_ERROR)
+        return "invalid serialized spline";
+    else if (err == TS_BUFFER_SIZE)
+        return "buffer too small";
+    else if (err == TS_DIM_UNSUPPORTED)
+        return "unsupported dimension";
+    else if (err == TS_NOT_MONOTONE)
+        return "spline is not monotone";
+    else if (err == TS_INCOMPATIBLE)
+        return "splines are not compatible";
+    else if (err == TS_INDEX_ERROR)
+        return "index out of range";
     return "unknown error";
 }
 
@@ -1160,6 +8143,18 @@ tsError ts_str_enum(const char* str)
         return TS_NUM_KNOTS;
     else if (!strcmp(str, ts_enum_str(TS_UNDERIVABLE)))
         return TS_UNDERIVABLE;
+    else if (!strcmp(str, ts_enum_str(TS_PARSE_ERROR)))
+        return TS_PARSE_ERROR;
+    else if (!strcmp(str, ts_enum_str(TS_BUFFER_SIZE)))
+        return TS_BUFFER_SIZE;
+    else if (!strcmp(str, ts_enum_str(TS_DIM_UNSUPPORTED)))
+        return TS_DIM_UNSUPPORTED;
+    else if (!strcmp(str, ts_enum_str(TS_NOT_MONOTONE)))
+        return TS_NOT_MONOTONE;
+    else if (!strcmp(str, ts_enum_str(TS_INCOMPATIBLE)))
+        return TS_INCOMPATIBLE;
+    else if (!strcmp(str, ts_enum_str(TS_INDEX_ERROR)))
+        return TS_INDEX_ERROR;
     return TS_SUCCESS;
 }
 
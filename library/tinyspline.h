@@ -25,6 +25,52 @@ typedef float tsReal;
 #define FLT_MAX_ABS_ERROR 1e-5
 #define FLT_MAX_REL_ERROR 1e-8
 
+/* The number of points processed at once by ::ts_bsplinevolume_evaluate_many.
+ * Should be a multiple of the SIMD width of the target (in tsReal). */
+#ifndef TS_VOLUME_BLOCK_SIZE
+#define TS_VOLUME_BLOCK_SIZE 8
+#endif
+
+/* The number of tsReal values per row solved at once by the grid
+ * interpolations (::ts_bsplinesurface_interpolate_cubic and
+ * ::ts_bsplinevolume_interpolate_cubic). A block of n rows should fit into
+ * the L2 cache twice (input and output). */
+#ifndef TS_INTERPOLATION_BLOCK_SIZE
+#define TS_INTERPOLATION_BLOCK_SIZE 16
+#endif
+
+/* The alignment (in bytes) of the buffers of splines and spline groups
+ * created with TS_ALIGNED (see tsLayoutFlag). Must be a power of two and a
+ * multiple of sizeof(tsReal). The default is the cache line size of x86
+ * and arm. */
+#ifndef TS_ALIGNMENT
+#define TS_ALIGNMENT 64
+#endif
+
+/**
+ * Marks a function as part of the public interface. The shared library is
+ * built with hidden symbol visibility (if supported by the compiler) so that
+ * only functions labeled with TINYSPLINE_API are exported. Internal functions
+ * ('ts_internal_*') do not leak into the dynamic symbol table and, thus, can
+ * be changed without breaking the ABI.
+ */
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define TINYSPLINE_API __attribute__ ((visibility ("default")))
+#else
+#define TINYSPLINE_API
+#endif
+
+/**
+ * The version of the binary interface of TinySpline. It is incremented
+ * whenever the layout of an exported data type or the signature/semantic of an
+ * exported function changes in an incompatible way. Foreign function
+ * interfaces (e.g., Rust or Julia) should compare this value with the return
+ * value of ::ts_abi_version to make sure that the loaded library matches the
+ * declarations they were generated from. The SOVERSION of the shared library
+ * is derived from this value.
+ */
+#define TINYSPLINE_ABI_VERSION 2
+
 
 
 /******************************************************************************
@@ -73,7 +119,25 @@ typedef enum
 	TS_NUM_KNOTS = -7,
 
 	/* Spline is not derivable */
-	TS_UNDERIVABLE = -8
+	TS_UNDERIVABLE = -8,
+
+	/* Buffer does not contain a valid serialized spline. */
+	TS_PARSE_ERROR = -9,
+
+	/* Buffer is too small to store the requested data. */
+	TS_BUFFER_SIZE = -10,
+
+	/* The dimension of the control points is not supported. */
+	TS_DIM_UNSUPPORTED = -11,
+
+	/* The first component of a spline is not monotone. */
+	TS_NOT_MONOTONE = -12,
+
+	/* Splines differ in degree, dimension, or knot vector. */
+	TS_INCOMPATIBLE = -13,
+
+	/* An index is out of range. */
+	TS_INDEX_ERROR = -14
 } tsError;
 
 /**
@@ -97,6 +161,53 @@ typedef enum
 	TS_BEZIERS = 3
 } tsBSplineType;
 
+/**
+ * Describes how the matrix passed to ::ts_bspline_transform is applied to
+ * the control points of a spline.
+ */
+typedef enum
+{
+	/* (dim+1)x(dim+1) matrix applied to (x, y, [z,] 1) for dim 2 and 3. The
+	 * last row of the matrix is ignored. */
+	TS_AFFINE = 0,
+
+	/* dim x dim matrix applied to the homogeneous coordinates of NURBS,
+	 * i.e., (x, y, w) for dim 3 and (x, y, z, w) for dim 4. */
+	TS_PROJECTIVE = 1
+} tsTransformType;
+
+/**
+ * Describes the alpha buffer written by ::ts_bspline_rasterize.
+ */
+typedef enum
+{
+	/* One unsigned char (0..255) per pixel. */
+	TS_ALPHA_UINT8 = 0,
+
+	/* One float (0..1) per pixel. */
+	TS_ALPHA_FLOAT = 1
+} tsAlphaType;
+
+/**
+ * Flags (combined with bitwise or) controlling the memory layout of a
+ * tsBSpline (see ::ts_bspline_new_layout) or a tsBSplineGroup (see
+ * ::ts_bspline_group_new).
+ */
+typedef enum
+{
+	/* Neither alignment nor padding. */
+	TS_PACKED = 0,
+
+	/* The buffer starts at a TS_ALIGNMENT byte boundary and is padded to
+	 * a multiple of TS_ALIGNMENT bytes, i.e., no two buffers share a cache
+	 * line. The knots of a spline start at the first aligned address
+	 * after its control points. Each row of lanes of a group (see
+	 * tsBSplineGroup) is padded to a multiple of TS_ALIGNMENT bytes.
+	 * Thus, every row, including the first row of the knots, starts at an
+	 * aligned address and can be loaded with aligned vector loads. */
+	TS_ALIGNED = 1
+} tsLayoutFlag;
+
 /**
  * Represents a B-Spline which may also be used for NURBS, Bezier curves,
  * lines, and points. NURBS are represented using homogeneous coordinates where
@@ -130,6 +241,8 @@ typedef enum
  *       memory is to be preferred anyway. If 'ctrlp' and 'knots' do not share
  *       the same array, or at least a consistent block of data, functions
  *       provided by TinySpline my fail because values are copied block wise.
+ *       Splines created with TS_ALIGNED (see 'flags') have padding between
+ *       'ctrlp' and 'knots'.
  */
 typedef struct
 {
@@ -153,6 +266,18 @@ typedef struct
 
 	/* Knot vector of a spline (ascending order). */
 	tsReal *knots;
+
+	/* tsLayoutFlag values of the buffer of 'ctrlp' and 'knots'. Splines
+	 * computed from a spline have its layout. */
+	int flags;
+
+	/* Incremented by each modification (see ts_bspline_set_ctrlp_range). */
+	size_t generation;
+
+	/* The knot intervals [dirty_first, dirty_last] modified since the dirty
+	 * range has been taken last. Empty if dirty_first > dirty_last. */
+	size_t dirty_first;
+	size_t dirty_last;
 } tsBSpline;
 
 /**
@@ -268,6 +393,318 @@ typedef struct
 	tsReal *result;
 } tsDeBoorNet;
 
+/**
+ * Represents a tensor-product B-Spline surface S(u, v) of degree \deg_u in
+ * u-direction and degree \deg_v in v-direction. Just like tsBSpline, NURBS
+ * surfaces are represented using homogeneous coordinates.
+ *
+ * The control points form a grid of \n_ctrlp_u rows and \n_ctrlp_v columns
+ * which is stored row by row, that is, the control point P_i,j (0 <= i <
+ * n_ctrlp_u, 0 <= j < n_ctrlp_v) starts at:
+ *
+ *     ctrlp[(i*n_ctrlp_v + j) * dim]
+ *
+ * Note: Similar to tsBSpline, the fields 'ctrlp', 'knots_u', and 'knots_v'
+ *       share the same array. That is, the first elements of this array
+ *       contain the control points, followed by the knots in u-direction and
+ *       the knots in v-direction. Accordingly, you should never free 'knots_u'
+ *       and 'knots_v' explicitly. Use ::ts_bsplinesurface_free instead.
+ */
+typedef struct
+{
+	/* Degree of the basis functions in u-direction. */
+	size_t deg_u;
+
+	/* Degree of the basis functions in v-direction. */
+	size_t deg_v;
+
+	/* A convenience field for deg_u+1. */
+	size_t order_u;
+
+	/* A convenience field for deg_v+1. */
+	size_t order_v;
+
+	/* Dimension of a control point. */
+	size_t dim;
+
+	/* Number of control points in u-direction (rows of the grid). */
+	size_t n_ctrlp_u;
+
+	/* Number of control points in v-direction (columns of the grid). */
+	size_t n_ctrlp_v;
+
+	/* Number of knots in u-direction (n_ctrlp_u + deg_u + 1). */
+	size_t n_knots_u;
+
+	/* Number of knots in v-direction (n_ctrlp_v + deg_v + 1). */
+	size_t n_knots_v;
+
+	/* Control points of a surface. */
+	tsReal *ctrlp;
+
+	/* Knot vector in u-direction (ascending order). */
+	tsReal *knots_u;
+
+	/* Knot vector in v-direction (ascending order). */
+	tsReal *knots_v;
+} tsBSplineSurface;
+
+/**
+ * Represents a trivariate tensor-product B-Spline volume V(u, v, w), e.g., a
+ * smooth 3D lookup table or vector field. The control points form a grid of
+ * \n_ctrlp_u x \n_ctrlp_v x \n_ctrlp_w points where the w-direction is stored
+ * contiguously, that is, the control point P_i,j,k starts at:
+ *
+ *     ctrlp[((i*n_ctrlp_v + j)*n_ctrlp_w + k) * dim]
+ *
+ * Note: Similar to tsBSpline, the fields 'ctrlp', 'knots_u', 'knots_v', and
+ *       'knots_w' share the same array. Use ::ts_bsplinevolume_free to free
+ *       dynamically allocated memory.
+ */
+typedef struct
+{
+	/* Degree of the basis functions in u-direction. */
+	size_t deg_u;
+
+	/* Degree of the basis functions in v-direction. */
+	size_t deg_v;
+
+	/* Degree of the basis functions in w-direction. */
+	size_t deg_w;
+
+	/* Dimension of a control point. */
+	size_t dim;
+
+	/* Number of control points in u-direction. */
+	size_t n_ctrlp_u;
+
+	/* Number of control points in v-direction. */
+	size_t n_ctrlp_v;
+
+	/* Number of control points in w-direction. */
+	size_t n_ctrlp_w;
+
+	/* Control points of a volume. */
+	tsReal *ctrlp;
+
+	/* Knot vector in u-direction (n_ctrlp_u + deg_u + 1 knots). */
+	tsReal *knots_u;
+
+	/* Knot vector in v-direction (n_ctrlp_v + deg_v + 1 knots). */
+	tsReal *knots_v;
+
+	/* Knot vector in w-direction (n_ctrlp_w + deg_w + 1 knots). */
+	tsReal *knots_w;
+} tsBSplineVolume;
+
+/**
+ * Precomputed bracketing data of a two-dimensional spline C(u) = (x(u), y(u))
+ * whose x-component is monotone, i.e., a spline describing a function y(x).
+ * Created with ::ts_bspline_lookup_new and used by ::ts_bspline_lookup and
+ * ::ts_bspline_lookup_many to find y for a given x without evaluating the
+ * spline at arbitrary knot values.
+ *
+ * Span i (0 <= i < n_spans) of the lookup covers the x-values
+ * [xs[i], xs[i+1]] and the knot values between us[i] and us[i+1], which lie
+ * within the knot interval [knots[spans[i]], knots[spans[i]+1]] of the
+ * spline. The x-values are always stored in increasing order. Thus, if x(u)
+ * is decreasing (see 'decreasing'), the spans are stored in reversed order.
+ */
+typedef struct
+{
+	/* Number of non-empty spans. */
+	size_t n_spans;
+
+	/* 1 if x(u) is decreasing, 0 otherwise. */
+	int decreasing;
+
+	/* x-values at the bounds of the spans (n_spans+1 values). */
+	tsReal *xs;
+
+	/* Knot values at the bounds of the spans (n_spans+1 values). */
+	tsReal *us;
+
+	/* Knot intervals of the spans (n_spans values). */
+	size_t *spans;
+} tsBSplineLookup;
+
+/**
+ * The state of a streaming polyline simplification (see
+ * ::ts_simplifier_push). Points are pushed one at a time and a subset of
+ * them is emitted such that each dropped point has a distance of at most
+ * 'tol' to the emitted polyline. Only the last emitted point (the anchor),
+ * the last pushed point, and the cone of directions a segment starting at
+ * the anchor may take are stored, i.e., the memory required by an open
+ * segment does not depend on the number of points it covers.
+ */
+typedef struct
+{
+	/* Dimension of the points. */
+	size_t dim;
+
+	/* Maximum distance of a dropped point to the emitted polyline. */
+	tsReal tol;
+
+	/* Number of points pushed since the last flush. */
+	size_t n_points;
+
+	/* Distance of the last pushed point to the anchor. */
+	tsReal radius;
+
+	/* Half opening angle of the cone (pi if the cone is not yet set). */
+	tsReal angle;
+
+	/* Last emitted point (dim values). */
+	tsReal *anchor;
+
+	/* Last pushed point (dim values). */
+	tsReal *last;
+
+	/* Unit axis of the cone (dim values). */
+	tsReal *axis;
+} tsSimplifier;
+
+/**
+ * A level-of-detail pyramid of a spline, created with ::ts_bspline_lod_new.
+ * Level 0 is a copy of the spline and each further level has fewer control
+ * points than its predecessor. The control points and knots of all levels
+ * are stored in a single block of memory (owned by the pyramid), i.e., the
+ * levels must not be freed with ::ts_bspline_free. Apart from that, they
+ * are regular splines sharing the degree and dimension of the original.
+ */
+typedef struct
+{
+	/* Number of levels. */
+	size_t n_levels;
+
+	/* Maximum deviation of each level from level 0 (n_levels values). */
+	tsReal *errors;
+
+	/* Levels from fine to coarse (n_levels values). */
+	tsBSpline *levels;
+} tsBSplineLOD;
+
+/**
+ * A tessellation of a spline into a polyline, created with
+ * ::ts_tessellation_new. Each non-empty knot interval contributes
+ * 'n_segments' uniformly spaced segments (starting at its lower bound), the
+ * last point is the end of the domain. Thus, the points of knot interval
+ * spans[i] are points[i*n_segments] to points[(i+1)*n_segments], and local
+ * edits of the spline can be patched into the polyline (see
+ * ::ts_tessellation_ctrlp_changed and ::ts_tessellation_knots_changed).
+ */
+typedef struct
+{
+	/* Degree of the tessellated spline. */
+	size_t deg;
+
+	/* Dimension of the tessellated spline. */
+	size_t dim;
+
+	/* Number of control points of the tessellated spline. */
+	size_t n_ctrlp;
+
+	/* Number of segments per knot interval. */
+	size_t n_segments;
+
+	/* Number of non-empty knot intervals. */
+	size_t n_spans;
+
+	/* Number of points (n_spans * n_segments + 1). */
+	size_t n_points;
+
+	/* Index of the first knot of each non-empty knot interval (n_spans
+	 * values). */
+	size_t *spans;
+
+	/* Points of the polyline (n_points * dim values). */
+	tsReal *points;
+} tsTessellation;
+
+/**
+ * A validated, immutable copy of a spline, created with ::ts_bspline_seal.
+ * Sealing validates the knot vector once and precomputes the reciprocals
+ * of the knot differences, inv[i*deg + j-1] = 1 / (knots[i+j] - knots[i])
+ * for 1 <= j <= deg (0 if the difference is 0 or i+j >= n_knots). Thus,
+ * sealed splines are evaluated without checking their knots and without
+ * divisions (see ::ts_sealed_bspline_evaluate_many). 'bspline' and 'inv'
+ * are stored in a single block of memory owned by the sealed spline, i.e.,
+ * 'bspline' must neither be modified nor be freed with ::ts_bspline_free.
+ */
+typedef struct
+{
+	/* Sealed copy (its generation is the one of the original at the time
+	 * of sealing). */
+	tsBSpline bspline;
+
+	/* Reciprocal knot differences (n_knots * deg values). */
+	tsReal *inv;
+
+	/* First non-empty knot interval of the domain. */
+	size_t first_span;
+
+	/* Last non-empty knot interval of the domain. */
+	size_t last_span;
+} tsSealedBSpline;
+
+/**
+ * A group of 'n_lanes' splines of equal degree, dimension, and number of
+ * control points packed in an AoSoA (array of structures of arrays) layout,
+ * created with ::ts_bspline_group_new. The value of a lane is stored next
+ * to the same value of the other lanes, i.e., coordinate d of control point
+ * i of lane w is ctrlp[(i*dim + d)*pitch + w] and knot i of lane w is
+ * knots[i*pitch + w]. Thus, all lanes are evaluated at once with SIMD
+ * instructions (see ::ts_bspline_group_evaluate). Typically, 'n_lanes' is
+ * the width of the vector registers, e.g., 8 or 16 floats. Without padding
+ * (see tsLayoutFlag), 'pitch' is 'n_lanes'. Padding lanes repeat the last
+ * lane. Similar to tsBSpline, 'ctrlp' and 'knots' share the same block of
+ * memory.
+ */
+typedef struct
+{
+	/* Degree of all lanes. */
+	size_t deg;
+
+	/* Order of all lanes (deg + 1). */
+	size_t order;
+
+	/* Dimension of all lanes. */
+	size_t dim;
+
+	/* Number of control points of each lane. */
+	size_t n_ctrlp;
+
+	/* Number of knots of each lane. */
+	size_t n_knots;
+
+	/* Number of packed splines. */
+	size_t n_lanes;
+
+	/* Number of values per row (>= n_lanes). */
+	size_t pitch;
+
+	/* tsLayoutFlag values of the layout. */
+	int flags;
+
+	/* Control points (n_ctrlp * dim * pitch values). */
+	tsReal *ctrlp;
+
+	/* Knots (n_knots * pitch values). */
+	tsReal *knots;
+} tsBSplineGroup;
+
+/**
+ * An integrand of ::ts_bspline_integrate. It is called with the knot value
+ * \u, the point C(u) (\dim values) and the first derivative C'(u) (\dim
+ * values) of the integrated spline, and the user data \ctx. Keep in mind
+ * that integrands may be called concurrently if TinySpline is compiled with
+ * OpenMP.
+ */
+typedef tsReal (*tsIntegrand)(
+	tsReal u, const tsReal *point, const tsReal *derivative, size_t dim,
+	void *ctx
+);
+
 
 
 /******************************************************************************
@@ -284,15 +721,16 @@ typedef struct
  *
  * All values of \bspline are set to 0/NULL.
  */
-void ts_bspline_default(tsBSpline *bspline);
+TINYSPLINE_API void ts_bspline_default(tsBSpline *bspline);
 
 /**
  * The copy constructor of tsBSpline.
  *
- * Creates a deep copy of \original and stores the result in \copy. This
- * function does not free already allocated memory in \copy. If you want to
- * reuse an instance of tsBSpline by using it in multiple calls of this
- * function, make sure to call ::ts_bspline_free beforehand.
+ * Creates a deep copy of \original (with the same layout, see tsLayoutFlag)
+ * and stores the result in \copy. This function does not free already
+ * allocated memory in \copy. If you want to reuse an instance of tsBSpline
+ * by using it in multiple calls of this function, make sure to call
+ * ::ts_bspline_free beforehand.
  *
  * On error all values of \copy are 0/NULL. The function does nothing if
  * \original == \result
@@ -300,7 +738,7 @@ void ts_bspline_default(tsBSpline *bspline);
  * @return TS_SUCCESS           on success.
  * @return TS_MALLOC            if allocating memory failed.
  */
-tsError ts_bspline_copy(
+TINYSPLINE_API tsError ts_bspline_copy(
 	const tsBSpline *original,
 	tsBSpline *copy
 );
@@ -311,7 +749,7 @@ tsError ts_bspline_copy(
  * Moves all values from \from to \to and calls ::ts_bspline_default on \from
  * afterwards. Does nothing if \from == \to.
  */
-void ts_bspline_move(tsBSpline *from, tsBSpline *to);
+TINYSPLINE_API void ts_bspline_move(tsBSpline *from, tsBSpline *to);
 
 /**
  * A convenient constructor for tsBSpline.
@@ -328,11 +766,32 @@ void ts_bspline_move(tsBSpline *from, tsBSpline *to);
  * @return TS_NUM_KNOTS        if \type == TS_BEZIERS and \n_ctrlp % \deg+1 != 0
  * @return TS_MALLOC           if allocating memory failed.
  */
-tsError ts_bspline_new(
+TINYSPLINE_API tsError ts_bspline_new(
 	size_t n_ctrlp, size_t dim, size_t deg, tsBSplineType type,
 	tsBSpline *bspline
 );
 
+/**
+ * Like ::ts_bspline_new, but the buffer of \bspline is laid out according
+ * to \flags (see tsLayoutFlag), which is stored in \bspline->flags. With
+ * TS_ALIGNED, \bspline->ctrlp and \bspline->knots start at TS_ALIGNMENT
+ * byte boundaries. The layout is kept by all functions modifying
+ * \bspline and passed on to copies and to splines computed from
+ * \bspline. ::ts_bspline_free releases the buffer accordingly.
+ *
+ * On error all values of \bspline are 0/NULL.
+ *
+ * @return TS_SUCCESS          on success.
+ * @return TS_DIM_ZERO         if \deg == 0.
+ * @return TS_DEG_GE_NCTRLP    if \deg >= \n_ctrlp.
+ * @return TS_NUM_KNOTS        if \type == TS_BEZIERS and \n_ctrlp % \deg+1 != 0
+ * @return TS_MALLOC           if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_new_layout(
+	size_t n_ctrlp, size_t dim, size_t deg, tsBSplineType type, int flags,
+	tsBSpline *bspline
+);
+
 /**
  * Performs a cubic spline interpolation using thomas algorithm.
  * https://en.wikipedia.org/wiki/Tridiagonal_matrix_algorithm
@@ -356,7 +815,7 @@ tsError ts_bspline_new(
  * @return TS_DEG_GE_NCTRLP     if \n < 2.
  * @return TS_MALLOC            if allocating memory failed.
  */
-tsError ts_bspline_interpolate_cubic(
+TINYSPLINE_API tsError ts_bspline_interpolate_cubic(
 	const tsReal *points, size_t n, size_t dim,
 	tsBSpline *bspline
 );
@@ -367,14 +826,14 @@ tsError ts_bspline_interpolate_cubic(
  * Frees all dynamically allocated memory and calls ::ts_deboornet_free
  * afterwards.
  */
-void ts_bspline_free(tsBSpline *bspline);
+TINYSPLINE_API void ts_bspline_free(tsBSpline *bspline);
 
 /**
  * The default constructor of tsDeBoorNet.
  *
  * All values of \deBoorNet are set to 0/NULL.
  */
-void ts_deboornet_default(tsDeBoorNet *deBoorNet);
+TINYSPLINE_API void ts_deboornet_default(tsDeBoorNet *deBoorNet);
 
 /**
  * The copy constructor of tsDeBoorNet.
@@ -390,7 +849,7 @@ void ts_deboornet_default(tsDeBoorNet *deBoorNet);
  * @return TS_SUCCESS           on success.
  * @return TS_MALLOC            if allocating memory failed.
  */
-tsError ts_deboornet_copy(
+TINYSPLINE_API tsError ts_deboornet_copy(
 	const tsDeBoorNet *original,
 	tsDeBoorNet *copy
 );
@@ -401,7 +860,7 @@ tsError ts_deboornet_copy(
  * Moves all values from \from to \to and calls ::ts_deboornet_default on
  * \from afterwards. Does nothing if \from == \to.
  */
-void ts_deboornet_move(tsDeBoorNet *from, tsDeBoorNet *to);
+TINYSPLINE_API void ts_deboornet_move(tsDeBoorNet *from, tsDeBoorNet *to);
 
 /**
  * Evaluates \bspline at knot value \u and stores result in \deBoorNet.
@@ -417,7 +876,7 @@ void ts_deboornet_move(tsDeBoorNet *from, tsDeBoorNet *to);
  * @return TS_MULTIPLICITY      if multiplicity of \u > order of \bspline.
  * @return TS_U_UNDEFINED       if \bspline is not defined at \u.
  */
-tsError ts_bspline_evaluate(
+TINYSPLINE_API tsError ts_bspline_evaluate(
 	const tsBSpline *bspline, tsReal u,
 	tsDeBoorNet *deBoorNet
 );
@@ -428,7 +887,7 @@ tsError ts_bspline_evaluate(
  * Frees all dynamically allocated memory and calls ::ts_deboornet_default
  * afterwards.
  */
-void ts_deboornet_free(tsDeBoorNet *deBoorNet);
+TINYSPLINE_API void ts_deboornet_free(tsDeBoorNet *deBoorNet);
 
 
 
@@ -525,115 +984,446 @@ void ts_deboornet_free(tsDeBoorNet *deBoorNet);
  *                              \original. NOTE: This will be fixed in the
  *                              future.
  */
-tsError ts_bspline_derive(
+TINYSPLINE_API tsError ts_bspline_derive(
 	const tsBSpline *original,
 	tsBSpline *derivative
 );
 
 /**
- * Creates a deep copy of \bspline (only if \bspline != \result) and copies the
- * first bspline->n_ctrlp * bspline->dim control points from \ctrlp to \result
- * using memmove. The behaviour of this function is undefined if the length of
- * \ctrlp is less than bspline->n_ctrlp * bspline->dim.
+ * Computes the integral (antiderivative) of \original, i.e., the inverse of
+ * ::ts_bspline_derive.
+ *
+ * The integral of a spline \original of degree \original->deg with
+ * \original->n_ctrlp control points and \original->n_knots knots is another
+ * spline of degree \original->deg+1 with \original->n_ctrlp+1 control points
+ * and \original->n_knots+2 knots (the first and the last knot of \original
+ * are repeated once more). Its control points are the cumulative sums
+ * Q_0 = 0, Q_{i+1} = Q_i + P_i * (u_{i+p+1}-u_{i}) / (p+1)
+ * followed by a shift such that the integral is 0 at the lower bound of the
+ * domain of \original. Thus, the definite integral of \original over
+ * [u_a, u_b] is I(u_b) - I(u_a), i.e., two evaluations, after computing I in
+ * O(n).
+ *
+ * This function does not free already allocated memory in \integral.
+ * If you want to reuse an instance of tsBSpline by using it in multiple
+ * calls of this function, make sure to call ::ts_bspline_free beforehand.
+ * \original may be \integral.
  *
- * On error (and if \bspline != \result) all values of \result are 0/NULL.
+ * On error all values of \integral are 0/NULL (unless \original is
+ * \integral, in which case it is not modified).
  *
  * @return TS_SUCCESS           on success.
- * @return TS_MALLOC            if \bspline != \result and allocating
- *                              memory failed.
+ * @return TS_MALLOC            if allocating memory failed.
  */
-tsError ts_bspline_set_ctrlp(
-	const tsBSpline *bspline, const tsReal *ctrlp,
-	tsBSpline *result
+TINYSPLINE_API tsError ts_bspline_integral(
+	const tsBSpline *original,
+	tsBSpline *integral
 );
 
 /**
- * Creates a deep copy of \bspline (only if \bspline != \result) and copies the
- * the first bspline->n_knots from \knots to \result using memmove. The
- * behaviour of this function is undefined if the length of \knots is less than
- * bspline->n_knots.
+ * Computes the sum \a + \b and stores the result in \sum.
  *
- * On error (and if \bspline != \result) all values of \result are 0/NULL.
+ * If \a and \b have the same degree and knot vector (knots are compared
+ * exactly, not with ::ts_fequals), the control points of \sum are the sums
+ * of the control points of \a and \b (a single pass over the control
+ * points without allocating memory if \sum is \a or \b). Otherwise, \a
+ * and \b are added on the intersection of their domains as described in
+ * ::ts_bspline_function_add, i.e., the degree of \sum is the maximum of the
+ * degrees of \a and \b and its knot vector has full multiplicity at the
+ * union of the breakpoints of \a and \b. Either way, the result is exact.
+ *
+ * If the dimensions of \a and \b differ, one of them must be 1. Its values
+ * are added to each component of the other spline. \sum may be \a or \b.
+ *
+ * On error all values of \sum are 0/NULL (unless \sum is \a or \b, in
+ * which case it is not modified).
  *
  * @return TS_SUCCESS           on success.
- * @return TS_MALLOC            if \bspline != \result and allocating
- *                              memory failed.
+ * @return TS_DIM_UNSUPPORTED   if the dimensions of \a and \b differ and
+ *                              none of them is 1.
+ * @return TS_U_UNDEFINED       if the domains of \a and \b do not overlap.
+ * @return TS_MALLOC            if allocating memory failed.
  */
-tsError ts_bspline_set_knots(
-	const tsBSpline *bspline, const tsReal *knots,
-	tsBSpline *result
+TINYSPLINE_API tsError ts_bspline_add(
+	const tsBSpline *a, const tsBSpline *b,
+	tsBSpline *sum
 );
 
 /**
- * Fills the knot vector of \original according to \type with minimum knot
- * value \min to maximum knot value \max and stores the result in \result.
- *
- * This function creates a deep copy of \original, if \original != \result.
+ * Multiplies each component of each control point of \original with \s and
+ * stores the result in \scaled. Note that for NURBS, the weights are scaled
+ * as well. \original may be \scaled.
  *
- * On error all values of \result are 0/NULL.
+ * On error all values of \scaled are 0/NULL (unless \original is
+ * \scaled, in which case it is not modified).
  *
  * @return TS_SUCCESS           on success.
- * @return TS_MALLOC            if \original != \result and allocating
- *                              memory failed.
- * @return TS_DEG_GE_NCTRLP     if \original->n_knots < 2*(\original->deg+1).
- * (We can reuse the error code TS_DEG_GE_NCTRLP because n_knots < 2*(deg+1)
- * implies deg >= n_ctrlp. Furthermore, using TS_DEG_GE_NCTRLP instead of
- * TS_NUM_KNOTS ensures that TS_NUM_KNOTS is not used twice for this function.
- * To be more fail-safe, \original->deg+1 instead of \original->order is used,
- * to make sure that \original->deg+1 >= 1)
- *
- * @return TS_NUM_KNOTS         if \type == TS_BEZIERS and n_knots % order != 0
- * @return TS_KNOTS_DECR        if \min >= \max.
- * (The function uses ::ts_fequals in order to determine if \min == \max)
+ * @return TS_MALLOC            if allocating memory failed.
  */
-tsError ts_bspline_fill_knots(
-	const tsBSpline *original, tsBSplineType type, tsReal min, tsReal max,
-	tsBSpline *result
+TINYSPLINE_API tsError ts_bspline_scale(
+	const tsBSpline *original, tsReal s,
+	tsBSpline *scaled
 );
 
-tsError ts_bspline_insert_knot(
-	const tsBSpline *bspline, tsReal u, size_t n,
-	tsBSpline *result, size_t *k
+/**
+ * Computes the product \a * \b on the intersection of the domains of \a
+ * and \b as described in ::ts_bspline_function_multiply and stores the
+ * result in \product. The degree of \product is the sum of the degrees of
+ * \a and \b. Products are computed componentwise. If the dimensions of \a
+ * and \b differ, one of them must be 1 (e.g., a gain function that scales
+ * all components of the other spline). \product may be \a or \b.
+ *
+ * On error all values of \product are 0/NULL (unless \product is \a or
+ * \b, in which case it is not modified).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimensions of \a and \b differ and
+ *                              none of them is 1.
+ * @return TS_U_UNDEFINED       if the domains of \a and \b do not overlap.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_multiply(
+	const tsBSpline *a, const tsBSpline *b,
+	tsBSpline *product
 );
 
 /**
- * Resizes \bspline by \n (number of control points) and stores the result in
- * \resized. If \back != 0 the resulting splines is resized at the end. If
- * \back == 0 the resulting spline is resized at the front.
+ * Transforms the control points of \original with the row-major matrix
+ * \matrix and stores the result in \transformed. Since splines are affine
+ * invariant, transforming the control points transforms the whole curve.
  *
- * Resizing a spline at the end is usually faster, because the current values
- * don't need to be copied.
+ * If \type is TS_AFFINE, \original must have dimension 2 or 3 and \matrix
+ * must be a 3x3 or 4x4 matrix, respectively. If \type is TS_PROJECTIVE,
+ * \original must be a NURBS in homogeneous coordinates with dimension 3 or
+ * 4 and \matrix must be a 3x3 or 4x4 matrix, respectively. As NURBS are
+ * invariant under projective transformations, the result is exact (e.g.,
+ * perspective projections of NURBS).
  *
- * This function creates a deep copy of \bspline, if \bspline != \resized.
+ * The control points are transformed in a single pass. \original may be
+ * \transformed, in which case no memory is allocated.
  *
- * On error (and if \bspline != \resized) all values of \resized are 0/NULL.
+ * On error all values of \transformed are 0/NULL (unless \original is
+ * \transformed, in which case it is not modified).
  *
  * @return TS_SUCCESS           on success.
- * @return TS_DEG_GE_NCTRLP     if the degree of \resized would be >= the number
- *                              of the control points of \resized.
- * @return TS_OVER_UNDERFLOW    if adding \n to the current length of the
- *                              control point/knot array would cause a
- *                              over/underflow.
- * @return TS_MALLOC            if (re)allocating memory failed.
- *
- * if \bspline != \resized:
- *      @return TS_DIM_ZERO         if the degree of \bspline == 0.
- *      @return TS_DEG_GE_NCTRLP    if the degree of \bspline >= the number of
- *                                  the control points of \bspline.
- *      @return TS_MALLOC           if allocating memory failed.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \original does not match
+ *                              \type or if \type is not a value of
+ *                              tsTransformType.
+ * @return TS_MALLOC            if allocating memory failed.
  */
-tsError ts_bspline_resize(
-	const tsBSpline *bspline, int n, int back,
-	tsBSpline *resized
-);
-
-tsError ts_bspline_split(
-	const tsBSpline *bspline, tsReal u,
-	tsBSpline *split, size_t *k
+TINYSPLINE_API tsError ts_bspline_transform(
+	const tsBSpline *original, const tsReal *matrix, tsTransformType type,
+	tsBSpline *transformed
 );
 
 /**
- * Buckles \original by \b and stores the result in \buckled.
+ * Transforms the \n_splines splines \splines with ::ts_bspline_transform
+ * and stores the results in \transformed (an array of \n_splines splines).
+ * \transformed may be \splines. If OpenMP is enabled, the splines are
+ * transformed in parallel. As the size of \matrix depends on the
+ * dimension, all splines must have the same dimension.
+ *
+ * If the dimensions differ, no spline is transformed and all values of
+ * \transformed are 0/NULL (unless \transformed is \splines, in which case
+ * the splines are not modified). On any other error, the splines that
+ * could not be transformed are handled as described in
+ * ::ts_bspline_transform. All other splines are transformed nevertheless.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INCOMPATIBLE      if the splines differ in dimension.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of the splines does not
+ *                              match \type or if \type is not a value of
+ *                              tsTransformType.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_transform_many(
+	const tsBSpline *splines, size_t n_splines, const tsReal *matrix,
+	tsTransformType type,
+	tsBSpline *transformed
+);
+
+/**
+ * Approximates the offset curve of the planar spline \bspline at distance
+ * \d, i.e., C(u) + \d * N(u) where N is the left unit normal (the tangent
+ * rotated by 90 degrees counterclockwise), and stores the result in
+ * \offset. Negative distances offset to the right.
+ *
+ * Each knot interval of \bspline is approximated with cubic Hermite pieces
+ * whose derivatives are computed from the hodograph (O' = (1 - d*k) * C',
+ * where k is the signed curvature). A piece is bisected until its distance
+ * to the exact offset is at most \tol at the sampled positions (or a
+ * maximum depth is reached). If OpenMP is enabled, long splines are fitted
+ * in parallel. Gaps at tangent discontinuities are closed with circular
+ * arcs around the corner. Finally, loops running opposite to the side of
+ * the offset (e.g., at concave corners or where the radius of curvature is
+ * less than |\d|) are cut off at their self-intersections. If, instead, the
+ * part outside of a self-intersection is the shorter one (e.g., the ends
+ * of a closed curve crossing each other), the ends are cut off.
+ *
+ * \offset is a sequence of cubic Bezier curves (see ::ts_bspline_to_beziers)
+ * with uniformly spaced knots in [0, 1]. Its end points are not connected
+ * for closed curves (unless they were cut off at their intersection). The
+ * error is measured in the precision of tsReal, i.e., \tol is at least a
+ * few ulps of the magnitude of the coordinates. \bspline may be \offset.
+ *
+ * On error all values of \offset are 0/NULL (unless \bspline is \offset,
+ * in which case it is not modified).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \bspline is not 2.
+ * @return TS_UNDERIVABLE       if the degree of \bspline is 0.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_offset(
+	const tsBSpline *bspline, tsReal d, tsReal tol,
+	tsBSpline *offset
+);
+
+/**
+ * Finds the self-intersections of the planar spline \bspline and stores
+ * them as pairs of knots (u, v), u < v, with C(u) = C(v) in \us, sorted by
+ * u. \n is set to the number of pairs, i.e., \us has 2 * \n values. The
+ * caller has to free \us (it is NULL if there are no intersections).
+ *
+ * The spline is decomposed into its Bezier pieces (one per knot interval).
+ * Pairs of pieces with overlapping bounding boxes are found by sorting the
+ * boxes along the axis in which the spline extends the most (sweep and
+ * prune) and are intersected with Bezier clipping until both parts are
+ * smaller than \tol. Parts closer than \tol are considered to intersect,
+ * i.e., \tol should exceed the rounding errors of the control points.
+ * Joints of neighbouring pieces (including the closing joint of closed
+ * splines) are not reported; neighbouring pieces and single pieces are
+ * only examined if their control polygons turn by more than pi.
+ *
+ * On error \us is NULL and \n is 0.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \bspline is not 2.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_self_intersections(
+	const tsBSpline *bspline, tsReal tol,
+	tsReal **us, size_t *n
+);
+
+/**
+ * Rasterizes the signed distance field of the planar splines \splines
+ * (\n_splines many) into \grid, a row-major grid of \width * \height cells
+ * of size \cell. The center of cell (r, c) is at \origin + ((c + 0.5) *
+ * \cell, (r + 0.5) * \cell). Distances are clamped to [-\band, \band] and
+ * are negative inside of the splines, where each spline is closed with a
+ * line from its end to its start and the even-odd rule is applied to all
+ * of them.
+ *
+ * The splines are tessellated adaptively (until their segments are within
+ * a fraction of \cell) and the segments are binned into square tiles,
+ * expanded by \band. The distance of each cell to the closest segment of
+ * its tile is refined with Newton's method against the spline. If OpenMP
+ * is enabled, large grids are processed in parallel (one tile at a time).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of a spline is not 2.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_distance_field(
+	const tsBSpline *splines, size_t n_splines, const tsReal *origin,
+	tsReal cell, size_t width, size_t height, tsReal band,
+	float *grid
+);
+
+/**
+ * Rasterizes the anti-aliased coverage of the closed outlines \outlines
+ * (\n_outlines planar splines, e.g., the contours of a glyph) into
+ * \alpha, a row-major buffer of \width * \height pixels of size \cell
+ * whose format is given by \type. Pixel (r, c) covers the square at
+ * \origin + (c * \cell, r * \cell). Each outline is closed with a line
+ * from its end to its start.
+ *
+ * The Bezier pieces of the outlines are flattened adaptively into an edge
+ * list, whose edges accumulate their exact signed area per pixel row.
+ * Only the modified columns of a row are summed up. The coverage is the
+ * absolute value of the sum, clamped to 1, i.e., holes have to be oriented
+ * opposite to their enclosing outline and overlapping outlines of the same
+ * orientation are merged (nonzero rule).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of an outline is not 2.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_rasterize(
+	const tsBSpline *outlines, size_t n_outlines, const tsReal *origin,
+	tsReal cell, size_t width, size_t height, tsAlphaType type,
+	void *alpha
+);
+
+/**
+ * Creates a deep copy of \bspline (only if \bspline != \result) and copies the
+ * first bspline->n_ctrlp * bspline->dim control points from \ctrlp to \result
+ * using memmove. The behaviour of this function is undefined if the length of
+ * \ctrlp is less than bspline->n_ctrlp * bspline->dim.
+ *
+ * On error (and if \bspline != \result) all values of \result are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if \bspline != \result and allocating
+ *                              memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_set_ctrlp(
+	const tsBSpline *bspline, const tsReal *ctrlp,
+	tsBSpline *result
+);
+
+/**
+ * Creates a deep copy of \bspline (only if \bspline != \result) and copies the
+ * the first bspline->n_knots from \knots to \result using memmove. The
+ * behaviour of this function is undefined if the length of \knots is less than
+ * bspline->n_knots.
+ *
+ * On error (and if \bspline != \result) all values of \result are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if \bspline != \result and allocating
+ *                              memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_set_knots(
+	const tsBSpline *bspline, const tsReal *knots,
+	tsBSpline *result
+);
+
+/**
+ * Copies the \count control points \values to the control points of
+ * \bspline starting at index \first. In contrast to ::ts_bspline_set_ctrlp,
+ * \bspline is modified in place and nothing is allocated. Increments the
+ * generation counter of \bspline and adds the knot intervals affected by
+ * the modified control points, [first, first+count-1+deg], to its dirty
+ * range (see ::ts_bspline_take_dirty). Nothing happens if \count == 0.
+ *
+ * On error \bspline is not modified.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INDEX_ERROR       if \first + \count > \bspline->n_ctrlp.
+ */
+TINYSPLINE_API tsError ts_bspline_set_ctrlp_range(
+	tsBSpline *bspline, size_t first, size_t count,
+	const tsReal *values
+);
+
+/**
+ * Sets the knot of \bspline at index \index to \value in place.
+ * Increments the generation counter of \bspline and adds the knot intervals
+ * affected by the modified knot, [index-deg-1, index+deg], to its dirty
+ * range (see ::ts_bspline_take_dirty).
+ *
+ * On error \bspline is not modified.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INDEX_ERROR       if \index >= \bspline->n_knots.
+ * @return TS_KNOTS_DECR        if \value is less than the previous or
+ *                              greater than the next knot.
+ * @return TS_MULTIPLICITY      if the multiplicity of \value would exceed
+ *                              the order of \bspline.
+ */
+TINYSPLINE_API tsError ts_bspline_set_knot(
+	tsBSpline *bspline, size_t index, tsReal value
+);
+
+/**
+ * Returns the number of knot intervals within the dirty range of \bspline
+ * and stores the first one in \first (0 if the range is empty). The dirty
+ * range accumulates the knot intervals of the domain that have been
+ * modified by ::ts_bspline_set_ctrlp_range and ::ts_bspline_set_knot
+ * (::ts_bspline_set_ctrlp and ::ts_bspline_set_knots mark the whole
+ * domain) since the range has been taken last. Functions computing a spline
+ * from other splines (e.g., ::ts_bspline_transform or
+ * ::ts_bspline_insert_knot), whether in place or not, mark the whole domain
+ * of their result and set its generation counter to the one following the
+ * generation counters of their input.
+ */
+TINYSPLINE_API size_t ts_bspline_dirty(
+	const tsBSpline *bspline, size_t *first
+);
+
+/**
+ * Like ::ts_bspline_dirty, but clears the dirty range of \bspline
+ * afterwards. Observers (e.g., ::ts_tessellation_update) only query the
+ * dirty range, i.e., multiple observers of \bspline can patch their state
+ * with the same range. The owner of \bspline takes the range once all
+ * observers have been updated.
+ */
+TINYSPLINE_API size_t ts_bspline_take_dirty(
+	tsBSpline *bspline, size_t *first
+);
+
+/**
+ * Fills the knot vector of \original according to \type with minimum knot
+ * value \min to maximum knot value \max and stores the result in \result.
+ *
+ * This function creates a deep copy of \original, if \original != \result.
+ *
+ * On error all values of \result are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if \original != \result and allocating
+ *                              memory failed.
+ * @return TS_DEG_GE_NCTRLP     if \original->n_knots < 2*(\original->deg+1).
+ * (We can reuse the error code TS_DEG_GE_NCTRLP because n_knots < 2*(deg+1)
+ * implies deg >= n_ctrlp. Furthermore, using TS_DEG_GE_NCTRLP instead of
+ * TS_NUM_KNOTS ensures that TS_NUM_KNOTS is not used twice for this function.
+ * To be more fail-safe, \original->deg+1 instead of \original->order is used,
+ * to make sure that \original->deg+1 >= 1)
+ *
+ * @return TS_NUM_KNOTS         if \type == TS_BEZIERS and n_knots % order != 0
+ * @return TS_KNOTS_DECR        if \min >= \max.
+ * (The function uses ::ts_fequals in order to determine if \min == \max)
+ */
+TINYSPLINE_API tsError ts_bspline_fill_knots(
+	const tsBSpline *original, tsBSplineType type, tsReal min, tsReal max,
+	tsBSpline *result
+);
+
+TINYSPLINE_API tsError ts_bspline_insert_knot(
+	const tsBSpline *bspline, tsReal u, size_t n,
+	tsBSpline *result, size_t *k
+);
+
+/**
+ * Resizes \bspline by \n (number of control points) and stores the result in
+ * \resized. If \back != 0 the resulting splines is resized at the end. If
+ * \back == 0 the resulting spline is resized at the front.
+ *
+ * Resizing a spline at the end is usually faster, because the current values
+ * don't need to be copied.
+ *
+ * This function creates a deep copy of \bspline, if \bspline != \resized.
+ *
+ * On error (and if \bspline != \resized) all values of \resized are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DEG_GE_NCTRLP     if the degree of \resized would be >= the number
+ *                              of the control points of \resized.
+ * @return TS_OVER_UNDERFLOW    if adding \n to the current length of the
+ *                              control point/knot array would cause a
+ *                              over/underflow.
+ * @return TS_MALLOC            if (re)allocating memory failed.
+ *
+ * if \bspline != \resized:
+ *      @return TS_DIM_ZERO         if the degree of \bspline == 0.
+ *      @return TS_DEG_GE_NCTRLP    if the degree of \bspline >= the number of
+ *                                  the control points of \bspline.
+ *      @return TS_MALLOC           if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_resize(
+	const tsBSpline *bspline, int n, int back,
+	tsBSpline *resized
+);
+
+TINYSPLINE_API tsError ts_bspline_split(
+	const tsBSpline *bspline, tsReal u,
+	tsBSpline *split, size_t *k
+);
+
+/**
+ * Buckles \original by \b and stores the result in \buckled.
  *
  * This function is based on:
  *      Holten, Danny. "Hierarchical edge bundles: Visualization of adjacency
@@ -648,6 +1438,9 @@ tsError ts_bspline_split(
  *
  * This function creates a deep copy of \original, if \original != \buckled
  * and will never fail if \original == \buckled (always returns TS_SUCCESS).
+ * In the latter case, the control points are blended in place in a single
+ * pass without allocating memory, i.e., buckling can be animated cheaply.
+ * The first and the last control point are never modified.
  *
  * On error all values of \buckled are 0/NULL.
  *
@@ -655,18 +1448,1223 @@ tsError ts_bspline_split(
  * @return TS_MALLOC            if \original != \buckled and allocating
  *                              memory failed.
  */
-tsError ts_bspline_buckle(
+TINYSPLINE_API tsError ts_bspline_buckle(
 	const tsBSpline *original, tsReal b,
 	tsBSpline *buckled
 );
 
-tsError ts_bspline_to_beziers(
+/**
+ * Linearly interpolates the control points of \a and \b, i.e.,
+ * (1-\t) * \a + \t * \b, and stores the result in \lerped. Since the knot
+ * vectors of \a and \b must be equal, the result is the pointwise
+ * interpolation of both splines, which can be used for morph animations.
+ * Usually the range of \t is: 0 <= \t <= 1, where 0 results in \a and 1 in
+ * \b. \lerped may be \a or \b, in which case no memory is allocated.
+ *
+ * On error all values of \lerped are 0/NULL (unless \lerped is \a or \b,
+ * in which case it is not modified).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INCOMPATIBLE      if \a and \b differ in degree, dimension,
+ *                              number of control points, or knot values.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_lerp(
+	const tsBSpline *a, const tsBSpline *b, tsReal t,
+	tsBSpline *lerped
+);
+
+TINYSPLINE_API tsError ts_bspline_to_beziers(
 	const tsBSpline *bspline,
 	tsBSpline *beziers
 );
 
 
 
+/******************************************************************************
+*                                                                             *
+* Batch Functions                                                             *
+*                                                                             *
+* The following section contains functions designed for high-throughput      *
+* processing and foreign function interfaces (FFI). All of them take plain    *
+* pointer/length arguments, write their results into caller-provided buffers *
+* and never allocate memory that must be freed by the caller. A tsBSpline is  *
+* a plain struct and serves as handle: create it with one of the              *
+* constructors above (or ::ts_bspline_deserialize) and release it with        *
+* ::ts_bspline_free.                                                          *
+*                                                                             *
+* The functions of this section are part of the versioned binary interface   *
+* (see TINYSPLINE_ABI_VERSION).                                               *
+*                                                                             *
+******************************************************************************/
+/**
+ * Returns the value of TINYSPLINE_ABI_VERSION the library has been compiled
+ * with.
+ */
+TINYSPLINE_API unsigned int ts_abi_version(void);
+
+/**
+ * Stores the domain [\min, \max] of \bspline, that is, the range of knot
+ * values \bspline is defined at.
+ */
+TINYSPLINE_API void ts_bspline_domain(
+	const tsBSpline *bspline,
+	tsReal *min, tsReal *max
+);
+
+/**
+ * Evaluates \bspline at the \n knot values in \us and stores the resulting
+ * points in \points. The length of \points must be at least \n *
+ * \bspline->dim. In contrast to ::ts_bspline_evaluate, no de Boor net is
+ * created. Instead, each point is evaluated in place using a single scratch
+ * buffer of \bspline->order points. If \bspline is discontinuous at a given
+ * knot value, the point stored in \points is equal to 'result' of the
+ * corresponding de Boor net.
+ *
+ * On error the content of \points is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ * @return TS_MULTIPLICITY      if multiplicity of a value of \us > order of
+ *                              \bspline.
+ * @return TS_U_UNDEFINED       if \bspline is not defined at a value of \us.
+ */
+TINYSPLINE_API tsError ts_bspline_evaluate_many(
+	const tsBSpline *bspline, const tsReal *us, size_t n,
+	tsReal *points
+);
+
+/**
+ * Tessellates \bspline by evaluating \n uniformly distributed knot values of
+ * its domain (including both bounds) and stores the resulting points in
+ * \points. The length of \points must be at least \n * \bspline->dim. If
+ * \n == 1, the lower bound of the domain is evaluated.
+ *
+ * On error the content of \points is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_sample(
+	const tsBSpline *bspline, size_t n,
+	tsReal *points
+);
+
+/**
+ * Tessellates \bspline like ::ts_bspline_sample, but passes the \n points
+ * through a simplifier (see ::ts_simplifier_push) with tolerance \tol
+ * instead of storing them. Thus, the dense tessellation is never
+ * materialized. The first and last sample are always part of the result.
+ * At most \max points are stored in \points (whose length must be at least
+ * \max * \bspline->dim) and \n_out is set to the number of points of the
+ * simplified polyline, which may exceed \max.
+ *
+ * On error the content of \points and \n_out is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_BUFFER_SIZE       if \n_out > \max. The first \max points are
+ *                              stored nonetheless.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_sample_simplified(
+	const tsBSpline *bspline, size_t n, tsReal tol,
+	tsReal *points, size_t max, size_t *n_out
+);
+
+/**
+ * Returns the number of bytes required by ::ts_bspline_serialize to store
+ * \bspline.
+ */
+TINYSPLINE_API size_t ts_bspline_serialized_size(const tsBSpline *bspline);
+
+/**
+ * Serializes \bspline into \buf which has a length of \len bytes. The layout
+ * of the resulting data is:
+ *
+ *     offset  size  content
+ *          0     4  magic number 'T', 'S', 'B', 'S'
+ *          4     4  TINYSPLINE_ABI_VERSION
+ *          8     4  sizeof(tsReal)
+ *         12     4  deg
+ *         16     4  dim
+ *         20     4  n_ctrlp
+ *         24     *  n_ctrlp*dim control points followed by n_knots knots
+ *
+ * All integers are unsigned and stored in little endian byte order. Control
+ * points and knots are stored as raw tsReal values in the byte order of the
+ * host.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_PARSE_ERROR       if the degree, dimension, or number of
+ *                              control points of \bspline does not fit
+ *                              into 32 bits.
+ * @return TS_BUFFER_SIZE       if \len < ::ts_bspline_serialized_size.
+ */
+TINYSPLINE_API tsError ts_bspline_serialize(
+	const tsBSpline *bspline,
+	unsigned char *buf, size_t len
+);
+
+/**
+ * Creates a new spline from the serialized data in \buf (see
+ * ::ts_bspline_serialize) which has a length of \len bytes.
+ *
+ * This function does not free already allocated memory in \bspline. On error
+ * all values of \bspline are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_PARSE_ERROR       if \buf does not start with a valid header,
+ *                              was created with a different precision, or
+ *                              its header describes more data than can be
+ *                              addressed.
+ * @return TS_BUFFER_SIZE       if \len is less than the length given by the
+ *                              header of \buf.
+ * @return TS_DIM_ZERO          if the serialized dimension is 0.
+ * @return TS_DEG_GE_NCTRLP     if the serialized degree >= number of control
+ *                              points.
+ * @return TS_KNOTS_DECR        if the serialized knot vector is decreasing.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_deserialize(
+	const unsigned char *buf, size_t len,
+	tsBSpline *bspline
+);
+
+/**
+ * Sweeps the 2D cross-section \profile (\n_profile points [x_0, y_0, x_1,
+ * ...]) along \bspline and stores the resulting mesh in \vertices and
+ * \indices. A tube is swept with a circle, a ribbon with a line segment.
+ *
+ * The \n rings are placed adaptively: the domain of \bspline is distributed
+ * such that arc length and turning angle (of the tangent) between two
+ * consecutive rings are equal parts of the total arc length and total
+ * turning angle respectively. Thus, straight sections get fewer rings than
+ * bends. The rings are oriented by rotation-minimizing frames (t, r, s)
+ * computed with the double reflection method (Wang et al., 2008), i.e., the
+ * tube does not twist. The k-th point of the profile is placed at
+ * C(u) + x_k*r + y_k*s. Splines with \dim < 3 are embedded into the xy-plane;
+ * only the first three components of splines with \dim > 3 are used.
+ *
+ * Ring i occupies \vertices[i*n_profile*3 ... (i+1)*n_profile*3-1] (xyz).
+ * \indices receives 6 * (\n-1) * m triangle indices (two triangles per quad,
+ * facing outwards if the profile is counter-clockwise), where m is
+ * \n_profile if \closed (the profile is a closed loop, e.g., a circle) and
+ * \n_profile-1 otherwise. Hence, \vertices must provide space for
+ * \n * \n_profile * 3 values. \indices may be NULL.
+ *
+ * On error the content of \vertices and \indices is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_sweep(
+	const tsBSpline *bspline, size_t n, const tsReal *profile,
+	size_t n_profile, int closed,
+	tsReal *vertices, size_t *indices
+);
+
+/**
+ * Calls ::ts_bspline_sweep for each of the \n_splines splines of \splines
+ * and concatenates the results, i.e., the vertices of the j-th spline start
+ * at \vertices[j * n * n_profile * 3] and its indices (which are offset by
+ * j * n * n_profile) at \indices[j * 6 * (n-1) * m]. The splines are swept
+ * in parallel if TinySpline is compiled with OpenMP.
+ *
+ * On error the content of \vertices and \indices is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_sweep_many(
+	const tsBSpline *splines, size_t n_splines, size_t n,
+	const tsReal *profile, size_t n_profile, int closed,
+	tsReal *vertices, size_t *indices
+);
+
+/**
+ * Computes the Frenet frame (unit tangent, unit normal, and unit binormal),
+ * the curvature, and the torsion of \bspline at the \n knot values of \us
+ * and stores them in \tangents, \normals, \binormals, \curvatures, and
+ * \torsions respectively. Each of the output buffers may be NULL, in which
+ * case the corresponding quantity is not stored.
+ *
+ * The vector outputs are stored as structure of arrays, that is, component d
+ * of the i-th value is located at [d * n + i]. Hence, \tangents and \normals
+ * must provide space for \n * \dim values, \binormals for \n * 3 values, and
+ * \curvatures and \torsions for \n values.
+ *
+ * \bspline must be two- or three-dimensional. For planar splines, the normal
+ * is the tangent rotated counter-clockwise by 90 degrees, the curvature is
+ * signed (positive for left turns), \binormals is not written, and the
+ * torsion is 0. For spatial splines, normal, binormal, and torsion are set to
+ * 0 where the curvature vanishes. The same applies to all values at knot
+ * values with a vanishing first derivative.
+ *
+ * The span of a knot value and all required derivatives are computed within
+ * a single pass over the non-vanishing basis functions (derived splines are
+ * not created). If \us is sorted, consecutive knot values within the same
+ * span skip the span search. Knot values are processed in blocks such that
+ * the geometry kernels (one for two and one for three dimensions) are
+ * straight-line loops compilers can vectorize.
+ *
+ * On error the content of the output buffers is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \bspline is neither 2
+ *                              nor 3.
+ * @return TS_U_UNDEFINED       if \bspline is not defined at a value of \us.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_frenet_many(
+	const tsBSpline *bspline, const tsReal *us, size_t n,
+	tsReal *tangents, tsReal *normals, tsReal *binormals,
+	tsReal *curvatures, tsReal *torsions
+);
+
+/**
+ * Computes the curvature of \bspline at the \n knot values of \us and
+ * stores the result in \curvatures. Equivalent to ::ts_bspline_frenet_many
+ * with all other outputs set to NULL. In particular, the curvature of planar
+ * splines is signed.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \bspline is neither 2
+ *                              nor 3.
+ * @return TS_U_UNDEFINED       if \bspline is not defined at a value of \us.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_curvature_many(
+	const tsBSpline *bspline, const tsReal *us, size_t n,
+	tsReal *curvatures
+);
+
+/**
+ * Integrates \f over the domain of \bspline, i.e., computes the integral of
+ * f(u, C(u), C'(u)) du, and stores the result in \result. For example, the
+ * line integral of a scalar field g is obtained with f = g(C(u)) * |C'(u)|.
+ *
+ * The integral is computed span by span (the integrand is smooth within a
+ * span) using adaptive 5-point Gauss-Legendre quadrature: an interval is
+ * bisected until the sum of both halves differs by at most its share of \tol
+ * from the value of the whole interval. All nodes of an interval are
+ * evaluated at once using the span's basis functions, i.e., there is no span
+ * search at all. The spans of long splines are integrated in parallel if
+ * TinySpline is compiled with OpenMP. If \tol <= 0, FLT_MAX_ABS_ERROR is used.
+ * An interval is not bisected further if the difference is within a few
+ * ulps of its value or does not decrease anymore. Thus, a \tol below the
+ * precision of tsReal does not cause excessive bisection.
+ *
+ * On error \result is 0.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_integrate(
+	const tsBSpline *bspline, tsIntegrand f, void *ctx, tsReal tol,
+	tsReal *result
+);
+
+/**
+ * Computes the arc length of \bspline (using all \dim components, i.e.,
+ * without dividing by the weights of NURBS) with an absolute error of about
+ * \tol and stores the result in \length. This is ::ts_bspline_integrate with
+ * the speed |C'(u)| of the hodograph as integrand.
+ *
+ * On error \length is 0.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_length(
+	const tsBSpline *bspline, tsReal tol,
+	tsReal *length
+);
+
+/**
+ * The default constructor of tsBSplineLookup.
+ *
+ * All values of \lookup are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_bspline_lookup_default(tsBSplineLookup *lookup);
+
+/**
+ * Creates the bracketing data of the two-dimensional spline \bspline (a
+ * function y(x), see tsBSplineLookup) and stores the result in \lookup.
+ *
+ * x(u) is verified to be monotone by checking that the x-components of the
+ * control points are monotone (a B-Spline never oscillates more often than
+ * its control polygon). Both increasing and decreasing splines are
+ * accepted. Afterwards, the x-values at the bounds of all non-empty spans
+ * are evaluated once, such that a lookup of an x-value only requires a
+ * binary search over these values.
+ *
+ * \lookup is bound to the control points and knots of \bspline at the time
+ * of this call. It must be recreated whenever \bspline changes.
+ *
+ * On error all values of \lookup are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \bspline is not 2.
+ * @return TS_NOT_MONOTONE      if the x-components of the control points of
+ *                              \bspline are not monotone or if all of them
+ *                              are equal.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_lookup_new(
+	const tsBSpline *bspline,
+	tsBSplineLookup *lookup
+);
+
+/**
+ * The destructor of tsBSplineLookup.
+ *
+ * Frees all dynamically allocated memory and calls ::ts_bspline_lookup_default
+ * afterwards.
+ */
+TINYSPLINE_API void ts_bspline_lookup_free(tsBSplineLookup *lookup);
+
+/**
+ * Computes y(\x) of \bspline (using the bracketing data \lookup created from
+ * \bspline) and stores the result in \y.
+ *
+ * The span containing \x is found with a binary search over the x-values of
+ * \lookup. Within this span, x(u) = \x is solved with Newton's method
+ * safeguarded by bisection: an iteration that leaves the current bracket (or
+ * hits a vanishing derivative) falls back to bisecting it. Hence, the
+ * solver always converges. It stops if the residual is within a few ulps of
+ * the x-range of \lookup or the bracket has collapsed to a few ulps. Hence,
+ * the accuracy does not depend on the scale of the x-values. Splines of
+ * small order are looked up without allocating memory.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_U_UNDEFINED       if \x is not within [lookup->xs[0],
+ *                              lookup->xs[lookup->n_spans]].
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_lookup(
+	const tsBSpline *bspline, const tsBSplineLookup *lookup, tsReal x,
+	tsReal *y
+);
+
+/**
+ * Computes y(x) for the \n x-values of \xs and stores the results in \ys.
+ * See ::ts_bspline_lookup for more details. If \xs is sorted, the span of the
+ * previous x-value is tried first and its neighbour second, such that sorted
+ * input is processed without binary searches. Unsorted input is supported as
+ * well.
+ *
+ * On error the content of \ys is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_U_UNDEFINED       if a value of \xs is not within
+ *                              [lookup->xs[0], lookup->xs[lookup->n_spans]].
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_lookup_many(
+	const tsBSpline *bspline, const tsBSplineLookup *lookup,
+	const tsReal *xs, size_t n,
+	tsReal *ys
+);
+
+/**
+ * The default constructor of tsSimplifier.
+ *
+ * All values of \simplifier are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_simplifier_default(tsSimplifier *simplifier);
+
+/**
+ * Creates an empty simplifier for points of dimension \dim which drops
+ * points whose distance to the simplified polyline is at most \tol.
+ *
+ * On error all values of \simplifier are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_ZERO          if \dim == 0.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_simplifier_new(
+	size_t dim, tsReal tol,
+	tsSimplifier *simplifier
+);
+
+/**
+ * The destructor of tsSimplifier.
+ *
+ * Frees all dynamically allocated memory and calls ::ts_simplifier_default
+ * afterwards.
+ */
+TINYSPLINE_API void ts_simplifier_free(tsSimplifier *simplifier);
+
+/**
+ * Pushes \point (\simplifier->dim values) to \simplifier. Returns the
+ * number of emitted points (0 or 1), which are stored in \out (with space
+ * for \simplifier->dim values). The first point pushed after creation or
+ * ::ts_simplifier_flush is always emitted.
+ *
+ * The segment starting at the anchor is extended to \point as long as
+ * \point lies within the cone of directions keeping all covered points
+ * within \simplifier->tol of the segment (sleeve fitting) and the segment
+ * does not move backwards. Otherwise, the previously pushed point is
+ * emitted and becomes the new anchor. The cones of two points are
+ * intersected in the plane spanned by their axes, which is exact for
+ * planar polylines and conservative in higher dimensions.
+ */
+TINYSPLINE_API size_t ts_simplifier_push(
+	tsSimplifier *simplifier, const tsReal *point,
+	tsReal *out
+);
+
+/**
+ * Terminates the current polyline of \simplifier: The last pushed point is
+ * stored in \out unless it has already been emitted. Returns the number of
+ * emitted points (0 or 1). Afterwards, \simplifier starts a new polyline.
+ */
+TINYSPLINE_API size_t ts_simplifier_flush(
+	tsSimplifier *simplifier,
+	tsReal *out
+);
+
+/**
+ * The default constructor of tsBSplineLOD.
+ *
+ * All values of \lod are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_bspline_lod_default(tsBSplineLOD *lod);
+
+/**
+ * Creates a level-of-detail pyramid of \bspline with at most \n_levels (at
+ * least 1) levels and stores the result in \lod.
+ *
+ * Level k > 0 is obtained by removing interior knots of \bspline as long as
+ * the curve deviates by at most \tol * 2^(k-1). The deviation of each knot
+ * interval is bounded by accumulating the bounds of the removals affecting
+ * it (see "The NURBS Book", Section 9.4.1). The levels are computed
+ * independently of each other, in parallel if OpenMP is enabled. Levels
+ * that do not have fewer control points than their predecessor are
+ * dropped. The resulting bound of each level is stored in lod->errors.
+ *
+ * \lod is bound to \bspline at the time of this call. It must be recreated
+ * whenever \bspline changes.
+ *
+ * On error all values of \lod are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_lod_new(
+	const tsBSpline *bspline, tsReal tol, size_t n_levels,
+	tsBSplineLOD *lod
+);
+
+/**
+ * The destructor of tsBSplineLOD.
+ *
+ * Frees all dynamically allocated memory and calls ::ts_bspline_lod_default
+ * afterwards.
+ */
+TINYSPLINE_API void ts_bspline_lod_free(tsBSplineLOD *lod);
+
+/**
+ * Returns the index of the coarsest level of \lod whose deviation, scaled
+ * by \scale (e.g., pixels per unit of the current zoom level), is at most
+ * \max_error (e.g., in pixels). Returns 0 if no level qualifies.
+ */
+TINYSPLINE_API size_t ts_bspline_lod_select(
+	const tsBSplineLOD *lod, tsReal scale, tsReal max_error
+);
+
+/**
+ * The default constructor of tsTessellation.
+ *
+ * All values of \tess are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_tessellation_default(tsTessellation *tess);
+
+/**
+ * Tessellates \bspline into \n_segments (at least 1) segments per
+ * non-empty knot interval and stores the result in \tess. If OpenMP is
+ * enabled, long splines are tessellated in parallel.
+ *
+ * On error all values of \tess are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_tessellation_new(
+	const tsBSpline *bspline, size_t n_segments,
+	tsTessellation *tess
+);
+
+/**
+ * The destructor of tsTessellation.
+ *
+ * Frees all dynamically allocated memory and calls ::ts_tessellation_default
+ * afterwards.
+ */
+TINYSPLINE_API void ts_tessellation_free(tsTessellation *tess);
+
+/**
+ * Notifies \tess that the \n control points of \bspline starting at index
+ * \first have changed. Due to the local support of B-Splines, only the knot
+ * intervals [first, first+n-1+deg] are re-evaluated. The indices of the
+ * patched points of \tess are stored in \from (the first one) and \count
+ * (their number), e.g., to update a vertex buffer. Indices beyond the last
+ * control point are ignored.
+ *
+ * On error \tess is not modified.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INCOMPATIBLE      if \bspline differs from the tessellated
+ *                              spline in degree, dimension, or number of
+ *                              control points.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_tessellation_ctrlp_changed(
+	tsTessellation *tess, const tsBSpline *bspline, size_t first, size_t n,
+	size_t *from, size_t *count
+);
+
+/**
+ * Notifies \tess that the \n knots of \bspline starting at index \first
+ * have changed. Only the knot intervals [first-deg-1, first+n+deg-1] are
+ * re-evaluated, unless a knot interval within this range became empty or
+ * non-empty. In this case, the whole spline is tessellated again. See
+ * ::ts_tessellation_ctrlp_changed for \from and \count.
+ *
+ * On error \tess is not modified.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INCOMPATIBLE      if \bspline differs from the tessellated
+ *                              spline in degree, dimension, or number of
+ *                              control points.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_tessellation_knots_changed(
+	tsTessellation *tess, const tsBSpline *bspline, size_t first, size_t n,
+	size_t *from, size_t *count
+);
+
+/**
+ * Re-evaluates the knot intervals of \tess within the dirty range of
+ * \bspline (see ::ts_bspline_dirty). If a knot interval within this range
+ * became empty or non-empty, the whole spline is tessellated again. See
+ * ::ts_tessellation_ctrlp_changed for \from and \count. The dirty range is
+ * not cleared, such that other observers of \bspline can use it as well.
+ * Call ::ts_bspline_take_dirty once all observers have been updated.
+ *
+ * On error \tess is not modified.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INCOMPATIBLE      if \bspline differs from the tessellated
+ *                              spline in degree, dimension, or number of
+ *                              control points.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_tessellation_update(
+	tsTessellation *tess, const tsBSpline *bspline,
+	size_t *from, size_t *count
+);
+
+/**
+ * The default constructor of tsSealedBSpline.
+ *
+ * All values of \sealed are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_sealed_bspline_default(tsSealedBSpline *sealed);
+
+/**
+ * Validates \bspline and stores a sealed copy of it in \sealed. The knot
+ * vector must be non-decreasing, no knot value may have a multiplicity
+ * greater than the order of \bspline, and the domain of \bspline must not
+ * be empty. Later changes of \bspline do not affect \sealed.
+ *
+ * On error all values of \sealed are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_ZERO          if the dimension of \bspline is 0.
+ * @return TS_DEG_GE_NCTRLP     if the degree of \bspline >= its number of
+ *                              control points.
+ * @return TS_KNOTS_DECR        if the knot vector is decreasing or the
+ *                              domain is empty.
+ * @return TS_MULTIPLICITY      if the multiplicity of a knot value > order.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_seal(
+	const tsBSpline *bspline,
+	tsSealedBSpline *sealed
+);
+
+/**
+ * The destructor of tsSealedBSpline.
+ *
+ * Frees all dynamically allocated memory and calls
+ * ::ts_sealed_bspline_default afterwards.
+ */
+TINYSPLINE_API void ts_sealed_bspline_free(tsSealedBSpline *sealed);
+
+/**
+ * Evaluates \sealed at the \n knot values in \us like
+ * ::ts_bspline_evaluate_many, but without validating the knot values:
+ * values outside of the domain are clamped to it, and each value is
+ * evaluated within the non-empty knot interval [knots[k], knots[k+1])
+ * containing it (the last interval is closed). Knot values are neither
+ * rounded to nearby knots (see ::ts_fequals) nor checked for
+ * multiplicities. The length of \points must be at least
+ * \n * \sealed->bspline.dim.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_sealed_bspline_evaluate_many(
+	const tsSealedBSpline *sealed, const tsReal *us, size_t n,
+	tsReal *points
+);
+
+/**
+ * Evaluates the derivatives 0..\n_ders of \sealed at the \n knot values
+ * in \us (see ::ts_sealed_bspline_evaluate_many) from the derivatives of
+ * its basis functions, i.e., without deriving \sealed. The derivatives of
+ * the i'th knot value are stored in \ders starting at index
+ * i * (\n_ders+1) * dim. Derivatives above the degree of \sealed are 0.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_sealed_bspline_derivatives_many(
+	const tsSealedBSpline *sealed, const tsReal *us, size_t n,
+	size_t n_ders, tsReal *ders
+);
+
+/**
+ * Like ::ts_bspline_derive, but multiplies with the reciprocal knot
+ * differences of \sealed instead of dividing by the knot differences. The
+ * derivative is an ordinary spline and is never stored in \sealed.
+ *
+ * On error all values of \derivative are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_UNDERIVABLE       if \sealed is discontinuous at an internal
+ *                              knot or the degree of \sealed is 0.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_sealed_bspline_derive(
+	const tsSealedBSpline *sealed,
+	tsBSpline *derivative
+);
+
+/**
+ * Like ::ts_bspline_insert_knot, but computes the de Boor net with the
+ * reciprocal knot differences of \sealed. The result is an ordinary spline
+ * and is never stored in \sealed.
+ *
+ * On error all values of \result are 0/NULL and \k is 0.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_U_UNDEFINED       if \sealed is not defined at \u.
+ * @return TS_MULTIPLICITY      if the multiplicity of \u would exceed the
+ *                              order of \sealed.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_sealed_bspline_insert_knot(
+	const tsSealedBSpline *sealed, tsReal u, size_t n,
+	tsBSpline *result, size_t *k
+);
+
+/**
+ * The default constructor of tsBSplineGroup.
+ *
+ * All values of \group are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_bspline_group_default(tsBSplineGroup *group);
+
+/**
+ * Packs the \n_lanes splines \splines into \group using the layout given
+ * by \flags (see tsLayoutFlag). All splines must have the same degree,
+ * dimension, and number of control points, and are validated like in
+ * ::ts_bspline_seal. Their knot vectors may differ.
+ *
+ * On error all values of \group are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_ZERO          if \n_lanes is 0 or the dimension of the
+ *                              splines is 0.
+ * @return TS_INCOMPATIBLE      if the splines differ in degree, dimension,
+ *                              or number of control points.
+ * @return TS_DEG_GE_NCTRLP     if the degree >= the number of control
+ *                              points.
+ * @return TS_KNOTS_DECR        if a knot vector is decreasing or a domain
+ *                              is empty.
+ * @return TS_MULTIPLICITY      if the multiplicity of a knot value > order.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_group_new(
+	const tsBSpline *splines, size_t n_lanes, int flags,
+	tsBSplineGroup *group
+);
+
+/**
+ * The destructor of tsBSplineGroup.
+ *
+ * Frees all dynamically allocated memory and calls
+ * ::ts_bspline_group_default afterwards.
+ */
+TINYSPLINE_API void ts_bspline_group_free(tsBSplineGroup *group);
+
+/**
+ * Unpacks lane \lane of \group into the ordinary spline \bspline, which
+ * has the layout of \group (see tsLayoutFlag).
+ *
+ * On error all values of \bspline are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_INDEX_ERROR       if \lane >= \group->n_lanes.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_group_lane(
+	const tsBSplineGroup *group, size_t lane,
+	tsBSpline *bspline
+);
+
+/**
+ * Evaluates each lane w of \group at its own knot value \us[w] and stores
+ * the resulting points in \points in the packed layout of the control
+ * points, i.e., coordinate d of lane w is points[d*n_lanes + w]. Knot
+ * values are handled like in ::ts_sealed_bspline_evaluate_many. The spans
+ * and their control points are gathered per lane, de Boor's algorithm then
+ * processes all lanes at once in loops over contiguous lanes that are
+ * vectorized by the compiler.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_group_evaluate(
+	const tsBSplineGroup *group, const tsReal *us,
+	tsReal *points
+);
+
+
+
+/******************************************************************************
+*                                                                             *
+* Surface Functions                                                           *
+*                                                                             *
+* The following section contains all functions related to tsBSplineSurface.  *
+* Surfaces are evaluated by computing the non-vanishing basis functions of    *
+* both directions (rather than running De Boor's algorithm per point). Hence, *
+* evaluating a point costs O((deg_u+1) * (deg_v+1) * dim) operations without  *
+* allocating memory for intermediate nets.                                    *
+*                                                                             *
+******************************************************************************/
+/**
+ * The default constructor of tsBSplineSurface.
+ *
+ * All values of \surface are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_bsplinesurface_default(tsBSplineSurface *surface);
+
+/**
+ * A convenient constructor for tsBSplineSurface.
+ *
+ * Creates a new surface of degree \deg_u x \deg_v with dimension \dim and a
+ * grid of \n_ctrlp_u x \n_ctrlp_v control points. Both knot vectors are filled
+ * according to \type within the domain [0, 1].
+ *
+ * On error all values of \surface are 0/NULL.
+ *
+ * @return TS_SUCCESS          on success.
+ * @return TS_DIM_ZERO         if \dim == 0.
+ * @return TS_DEG_GE_NCTRLP    if \deg_u >= \n_ctrlp_u or \deg_v >= \n_ctrlp_v.
+ * @return TS_NUM_KNOTS        if \type == TS_BEZIERS and the number of knots
+ *                             of a direction is not a multiple of its order.
+ * @return TS_MALLOC           if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bsplinesurface_new(
+	size_t n_ctrlp_u, size_t n_ctrlp_v, size_t dim,
+	size_t deg_u, size_t deg_v, tsBSplineType type,
+	tsBSplineSurface *surface
+);
+
+/**
+ * The copy constructor of tsBSplineSurface.
+ *
+ * Creates a deep copy of \original and stores the result in \copy. Does
+ * nothing if \original == \copy.
+ *
+ * On error all values of \copy are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bsplinesurface_copy(
+	const tsBSplineSurface *original,
+	tsBSplineSurface *copy
+);
+
+/**
+ * The move constructor of tsBSplineSurface.
+ *
+ * Moves all values from \from to \to and calls ::ts_bsplinesurface_default on
+ * \from afterwards. Does nothing if \from == \to.
+ */
+TINYSPLINE_API void ts_bsplinesurface_move(
+	tsBSplineSurface *from,
+	tsBSplineSurface *to
+);
+
+/**
+ * The destructor of tsBSplineSurface.
+ *
+ * Frees all dynamically allocated memory and calls ::ts_bsplinesurface_default
+ * afterwards.
+ */
+TINYSPLINE_API void ts_bsplinesurface_free(tsBSplineSurface *surface);
+
+/**
+ * Stores the domain [\min_u, \max_u] x [\min_v, \max_v] of \surface.
+ */
+TINYSPLINE_API void ts_bsplinesurface_domain(
+	const tsBSplineSurface *surface,
+	tsReal *min_u, tsReal *max_u, tsReal *min_v, tsReal *max_v
+);
+
+/**
+ * Evaluates \surface at (\u, \v) and stores the resulting point (\dim values)
+ * in \point.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ * @return TS_U_UNDEFINED       if \surface is not defined at (\u, \v).
+ */
+TINYSPLINE_API tsError ts_bsplinesurface_evaluate(
+	const tsBSplineSurface *surface, tsReal u, tsReal v,
+	tsReal *point
+);
+
+/**
+ * Computes all partial derivatives of \surface at (\u, \v) up to order \d
+ * (inclusive), that is, d^(k+l) S / du^k dv^l for 0 <= k+l <= \d. The
+ * derivative of order (k, l) is stored at:
+ *
+ *     ders[(k*(d+1) + l) * dim]
+ *
+ * Hence, \ders must provide (\d+1)*(\d+1)*dim values. ders[0] contains the
+ * point S(\u, \v) itself. Entries with k+l > \d are set to 0. Keep in mind
+ * that, for NURBS, these are the derivatives of the homogeneous surface.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ * @return TS_U_UNDEFINED       if \surface is not defined at (\u, \v).
+ */
+TINYSPLINE_API tsError ts_bsplinesurface_derivatives(
+	const tsBSplineSurface *surface, tsReal u, tsReal v, size_t d,
+	tsReal *ders
+);
+
+/**
+ * Evaluates \surface at the grid \us x \vs consisting of \m x \n parameter
+ * pairs and stores the resulting points row by row in \points, that is,
+ * S(us[i], vs[j]) starts at points[(i*n + j) * dim]. The length of \points
+ * must be at least \m * \n * \dim.
+ *
+ * The basis functions of each row and each column are calculated only once.
+ * Furthermore, each row is first collapsed into an intermediate curve such
+ * that the whole grid costs O(m * n_ctrlp_v * (deg_u+1) + m * n * (deg_v+1))
+ * instead of O(m * n * (deg_u+1) * (deg_v+1)).
+ *
+ * On error the content of \points is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ * @return TS_U_UNDEFINED       if \surface is not defined at a value of \us
+ *                              or \vs.
+ */
+TINYSPLINE_API tsError ts_bsplinesurface_evaluate_grid(
+	const tsBSplineSurface *surface,
+	const tsReal *us, size_t m, const tsReal *vs, size_t n,
+	tsReal *points
+);
+
+/**
+ * Interpolates the regular grid of \n_u x \n_v samples of dimension \dim given
+ * in \samples (same layout as the control points of tsBSplineSurface, i.e.,
+ * row by row) with a cubic surface. The sample (i, j) is interpolated at
+ * (i/(n_u-1), j/(n_v-1)).
+ *
+ * The interpolation is separable: the rows are solved first, followed by the
+ * columns, each with the tridiagonal system of ::ts_bspline_interpolate_cubic
+ * (natural end conditions). The columns are never transposed. Instead, all
+ * rows are treated as points of dimension (n_v+2) * dim and split into
+ * blocks of TS_INTERPOLATION_BLOCK_SIZE values that are solved independently
+ * (in parallel if TinySpline is compiled with OpenMP). The resulting surface
+ * has uniform knot vectors and (n_u+2) x (n_v+2) control points.
+ *
+ * Approximation (a least-squares fit with fewer control points than
+ * samples) is not supported. To reduce the number of control points, pass
+ * a subsampled grid, e.g., every k-th row and column of \samples.
+ *
+ * On error all values of \surface are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_ZERO          if \dim == 0.
+ * @return TS_DEG_GE_NCTRLP     if \n_u < 2 or \n_v < 2.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bsplinesurface_interpolate_cubic(
+	const tsReal *samples, size_t n_u, size_t n_v, size_t dim,
+	tsBSplineSurface *surface
+);
+
+
+
+/******************************************************************************
+*                                                                             *
+* Volume Functions                                                            *
+*                                                                             *
+* The following section contains all functions related to tsBSplineVolume.   *
+*                                                                             *
+******************************************************************************/
+/**
+ * The default constructor of tsBSplineVolume.
+ *
+ * All values of \volume are set to 0/NULL.
+ */
+TINYSPLINE_API void ts_bsplinevolume_default(tsBSplineVolume *volume);
+
+/**
+ * A convenient constructor for tsBSplineVolume.
+ *
+ * Creates a new volume with the given degrees and a grid of \n_ctrlp_u x
+ * \n_ctrlp_v x \n_ctrlp_w control points of dimension \dim. All knot vectors
+ * are filled according to \type within the domain [0, 1].
+ *
+ * On error all values of \volume are 0/NULL.
+ *
+ * @return TS_SUCCESS          on success.
+ * @return TS_DIM_ZERO         if \dim == 0.
+ * @return TS_DEG_GE_NCTRLP    if the degree of a direction >= its number of
+ *                             control points.
+ * @return TS_NUM_KNOTS        if \type == TS_BEZIERS and the number of knots
+ *                             of a direction is not a multiple of its order.
+ * @return TS_MALLOC           if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bsplinevolume_new(
+	size_t n_ctrlp_u, size_t n_ctrlp_v, size_t n_ctrlp_w, size_t dim,
+	size_t deg_u, size_t deg_v, size_t deg_w, tsBSplineType type,
+	tsBSplineVolume *volume
+);
+
+/**
+ * The copy constructor of tsBSplineVolume.
+ *
+ * Creates a deep copy of \original and stores the result in \copy. Does
+ * nothing if \original == \copy.
+ *
+ * On error all values of \copy are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bsplinevolume_copy(
+	const tsBSplineVolume *original,
+	tsBSplineVolume *copy
+);
+
+/**
+ * The move constructor of tsBSplineVolume.
+ *
+ * Moves all values from \from to \to and calls ::ts_bsplinevolume_default on
+ * \from afterwards. Does nothing if \from == \to.
+ */
+TINYSPLINE_API void ts_bsplinevolume_move(
+	tsBSplineVolume *from,
+	tsBSplineVolume *to
+);
+
+/**
+ * The destructor of tsBSplineVolume.
+ *
+ * Frees all dynamically allocated memory and calls ::ts_bsplinevolume_default
+ * afterwards.
+ */
+TINYSPLINE_API void ts_bsplinevolume_free(tsBSplineVolume *volume);
+
+/**
+ * Evaluates \volume at (\u, \v, \w) and stores the resulting point (\dim
+ * values) in \point.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ * @return TS_U_UNDEFINED       if \volume is not defined at (\u, \v, \w).
+ */
+TINYSPLINE_API tsError ts_bsplinevolume_evaluate(
+	const tsBSplineVolume *volume, tsReal u, tsReal v, tsReal w,
+	tsReal *point
+);
+
+/**
+ * Evaluates \volume at \n parameter triples stored in \uvw ([u_0, v_0, w_0,
+ * u_1, ...]) and stores the resulting points in \points (\n * \dim values).
+ *
+ * The knot vectors are analyzed once per call. If the domain of a direction is
+ * uniformly spaced, spans are computed in O(1) instead of using a binary
+ * search. If the whole knot vector of a cubic direction is uniform (e.g.,
+ * volumes created with ::ts_bsplinevolume_interpolate_cubic), the basis
+ * functions are evaluated with closed-form polynomials instead of the
+ * Cox-de Boor recursion. Points are processed in blocks of
+ * TS_VOLUME_BLOCK_SIZE, with the span and basis computation laid out
+ * lane by lane so that compilers can vectorize it.
+ *
+ * On error the content of \points is undefined.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_MALLOC            if allocating memory failed.
+ * @return TS_U_UNDEFINED       if \volume is not defined at a triple.
+ */
+TINYSPLINE_API tsError ts_bsplinevolume_evaluate_many(
+	const tsBSplineVolume *volume, const tsReal *uvw, size_t n,
+	tsReal *points
+);
+
+/**
+ * Interpolates the regular grid of \n_u x \n_v x \n_w samples of dimension
+ * \dim given in \samples (same layout as the control points of
+ * tsBSplineVolume) with a cubic volume. The sample (i, j, k) is interpolated
+ * at (i/(n_u-1), j/(n_v-1), k/(n_w-1)).
+ *
+ * The interpolation is separable: each direction is solved with the
+ * tridiagonal system of ::ts_bspline_interpolate_cubic (natural end
+ * conditions). Lines of the same direction are solved at once, i.e., the
+ * grid is never transposed. The resulting volume has uniform knot vectors and
+ * (n_u+2) x (n_v+2) x (n_w+2) control points. Like
+ * ::ts_bsplinesurface_interpolate_cubic, samples are interpolated, not
+ * approximated.
+ *
+ * On error all values of \volume are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_ZERO          if \dim == 0.
+ * @return TS_DEG_GE_NCTRLP     if \n_u < 2, \n_v < 2, or \n_w < 2.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bsplinevolume_interpolate_cubic(
+	const tsReal *samples, size_t n_u, size_t n_v, size_t n_w, size_t dim,
+	tsBSplineVolume *volume
+);
+
+
+
+/******************************************************************************
+*                                                                             *
+* Function Splines                                                            *
+*                                                                             *
+* The following section contains functions for scalar functions y(x) given    *
+* as one-dimensional tsBSpline ('function splines'). The knot vector of a     *
+* function spline lives in the domain of the function (i.e., knot value ==    *
+* abscissa) and each control point consists of a single value. Thus, y(x) is  *
+* evaluated directly without inverting a parametric curve (x(u), y(u)).       *
+* Function splines are regular splines: all other functions of TinySpline,    *
+* e.g., ::ts_bspline_derive (which yields the derivative y'(x)), can be used  *
+* with them as well.                                                          *
+*                                                                             *
+* Sums and products do not require compatible knot vectors. Both operands     *
+* are restricted to the intersection of their domains and decomposed into     *
+* Bezier segments at the union of their breakpoints. The segments are then    *
+* combined exactly (sums after degree elevation, products with the product    *
+* formula of Bernstein polynomials). The resulting knot vector has full       *
+* multiplicity at each breakpoint.                                            *
+*                                                                             *
+******************************************************************************/
+/**
+ * Interpolates the \n uniformly spaced samples \ys (y_0 = y(x_min), ...,
+ * y_{n-1} = y(x_max)) with a cubic function spline (natural end conditions,
+ * see ::ts_bspline_interpolate_cubic) and stores the result in \function.
+ *
+ * On error all values of \function are 0/NULL.
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DEG_GE_NCTRLP     if \n < 2.
+ * @return TS_KNOTS_DECR        if \x_min >= \x_max.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_function_interpolate_cubic(
+	const tsReal *ys, size_t n, tsReal x_min, tsReal x_max,
+	tsBSpline *function
+);
+
+/**
+ * Evaluates the function spline \function at \x and stores the result in
+ * \y. The span of \x is found with a binary search followed by a single
+ * De Boor pass over the \order affected control values (without allocating
+ * memory for common degrees).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \function is not 1.
+ * @return TS_U_UNDEFINED       if \function is not defined at \x.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_function_evaluate(
+	const tsBSpline *function, tsReal x,
+	tsReal *y
+);
+
+/**
+ * Computes the sum \a + \b of two function splines on the intersection of
+ * their domains and stores the result in \sum. The degree of \sum is the
+ * maximum of the degrees of \a and \b. \sum may be \a or \b.
+ *
+ * On error all values of \sum are 0/NULL (unless \sum is \a or \b, in
+ * which case it is not modified).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \a or \b is not 1.
+ * @return TS_U_UNDEFINED       if the domains of \a and \b do not overlap.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_function_add(
+	const tsBSpline *a, const tsBSpline *b,
+	tsBSpline *sum
+);
+
+/**
+ * Computes the product \a * \b of two function splines on the intersection
+ * of their domains and stores the result in \product. The degree of
+ * \product is the sum of the degrees of \a and \b. \product may be \a or
+ * \b.
+ *
+ * On error all values of \product are 0/NULL (unless \product is \a or \b,
+ * in which case it is not modified).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \a or \b is not 1.
+ * @return TS_U_UNDEFINED       if the domains of \a and \b do not overlap.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_function_multiply(
+	const tsBSpline *a, const tsBSpline *b,
+	tsBSpline *product
+);
+
+/**
+ * Computes the antiderivative Y of the function spline \function with
+ * Y(x_min) = 0 (where x_min is the lower bound of the domain of \function)
+ * and stores the result in \antiderivative. Hence, the definite integral of
+ * \function over [x_min, x] is Y(x). The degree of \antiderivative is the
+ * degree of \function plus one. \antiderivative may be \function.
+ *
+ * On error all values of \antiderivative are 0/NULL (unless
+ * \antiderivative is \function, in which case it is not modified).
+ *
+ * @return TS_SUCCESS           on success.
+ * @return TS_DIM_UNSUPPORTED   if the dimension of \function is not 1.
+ * @return TS_MALLOC            if allocating memory failed.
+ */
+TINYSPLINE_API tsError ts_bspline_function_antiderivative(
+	const tsBSpline *function,
+	tsBSpline *antiderivative
+);
+
+
 /******************************************************************************
 *                                                                             *
 * Utility Functions                                                           *
@@ -682,26 +2680,26 @@ tsError ts_bspline_to_beziers(
  * @return 1    if \x is equals to \y.
  * @return 0    otherwise.
  */
-int ts_fequals(tsReal x, tsReal y);
+TINYSPLINE_API int ts_fequals(tsReal x, tsReal y);
 
 /**
  * Returns the error message associated to \err. Returns "unknown error" if
  * \err is not associated (indicating a bug) or is TS_SUCCESS (which is not an
  * actual error).
  */
-const char* ts_enum_str(tsError err);
+TINYSPLINE_API const char* ts_enum_str(tsError err);
 
 /**
  * Returns the error code associated to \str or TS_SUCCESS if \str is not
  * associated. Keep in mind that by concept "unknown error" is not associated,
  * though, TS_SUCCESS is returned.
  */
-tsError ts_str_enum(const char *str);
+TINYSPLINE_API tsError ts_str_enum(const char *str);
 
 /**
  * Fills the given array \arr with \val from \arr+0 to \arr+\num (exclusive).
  */
-void ts_arr_fill(tsReal *arr, size_t num, tsReal val);
+TINYSPLINE_API void ts_arr_fill(tsReal *arr, size_t num, tsReal val);
 
 /**
  * Returns the euclidean distance of \x and \y consisting of \dim components,
@@ -709,7 +2707,7 @@ void ts_arr_fill(tsReal *arr, size_t num, tsReal val);
  *
  * @return  the euclidean of \x and \y.
  */
-tsReal ts_ctrlp_dist2(const tsReal *x, const tsReal *y, size_t dim);
+TINYSPLINE_API tsReal ts_ctrlp_dist2(const tsReal *x, const tsReal *y, size_t dim);
 
 
 
@@ -48,6 +48,14 @@
 %ignore tinyspline::DeBoorNet::data;
 %ignore tsBSpline;
 %ignore tinyspline::BSpline::data;
+%ignore tsBSplineSurface;
+%ignore tsBSplineVolume;
+%ignore tsBSplineLookup;
+%ignore tsSimplifier;
+%ignore tsBSplineLOD;
+%ignore tsTessellation;
+%ignore tsSealedBSpline;
+%ignore tsBSplineGroup;
 // Ignore move semantics.
 %ignore tinyspline::DeBoorNet::DeBoorNet(DeBoorNet &&);
 %ignore tinyspline::swap(DeBoorNet &, DeBoorNet &);
@@ -60,6 +68,15 @@
 %rename(CLAMPED) TS_CLAMPED;
 %rename(BEZIERS) TS_BEZIERS;
 %rename(NONE) TS_NONE;
+%rename(TransformType) tsTransformType;
+%rename(AFFINE) TS_AFFINE;
+%rename(PROJECTIVE) TS_PROJECTIVE;
+%rename(AlphaType) tsAlphaType;
+%rename(ALPHA_UINT8) TS_ALPHA_UINT8;
+%rename(ALPHA_FLOAT) TS_ALPHA_FLOAT;
+%rename(LayoutFlag) tsLayoutFlag;
+%rename(PACKED) TS_PACKED;
+%rename(ALIGNED) TS_ALIGNED;
 
 %{
 	#include "tinyspline.h"
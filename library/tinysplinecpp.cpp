@@ -222,8 +222,8 @@ void tinyspline::BSpline::setCtrlp(
 	const std::vector<tinyspline::real> &ctrlp)
 {
 	if (ctrlp.size() != nCtrlp() * dim()) {
-		throw std::runtime_error("The number of values must be equals"
-			"to the spline's number of control points multiplied"
+		throw std::runtime_error("The number of values must be equal "
+			"to the spline's number of control points multiplied "
 			"by the dimension of each control point.");
 	}
 	const tsError err = ts_bspline_set_ctrlp(
@@ -236,7 +236,7 @@ void tinyspline::BSpline::setKnots(
 	const std::vector<tinyspline::real> &knots)
 {
 	if (knots.size() != nKnots()) {
-		throw std::runtime_error("The number of values must be equals"
+		throw std::runtime_error("The number of values must be equal "
 			"to the spline's number of knots.");
 	}
 	const tsError err = ts_bspline_set_knots(
@@ -318,6 +318,32 @@ tinyspline::BSpline tinyspline::BSpline::derive() const
 	return bs;
 }
 
+tinyspline::BSpline tinyspline::BSpline::integral() const
+{
+	tinyspline::BSpline bs;
+	const tsError err = ts_bspline_integral(&bspline, &bs.bspline);
+	if (err < 0)
+		throw std::runtime_error(ts_enum_str(err));
+	return bs;
+}
+
+tinyspline::BSpline tinyspline::BSpline::transform(
+	const std::vector<tinyspline::real> &matrix,
+	const tsTransformType type) const
+{
+	const size_t k = type == TS_AFFINE ? dim() + 1 : dim();
+	if (matrix.size() != k*k) {
+		throw std::runtime_error("The number of values must be equal "
+			"to the size of the transformation matrix.");
+	}
+	tinyspline::BSpline bs;
+	const tsError err = ts_bspline_transform(
+		&bspline, matrix.data(), type, &bs.bspline);
+	if (err < 0)
+		throw std::runtime_error(ts_enum_str(err));
+	return bs;
+}
+
 #ifndef TINYSPLINE_DISABLE_CXX11_FEATURES
 tinyspline::BSpline::BSpline(tinyspline::BSpline &&other) noexcept
 {
@@ -82,6 +82,9 @@ public:
 	BSpline buckle(real b) const;
 	BSpline toBeziers() const;
 	BSpline derive() const;
+	BSpline integral() const;
+	BSpline transform(const std::vector<real> &matrix,
+		tsTransformType type = TS_AFFINE) const;
 
 	/* C++11 features */
 #ifndef TINYSPLINE_DISABLE_CXX11_FEATURES
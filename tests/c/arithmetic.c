@@ -0,0 +1,170 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double arithmetic_tests_delta = 0.0001;
+
+void arithmetic_tests_init(CuTest *tc, tsBSpline *spline, size_t n_ctrlp,
+    size_t dim, size_t deg, size_t seed)
+{
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(n_ctrlp, dim, deg, TS_CLAMPED, spline));
+    for (i = 0; i < n_ctrlp*dim; i++)
+        spline->ctrlp[i] = (tsReal) ((i*seed) % 7) - 3.f;
+}
+
+/* Asserts that op(a(u), b(u)) == result(u) for u in [0, 1]. */
+void arithmetic_tests_check(CuTest *tc, const tsBSpline *a,
+    const tsBSpline *b, int multiply, const tsBSpline *result)
+{
+    tsDeBoorNet na, nb, nr;
+    tsReal va, vb;
+    size_t i, d;
+
+    for (i = 0; i <= 20; i++) {
+        ts_bspline_evaluate(a, i / 20.f, &na);
+        ts_bspline_evaluate(b, i / 20.f, &nb);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate(result, i / 20.f, &nr));
+        for (d = 0; d < result->dim; d++) {
+            va = na.result[a->dim == 1 ? 0 : d];
+            vb = nb.result[b->dim == 1 ? 0 : d];
+            CuAssertDblEquals(tc, multiply ? va*vb : va+vb, nr.result[d],
+                arithmetic_tests_delta);
+        }
+        ts_deboornet_free(&na);
+        ts_deboornet_free(&nb);
+        ts_deboornet_free(&nr);
+    }
+}
+
+void arithmetic_test_add(CuTest *tc)
+{
+    tsBSpline a, b, c, sum;
+
+    arithmetic_tests_init(tc, &a, 6, 2, 3, 3);
+    arithmetic_tests_init(tc, &b, 6, 2, 3, 5);
+    arithmetic_tests_init(tc, &c, 4, 1, 2, 2);
+
+    /* compatible knot vectors: sum of control points */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_add(&a, &b, &sum));
+    CuAssertIntEquals(tc, 6, (int) sum.n_ctrlp);
+    CuAssertDblEquals(tc, a.ctrlp[5] + b.ctrlp[5], sum.ctrlp[5], 0);
+    arithmetic_tests_check(tc, &a, &b, 0, &sum);
+    ts_bspline_free(&sum);
+
+    /* different knot vectors and broadcasting */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_add(&c, &a, &sum));
+    CuAssertIntEquals(tc, 3, (int) sum.deg);
+    CuAssertIntEquals(tc, 2, (int) sum.dim);
+    arithmetic_tests_check(tc, &c, &a, 0, &sum);
+    ts_bspline_free(&sum);
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_add(&b, &b, &sum));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_add(&b, &b, &b));
+    CuAssertDblEquals(tc, sum.ctrlp[3], b.ctrlp[3], 0);
+    ts_bspline_free(&sum);
+    ts_bspline_free(&b);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_new(6, 3, 3, TS_CLAMPED,
+        &sum));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED, ts_bspline_add(&a, &sum, &b));
+    CuAssertPtrEquals(tc, NULL, b.ctrlp);
+    ts_bspline_free(&sum);
+    ts_bspline_free(&a);
+    ts_bspline_free(&c);
+}
+
+void arithmetic_test_add_close_knots(CuTest *tc)
+{
+    tsBSpline a, b, sum;
+    tsDeBoorNet na, nb, ns;
+    tsReal u;
+    size_t i, d;
+
+    /* knots that differ by less than FLT_MAX_ABS_ERROR are not equal */
+    arithmetic_tests_init(tc, &a, 6, 2, 3, 3);
+    arithmetic_tests_init(tc, &b, 6, 2, 3, 5);
+    for (i = 0; i < 12; i++)
+        b.ctrlp[i] *= 1000.f;
+    b.knots[5] += 8e-6f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_add(&a, &b, &sum));
+    CuAssertTrue(tc, sum.n_ctrlp > a.n_ctrlp);
+    for (i = 0; i <= 20; i++) {
+        u = 0.6f + i * 0.005f;
+        ts_bspline_evaluate(&a, u, &na);
+        ts_bspline_evaluate(&b, u, &nb);
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&sum, u, &ns));
+        for (d = 0; d < 2; d++) {
+            CuAssertDblEquals(tc, na.result[d] + nb.result[d],
+                ns.result[d], 0.002);
+        }
+        ts_deboornet_free(&na);
+        ts_deboornet_free(&nb);
+        ts_deboornet_free(&ns);
+    }
+    ts_bspline_free(&sum);
+    ts_bspline_free(&a);
+    ts_bspline_free(&b);
+}
+
+void arithmetic_test_scale(CuTest *tc)
+{
+    tsBSpline a, scaled;
+    size_t i;
+
+    arithmetic_tests_init(tc, &a, 6, 2, 3, 3);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_scale(&a, 2.5f, &scaled));
+    for (i = 0; i < 12; i++)
+        CuAssertDblEquals(tc, a.ctrlp[i] * 2.5f, scaled.ctrlp[i], 0);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_scale(&a, 2.5f, &a));
+    for (i = 0; i < 12; i++)
+        CuAssertDblEquals(tc, a.ctrlp[i], scaled.ctrlp[i], 0);
+    ts_bspline_free(&a);
+    ts_bspline_free(&scaled);
+}
+
+void arithmetic_test_multiply(CuTest *tc)
+{
+    tsBSpline a, b, gain, product;
+
+    arithmetic_tests_init(tc, &a, 6, 2, 3, 3);
+    arithmetic_tests_init(tc, &b, 5, 2, 2, 5);
+    arithmetic_tests_init(tc, &gain, 4, 1, 1, 2);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_multiply(&a, &b,
+        &product));
+    CuAssertIntEquals(tc, 5, (int) product.deg);
+    arithmetic_tests_check(tc, &a, &b, 1, &product);
+    ts_bspline_free(&product);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_multiply(&a, &gain,
+        &product));
+    CuAssertIntEquals(tc, 4, (int) product.deg);
+    CuAssertIntEquals(tc, 2, (int) product.dim);
+    arithmetic_tests_check(tc, &a, &gain, 1, &product);
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_multiply(&a, &gain, &a));
+    CuAssertIntEquals(tc, (int) product.n_ctrlp, (int) a.n_ctrlp);
+    CuAssertDblEquals(tc, product.ctrlp[7], a.ctrlp[7], 0);
+    ts_bspline_free(&product);
+
+    ts_bspline_free(&a);
+    ts_bspline_free(&b);
+    ts_bspline_free(&gain);
+}
+
+CuSuite* get_arithmetic_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, arithmetic_test_add);
+    SUITE_ADD_TEST(suite, arithmetic_test_add_close_knots);
+    SUITE_ADD_TEST(suite, arithmetic_test_scale);
+    SUITE_ADD_TEST(suite, arithmetic_test_multiply);
+
+    return suite;
+}
@@ -0,0 +1,145 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <stdlib.h>
+
+const double batch_tests_delta = 0.0001;
+
+void batch_tests_init_spline(CuTest *tc, tsBSpline *spline)
+{
+    size_t i;
+    tsError err = ts_bspline_new(7, 2, 3, TS_CLAMPED, spline);
+    CuAssertIntEquals(tc, TS_SUCCESS, err);
+    for (i = 0; i < spline->n_ctrlp; i++) {
+        spline->ctrlp[i*2] = (tsReal) i;
+        spline->ctrlp[i*2 + 1] = (tsReal) ((i % 2) ? 1.0 : -1.0);
+    }
+}
+
+void batch_test_evaluate_many(CuTest *tc)
+{
+    tsBSpline spline;
+    tsDeBoorNet net;
+    tsReal us[5] = { 0.f, 0.1f, 0.25f, 0.7f, 1.f };
+    tsReal points[10];
+    size_t i;
+
+    batch_tests_init_spline(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_evaluate_many(&spline, us, 5, points));
+    for (i = 0; i < 5; i++) {
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate(&spline, us[i], &net));
+        CuAssertDblEquals(tc, net.result[0], points[i*2], batch_tests_delta);
+        CuAssertDblEquals(tc, net.result[1], points[i*2+1], batch_tests_delta);
+        ts_deboornet_free(&net);
+    }
+
+    us[2] = 1.5f;
+    CuAssertIntEquals(tc, TS_U_UNDEFINED,
+        ts_bspline_evaluate_many(&spline, us, 5, points));
+    ts_bspline_free(&spline);
+}
+
+void batch_test_sample(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal points[22];
+    tsReal min, max;
+
+    batch_tests_init_spline(tc, &spline);
+    ts_bspline_domain(&spline, &min, &max);
+    CuAssertDblEquals(tc, 0, min, batch_tests_delta);
+    CuAssertDblEquals(tc, 1, max, batch_tests_delta);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sample(&spline, 11, points));
+    /* clamped splines pass through the first and last control point */
+    CuAssertDblEquals(tc, 0, points[0], batch_tests_delta);
+    CuAssertDblEquals(tc, -1, points[1], batch_tests_delta);
+    CuAssertDblEquals(tc, 6, points[20], batch_tests_delta);
+    CuAssertDblEquals(tc, -1, points[21], batch_tests_delta);
+    ts_bspline_free(&spline);
+}
+
+void batch_test_serialize(CuTest *tc)
+{
+    tsBSpline spline, copy;
+    unsigned char *buf;
+    size_t len, i;
+
+    batch_tests_init_spline(tc, &spline);
+    len = ts_bspline_serialized_size(&spline);
+    buf = (unsigned char *) malloc(len);
+    CuAssertPtrNotNull(tc, buf);
+
+    CuAssertIntEquals(tc, TS_BUFFER_SIZE,
+        ts_bspline_serialize(&spline, buf, len-1));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_serialize(&spline, buf, len));
+    CuAssertIntEquals(tc, TS_BUFFER_SIZE,
+        ts_bspline_deserialize(buf, len-1, &copy));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_deserialize(buf, len, &copy));
+
+    CuAssertIntEquals(tc, (int) spline.deg, (int) copy.deg);
+    CuAssertIntEquals(tc, (int) spline.dim, (int) copy.dim);
+    CuAssertIntEquals(tc, (int) spline.n_ctrlp, (int) copy.n_ctrlp);
+    CuAssertIntEquals(tc, (int) spline.n_knots, (int) copy.n_knots);
+    for (i = 0; i < spline.n_ctrlp*spline.dim; i++)
+        CuAssertDblEquals(tc, spline.ctrlp[i], copy.ctrlp[i], 0);
+    for (i = 0; i < spline.n_knots; i++)
+        CuAssertDblEquals(tc, spline.knots[i], copy.knots[i], 0);
+    ts_bspline_free(&copy);
+
+    buf[0] = 'X';
+    CuAssertIntEquals(tc, TS_PARSE_ERROR,
+        ts_bspline_deserialize(buf, len, &copy));
+    CuAssertPtrEquals(tc, NULL, copy.ctrlp);
+
+    free(buf);
+    ts_bspline_free(&spline);
+}
+
+void batch_test_serialize_overflow(CuTest *tc)
+{
+    tsBSpline spline, copy;
+    unsigned char buf[256];
+    size_t len;
+
+    batch_tests_init_spline(tc, &spline);
+    len = ts_bspline_serialized_size(&spline);
+    CuAssertTrue(tc, len <= sizeof(buf));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_serialize(&spline, buf, len));
+
+    /* (2^31 * 2^31 + 2^31 + 4) * sizeof(tsReal) wraps with 64 bit size_t
+     * and n_ctrlp*dim wraps with 32 bit size_t */
+    buf[16] = buf[20] = 0;
+    buf[17] = buf[21] = 0;
+    buf[18] = buf[22] = 0;
+    buf[19] = buf[23] = 0x80;
+    CuAssertIntEquals(tc, TS_PARSE_ERROR,
+        ts_bspline_deserialize(buf, len, &copy));
+    CuAssertPtrEquals(tc, NULL, copy.ctrlp);
+    buf[16] = buf[20] = buf[17] = buf[21] = 0xFF;
+    buf[18] = buf[22] = buf[19] = buf[23] = 0xFF;
+    CuAssertIntEquals(tc, TS_PARSE_ERROR,
+        ts_bspline_deserialize(buf, len, &copy));
+
+    /* sizes beyond 32 bits can not be stored in the header */
+    if (sizeof(size_t) > 4) {
+        copy = spline;
+        copy.n_ctrlp += ((size_t) 1 << 16) << 16;
+        CuAssertIntEquals(tc, TS_PARSE_ERROR,
+            ts_bspline_serialize(&copy, buf, sizeof(buf)));
+    }
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_batch_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, batch_test_evaluate_many);
+    SUITE_ADD_TEST(suite, batch_test_sample);
+    SUITE_ADD_TEST(suite, batch_test_serialize);
+    SUITE_ADD_TEST(suite, batch_test_serialize_overflow);
+
+    return suite;
+}
@@ -11,6 +11,7 @@ void default_test_bspline(CuTest* tc)
     b.n_knots = 14;
     b.ctrlp = (tsReal*) &b.deg;
     b.knots = (tsReal*) &b.dim;
+    b.flags = TS_ALIGNED;
 
     CuAssertPtrNotNull(tc, b.ctrlp);
     CuAssertPtrNotNull(tc, b.knots);
@@ -23,6 +24,7 @@ void default_test_bspline(CuTest* tc)
     CuAssertTrue(tc, b.n_knots == 0);
     CuAssertPtrEquals(tc, b.ctrlp, NULL);
     CuAssertPtrEquals(tc, b.knots, NULL);
+    CuAssertTrue(tc, b.flags == TS_PACKED);
 }
 
 void default_test_deboornet(CuTest* tc)
@@ -0,0 +1,144 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <stdlib.h>
+#include <math.h>
+
+const double field_tests_delta = 0.001;
+
+tsReal field_tests_clamp(tsReal d, tsReal band)
+{
+    return d < -band ? -band : (d > band ? band : d);
+}
+
+/* The minimum distance of (x, y) to the polyline \pts of \n points. */
+tsReal field_tests_dist(const tsReal *pts, size_t n, tsReal x, tsReal y)
+{
+    tsReal min = -1.f, dx, dy, ex, ey, t, dist;
+    size_t i;
+
+    for (i = 0; i+1 < n; i++) {
+        ex = pts[(i+1)*2] - pts[i*2];
+        ey = pts[(i+1)*2 + 1] - pts[i*2 + 1];
+        dx = x - pts[i*2];
+        dy = y - pts[i*2 + 1];
+        t = (ex*ex + ey*ey) > 0.f ? (dx*ex + dy*ey) / (ex*ex + ey*ey) : 0.f;
+        t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+        dx -= t*ex;
+        dy -= t*ey;
+        dist = (tsReal) sqrt(dx*dx + dy*dy);
+        if (min < 0.f || dist < min)
+            min = dist;
+    }
+    return min;
+}
+
+void field_test_circle(CuTest *tc)
+{
+    tsBSpline circle;
+    tsReal pts[2*65], origin[2] = { -3.f, -2.f }, x, y, d;
+    tsReal *samples;
+    float *grid;
+    const size_t width = 70, height = 50;
+    size_t i, r, c;
+
+    /* radius 10 around (30, 20), larger than a tile */
+    for (i = 0; i < 65; i++) {
+        pts[i*2] = 30.f + 10.f * (tsReal) cos(2*3.14159265 * i / 64);
+        pts[i*2 + 1] = 20.f + 10.f * (tsReal) sin(2*3.14159265 * i / 64);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_interpolate_cubic(pts, 65, 2, &circle));
+    samples = (tsReal *) malloc(2*2001 * sizeof(tsReal));
+    grid = (float *) malloc(width * height * sizeof(float));
+    CuAssertPtrNotNull(tc, samples);
+    CuAssertPtrNotNull(tc, grid);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_sample(&circle, 2001, samples));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_distance_field(&circle,
+        1, origin, .7f, width, height, 3.f, grid));
+    for (r = 0; r < height; r++) {
+        for (c = 0; c < width; c++) {
+            x = origin[0] + (c + .5f) * .7f;
+            y = origin[1] + (r + .5f) * .7f;
+            d = field_tests_dist(samples, 2001, x, y);
+            /* inside of the circle */
+            if ((x-30.f)*(x-30.f) + (y-20.f)*(y-20.f) < 100.f)
+                d = -d;
+            /* the sign is undefined next to the circle */
+            if (fabs(d) < .1f) {
+                CuAssertDblEquals(tc, fabs(d), fabs(grid[r*width + c]),
+                    field_tests_delta);
+            } else {
+                CuAssertDblEquals(tc, field_tests_clamp(d, 3.f),
+                    grid[r*width + c], field_tests_delta);
+            }
+        }
+    }
+    free(samples);
+    free(grid);
+    ts_bspline_free(&circle);
+}
+
+void field_test_lines(CuTest *tc)
+{
+    tsBSpline lines[2];
+    tsReal origin[2] = { 0.f, 0.f }, x, y, d0, d1, t;
+    float grid[40*40];
+    size_t r, c;
+
+    /* two (open) lines, the closing lines coincide: nothing is inside */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(2, 2, 1, TS_CLAMPED, lines));
+    lines[0].ctrlp[0] = 5.f;
+    lines[0].ctrlp[1] = 5.f;
+    lines[0].ctrlp[2] = 30.f;
+    lines[0].ctrlp[3] = 15.f;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_copy(lines, lines + 1));
+    lines[1].ctrlp[0] = 35.f;
+    lines[1].ctrlp[1] = 2.f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_distance_field(lines, 2,
+        origin, 1.f, 40, 40, 5.f, grid));
+    for (r = 0; r < 40; r++) {
+        for (c = 0; c < 40; c++) {
+            x = c + .5f;
+            y = r + .5f;
+            t = ((x-5.f)*25.f + (y-5.f)*10.f) / 725.f;
+            t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+            d0 = (tsReal) sqrt((x-5.f-t*25.f)*(x-5.f-t*25.f) +
+                (y-5.f-t*10.f)*(y-5.f-t*10.f));
+            t = ((x-35.f)*-5.f + (y-2.f)*13.f) / 194.f;
+            t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+            d1 = (tsReal) sqrt((x-35.f+t*5.f)*(x-35.f+t*5.f) +
+                (y-2.f-t*13.f)*(y-2.f-t*13.f));
+            CuAssertDblEquals(tc, field_tests_clamp(d0 < d1 ? d0 : d1,
+                5.f), grid[r*40 + c], field_tests_delta);
+        }
+    }
+    ts_bspline_free(lines);
+    ts_bspline_free(lines + 1);
+}
+
+void field_test_errors(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal origin[2] = { 0.f, 0.f };
+    float grid[4];
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 3, 3, TS_CLAMPED, &spline));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED, ts_bspline_distance_field(
+        &spline, 1, origin, 1.f, 2, 2, 1.f, grid));
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_field_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, field_test_circle);
+    SUITE_ADD_TEST(suite, field_test_lines);
+    SUITE_ADD_TEST(suite, field_test_errors);
+
+    return suite;
+}
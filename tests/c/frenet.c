@@ -0,0 +1,139 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <math.h>
+
+const double frenet_tests_delta = 0.001;
+
+/* Evaluates the first three derivatives of \spline at \u by deriving it. */
+void frenet_tests_ders(CuTest *tc, const tsBSpline *spline, tsReal u,
+    tsReal *ders)
+{
+    tsBSpline d1, d2, d3;
+    tsDeBoorNet net;
+    size_t d, dim = spline->dim;
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(spline, &d1));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&d1, &d2));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&d2, &d3));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&d1, u, &net));
+    for (d = 0; d < dim; d++)
+        ders[d] = net.result[d];
+    ts_deboornet_free(&net);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&d2, u, &net));
+    for (d = 0; d < dim; d++)
+        ders[dim + d] = net.result[d];
+    ts_deboornet_free(&net);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&d3, u, &net));
+    for (d = 0; d < dim; d++)
+        ders[2*dim + d] = net.result[d];
+    ts_deboornet_free(&net);
+    ts_bspline_free(&d1);
+    ts_bspline_free(&d2);
+    ts_bspline_free(&d3);
+}
+
+void frenet_test_planar(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal us[4] = { 0.f, 0.25f, 0.6f, 1.f };
+    tsReal T[8], N[8], kappa[4], curv[4], ders[6], s;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 2, 3, TS_CLAMPED, &spline));
+    spline.ctrlp[0] = 0.f; spline.ctrlp[1] = 0.f;
+    spline.ctrlp[2] = 2.f; spline.ctrlp[3] = 0.f;
+    spline.ctrlp[4] = 3.f; spline.ctrlp[5] = 1.f;
+    spline.ctrlp[6] = 2.f; spline.ctrlp[7] = 3.f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_frenet_many(&spline, us, 4,
+        T, N, NULL, kappa, NULL));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_curvature_many(&spline, us, 4, curv));
+    for (i = 0; i < 4; i++) {
+        frenet_tests_ders(tc, &spline, us[i], ders);
+        s = (tsReal) sqrt(ders[0]*ders[0] + ders[1]*ders[1]);
+        CuAssertDblEquals(tc, ders[0] / s, T[i], frenet_tests_delta);
+        CuAssertDblEquals(tc, ders[1] / s, T[4 + i], frenet_tests_delta);
+        CuAssertDblEquals(tc, -T[4 + i], N[i], frenet_tests_delta);
+        CuAssertDblEquals(tc, T[i], N[4 + i], frenet_tests_delta);
+        /* left turn: positive curvature */
+        CuAssertDblEquals(tc, (ders[0]*ders[3] - ders[1]*ders[2]) / (s*s*s),
+            kappa[i], frenet_tests_delta);
+        CuAssertTrue(tc, kappa[i] > 0.f);
+        CuAssertDblEquals(tc, kappa[i], curv[i], 0);
+    }
+    ts_bspline_free(&spline);
+}
+
+void frenet_test_spatial(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal us[5] = { 0.f, 0.2f, 0.2f, 0.7f, 0.95f };
+    tsReal T[15], N[15], B[15], kappa[5], tau[5], ders[9];
+    tsReal cx, cy, cz, l, s;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(6, 3, 3, TS_CLAMPED, &spline));
+    for (i = 0; i < 6; i++) {
+        spline.ctrlp[i*3] = (tsReal) cos(i * 1.2);
+        spline.ctrlp[i*3 + 1] = (tsReal) sin(i * 1.2);
+        spline.ctrlp[i*3 + 2] = .5f * i;
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_frenet_many(&spline, us, 5,
+        T, N, B, kappa, tau));
+    for (i = 0; i < 5; i++) {
+        frenet_tests_ders(tc, &spline, us[i], ders);
+        cx = ders[1]*ders[5] - ders[2]*ders[4];
+        cy = ders[2]*ders[3] - ders[0]*ders[5];
+        cz = ders[0]*ders[4] - ders[1]*ders[3];
+        l = (tsReal) sqrt(cx*cx + cy*cy + cz*cz);
+        s = (tsReal) sqrt(ders[0]*ders[0] + ders[1]*ders[1] +
+            ders[2]*ders[2]);
+        CuAssertDblEquals(tc, l / (s*s*s), kappa[i], frenet_tests_delta);
+        CuAssertDblEquals(tc, (cx*ders[6] + cy*ders[7] + cz*ders[8]) / (l*l),
+            tau[i], frenet_tests_delta);
+        CuAssertDblEquals(tc, cz / l, B[10 + i], frenet_tests_delta);
+        /* orthonormal frame */
+        CuAssertDblEquals(tc, 0, T[i]*N[i] + T[5+i]*N[5+i] + T[10+i]*N[10+i],
+            frenet_tests_delta);
+        CuAssertDblEquals(tc, 1, N[i]*N[i] + N[5+i]*N[5+i] + N[10+i]*N[10+i],
+            frenet_tests_delta);
+    }
+    ts_bspline_free(&spline);
+}
+
+void frenet_test_degenerate(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal u = 0.5f, N[3], kappa, tau;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(3, 3, 2, TS_CLAMPED, &spline));
+    for (i = 0; i < 9; i++)
+        spline.ctrlp[i] = (tsReal) (i / 3);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_frenet_many(&spline, &u, 1,
+        NULL, N, NULL, &kappa, &tau));
+    CuAssertDblEquals(tc, 0, kappa, frenet_tests_delta);
+    CuAssertDblEquals(tc, 0, tau, frenet_tests_delta);
+    CuAssertDblEquals(tc, 0, N[0], frenet_tests_delta);
+    ts_bspline_free(&spline);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(3, 4, 2, TS_CLAMPED, &spline));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_curvature_many(&spline, &u, 1, &kappa));
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_frenet_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, frenet_test_planar);
+    SUITE_ADD_TEST(suite, frenet_test_spatial);
+    SUITE_ADD_TEST(suite, frenet_test_degenerate);
+
+    return suite;
+}
@@ -0,0 +1,162 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double function_tests_delta = 0.0001;
+
+/* y = x^2 on [0, 2] */
+void function_tests_init_square(CuTest *tc, tsBSpline *function)
+{
+    tsReal ys[9];
+    size_t i;
+
+    for (i = 0; i < 9; i++)
+        ys[i] = (tsReal) (i*i) / 16.f;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_function_interpolate_cubic(ys, 9, 0.f, 2.f, function));
+}
+
+/* y = 1 - x on [-1, 1] (degree 2, opened knot vector) */
+void function_tests_init_line(CuTest *tc, tsBSpline *function)
+{
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(6, 1, 2, TS_OPENED, function));
+    for (i = 0; i < function->n_knots; i++)
+        function->knots[i] = -2.f + i * 0.5f;
+    /* Greville abscissae of opened uniform knots: -1.25 + i*0.5 */
+    for (i = 0; i < function->n_ctrlp; i++)
+        function->ctrlp[i] = 1.f - (-1.25f + i*0.5f);
+}
+
+void function_test_interpolate_cubic(CuTest *tc)
+{
+    tsBSpline function;
+    tsReal ys[4] = { 1.f, -2.f, 0.5f, 3.f };
+    tsReal y;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_function_interpolate_cubic(ys, 4, 1.f, 4.f, &function));
+    for (i = 0; i < 4; i++) {
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_function_evaluate(&function, 1.f + i, &y));
+        CuAssertDblEquals(tc, ys[i], y, function_tests_delta);
+    }
+    CuAssertIntEquals(tc, TS_U_UNDEFINED,
+        ts_bspline_function_evaluate(&function, 4.5f, &y));
+    ts_bspline_free(&function);
+
+    CuAssertIntEquals(tc, TS_KNOTS_DECR,
+        ts_bspline_function_interpolate_cubic(ys, 4, 1.f, 1.f, &function));
+    CuAssertPtrEquals(tc, NULL, function.ctrlp);
+    CuAssertIntEquals(tc, TS_DEG_GE_NCTRLP,
+        ts_bspline_function_interpolate_cubic(ys, 1, 0.f, 1.f, &function));
+}
+
+void function_test_add_multiply(CuTest *tc)
+{
+    tsBSpline square, line, sum, product;
+    tsReal x, y, ys, yl;
+    size_t i;
+
+    function_tests_init_square(tc, &square);
+    function_tests_init_line(tc, &line);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_function_add(&square, &line, &sum));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_function_multiply(&square, &line, &product));
+    CuAssertIntEquals(tc, 3, (int) sum.deg);
+    CuAssertIntEquals(tc, 5, (int) product.deg);
+    /* the intersection of the domains is [0, 1] */
+    CuAssertDblEquals(tc, 0, sum.knots[sum.deg], 0);
+    CuAssertDblEquals(tc, 1, sum.knots[sum.n_ctrlp], 0);
+
+    for (i = 0; i <= 20; i++) {
+        x = i / 20.f;
+        ts_bspline_function_evaluate(&square, x, &ys);
+        ts_bspline_function_evaluate(&line, x, &yl);
+        CuAssertDblEquals(tc, 1 - x, yl, function_tests_delta);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_function_evaluate(&sum, x, &y));
+        CuAssertDblEquals(tc, ys + yl, y, function_tests_delta);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_function_evaluate(&product, x, &y));
+        CuAssertDblEquals(tc, ys * yl, y, function_tests_delta);
+    }
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_function_multiply(&sum, &line, &sum));
+    ts_bspline_function_evaluate(&sum, 0.5f, &y);
+    ts_bspline_function_evaluate(&square, 0.5f, &ys);
+    CuAssertDblEquals(tc, (ys + 0.5f) * 0.5f, y, function_tests_delta);
+
+    ts_bspline_free(&square);
+    ts_bspline_free(&line);
+    ts_bspline_free(&sum);
+    ts_bspline_free(&product);
+}
+
+void function_test_antiderivative(CuTest *tc)
+{
+    tsBSpline function, antiderivative, derivative;
+    tsReal x, y, yd;
+    size_t i;
+
+    function_tests_init_line(tc, &function);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_function_antiderivative(&function, &antiderivative));
+    CuAssertIntEquals(tc, 3, (int) antiderivative.deg);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_derive(&antiderivative, &derivative));
+    for (i = 0; i <= 10; i++) {
+        x = -1.f + i / 5.f;
+        /* integral of 1 - t over [-1, x] */
+        ts_bspline_function_evaluate(&antiderivative, x, &y);
+        CuAssertDblEquals(tc, x - x*x/2 + 1.5f, y, function_tests_delta);
+        ts_bspline_function_evaluate(&derivative, x, &yd);
+        CuAssertDblEquals(tc, 1 - x, yd, function_tests_delta);
+    }
+    ts_bspline_free(&antiderivative);
+    ts_bspline_free(&derivative);
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_function_antiderivative(&function, &function));
+    ts_bspline_function_evaluate(&function, 1.f, &y);
+    CuAssertDblEquals(tc, 2, y, function_tests_delta);
+    ts_bspline_free(&function);
+}
+
+void function_test_dim(CuTest *tc)
+{
+    tsBSpline spline, function, result;
+    tsReal y;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 2, 3, TS_CLAMPED, &spline));
+    function_tests_init_line(tc, &function);
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_function_evaluate(&spline, 0.5f, &y));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_function_add(&function, &spline, &result));
+    CuAssertPtrEquals(tc, NULL, result.ctrlp);
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_function_antiderivative(&spline, &spline));
+    CuAssertIntEquals(tc, 2, (int) spline.dim);
+    ts_bspline_free(&spline);
+    ts_bspline_free(&function);
+}
+
+CuSuite* get_function_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, function_test_interpolate_cubic);
+    SUITE_ADD_TEST(suite, function_test_add_multiply);
+    SUITE_ADD_TEST(suite, function_test_antiderivative);
+    SUITE_ADD_TEST(suite, function_test_dim);
+
+    return suite;
+}
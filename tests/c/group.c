@@ -0,0 +1,173 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <math.h>
+
+const double group_tests_delta = 0.0001;
+
+/* Creates 8 cubic splines in 3D whose control points and inner knots
+ * differ per lane. */
+void group_tests_init(CuTest *tc, tsBSpline *splines)
+{
+    size_t w, i;
+
+    for (w = 0; w < 8; w++) {
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_new(10, 3, 3, TS_CLAMPED, splines + w));
+        for (i = 0; i < 30; i++)
+            splines[w].ctrlp[i] = (tsReal) sin(i * 0.3 + w);
+        splines[w].knots[5] += 0.01f * w;
+    }
+}
+
+void group_test_evaluate(CuTest *tc)
+{
+    tsBSpline splines[8];
+    tsBSplineGroup group;
+    tsReal us[8], points[3*8], point[3];
+    size_t w, i, d;
+
+    group_tests_init(tc, splines);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_group_new(splines, 8, TS_PACKED, &group));
+    CuAssertIntEquals(tc, 8, (int) group.n_lanes);
+    CuAssertDblEquals(tc, splines[2].ctrlp[4], group.ctrlp[4*8 + 2], 0);
+    CuAssertDblEquals(tc, splines[7].knots[5], group.knots[5*8 + 7], 0);
+
+    for (i = 0; i < 97; i++) {
+        for (w = 0; w < 8; w++)
+            us[w] = (tsReal) fmod((i + 0.5) / 97.0 + w * 0.13, 1.0);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_group_evaluate(&group, us, points));
+        for (w = 0; w < 8; w++) {
+            CuAssertIntEquals(tc, TS_SUCCESS,
+                ts_bspline_evaluate_many(splines + w, us + w, 1, point));
+            for (d = 0; d < 3; d++) {
+                CuAssertDblEquals(tc, point[d], points[d*8 + w],
+                    group_tests_delta);
+            }
+        }
+    }
+
+    /* knot values outside of the domain are clamped */
+    for (w = 0; w < 8; w++)
+        us[w] = w % 2 ? 2.f : -1.f;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_group_evaluate(&group, us, points));
+    CuAssertDblEquals(tc, splines[0].ctrlp[0], points[0],
+        group_tests_delta);
+    CuAssertDblEquals(tc, splines[1].ctrlp[27], points[1],
+        group_tests_delta);
+
+    ts_bspline_group_free(&group);
+    CuAssertPtrEquals(tc, NULL, group.ctrlp);
+    for (w = 0; w < 8; w++)
+        ts_bspline_free(splines + w);
+}
+
+void group_test_lane(CuTest *tc)
+{
+    tsBSpline splines[8], lane;
+    tsBSplineGroup group;
+    size_t w, i;
+
+    group_tests_init(tc, splines);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_group_new(splines, 5, TS_PACKED, &group));
+    for (w = 0; w < 5; w++) {
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_group_lane(&group, w, &lane));
+        CuAssertIntEquals(tc, 10, (int) lane.n_ctrlp);
+        CuAssertIntEquals(tc, 3, (int) lane.deg);
+        for (i = 0; i < 30; i++)
+            CuAssertDblEquals(tc, splines[w].ctrlp[i], lane.ctrlp[i], 0);
+        for (i = 0; i < 14; i++)
+            CuAssertDblEquals(tc, splines[w].knots[i], lane.knots[i], 0);
+        ts_bspline_free(&lane);
+    }
+    CuAssertIntEquals(tc, TS_INDEX_ERROR,
+        ts_bspline_group_lane(&group, 5, &lane));
+    CuAssertPtrEquals(tc, NULL, lane.ctrlp);
+    ts_bspline_group_free(&group);
+
+    /* lanes must be compatible and valid */
+    CuAssertIntEquals(tc, TS_DIM_ZERO,
+        ts_bspline_group_new(splines, 0, TS_PACKED, &group));
+    splines[3].knots[6] = 0.f;
+    CuAssertIntEquals(tc, TS_KNOTS_DECR,
+        ts_bspline_group_new(splines, 8, TS_PACKED, &group));
+    CuAssertPtrEquals(tc, NULL, group.ctrlp);
+    ts_bspline_free(splines + 3);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(11, 3, 3, TS_CLAMPED, splines + 3));
+    CuAssertIntEquals(tc, TS_INCOMPATIBLE,
+        ts_bspline_group_new(splines, 8, TS_PACKED, &group));
+    for (w = 0; w < 8; w++)
+        ts_bspline_free(splines + w);
+}
+
+void group_test_aligned(CuTest *tc)
+{
+    const size_t per = TS_ALIGNMENT / sizeof(tsReal);
+    tsBSpline splines[8], lane;
+    tsBSplineGroup group;
+    tsReal us[5], points[3*5], point[3];
+    size_t w, i, d;
+
+    group_tests_init(tc, splines);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_group_new(
+        splines, 5, TS_ALIGNED, &group));
+    CuAssertIntEquals(tc, 0, (int) ((size_t) group.ctrlp % TS_ALIGNMENT));
+    CuAssertIntEquals(tc, 0, (int) ((size_t) group.knots % TS_ALIGNMENT));
+    CuAssertIntEquals(tc, (int) per, (int) group.pitch);
+    CuAssertIntEquals(tc, TS_ALIGNED, group.flags);
+
+    /* padding lanes repeat the last lane */
+    for (i = 0; i < 10; i++) {
+        for (w = 0; w < per; w++) {
+            CuAssertDblEquals(tc, splines[w < 5 ? w : 4].ctrlp[i*3 + 1],
+                group.ctrlp[(i*3 + 1)*per + w], 0);
+        }
+    }
+    for (w = 5; w < per; w++)
+        CuAssertDblEquals(tc, splines[4].knots[5], group.knots[5*per + w], 0);
+
+    for (i = 0; i < 31; i++) {
+        for (w = 0; w < 5; w++)
+            us[w] = (tsReal) fmod((i + 0.5) / 31.0 + w * 0.17, 1.0);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_group_evaluate(&group, us, points));
+        for (w = 0; w < 5; w++) {
+            CuAssertIntEquals(tc, TS_SUCCESS,
+                ts_bspline_evaluate_many(splines + w, us + w, 1, point));
+            for (d = 0; d < 3; d++) {
+                CuAssertDblEquals(tc, point[d], points[d*5 + w],
+                    group_tests_delta);
+            }
+        }
+    }
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_group_lane(&group, 3, &lane));
+    CuAssertIntEquals(tc, TS_ALIGNED, lane.flags);
+    CuAssertIntEquals(tc, 0, (int) ((size_t) lane.knots % TS_ALIGNMENT));
+    for (i = 0; i < 30; i++)
+        CuAssertDblEquals(tc, splines[3].ctrlp[i], lane.ctrlp[i], 0);
+    for (i = 0; i < 14; i++)
+        CuAssertDblEquals(tc, splines[3].knots[i], lane.knots[i], 0);
+    ts_bspline_free(&lane);
+    ts_bspline_group_free(&group);
+    CuAssertPtrEquals(tc, NULL, group.ctrlp);
+    CuAssertIntEquals(tc, TS_PACKED, group.flags);
+    for (w = 0; w < 8; w++)
+        ts_bspline_free(splines + w);
+}
+
+CuSuite* get_group_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, group_test_evaluate);
+    SUITE_ADD_TEST(suite, group_test_lane);
+    SUITE_ADD_TEST(suite, group_test_aligned);
+
+    return suite;
+}
@@ -0,0 +1,190 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <stdlib.h>
+#include <math.h>
+
+const double integrate_tests_delta = 0.0001;
+
+tsReal integrate_tests_one(tsReal u, const tsReal *point,
+    const tsReal *derivative, size_t dim, void *ctx)
+{
+    (void) u; (void) point; (void) derivative; (void) dim; (void) ctx;
+    return 1.f;
+}
+
+/* x * |C'(u)|, scaled by *(tsReal *)ctx */
+tsReal integrate_tests_x(tsReal u, const tsReal *point,
+    const tsReal *derivative, size_t dim, void *ctx)
+{
+    (void) u; (void) dim;
+    return *((tsReal *) ctx) * point[0] * (tsReal) sqrt(
+        derivative[0]*derivative[0] + derivative[1]*derivative[1]);
+}
+
+/* the component *(size_t *)ctx of C(u) */
+tsReal integrate_tests_component(tsReal u, const tsReal *point,
+    const tsReal *derivative, size_t dim, void *ctx)
+{
+    (void) u; (void) derivative; (void) dim;
+    return point[*((size_t *) ctx)];
+}
+
+void integrate_test_line(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal length, result, scale = 2.f;
+
+    /* a non-uniformly parametrized line from (0, 0) to (6, 0) */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 2, 3, TS_CLAMPED, &spline));
+    spline.ctrlp[0] = 0.f; spline.ctrlp[1] = 0.f;
+    spline.ctrlp[2] = 1.f; spline.ctrlp[3] = 0.f;
+    spline.ctrlp[4] = 5.f; spline.ctrlp[5] = 0.f;
+    spline.ctrlp[6] = 6.f; spline.ctrlp[7] = 0.f;
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_length(&spline, 1e-5f,
+        &length));
+    CuAssertDblEquals(tc, 6, length, integrate_tests_delta);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_integrate(&spline,
+        integrate_tests_one, NULL, 1e-5f, &result));
+    CuAssertDblEquals(tc, 1, result, integrate_tests_delta);
+
+    /* 2 * (integral of x ds from 0 to 6) */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_integrate(&spline,
+        integrate_tests_x, &scale, 1e-5f, &result));
+    CuAssertDblEquals(tc, 36, result, 0.001);
+    ts_bspline_free(&spline);
+}
+
+void integrate_test_length(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal *points, length, polyline = 0.f, dx, dy;
+    const size_t n = 20001;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(9, 2, 3, TS_CLAMPED, &spline));
+    for (i = 0; i < 9; i++) {
+        spline.ctrlp[i*2] = (tsReal) i;
+        spline.ctrlp[i*2 + 1] = (tsReal) ((i*i) % 5);
+    }
+    points = (tsReal *) malloc(n * 2 * sizeof(tsReal));
+    CuAssertPtrNotNull(tc, points);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sample(&spline, n, points));
+    for (i = 1; i < n; i++) {
+        dx = points[i*2] - points[(i-1)*2];
+        dy = points[i*2 + 1] - points[(i-1)*2 + 1];
+        polyline += (tsReal) sqrt(dx*dx + dy*dy);
+    }
+    free(points);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_length(&spline, 1e-5f,
+        &length));
+    /* the polyline is slightly shorter than the spline */
+    CuAssertDblEquals(tc, polyline, length, 0.001);
+    CuAssertTrue(tc, length >= polyline - 0.0001f);
+    ts_bspline_free(&spline);
+}
+
+void integrate_test_large_coordinates(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal *points, length, polyline = 0.f, dx, dy;
+    const size_t n = 20001;
+    size_t i;
+
+    /* FLT_MAX_ABS_ERROR is below the precision of these coordinates */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(40, 2, 3, TS_CLAMPED, &spline));
+    for (i = 0; i < 40; i++) {
+        spline.ctrlp[i*2] = i * 100.f;
+        spline.ctrlp[i*2 + 1] = i % 2 ? 300.f : -300.f;
+    }
+    points = (tsReal *) malloc(n * 2 * sizeof(tsReal));
+    CuAssertPtrNotNull(tc, points);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sample(&spline, n, points));
+    for (i = 1; i < n; i++) {
+        dx = points[i*2] - points[(i-1)*2];
+        dy = points[i*2 + 1] - points[(i-1)*2 + 1];
+        polyline += (tsReal) sqrt(dx*dx + dy*dy);
+    }
+    free(points);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_length(&spline, 0.f,
+        &length));
+    CuAssertDblEquals(tc, polyline, length, polyline * 1e-4);
+    ts_bspline_free(&spline);
+}
+
+void integrate_test_integral(CuTest *tc)
+{
+    tsBSpline spline, integral, derivative;
+    tsDeBoorNet net, ref;
+    tsReal result, lo;
+    size_t i, d;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(7, 2, 3, TS_CLAMPED, &spline));
+    for (i = 0; i < 7; i++) {
+        spline.ctrlp[i*2] = (tsReal) i;
+        spline.ctrlp[i*2 + 1] = (tsReal) ((i*i) % 5);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_integral(&spline,
+        &integral));
+    CuAssertIntEquals(tc, 4, (int) integral.deg);
+    CuAssertIntEquals(tc, 8, (int) integral.n_ctrlp);
+    CuAssertIntEquals(tc, 13, (int) integral.n_knots);
+
+    /* the derivative of the integral is the original spline */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&integral,
+        &derivative));
+    for (i = 0; i <= 10; i++) {
+        ts_bspline_evaluate(&spline, i / 10.f, &ref);
+        ts_bspline_evaluate(&derivative, i / 10.f, &net);
+        for (d = 0; d < 2; d++) {
+            CuAssertDblEquals(tc, ref.result[d], net.result[d],
+                integrate_tests_delta);
+        }
+        ts_deboornet_free(&ref);
+        ts_deboornet_free(&net);
+    }
+    ts_bspline_free(&derivative);
+
+    /* definite integrals are differences of two evaluations */
+    ts_bspline_evaluate(&integral, 0.f, &net);
+    CuAssertDblEquals(tc, 0, net.result[0], 0);
+    CuAssertDblEquals(tc, 0, net.result[1], 0);
+    ts_deboornet_free(&net);
+    ts_bspline_evaluate(&integral, 0.25f, &net);
+    lo = net.result[1];
+    ts_deboornet_free(&net);
+    ts_bspline_evaluate(&integral, 1.f, &net);
+    d = 1;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_integrate(&spline,
+        integrate_tests_component, &d, 1e-6f, &result));
+    CuAssertDblEquals(tc, result, net.result[1], integrate_tests_delta);
+    ts_deboornet_free(&net);
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_integral(&spline, &spline));
+    ts_bspline_evaluate(&spline, 0.25f, &net);
+    CuAssertDblEquals(tc, lo, net.result[1], 0);
+    ts_deboornet_free(&net);
+
+    ts_bspline_free(&spline);
+    ts_bspline_free(&integral);
+}
+
+CuSuite* get_integrate_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, integrate_test_line);
+    SUITE_ADD_TEST(suite, integrate_test_length);
+    SUITE_ADD_TEST(suite, integrate_test_large_coordinates);
+    SUITE_ADD_TEST(suite, integrate_test_integral);
+
+    return suite;
+}
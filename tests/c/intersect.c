@@ -0,0 +1,155 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <stdlib.h>
+#include <math.h>
+
+const double intersect_tests_delta = 0.01;
+
+/* Interpolates \n points of (a*t - b*sin(t), c*cos(t) + d*sin(t)*cos(t))
+ * with t in [t0, t1]. */
+void intersect_tests_init(CuTest *tc, size_t n, tsReal t0, tsReal t1,
+    tsReal a, tsReal b, tsReal c, tsReal d, tsBSpline *spline)
+{
+    tsReal *pts, t;
+    size_t i;
+
+    pts = (tsReal *) malloc(n * 2 * sizeof(tsReal));
+    CuAssertPtrNotNull(tc, pts);
+    for (i = 0; i < n; i++) {
+        t = t0 + (t1-t0) * i / (n-1);
+        pts[i*2] = a*t - b * (tsReal) sin(t);
+        pts[i*2 + 1] = c * (tsReal) cos(t) + d * (tsReal) (sin(t) * cos(t));
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_interpolate_cubic(pts, n, 2, spline));
+    free(pts);
+}
+
+/* Asserts that \us contains \n pairs (u, v), u < v, sorted by u, with
+ * C(u) = C(v). */
+void intersect_tests_check(CuTest *tc, const tsBSpline *spline,
+    const tsReal *us, size_t n)
+{
+    tsReal p[2], q[2];
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        CuAssertTrue(tc, us[i*2] < us[i*2 + 1]);
+        if (i > 0)
+            CuAssertTrue(tc, us[(i-1)*2] < us[i*2]);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate_many(spline, us + i*2, 1, p));
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate_many(spline, us + i*2 + 1, 1, q));
+        CuAssertDblEquals(tc, p[0], q[0], intersect_tests_delta);
+        CuAssertDblEquals(tc, p[1], q[1], intersect_tests_delta);
+    }
+}
+
+void intersect_test_figure_eight(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal *us;
+    size_t n;
+
+    /* lemniscate of Gerono, crossing itself at the origin (t = 0, pi) */
+    intersect_tests_init(tc, 41, -1.f, 4.f, 0.f, -1.f, 0.f, 1.f, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_self_intersections(&spline, 1e-4f, &us, &n));
+    CuAssertIntEquals(tc, 1, (int) n);
+    intersect_tests_check(tc, &spline, us, n);
+    free(us);
+    ts_bspline_free(&spline);
+}
+
+void intersect_test_loops(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal *us, p[2];
+    size_t n, i;
+
+    /* prolate cycloid with loops at t = 2pi, 4pi and 6pi */
+    intersect_tests_init(tc, 301, 3.2f, 21.f, 1.f, 2.f, -2.f, 0.f,
+        &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_self_intersections(&spline, 1e-4f, &us, &n));
+    CuAssertIntEquals(tc, 3, (int) n);
+    intersect_tests_check(tc, &spline, us, n);
+    for (i = 0; i < n; i++) {
+        ts_bspline_evaluate_many(&spline, us + i*2, 1, p);
+        CuAssertDblEquals(tc, 2*3.14159265 * (i+1), p[0], 0.05);
+    }
+    free(us);
+    ts_bspline_free(&spline);
+}
+
+void intersect_test_single_piece(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal *us;
+    size_t n;
+    tsReal ctrlp[8] = { 0.f, 0.f, 3.f, 2.f, -1.f, 2.f, 2.f, 0.f };
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 2, 3, TS_BEZIERS, &spline));
+    ts_bspline_set_ctrlp(&spline, ctrlp, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_self_intersections(&spline, 1e-4f, &us, &n));
+    CuAssertIntEquals(tc, 1, (int) n);
+    intersect_tests_check(tc, &spline, us, n);
+    free(us);
+    ts_bspline_free(&spline);
+}
+
+void intersect_test_none(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal *us;
+    size_t n;
+
+    /* sine wave */
+    intersect_tests_init(tc, 101, 0.f, 20.f, 1.f, 0.f, 0.f, 0.f, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_self_intersections(&spline, 1e-4f, &us, &n));
+    CuAssertIntEquals(tc, 0, (int) n);
+    CuAssertPtrEquals(tc, NULL, us);
+    ts_bspline_free(&spline);
+
+    /* closed circle: the closing joint is not an intersection */
+    intersect_tests_init(tc, 33, 0.f, 2*3.14159265f, 0.f, -1.f, 1.f, 0.f,
+        &spline);
+    spline.ctrlp[spline.n_ctrlp*2 - 2] = spline.ctrlp[0];
+    spline.ctrlp[spline.n_ctrlp*2 - 1] = spline.ctrlp[1];
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_self_intersections(&spline, 1e-4f, &us, &n));
+    CuAssertIntEquals(tc, 0, (int) n);
+    ts_bspline_free(&spline);
+}
+
+void intersect_test_errors(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal *us;
+    size_t n;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(5, 3, 3, TS_CLAMPED, &spline));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_self_intersections(&spline, 1e-4f, &us, &n));
+    CuAssertPtrEquals(tc, NULL, us);
+    CuAssertIntEquals(tc, 0, (int) n);
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_intersect_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, intersect_test_figure_eight);
+    SUITE_ADD_TEST(suite, intersect_test_loops);
+    SUITE_ADD_TEST(suite, intersect_test_single_piece);
+    SUITE_ADD_TEST(suite, intersect_test_none);
+    SUITE_ADD_TEST(suite, intersect_test_errors);
+
+    return suite;
+}
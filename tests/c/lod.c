@@ -0,0 +1,121 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <math.h>
+
+const double lod_tests_delta = 0.0001;
+
+/* The maximum distance of \a and \b at knot values that keep away from
+ * the knots of both splines (evaluation snaps to nearby knots). */
+tsReal lod_tests_deviation(CuTest *tc, tsBSpline *a, tsBSpline *b)
+{
+    tsReal u, pa[2], pb[2], d, max = 0.f;
+    size_t i;
+
+    for (i = 0; i < 997; i++) {
+        u = (i + 0.5f) / 997.f;
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate_many(a, &u, 1, pa));
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate_many(b, &u, 1, pb));
+        d = (tsReal) sqrt((pa[0]-pb[0])*(pa[0]-pb[0]) +
+            (pa[1]-pb[1])*(pa[1]-pb[1]));
+        max = d > max ? d : max;
+    }
+    return max;
+}
+
+void lod_test_pyramid(CuTest *tc)
+{
+    tsBSpline spline;
+    tsBSplineLOD lod;
+    tsReal points[2*20];
+    size_t i, k;
+
+    for (i = 0; i < 20; i++) {
+        points[i*2] = i * 0.25f;
+        points[i*2 + 1] = (tsReal) sin(i * 0.5);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_interpolate_cubic(points, 20, 2, &spline));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_lod_new(&spline, 0.001f, 12, &lod));
+    CuAssertTrue(tc, lod.n_levels > 3);
+    CuAssertTrue(tc, lod.n_levels <= 12);
+
+    /* level 0 is a copy */
+    CuAssertIntEquals(tc, (int) spline.n_ctrlp, (int) lod.levels[0].n_ctrlp);
+    CuAssertDblEquals(tc, 0, lod.errors[0], 0);
+    for (i = 0; i < spline.n_knots; i++)
+        CuAssertDblEquals(tc, spline.knots[i], lod.levels[0].knots[i], 0);
+
+    for (k = 1; k < lod.n_levels; k++) {
+        CuAssertTrue(tc, lod.levels[k].n_ctrlp < lod.levels[k-1].n_ctrlp);
+        CuAssertIntEquals(tc, (int) spline.deg, (int) lod.levels[k].deg);
+        CuAssertIntEquals(tc, (int) lod.levels[k].n_ctrlp + 4,
+            (int) lod.levels[k].n_knots);
+        CuAssertTrue(tc, lod.errors[k] <= 0.001f * 1024);
+        CuAssertTrue(tc, lod_tests_deviation(tc, &spline, lod.levels + k)
+            <= lod.errors[k] + lod_tests_delta);
+        /* the domain does not change */
+        CuAssertDblEquals(tc, 0, lod.levels[k].knots[3], 0);
+        CuAssertDblEquals(tc, 1, lod.levels[k].knots[lod.levels[k].n_ctrlp],
+            0);
+    }
+
+    /* select */
+    CuAssertIntEquals(tc, 0, (int) ts_bspline_lod_select(&lod, 1.f, 0.f));
+    CuAssertIntEquals(tc, (int) lod.n_levels - 1,
+        (int) ts_bspline_lod_select(&lod, 1.f, 1000.f));
+    k = ts_bspline_lod_select(&lod, 100.f, 0.5f);
+    CuAssertTrue(tc, lod.errors[k] * 100.f <= 0.5f);
+    CuAssertTrue(tc, k+1 == lod.n_levels ||
+        lod.errors[k+1] * 100.f > 0.5f);
+
+    ts_bspline_lod_free(&lod);
+    CuAssertPtrEquals(tc, NULL, lod.levels);
+    CuAssertPtrEquals(tc, NULL, lod.errors);
+    ts_bspline_free(&spline);
+}
+
+void lod_test_line(CuTest *tc)
+{
+    tsBSpline line;
+    tsBSplineLOD lod;
+    tsReal ctrlp[2*6];
+    size_t i;
+
+    for (i = 0; i < 6; i++) {
+        ctrlp[i*2] = (tsReal) i;
+        ctrlp[i*2 + 1] = 2.f * i;
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(6, 2, 1, TS_CLAMPED, &line));
+    ts_bspline_set_ctrlp(&line, ctrlp, &line);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_lod_new(&line, 0.001f, 4, &lod));
+    /* all interior knots are removable without error */
+    CuAssertIntEquals(tc, 2, (int) lod.n_levels);
+    CuAssertIntEquals(tc, 2, (int) lod.levels[1].n_ctrlp);
+    CuAssertDblEquals(tc, 0, lod.errors[1], lod_tests_delta);
+    CuAssertTrue(tc, lod_tests_deviation(tc, &line, lod.levels + 1)
+        <= lod_tests_delta);
+    ts_bspline_lod_free(&lod);
+
+    /* at least one level */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_lod_new(&line, 0.001f, 0, &lod));
+    CuAssertIntEquals(tc, 1, (int) lod.n_levels);
+    CuAssertIntEquals(tc, 0, (int) ts_bspline_lod_select(&lod, 1.f, 1.f));
+    ts_bspline_lod_free(&lod);
+    ts_bspline_free(&line);
+}
+
+CuSuite* get_lod_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, lod_test_pyramid);
+    SUITE_ADD_TEST(suite, lod_test_line);
+
+    return suite;
+}
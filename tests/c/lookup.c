@@ -0,0 +1,125 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double lookup_tests_delta = 0.0001;
+
+void lookup_tests_init(CuTest *tc, tsBSpline *spline, int decreasing)
+{
+    tsReal xs[6] = { 0.f, 1.f, 3.f, 3.5f, 4.f, 6.f };
+    tsReal ys[6] = { 0.f, 2.f, -1.f, 3.f, 1.f, 1.f };
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(6, 2, 3, TS_CLAMPED, spline));
+    for (i = 0; i < 6; i++) {
+        spline->ctrlp[i*2] = decreasing ? -xs[i] : xs[i];
+        spline->ctrlp[i*2 + 1] = ys[i];
+    }
+}
+
+void lookup_tests_verify(CuTest *tc, int decreasing)
+{
+    tsBSpline spline;
+    tsBSplineLookup lookup;
+    tsDeBoorNet net;
+    tsReal xs[9], ys[9], expected[9], y;
+    size_t i;
+
+    lookup_tests_init(tc, &spline, decreasing);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_lookup_new(&spline,
+        &lookup));
+    CuAssertIntEquals(tc, 3, (int) lookup.n_spans);
+    CuAssertIntEquals(tc, decreasing, lookup.decreasing);
+    CuAssertDblEquals(tc, decreasing ? -6 : 0, lookup.xs[0],
+        lookup_tests_delta);
+
+    /* reference values, sorted by x */
+    for (i = 0; i < 9; i++) {
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&spline,
+            decreasing ? 1.f - i/8.f : i/8.f, &net));
+        xs[i] = net.result[0];
+        expected[i] = net.result[1];
+        ts_deboornet_free(&net);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_lookup_many(&spline,
+        &lookup, xs, 9, ys));
+    for (i = 0; i < 9; i++) {
+        CuAssertDblEquals(tc, expected[i], ys[i], lookup_tests_delta);
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_lookup(&spline,
+            &lookup, xs[8-i], &y));
+        CuAssertDblEquals(tc, expected[8-i], y, lookup_tests_delta);
+    }
+
+    CuAssertIntEquals(tc, TS_U_UNDEFINED, ts_bspline_lookup(&spline,
+        &lookup, 7.f, &y));
+    ts_bspline_lookup_free(&lookup);
+    CuAssertPtrEquals(tc, NULL, lookup.xs);
+    ts_bspline_free(&spline);
+}
+
+void lookup_test_increasing(CuTest *tc)
+{
+    lookup_tests_verify(tc, 0);
+}
+
+void lookup_test_decreasing(CuTest *tc)
+{
+    lookup_tests_verify(tc, 1);
+}
+
+void lookup_test_small_domain(CuTest *tc)
+{
+    tsBSpline spline;
+    tsBSplineLookup lookup;
+    tsDeBoorNet net;
+    tsReal y;
+    size_t i;
+
+    /* the x-range [0, 1e-4] is below FLT_MAX_ABS_ERROR */
+    lookup_tests_init(tc, &spline, 0);
+    for (i = 0; i < 6; i++)
+        spline.ctrlp[i*2] *= 1e-4f / 6.f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_lookup_new(&spline,
+        &lookup));
+    for (i = 0; i <= 16; i++) {
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&spline,
+            i/16.f, &net));
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_lookup(&spline,
+            &lookup, net.result[0], &y));
+        CuAssertDblEquals(tc, net.result[1], y, lookup_tests_delta);
+        ts_deboornet_free(&net);
+    }
+    ts_bspline_lookup_free(&lookup);
+    ts_bspline_free(&spline);
+}
+
+void lookup_test_errors(CuTest *tc)
+{
+    tsBSpline spline;
+    tsBSplineLookup lookup;
+
+    lookup_tests_init(tc, &spline, 0);
+    spline.ctrlp[4] = 0.5f; /* x: 0, 1, 0.5, ... */
+    CuAssertIntEquals(tc, TS_NOT_MONOTONE, ts_bspline_lookup_new(&spline,
+        &lookup));
+    CuAssertPtrEquals(tc, NULL, lookup.xs);
+    ts_bspline_free(&spline);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 3, 3, TS_CLAMPED, &spline));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED, ts_bspline_lookup_new(&spline,
+        &lookup));
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_lookup_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, lookup_test_increasing);
+    SUITE_ADD_TEST(suite, lookup_test_decreasing);
+    SUITE_ADD_TEST(suite, lookup_test_small_domain);
+    SUITE_ADD_TEST(suite, lookup_test_errors);
+
+    return suite;
+}
@@ -0,0 +1,264 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double mutate_tests_delta = 0.0001;
+
+void mutate_tests_init(CuTest *tc, tsBSpline *spline)
+{
+    size_t i;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(12, 2, 3, TS_CLAMPED, spline));
+    for (i = 0; i < spline->n_ctrlp; i++) {
+        spline->ctrlp[i*2] = (tsReal) i;
+        spline->ctrlp[i*2 + 1] = (tsReal) ((i*7) % 5);
+    }
+}
+
+void mutate_test_set_ctrlp_range(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal values[4] = { 1.f, 2.f, 3.f, 4.f };
+    size_t first;
+
+    mutate_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, 0, (int) spline.generation);
+    CuAssertIntEquals(tc, 0, (int) ts_bspline_dirty(&spline, &first));
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_ctrlp_range(&spline, 5, 2, values));
+    CuAssertDblEquals(tc, 1, spline.ctrlp[5*2], 0);
+    CuAssertDblEquals(tc, 4, spline.ctrlp[6*2 + 1], 0);
+    CuAssertDblEquals(tc, 4, spline.ctrlp[4*2], 0);
+    CuAssertIntEquals(tc, 1, (int) spline.generation);
+    /* control points 5 and 6 affect the knot intervals 5..9 */
+    CuAssertIntEquals(tc, 5, (int) ts_bspline_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 5, (int) first);
+
+    /* dirty ranges are merged and clamped to the domain */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_ctrlp_range(&spline, 0, 1, values));
+    CuAssertIntEquals(tc, 2, (int) spline.generation);
+    CuAssertIntEquals(tc, 7, (int) ts_bspline_take_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 3, (int) first);
+    CuAssertIntEquals(tc, 0, (int) ts_bspline_take_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 0, (int) first);
+
+    /* invalid ranges do not modify the spline */
+    CuAssertIntEquals(tc, TS_INDEX_ERROR,
+        ts_bspline_set_ctrlp_range(&spline, 11, 2, values));
+    CuAssertIntEquals(tc, TS_INDEX_ERROR,
+        ts_bspline_set_ctrlp_range(&spline, (size_t) -1, 2, values));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_ctrlp_range(&spline, 12, 0, values));
+    CuAssertDblEquals(tc, 11, spline.ctrlp[11*2], 0);
+    CuAssertIntEquals(tc, 2, (int) spline.generation);
+    CuAssertIntEquals(tc, 0, (int) ts_bspline_dirty(&spline, &first));
+
+    /* replacing all control points marks the whole domain */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_ctrlp(&spline, spline.ctrlp, &spline));
+    CuAssertIntEquals(tc, 3, (int) spline.generation);
+    CuAssertIntEquals(tc, 9, (int) ts_bspline_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 3, (int) first);
+    ts_bspline_free(&spline);
+    CuAssertIntEquals(tc, 0, (int) spline.generation);
+}
+
+void mutate_test_set_knot(CuTest *tc)
+{
+    tsBSpline spline;
+    size_t first;
+
+    mutate_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_knot(&spline, 7, 0.4f));
+    CuAssertDblEquals(tc, 0.4, spline.knots[7], mutate_tests_delta);
+    CuAssertIntEquals(tc, 1, (int) spline.generation);
+    /* knot 7 affects the knot intervals 3..10 */
+    CuAssertIntEquals(tc, 8, (int) ts_bspline_take_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 3, (int) first);
+
+    /* monotonicity and multiplicity are validated */
+    CuAssertIntEquals(tc, TS_KNOTS_DECR,
+        ts_bspline_set_knot(&spline, 7, 0.2f));
+    CuAssertIntEquals(tc, TS_KNOTS_DECR,
+        ts_bspline_set_knot(&spline, 7, 0.6f));
+    CuAssertIntEquals(tc, TS_MULTIPLICITY,
+        ts_bspline_set_knot(&spline, 4, 0.f));
+    CuAssertIntEquals(tc, TS_INDEX_ERROR,
+        ts_bspline_set_knot(&spline, 16, 1.f));
+    CuAssertDblEquals(tc, 0.4, spline.knots[7], mutate_tests_delta);
+    CuAssertIntEquals(tc, 1, (int) spline.generation);
+    CuAssertIntEquals(tc, 0, (int) ts_bspline_dirty(&spline, &first));
+
+    /* the last knot affects the last knot interval only */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_knot(&spline, 15, 2.f));
+    CuAssertIntEquals(tc, 1, (int) ts_bspline_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 11, (int) first);
+    ts_bspline_free(&spline);
+}
+
+void mutate_test_tessellation_update(CuTest *tc)
+{
+    tsBSpline spline;
+    tsTessellation tess, fresh;
+    tsReal value[2] = { 5.f, 7.f };
+    size_t from, count, i;
+
+    mutate_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 4, &tess));
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_ctrlp_range(&spline, 6, 1, value));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_update(&tess, &spline, &from, &count));
+    CuAssertIntEquals(tc, 3*4, (int) from);
+    CuAssertIntEquals(tc, 4*4, (int) count);
+    /* the range is left to the owner of the spline */
+    CuAssertIntEquals(tc, 4, (int) ts_bspline_dirty(&spline, &from));
+    ts_bspline_take_dirty(&spline, &from);
+
+    /* nothing to do */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_update(&tess, &spline, &from, &count));
+    CuAssertIntEquals(tc, 0, (int) count);
+
+    /* an empty knot interval requires a new tessellation */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_knot(&spline, 8, spline.knots[7]));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_update(&tess, &spline, &from, &count));
+    CuAssertIntEquals(tc, 8, (int) tess.n_spans);
+    CuAssertIntEquals(tc, (int) tess.n_points, (int) count);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 4, &fresh));
+    CuAssertIntEquals(tc, (int) fresh.n_points, (int) tess.n_points);
+    for (i = 0; i < fresh.n_points*2; i++) {
+        CuAssertDblEquals(tc, fresh.points[i], tess.points[i],
+            mutate_tests_delta);
+    }
+    ts_tessellation_free(&fresh);
+    ts_tessellation_free(&tess);
+    ts_bspline_free(&spline);
+}
+
+void mutate_test_derived(CuTest *tc)
+{
+    tsBSpline spline, result;
+    tsTessellation tess, fresh;
+    const tsReal matrix[9] = { 2.f, 0.f, 1.f, 0.f, 2.f, 1.f, 0.f, 0.f, 1.f };
+    tsReal value[2] = { 5.f, 7.f };
+    size_t from, count, first, k, i;
+
+    mutate_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 4, &tess));
+
+    /* in place transformations mark the whole domain */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_transform(&spline, matrix, TS_AFFINE, &spline));
+    CuAssertIntEquals(tc, 1, (int) spline.generation);
+    CuAssertIntEquals(tc, 9, (int) ts_bspline_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 3, (int) first);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_update(&tess, &spline, &from, &count));
+    CuAssertIntEquals(tc, 0, (int) from);
+    CuAssertIntEquals(tc, (int) tess.n_points, (int) count);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 4, &fresh));
+    for (i = 0; i < fresh.n_points*2; i++) {
+        CuAssertDblEquals(tc, fresh.points[i], tess.points[i],
+            mutate_tests_delta);
+    }
+    ts_tessellation_free(&fresh);
+    ts_tessellation_free(&tess);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_buckle(&spline, 0.5f, &spline));
+    CuAssertIntEquals(tc, 2, (int) spline.generation);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_lerp(&spline, &spline, 0.5f, &spline));
+    CuAssertIntEquals(tc, 3, (int) spline.generation);
+
+    /* The dirty range of a spline with a different structure is not
+     * copied, the whole domain of the result is dirty. */
+    ts_bspline_take_dirty(&spline, &first);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_ctrlp_range(&spline, 0, 1, value));
+    CuAssertIntEquals(tc, 1, (int) ts_bspline_dirty(&spline, &first));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_insert_knot(&spline, 0.5f, 1, &result, &k));
+    CuAssertIntEquals(tc, 5, (int) result.generation);
+    CuAssertIntEquals(tc, 10, (int) ts_bspline_dirty(&result, &first));
+    CuAssertIntEquals(tc, 3, (int) first);
+    ts_bspline_free(&result);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&spline, &spline));
+    CuAssertIntEquals(tc, 5, (int) spline.generation);
+    CuAssertIntEquals(tc, 9, (int) ts_bspline_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 2, (int) first);
+    ts_bspline_free(&spline);
+}
+
+void mutate_test_observers(CuTest *tc)
+{
+    tsBSpline spline;
+    tsTessellation fine, coarse, fresh;
+    tsReal value[2] = { 5.f, 7.f };
+    size_t from, count, first, i;
+
+    mutate_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 8, &fine));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 2, &coarse));
+
+    /* both observers patch the same range */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_set_ctrlp_range(&spline, 6, 1, value));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_update(&fine, &spline, &from, &count));
+    CuAssertIntEquals(tc, 3*8, (int) from);
+    CuAssertIntEquals(tc, 4*8, (int) count);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_update(&coarse, &spline, &from, &count));
+    CuAssertIntEquals(tc, 3*2, (int) from);
+    CuAssertIntEquals(tc, 4*2, (int) count);
+    CuAssertIntEquals(tc, 4, (int) ts_bspline_take_dirty(&spline, &first));
+    CuAssertIntEquals(tc, 6, (int) first);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 8, &fresh));
+    for (i = 0; i < fresh.n_points*2; i++) {
+        CuAssertDblEquals(tc, fresh.points[i], fine.points[i],
+            mutate_tests_delta);
+    }
+    ts_tessellation_free(&fresh);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 2, &fresh));
+    for (i = 0; i < fresh.n_points*2; i++) {
+        CuAssertDblEquals(tc, fresh.points[i], coarse.points[i],
+            mutate_tests_delta);
+    }
+    ts_tessellation_free(&fresh);
+
+    ts_tessellation_free(&fine);
+    ts_tessellation_free(&coarse);
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_mutate_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, mutate_test_set_ctrlp_range);
+    SUITE_ADD_TEST(suite, mutate_test_set_knot);
+    SUITE_ADD_TEST(suite, mutate_test_tessellation_update);
+    SUITE_ADD_TEST(suite, mutate_test_derived);
+    SUITE_ADD_TEST(suite, mutate_test_observers);
+
+    return suite;
+}
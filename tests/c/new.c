@@ -2,6 +2,7 @@
 #include "CuTest.h"
 #include "utils.h"
 #include <stdint.h>
+#include <string.h>
 
 void new_test_bspline_zero_dim(CuTest* tc)
 {
@@ -127,6 +128,62 @@ void new_test_bspline_beziers_setup_failed(CuTest* tc)
     ctests_assert_default_bspline(tc, &bspline);
 }
 
+void new_test_bspline_aligned(CuTest* tc)
+{
+    const size_t per = TS_ALIGNMENT / sizeof(tsReal);
+    tsBSpline packed, aligned, copy;
+    unsigned char a[512], b[512];
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(7, 3, 3, TS_CLAMPED, &packed));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new_layout(7, 3, 3, TS_CLAMPED, TS_ALIGNED, &aligned));
+    CuAssertIntEquals(tc, TS_PACKED, packed.flags);
+    CuAssertIntEquals(tc, TS_ALIGNED, aligned.flags);
+    CuAssertIntEquals(tc, 0, (int) ((size_t) aligned.ctrlp % TS_ALIGNMENT));
+    CuAssertIntEquals(tc, 0, (int) ((size_t) aligned.knots % TS_ALIGNMENT));
+    CuAssertIntEquals(tc, (int) ((21 + per-1) / per * per),
+        (int) (aligned.knots - aligned.ctrlp));
+    for (i = 0; i < 21; i++)
+        packed.ctrlp[i] = aligned.ctrlp[i] = (tsReal) i;
+    for (i = 0; i < 11; i++)
+        CuAssertDblEquals(tc, packed.knots[i], aligned.knots[i], 0);
+
+    /* the knots are serialized right after the control points */
+    memset(a, 0, 512);
+    memset(b, 0, 512);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_serialize(&packed, a, 512));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_serialize(&aligned, b, 512));
+    CuAssertTrue(tc, memcmp(a, b, 512) == 0);
+
+    /* copies and in place modifications keep the layout */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_copy(&aligned, &copy));
+    CuAssertIntEquals(tc, TS_ALIGNED, copy.flags);
+    CuAssertIntEquals(tc, 0, (int) ((size_t) copy.knots % TS_ALIGNMENT));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_resize(&copy, 3, 1, &copy));
+    CuAssertIntEquals(tc, TS_ALIGNED, copy.flags);
+    CuAssertIntEquals(tc, 0, (int) ((size_t) copy.ctrlp % TS_ALIGNMENT));
+    CuAssertIntEquals(tc, 0, (int) ((size_t) copy.knots % TS_ALIGNMENT));
+    for (i = 0; i < 21; i++)
+        CuAssertDblEquals(tc, aligned.ctrlp[i], copy.ctrlp[i], 0);
+    for (i = 0; i < 11; i++)
+        CuAssertDblEquals(tc, aligned.knots[i], copy.knots[i], 0);
+    ts_bspline_free(&copy);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&packed, &packed));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&aligned, &aligned));
+    CuAssertIntEquals(tc, TS_ALIGNED, aligned.flags);
+    CuAssertIntEquals(tc, 0, (int) ((size_t) aligned.knots % TS_ALIGNMENT));
+    for (i = 0; i < 18; i++)
+        CuAssertDblEquals(tc, packed.ctrlp[i], aligned.ctrlp[i], 0);
+    for (i = 0; i < 9; i++)
+        CuAssertDblEquals(tc, packed.knots[i], aligned.knots[i], 0);
+
+    ts_bspline_free(&packed);
+    ts_bspline_free(&aligned);
+    ctests_assert_default_bspline(tc, &aligned);
+}
+
 CuSuite* get_new_suite()
 {
     CuSuite* suite = CuSuiteNew();
@@ -136,6 +193,7 @@ CuSuite* get_new_suite()
     SUITE_ADD_TEST(suite, new_test_bspline_deg_equals_nctrlp);
     SUITE_ADD_TEST(suite, new_test_bspline_malloc_failed);
     SUITE_ADD_TEST(suite, new_test_bspline_beziers_setup_failed);
+    SUITE_ADD_TEST(suite, new_test_bspline_aligned);
 
     return suite;
 }
@@ -0,0 +1,201 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <stdlib.h>
+#include <math.h>
+
+const double offset_tests_delta = 0.001;
+
+/* The minimum distance of (x, y) to the polyline \pts of \n points. */
+tsReal offset_tests_dist(const tsReal *pts, size_t n, tsReal x, tsReal y)
+{
+    tsReal min = -1.f, dx, dy, ex, ey, t, dist;
+    size_t i;
+
+    for (i = 0; i+1 < n; i++) {
+        ex = pts[(i+1)*2] - pts[i*2];
+        ey = pts[(i+1)*2 + 1] - pts[i*2 + 1];
+        dx = x - pts[i*2];
+        dy = y - pts[i*2 + 1];
+        t = (ex*ex + ey*ey) > 0.f ? (dx*ex + dy*ey) / (ex*ex + ey*ey) : 0.f;
+        t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+        dx -= t*ex;
+        dy -= t*ey;
+        dist = (tsReal) sqrt(dx*dx + dy*dy);
+        if (min < 0.f || dist < min)
+            min = dist;
+    }
+    return min;
+}
+
+/* Asserts that each sample of \offset has distance |d| to the polyline
+ * \pts of \n points. */
+void offset_tests_check(CuTest *tc, const tsBSpline *offset,
+    const tsReal *pts, size_t n, tsReal d, double delta)
+{
+    tsReal samples[2*401];
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sample(offset, 401,
+        samples));
+    for (i = 0; i < 401; i++) {
+        CuAssertDblEquals(tc, fabs(d), offset_tests_dist(pts, n,
+            samples[i*2], samples[i*2 + 1]), delta);
+    }
+}
+
+void offset_test_curve(CuTest *tc)
+{
+    tsBSpline spline, offset;
+    tsReal *pts;
+    const size_t n = 4001;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(8, 2, 3, TS_CLAMPED, &spline));
+    for (i = 0; i < 8; i++) {
+        spline.ctrlp[i*2] = (tsReal) i;
+        spline.ctrlp[i*2 + 1] = (i % 2) ? 1.f : -1.f;
+    }
+    pts = (tsReal *) malloc(n * 2 * sizeof(tsReal));
+    CuAssertPtrNotNull(tc, pts);
+    ts_bspline_sample(&spline, n, pts);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_offset(&spline, 0.3f, 0.0001f, &offset));
+    CuAssertIntEquals(tc, 3, (int) offset.deg);
+    offset_tests_check(tc, &offset, pts, n, 0.3f, offset_tests_delta);
+    ts_bspline_free(&offset);
+
+    /* in place, to the right */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_offset(&spline, -0.3f, 0.0001f, &spline));
+    offset_tests_check(tc, &spline, pts, n, 0.3f, offset_tests_delta);
+    ts_bspline_free(&spline);
+    free(pts);
+}
+
+void offset_test_corner(CuTest *tc)
+{
+    tsBSpline polyline, offset;
+    tsReal pts[6] = { 0.f, 0.f, 2.f, 0.f, 2.f, 2.f };
+    tsReal p[2];
+    tsDeBoorNet net;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(3, 2, 1, TS_CLAMPED, &polyline));
+    ts_bspline_set_ctrlp(&polyline, pts, &polyline);
+
+    /* outer side: round join */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_offset(&polyline, -0.5f, 0.0001f, &offset));
+    offset_tests_check(tc, &offset, pts, 3, 0.5f, offset_tests_delta);
+    ts_bspline_evaluate(&offset, 0.f, &net);
+    CuAssertDblEquals(tc, 0, net.result[0], offset_tests_delta);
+    CuAssertDblEquals(tc, -0.5, net.result[1], offset_tests_delta);
+    ts_deboornet_free(&net);
+    ts_bspline_free(&offset);
+
+    /* inner side: the loop is cut off */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_offset(&polyline, 0.5f, 0.0001f, &offset));
+    offset_tests_check(tc, &offset, pts, 3, 0.5f, offset_tests_delta);
+    ts_bspline_evaluate(&offset, 1.f, &net);
+    p[0] = net.result[0];
+    p[1] = net.result[1];
+    ts_deboornet_free(&net);
+    CuAssertDblEquals(tc, 1.5, p[0], offset_tests_delta);
+    CuAssertDblEquals(tc, 2, p[1], offset_tests_delta);
+    ts_bspline_free(&offset);
+
+    ts_bspline_free(&polyline);
+}
+
+void offset_test_closed(CuTest *tc)
+{
+    tsBSpline circle, offset;
+    tsReal pts[2*33], *samples;
+    const size_t n = 4001;
+    tsReal *first, *last;
+    size_t i;
+
+    for (i = 0; i < 33; i++) {
+        pts[i*2] = (tsReal) cos(2 * 3.14159265358979 * i / 32);
+        pts[i*2 + 1] = (tsReal) sin(2 * 3.14159265358979 * i / 32);
+    }
+    pts[64] = pts[0];
+    pts[65] = pts[1];
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_interpolate_cubic(pts, 33, 2, &circle));
+    samples = (tsReal *) malloc(n * 2 * sizeof(tsReal));
+    CuAssertPtrNotNull(tc, samples);
+    ts_bspline_sample(&circle, n, samples);
+
+    /* inner side: only the crossing ends are cut off */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_offset(&circle, 0.5f, 0.0001f, &offset));
+    CuAssertTrue(tc, offset.n_ctrlp >= 4*32);
+    offset_tests_check(tc, &offset, samples, n, 0.5f, offset_tests_delta);
+    first = offset.ctrlp;
+    last = offset.ctrlp + offset.n_ctrlp*2 - 2;
+    CuAssertDblEquals(tc, 0.5, first[0], offset_tests_delta);
+    CuAssertDblEquals(tc, 0, first[1], offset_tests_delta);
+    CuAssertDblEquals(tc, first[0], last[0], offset_tests_delta);
+    CuAssertDblEquals(tc, first[1], last[1], offset_tests_delta);
+    ts_bspline_free(&offset);
+
+    /* outer side */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_offset(&circle, -0.5f, 0.0001f, &offset));
+    CuAssertTrue(tc, offset.n_ctrlp >= 4*32);
+    offset_tests_check(tc, &offset, samples, n, 0.5f, offset_tests_delta);
+    ts_bspline_free(&offset);
+
+    ts_bspline_free(&circle);
+    free(samples);
+}
+
+void offset_test_large_coordinates(CuTest *tc)
+{
+    tsBSpline spline, offset;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(200, 2, 3, TS_CLAMPED, &spline));
+    for (i = 0; i < 200; i++) {
+        spline.ctrlp[i*2] = (tsReal) i * 100.f;
+        spline.ctrlp[i*2 + 1] = (i % 2) ? 100.f : -100.f;
+    }
+
+    /* The tolerance is less than the precision of the coordinates, which
+     * must not lead to maximum subdivision. */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_offset(&spline, 1.f, 0.0001f, &offset));
+    CuAssertTrue(tc, offset.n_ctrlp < 200 * 4 * 64);
+    ts_bspline_free(&offset);
+    ts_bspline_free(&spline);
+}
+
+void offset_test_errors(CuTest *tc)
+{
+    tsBSpline spline, offset;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 3, 3, TS_CLAMPED, &spline));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_offset(&spline, 1.f, 0.001f, &offset));
+    CuAssertPtrEquals(tc, NULL, offset.ctrlp);
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_offset_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, offset_test_curve);
+    SUITE_ADD_TEST(suite, offset_test_corner);
+    SUITE_ADD_TEST(suite, offset_test_closed);
+    SUITE_ADD_TEST(suite, offset_test_large_coordinates);
+    SUITE_ADD_TEST(suite, offset_test_errors);
+
+    return suite;
+}
@@ -0,0 +1,137 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <stdlib.h>
+#include <math.h>
+
+const double raster_tests_delta = 0.0001;
+
+/* Creates the closed polygon of the rectangle [x0, x1] x [y0, y1]. */
+void raster_tests_rect(CuTest *tc, tsReal x0, tsReal y0, tsReal x1,
+    tsReal y1, tsBSpline *rect)
+{
+    tsReal ctrlp[10];
+
+    ctrlp[0] = x0; ctrlp[1] = y0;
+    ctrlp[2] = x1; ctrlp[3] = y0;
+    ctrlp[4] = x1; ctrlp[5] = y1;
+    ctrlp[6] = x0; ctrlp[7] = y1;
+    ctrlp[8] = x0; ctrlp[9] = y0;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(5, 2, 1, TS_CLAMPED, rect));
+    ts_bspline_set_ctrlp(rect, ctrlp, rect);
+}
+
+/* The area of [c, c+1] x [r, r+1] within [x0, x1] x [y0, y1]. */
+tsReal raster_tests_overlap(size_t r, size_t c, tsReal x0, tsReal y0,
+    tsReal x1, tsReal y1)
+{
+    tsReal w = (c+1 < x1 ? c+1 : x1) - (c > x0 ? c : x0);
+    tsReal h = (r+1 < y1 ? r+1 : y1) - (r > y0 ? r : y0);
+    return w > 0.f && h > 0.f ? w*h : 0.f;
+}
+
+void raster_test_rect(CuTest *tc)
+{
+    tsBSpline rect;
+    tsReal origin[2] = { 0.f, 0.f };
+    float alpha[16*12];
+    unsigned char bytes[16*12];
+    tsReal a;
+    size_t r, c;
+
+    /* partially outside of the image */
+    raster_tests_rect(tc, -3.f, 3.5f, 10.75f, 14.25f, &rect);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_rasterize(&rect, 1,
+        origin, 1.f, 16, 12, TS_ALPHA_FLOAT, alpha));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_rasterize(&rect, 1,
+        origin, 1.f, 16, 12, TS_ALPHA_UINT8, bytes));
+    for (r = 0; r < 12; r++) {
+        for (c = 0; c < 16; c++) {
+            a = raster_tests_overlap(r, c, -3.f, 3.5f, 10.75f, 14.25f);
+            CuAssertDblEquals(tc, a, alpha[r*16 + c], raster_tests_delta);
+            CuAssertIntEquals(tc, (int) (a*255.f + .5f), bytes[r*16 + c]);
+        }
+    }
+    ts_bspline_free(&rect);
+}
+
+void raster_test_skewed(CuTest *tc)
+{
+    tsBSpline tri;
+    tsReal ctrlp[8] = { 1.3f, 0.4f, 30.2f, 5.1f, 7.7f, 19.6f, 1.3f, 0.4f };
+    tsReal origin[2] = { 0.f, 0.f }, sum = 0.f;
+    float alpha[32*20];
+    size_t i;
+
+    /* the total coverage is the area of the triangle */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 2, 1, TS_CLAMPED, &tri));
+    ts_bspline_set_ctrlp(&tri, ctrlp, &tri);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_rasterize(&tri, 1,
+        origin, 1.f, 32, 20, TS_ALPHA_FLOAT, alpha));
+    for (i = 0; i < 32*20; i++) {
+        CuAssertTrue(tc, alpha[i] >= 0.f && alpha[i] <= 1.f);
+        sum += alpha[i];
+    }
+    CuAssertDblEquals(tc, .5 * fabs((30.2-1.3)*(19.6-0.4) -
+        (7.7-1.3)*(5.1-0.4)), sum, 0.01);
+    ts_bspline_free(&tri);
+}
+
+void raster_test_ring(CuTest *tc)
+{
+    tsBSpline rings[2];
+    tsReal pts[2*65], origin[2] = { -16.f, -16.f }, sum = 0.f;
+    float *alpha;
+    size_t i, k;
+
+    /* outer circle counterclockwise, hole clockwise */
+    for (k = 0; k < 2; k++) {
+        for (i = 0; i < 65; i++) {
+            pts[i*2] = (k ? 5.f : 12.f) *
+                (tsReal) cos((k ? -1 : 1) * 2*3.14159265 * i / 64);
+            pts[i*2 + 1] = (k ? 5.f : 12.f) *
+                (tsReal) sin((k ? -1 : 1) * 2*3.14159265 * i / 64);
+        }
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_interpolate_cubic(pts, 65, 2, rings + k));
+    }
+    alpha = (float *) malloc(64*64 * sizeof(float));
+    CuAssertPtrNotNull(tc, alpha);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_rasterize(rings, 2,
+        origin, .5f, 64, 64, TS_ALPHA_FLOAT, alpha));
+    for (i = 0; i < 64*64; i++)
+        sum += alpha[i];
+    CuAssertDblEquals(tc, 3.14159265 * (144-25), sum * .25f, 1.0);
+    CuAssertDblEquals(tc, 0, alpha[32*64 + 32], raster_tests_delta);
+    CuAssertDblEquals(tc, 1, alpha[32*64 + 14], raster_tests_delta);
+    CuAssertDblEquals(tc, 0, alpha[0], raster_tests_delta);
+    free(alpha);
+    ts_bspline_free(rings);
+    ts_bspline_free(rings + 1);
+}
+
+void raster_test_errors(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal origin[2] = { 0.f, 0.f };
+    float alpha[4];
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 3, 3, TS_CLAMPED, &spline));
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED, ts_bspline_rasterize(&spline,
+        1, origin, 1.f, 2, 2, TS_ALPHA_FLOAT, alpha));
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_raster_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, raster_test_rect);
+    SUITE_ADD_TEST(suite, raster_test_skewed);
+    SUITE_ADD_TEST(suite, raster_test_ring);
+    SUITE_ADD_TEST(suite, raster_test_errors);
+
+    return suite;
+}
@@ -0,0 +1,240 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <math.h>
+
+const double seal_tests_delta = 0.0001;
+
+void seal_tests_wave(CuTest *tc, size_t dim, tsBSpline *spline)
+{
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(30, dim, 3, TS_CLAMPED, spline));
+    for (i = 0; i < 30; i++) {
+        spline->ctrlp[i*dim] = i * 0.25f;
+        spline->ctrlp[i*dim + 1] = (tsReal) sin(i * 0.5);
+        if (dim > 2)
+            spline->ctrlp[i*dim + 2] = (tsReal) cos(i * 0.3);
+    }
+}
+
+void seal_test_evaluate(CuTest *tc)
+{
+    tsBSpline spline;
+    tsSealedBSpline sealed;
+    tsReal us[997], expected[3*997], actual[3*997], u;
+    size_t i;
+
+    seal_tests_wave(tc, 3, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_seal(&spline, &sealed));
+    CuAssertIntEquals(tc, (int) spline.n_ctrlp,
+        (int) sealed.bspline.n_ctrlp);
+    CuAssertIntEquals(tc, 3, (int) sealed.first_span);
+    CuAssertIntEquals(tc, (int) spline.n_ctrlp - 1, (int) sealed.last_span);
+
+    for (i = 0; i < 997; i++)
+        us[i] = (i + 0.5f) / 997.f;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_evaluate_many(&spline, us, 997, expected));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_sealed_bspline_evaluate_many(&sealed, us, 997, actual));
+    for (i = 0; i < 3*997; i++)
+        CuAssertDblEquals(tc, expected[i], actual[i], seal_tests_delta);
+
+    /* the sealed copy does not change */
+    spline.ctrlp[0] += 1.f;
+    u = 0.f;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_sealed_bspline_evaluate_many(&sealed, &u, 1, actual));
+    CuAssertDblEquals(tc, 0, actual[0], seal_tests_delta);
+
+    /* knot values outside of the domain are clamped */
+    us[0] = -1.f;
+    us[1] = 2.f;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_sealed_bspline_evaluate_many(&sealed, us, 2, actual));
+    CuAssertDblEquals(tc, 0, actual[0], seal_tests_delta);
+    CuAssertDblEquals(tc, 29 * 0.25, actual[3], seal_tests_delta);
+    CuAssertDblEquals(tc, sin(29 * 0.5), actual[4], seal_tests_delta);
+
+    ts_sealed_bspline_free(&sealed);
+    CuAssertPtrEquals(tc, NULL, sealed.inv);
+    CuAssertPtrEquals(tc, NULL, sealed.bspline.ctrlp);
+    ts_bspline_free(&spline);
+}
+
+void seal_test_derivatives(CuTest *tc)
+{
+    tsBSpline spline, first, second;
+    tsSealedBSpline sealed;
+    tsReal u, ders[5*2], point[2];
+    size_t i;
+
+    seal_tests_wave(tc, 2, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&spline, &first));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&first, &second));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_seal(&spline, &sealed));
+    for (i = 0; i < 97; i++) {
+        u = (i + 0.5f) / 97.f;
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_sealed_bspline_derivatives_many(&sealed, &u, 1, 3, ders));
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate_many(&spline, &u, 1, point));
+        CuAssertDblEquals(tc, point[0], ders[0], seal_tests_delta);
+        CuAssertDblEquals(tc, point[1], ders[1], seal_tests_delta);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate_many(&first, &u, 1, point));
+        CuAssertDblEquals(tc, point[0], ders[2], 0.001);
+        CuAssertDblEquals(tc, point[1], ders[3], 0.001);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate_many(&second, &u, 1, point));
+        CuAssertDblEquals(tc, point[0], ders[4], 0.01);
+        CuAssertDblEquals(tc, point[1], ders[5], 0.01);
+    }
+    /* cubic splines have no fourth derivative */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_sealed_bspline_derivatives_many(&sealed, &u, 1, 4, ders));
+    CuAssertDblEquals(tc, 0, ders[8], 0);
+    CuAssertDblEquals(tc, 0, ders[9], 0);
+
+    ts_sealed_bspline_free(&sealed);
+    ts_bspline_free(&second);
+    ts_bspline_free(&first);
+    ts_bspline_free(&spline);
+}
+
+void seal_test_validate(CuTest *tc)
+{
+    tsBSpline spline;
+    tsSealedBSpline sealed;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(7, 2, 2, TS_CLAMPED, &spline));
+
+    spline.knots[4] = 0.1f;
+    CuAssertIntEquals(tc, TS_KNOTS_DECR, ts_bspline_seal(&spline, &sealed));
+    CuAssertPtrEquals(tc, NULL, sealed.inv);
+
+    spline.knots[3] = spline.knots[4] = spline.knots[5] = 0.5f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_seal(&spline, &sealed));
+    ts_sealed_bspline_free(&sealed);
+    spline.knots[6] = 0.5f;
+    CuAssertIntEquals(tc, TS_MULTIPLICITY,
+        ts_bspline_seal(&spline, &sealed));
+
+    ts_arr_fill(spline.knots, spline.n_knots, 1.f);
+    CuAssertIntEquals(tc, TS_MULTIPLICITY,
+        ts_bspline_seal(&spline, &sealed));
+    ts_bspline_free(&spline);
+    CuAssertIntEquals(tc, TS_DIM_ZERO, ts_bspline_seal(&spline, &sealed));
+}
+
+void seal_test_empty_spans(CuTest *tc)
+{
+    tsBSpline spline;
+    tsSealedBSpline sealed;
+    tsReal empty[6] = { 0.f, 0.f, 0.5f, 0.5f, 1.f, 1.f };
+    tsReal knots[6] = { 0.f, 0.25f, 0.5f, 0.5f, 0.75f, 1.f };
+    tsReal us[2] = { 0.2f, 0.5f }, points[2];
+    size_t i;
+
+    /* the domain [0.5, 0.5] of a quadratic spline is empty */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(3, 1, 2, TS_CLAMPED, &spline));
+    ts_bspline_set_knots(&spline, empty, &spline);
+    CuAssertIntEquals(tc, TS_KNOTS_DECR, ts_bspline_seal(&spline, &sealed));
+    ts_bspline_free(&spline);
+
+    /* empty intervals within the domain are skipped */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 1, 1, TS_OPENED, &spline));
+    for (i = 0; i < 4; i++)
+        spline.ctrlp[i] = (tsReal) i;
+    ts_bspline_set_knots(&spline, knots, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_seal(&spline, &sealed));
+    CuAssertIntEquals(tc, 1, (int) sealed.first_span);
+    CuAssertIntEquals(tc, 3, (int) sealed.last_span);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_sealed_bspline_evaluate_many(&sealed, us, 2, points));
+    CuAssertDblEquals(tc, 0, points[0], seal_tests_delta);
+    CuAssertDblEquals(tc, 2, points[1], seal_tests_delta);
+    ts_sealed_bspline_free(&sealed);
+    ts_bspline_free(&spline);
+}
+
+void seal_test_derive_insert(CuTest *tc)
+{
+    tsBSpline spline, expected, actual;
+    tsSealedBSpline sealed;
+    size_t i, k1, k2;
+
+    seal_tests_wave(tc, 2, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_seal(&spline, &sealed));
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_derive(&spline, &expected));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_sealed_bspline_derive(&sealed, &actual));
+    CuAssertIntEquals(tc, (int) expected.n_ctrlp, (int) actual.n_ctrlp);
+    for (i = 0; i < expected.n_ctrlp*2; i++) {
+        CuAssertDblEquals(tc, expected.ctrlp[i], actual.ctrlp[i],
+            seal_tests_delta);
+    }
+    for (i = 0; i < expected.n_knots; i++)
+        CuAssertDblEquals(tc, expected.knots[i], actual.knots[i], 0);
+    ts_bspline_free(&expected);
+    ts_bspline_free(&actual);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_insert_knot(&spline, 0.3f, 2, &expected, &k1));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_sealed_bspline_insert_knot(&sealed, 0.3f, 2, &actual, &k2));
+    CuAssertIntEquals(tc, (int) k1, (int) k2);
+    CuAssertIntEquals(tc, (int) expected.n_ctrlp, (int) actual.n_ctrlp);
+    for (i = 0; i < expected.n_ctrlp*2; i++) {
+        CuAssertDblEquals(tc, expected.ctrlp[i], actual.ctrlp[i],
+            seal_tests_delta);
+    }
+    for (i = 0; i < expected.n_knots; i++)
+        CuAssertDblEquals(tc, expected.knots[i], actual.knots[i], 0);
+    ts_bspline_free(&expected);
+    ts_bspline_free(&actual);
+
+    CuAssertIntEquals(tc, TS_MULTIPLICITY,
+        ts_sealed_bspline_insert_knot(&sealed, 0.3f, 5, &actual, &k2));
+    CuAssertIntEquals(tc, 0, (int) k2);
+    CuAssertPtrEquals(tc, NULL, actual.ctrlp);
+    ts_sealed_bspline_free(&sealed);
+
+    /* discontinuous splines are underivable */
+    spline.knots[4] = spline.knots[5] = spline.knots[6] = spline.knots[7];
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_seal(&spline, &sealed));
+    CuAssertIntEquals(tc, TS_UNDERIVABLE,
+        ts_sealed_bspline_derive(&sealed, &actual));
+    CuAssertPtrEquals(tc, NULL, actual.ctrlp);
+    ts_sealed_bspline_free(&sealed);
+
+    /* ... even if their knots are equal according to ts_fequals only */
+    spline.knots[4] -= 2e-6f;
+    CuAssertTrue(tc, spline.knots[4] < spline.knots[7]);
+    CuAssertIntEquals(tc, TS_UNDERIVABLE, ts_bspline_derive(&spline,
+        &actual));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_seal(&spline, &sealed));
+    CuAssertIntEquals(tc, TS_UNDERIVABLE,
+        ts_sealed_bspline_derive(&sealed, &actual));
+    CuAssertPtrEquals(tc, NULL, actual.ctrlp);
+    ts_sealed_bspline_free(&sealed);
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_seal_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, seal_test_evaluate);
+    SUITE_ADD_TEST(suite, seal_test_derivatives);
+    SUITE_ADD_TEST(suite, seal_test_derive_insert);
+    SUITE_ADD_TEST(suite, seal_test_validate);
+    SUITE_ADD_TEST(suite, seal_test_empty_spans);
+
+    return suite;
+}
@@ -0,0 +1,240 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <stdlib.h>
+#include <math.h>
+
+const double simplify_tests_delta = 0.0001;
+
+/* The distance of \p to the closest segment of \poly (\n points). */
+tsReal simplify_tests_dist(const tsReal *p, const tsReal *poly, size_t n,
+    size_t dim)
+{
+    tsReal best = -1.f, t, dd, ll, d2, x;
+    size_t i, d;
+
+    for (i = 0; i+1 < n || (n == 1 && i == 0); i++) {
+        dd = ll = 0.f;
+        for (d = 0; d < dim && n > 1; d++) {
+            x = poly[(i+1)*dim + d] - poly[i*dim + d];
+            dd += (p[d] - poly[i*dim + d]) * x;
+            ll += x*x;
+        }
+        t = ll > 0.f ? dd/ll : 0.f;
+        t = t < 0.f ? 0.f : t > 1.f ? 1.f : t;
+        d2 = 0.f;
+        for (d = 0; d < dim; d++) {
+            x = n > 1 ? poly[i*dim + d] +
+                t * (poly[(i+1)*dim + d] - poly[i*dim + d]) : poly[d];
+            d2 += (p[d] - x) * (p[d] - x);
+        }
+        if (best < 0.f || d2 < best)
+            best = d2;
+    }
+    return (tsReal) sqrt(best);
+}
+
+/* Samples \spline densely and simplifies the samples with \tol. Checks
+ * that each sample is within \tol of the result. Returns the number of
+ * points of the result. */
+size_t simplify_tests_check(CuTest *tc, tsBSpline *spline, size_t n,
+    tsReal tol)
+{
+    const size_t dim = spline->dim;
+    tsReal *dense = (tsReal *) malloc(n * dim * sizeof(tsReal));
+    tsReal *poly = (tsReal *) malloc(n * dim * sizeof(tsReal));
+    size_t n_out, i, d;
+
+    CuAssertPtrNotNull(tc, dense);
+    CuAssertPtrNotNull(tc, poly);
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sample(spline, n, dense));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_sample_simplified(spline, n, tol, poly, n, &n_out));
+    CuAssertTrue(tc, n_out >= 2);
+    for (d = 0; d < dim; d++) {
+        CuAssertDblEquals(tc, dense[d], poly[d], 0);
+        CuAssertDblEquals(tc, dense[(n-1)*dim + d], poly[(n_out-1)*dim + d],
+            0);
+    }
+    for (i = 0; i < n; i++) {
+        CuAssertTrue(tc, simplify_tests_dist(dense + i*dim, poly, n_out, dim)
+            <= tol + simplify_tests_delta);
+    }
+    free(dense);
+    free(poly);
+    return n_out;
+}
+
+void simplify_test_line(CuTest *tc)
+{
+    tsBSpline line;
+    tsReal ctrlp[6] = { 0.f, 0.f, 1.f, 1.f, 3.f, 3.f };
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(3, 2, 1, TS_CLAMPED, &line));
+    ts_bspline_set_ctrlp(&line, ctrlp, &line);
+    CuAssertIntEquals(tc, 2, (int) simplify_tests_check(tc, &line, 1000,
+        0.001f));
+    ts_bspline_free(&line);
+}
+
+void simplify_test_curves(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal points[3*40];
+    size_t i, n_fine, n_coarse;
+
+    /* planar wave */
+    for (i = 0; i < 40; i++) {
+        points[i*2] = i * 0.25f;
+        points[i*2 + 1] = (tsReal) sin(i * 0.5);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_interpolate_cubic(points, 40, 2, &spline));
+    n_fine = simplify_tests_check(tc, &spline, 5000, 0.001f);
+    n_coarse = simplify_tests_check(tc, &spline, 5000, 0.05f);
+    CuAssertTrue(tc, n_fine < 1000);
+    CuAssertTrue(tc, n_coarse < n_fine);
+    ts_bspline_free(&spline);
+
+    /* helix */
+    for (i = 0; i < 40; i++) {
+        points[i*3] = (tsReal) cos(i * 0.4);
+        points[i*3 + 1] = (tsReal) sin(i * 0.4);
+        points[i*3 + 2] = i * 0.1f;
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_interpolate_cubic(points, 40, 3, &spline));
+    CuAssertTrue(tc, simplify_tests_check(tc, &spline, 5000, 0.01f) < 500);
+    ts_bspline_free(&spline);
+}
+
+void simplify_test_buffer_size(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal points[2*10], all[2*100], few[2*3];
+    size_t i, n_all, n_few;
+
+    for (i = 0; i < 10; i++) {
+        points[i*2] = (tsReal) i;
+        points[i*2 + 1] = (tsReal) (i % 2);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_interpolate_cubic(points, 10, 2, &spline));
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_sample_simplified(&spline, 500, 0.01f, all, 100, &n_all));
+    CuAssertTrue(tc, n_all > 3);
+    CuAssertIntEquals(tc, TS_BUFFER_SIZE,
+        ts_bspline_sample_simplified(&spline, 500, 0.01f, few, 3, &n_few));
+    CuAssertIntEquals(tc, (int) n_all, (int) n_few);
+    for (i = 0; i < 2*3; i++)
+        CuAssertDblEquals(tc, all[i], few[i], 0);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_sample_simplified(&spline, 0, 0.01f, all, 100, &n_all));
+    CuAssertIntEquals(tc, 0, (int) n_all);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_sample_simplified(&spline, 1, 0.01f, all, 100, &n_all));
+    CuAssertIntEquals(tc, 1, (int) n_all);
+    ts_bspline_free(&spline);
+}
+
+void simplify_test_stream(CuTest *tc)
+{
+    tsSimplifier simplifier;
+    tsReal walk[2*2000], poly[2*2001], p[2];
+    unsigned long seed = 12345;
+    size_t i, n = 0;
+
+    /* random walk */
+    p[0] = p[1] = 0.f;
+    for (i = 0; i < 2000; i++) {
+        seed = (seed * 1103515245 + 12345) % 2147483648UL;
+        p[0] += (tsReal) (seed % 1000) / 1000.f;
+        seed = (seed * 1103515245 + 12345) % 2147483648UL;
+        p[1] += (tsReal) (seed % 1000) / 500.f - 1.f;
+        walk[i*2] = p[0];
+        walk[i*2 + 1] = p[1];
+    }
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_simplifier_new(2, 0.5f,
+        &simplifier));
+    for (i = 0; i < 2000; i++)
+        n += ts_simplifier_push(&simplifier, walk + i*2, poly + n*2);
+    n += ts_simplifier_flush(&simplifier, poly + n*2);
+    CuAssertTrue(tc, n < 2000);
+    CuAssertDblEquals(tc, walk[2*1999], poly[(n-1)*2], 0);
+    for (i = 0; i < 2000; i++) {
+        CuAssertTrue(tc, simplify_tests_dist(walk + i*2, poly, n, 2)
+            <= 0.5f + simplify_tests_delta);
+    }
+
+    /* a new polyline starts after flushing */
+    CuAssertIntEquals(tc, 1, (int) ts_simplifier_push(&simplifier, walk,
+        poly));
+    CuAssertIntEquals(tc, 0, (int) ts_simplifier_flush(&simplifier, poly));
+    CuAssertIntEquals(tc, 1, (int) ts_simplifier_push(&simplifier, walk + 2,
+        poly));
+    CuAssertDblEquals(tc, walk[2], poly[0], 0);
+    ts_simplifier_free(&simplifier);
+    CuAssertPtrEquals(tc, NULL, simplifier.anchor);
+
+    CuAssertIntEquals(tc, TS_DIM_ZERO, ts_simplifier_new(0, 0.5f,
+        &simplifier));
+    CuAssertPtrEquals(tc, NULL, simplifier.anchor);
+}
+
+void simplify_test_large_coordinates(CuTest *tc)
+{
+    const size_t n_walk = 20000;
+    const tsReal tols[2] = { 0.05f, 0.5f };
+    tsSimplifier simplifier;
+    tsReal *walk, *poly, p[2];
+    unsigned long seed = 12345;
+    size_t i, k, n;
+
+    walk = (tsReal *) malloc(n_walk * 2 * sizeof(tsReal));
+    poly = (tsReal *) malloc((n_walk+1) * 2 * sizeof(tsReal));
+    CuAssertPtrNotNull(tc, walk);
+    CuAssertPtrNotNull(tc, poly);
+
+    /* A flat random walk reaching x = 10000, i.e., long segments whose
+     * points deviate from the axis of the cone by very small angles. */
+    p[0] = p[1] = 0.f;
+    for (i = 0; i < n_walk; i++) {
+        seed = (seed * 1103515245 + 12345) % 2147483648UL;
+        p[0] += (tsReal) (seed % 1000) / 1000.f;
+        seed = (seed * 1103515245 + 12345) % 2147483648UL;
+        p[1] += (tsReal) (seed % 1000) / 50000.f - 0.01f;
+        walk[i*2] = p[0];
+        walk[i*2 + 1] = p[1];
+    }
+
+    for (k = 0; k < 2; k++) {
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_simplifier_new(2, tols[k],
+            &simplifier));
+        n = 0;
+        for (i = 0; i < n_walk; i++)
+            n += ts_simplifier_push(&simplifier, walk + i*2, poly + n*2);
+        n += ts_simplifier_flush(&simplifier, poly + n*2);
+        ts_simplifier_free(&simplifier);
+        for (i = 0; i < n_walk; i++) {
+            CuAssertTrue(tc, simplify_tests_dist(walk + i*2, poly, n, 2)
+                <= tols[k] + simplify_tests_delta);
+        }
+    }
+    free(walk);
+    free(poly);
+}
+
+CuSuite* get_simplify_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, simplify_test_line);
+    SUITE_ADD_TEST(suite, simplify_test_curves);
+    SUITE_ADD_TEST(suite, simplify_test_buffer_size);
+    SUITE_ADD_TEST(suite, simplify_test_stream);
+    SUITE_ADD_TEST(suite, simplify_test_large_coordinates);
+
+    return suite;
+}
@@ -6,7 +6,7 @@ void str_enum_test_bijection(CuTest* tc)
 {
     char *str;
     int i, j;
-    for (i = 0; i > -9; i--) {
+    for (i = 0; i > -15; i--) {
         str = (char *)ts_enum_str((tsError) i);
         j = strcmp("unknown error", str);
         if (j == 0) /* TS_SUCCESS */
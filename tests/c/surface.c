@@ -0,0 +1,156 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double surface_tests_delta = 0.0001;
+
+void surface_tests_init(CuTest *tc, tsBSplineSurface *surface)
+{
+    size_t i, j;
+    tsReal *p;
+    tsError err = ts_bsplinesurface_new(5, 6, 3, 2, 3, TS_CLAMPED, surface);
+    CuAssertIntEquals(tc, TS_SUCCESS, err);
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 6; j++) {
+            p = surface->ctrlp + (i*6 + j) * 3;
+            p[0] = (tsReal) i;
+            p[1] = (tsReal) j;
+            p[2] = (tsReal) ((i*j) % 3) - (tsReal) 1.0;
+        }
+    }
+}
+
+/* Evaluates the surface by evaluating each row as a curve in v-direction
+ * and the resulting points as a curve in u-direction. */
+void surface_tests_reference(CuTest *tc, tsBSplineSurface *surface,
+    tsReal u, tsReal v, tsReal *point)
+{
+    tsBSpline row, col;
+    tsDeBoorNet net;
+    size_t i, d;
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_new(surface->n_ctrlp_u,
+        3, surface->deg_u, TS_CLAMPED, &col));
+    for (i = 0; i < surface->n_ctrlp_u; i++) {
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_new(surface->n_ctrlp_v,
+            3, surface->deg_v, TS_CLAMPED, &row));
+        ts_bspline_set_ctrlp(&row, surface->ctrlp + i*surface->n_ctrlp_v*3,
+            &row);
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&row, v, &net));
+        for (d = 0; d < 3; d++)
+            col.ctrlp[i*3 + d] = net.result[d];
+        ts_deboornet_free(&net);
+        ts_bspline_free(&row);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_evaluate(&col, u, &net));
+    for (d = 0; d < 3; d++)
+        point[d] = net.result[d];
+    ts_deboornet_free(&net);
+    ts_bspline_free(&col);
+}
+
+void surface_test_evaluate(CuTest *tc)
+{
+    tsBSplineSurface surface;
+    tsReal us[4] = { 0.f, 0.3f, 0.55f, 1.f };
+    tsReal vs[3] = { 0.f, 0.42f, 1.f };
+    tsReal point[3], ref[3], grid[4*3*3];
+    size_t i, j, d;
+
+    surface_tests_init(tc, &surface);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinesurface_evaluate_grid(&surface, us, 4, vs, 3, grid));
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 3; j++) {
+            CuAssertIntEquals(tc, TS_SUCCESS,
+                ts_bsplinesurface_evaluate(&surface, us[i], vs[j], point));
+            surface_tests_reference(tc, &surface, us[i], vs[j], ref);
+            for (d = 0; d < 3; d++) {
+                CuAssertDblEquals(tc, ref[d], point[d], surface_tests_delta);
+                CuAssertDblEquals(tc, ref[d], grid[(i*3 + j)*3 + d],
+                    surface_tests_delta);
+            }
+        }
+    }
+
+    CuAssertIntEquals(tc, TS_U_UNDEFINED,
+        ts_bsplinesurface_evaluate(&surface, 1.5f, 0.5f, point));
+    ts_bsplinesurface_free(&surface);
+}
+
+void surface_test_derivatives(CuTest *tc)
+{
+    tsBSplineSurface surface;
+    tsReal ders[3*3*3], point[3], lo[3], hi[3];
+    const tsReal u = 0.4f, v = 0.6f, h = 0.001f;
+    size_t d;
+
+    surface_tests_init(tc, &surface);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinesurface_derivatives(&surface, u, v, 2, ders));
+    ts_bsplinesurface_evaluate(&surface, u, v, point);
+    for (d = 0; d < 3; d++)
+        CuAssertDblEquals(tc, point[d], ders[d], surface_tests_delta);
+
+    /* d/du */
+    ts_bsplinesurface_evaluate(&surface, u-h, v, lo);
+    ts_bsplinesurface_evaluate(&surface, u+h, v, hi);
+    for (d = 0; d < 3; d++)
+        CuAssertDblEquals(tc, (hi[d]-lo[d]) / (2*h), ders[3*3 + d], 0.01);
+
+    /* d/dv */
+    ts_bsplinesurface_evaluate(&surface, u, v-h, lo);
+    ts_bsplinesurface_evaluate(&surface, u, v+h, hi);
+    for (d = 0; d < 3; d++)
+        CuAssertDblEquals(tc, (hi[d]-lo[d]) / (2*h), ders[3 + d], 0.01);
+
+    /* k+l > 2 is zero */
+    for (d = 0; d < 3; d++)
+        CuAssertDblEquals(tc, 0, ders[(2*3 + 2)*3 + d], 0);
+    ts_bsplinesurface_free(&surface);
+}
+
+void surface_test_interpolate_cubic(CuTest *tc)
+{
+    tsBSplineSurface surface;
+    tsReal samples[5*9*3], point[3];
+    size_t i, j, d;
+
+    /* 11 control points * 3 values per row: more than one block */
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 9; j++) {
+            samples[(i*9 + j)*3] = (tsReal) i;
+            samples[(i*9 + j)*3 + 1] = (tsReal) j;
+            samples[(i*9 + j)*3 + 2] = (tsReal) ((i*j) % 4);
+        }
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinesurface_interpolate_cubic(samples, 5, 9, 3, &surface));
+    CuAssertIntEquals(tc, 7, (int) surface.n_ctrlp_u);
+    CuAssertIntEquals(tc, 11, (int) surface.n_ctrlp_v);
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 9; j++) {
+            CuAssertIntEquals(tc, TS_SUCCESS, ts_bsplinesurface_evaluate(
+                &surface, i/4.f, j/8.f, point));
+            for (d = 0; d < 3; d++) {
+                CuAssertDblEquals(tc, samples[(i*9 + j)*3 + d], point[d],
+                    surface_tests_delta);
+            }
+        }
+    }
+    ts_bsplinesurface_free(&surface);
+
+    CuAssertIntEquals(tc, TS_DIM_ZERO,
+        ts_bsplinesurface_interpolate_cubic(samples, 5, 9, 0, &surface));
+    CuAssertPtrEquals(tc, NULL, surface.ctrlp);
+}
+
+CuSuite* get_surface_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, surface_test_evaluate);
+    SUITE_ADD_TEST(suite, surface_test_derivatives);
+    SUITE_ADD_TEST(suite, surface_test_interpolate_cubic);
+
+    return suite;
+}
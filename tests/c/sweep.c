@@ -0,0 +1,112 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+#include <math.h>
+
+const double sweep_tests_delta = 0.0001;
+
+/* A square with the corners at distance 1 from the center. */
+const tsReal sweep_tests_square[8] = {
+    1.f, 0.f,   0.f, 1.f,   -1.f, 0.f,   0.f, -1.f
+};
+
+void sweep_test_tube(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal vertices[5*4*3], dx, dy, dz;
+    size_t indices[6*4*4], i, k;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(4, 3, 3, TS_CLAMPED, &spline));
+    for (i = 0; i < 4; i++) {
+        spline.ctrlp[i*3] = (tsReal) i;
+        spline.ctrlp[i*3 + 1] = 2.f;
+        spline.ctrlp[i*3 + 2] = 0.f;
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sweep(&spline, 5,
+        sweep_tests_square, 4, 1, vertices, indices));
+
+    for (i = 0; i < 5; i++) {
+        for (k = 0; k < 4; k++) {
+            /* straight line: rings are perpendicular to the x-axis */
+            dx = vertices[(i*4 + k)*3] - vertices[i*4*3];
+            dy = vertices[(i*4 + k)*3 + 1] - 2.f;
+            dz = vertices[(i*4 + k)*3 + 2];
+            CuAssertDblEquals(tc, 0, dx, sweep_tests_delta);
+            CuAssertDblEquals(tc, 1, sqrt(dy*dy + dz*dz), sweep_tests_delta);
+        }
+    }
+    CuAssertDblEquals(tc, 0, vertices[0], sweep_tests_delta);
+    CuAssertDblEquals(tc, 3, vertices[4*4*3], sweep_tests_delta);
+
+    /* the first quad */
+    CuAssertIntEquals(tc, 0, (int) indices[0]);
+    CuAssertIntEquals(tc, 1, (int) indices[1]);
+    CuAssertIntEquals(tc, 5, (int) indices[2]);
+    CuAssertIntEquals(tc, 4, (int) indices[5]);
+    /* the last quad of a closed profile wraps around */
+    CuAssertIntEquals(tc, 15, (int) indices[6*15]);
+    CuAssertIntEquals(tc, 12, (int) indices[6*15 + 1]);
+    ts_bspline_free(&spline);
+}
+
+void sweep_test_ribbon_planar(CuTest *tc)
+{
+    tsBSpline spline;
+    tsReal segment[4] = { -.5f, 0.f, .5f, 0.f };
+    tsReal vertices[16*2*3], dx, dy;
+    size_t i;
+
+    /* a bend: the ribbon of a planar curve stays in its plane */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(5, 2, 3, TS_CLAMPED, &spline));
+    spline.ctrlp[0] = 0.f; spline.ctrlp[1] = 0.f;
+    spline.ctrlp[2] = 4.f; spline.ctrlp[3] = 0.f;
+    spline.ctrlp[4] = 5.f; spline.ctrlp[5] = 1.f;
+    spline.ctrlp[6] = 5.f; spline.ctrlp[7] = 5.f;
+    spline.ctrlp[8] = 5.f; spline.ctrlp[9] = 9.f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sweep(&spline, 16,
+        segment, 2, 0, vertices, NULL));
+    for (i = 0; i < 16*2; i++)
+        CuAssertDblEquals(tc, 0, vertices[i*3 + 2], sweep_tests_delta);
+    for (i = 0; i < 16; i++) {
+        dx = vertices[(i*2 + 1)*3] - vertices[i*2*3];
+        dy = vertices[(i*2 + 1)*3 + 1] - vertices[i*2*3 + 1];
+        CuAssertDblEquals(tc, 1, sqrt(dx*dx + dy*dy), sweep_tests_delta);
+    }
+    ts_bspline_free(&spline);
+}
+
+void sweep_test_many(CuTest *tc)
+{
+    tsBSpline splines[2];
+    tsReal vertices[2*3*4*3], single[3*4*3];
+    size_t indices[2*6*2*4], i, j;
+
+    for (j = 0; j < 2; j++) {
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_new(3, 3, 2, TS_CLAMPED, &splines[j]));
+        for (i = 0; i < 9; i++)
+            splines[j].ctrlp[i] = (tsReal) ((i*(j+2)) % 5);
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sweep_many(splines, 2, 3,
+        sweep_tests_square, 4, 1, vertices, indices));
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_sweep(&splines[1], 3,
+        sweep_tests_square, 4, 1, single, NULL));
+    for (i = 0; i < 3*4*3; i++)
+        CuAssertDblEquals(tc, single[i], vertices[3*4*3 + i], 0);
+    CuAssertIntEquals(tc, 12, (int) indices[6*2*4]);
+
+    for (j = 0; j < 2; j++)
+        ts_bspline_free(&splines[j]);
+}
+
+CuSuite* get_sweep_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, sweep_test_tube);
+    SUITE_ADD_TEST(suite, sweep_test_ribbon_planar);
+    SUITE_ADD_TEST(suite, sweep_test_many);
+
+    return suite;
+}
@@ -0,0 +1,146 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double tessellation_tests_delta = 0.0001;
+
+void tessellation_tests_init(CuTest *tc, tsBSpline *spline)
+{
+    size_t i;
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(12, 2, 3, TS_CLAMPED, spline));
+    for (i = 0; i < spline->n_ctrlp; i++) {
+        spline->ctrlp[i*2] = (tsReal) i;
+        spline->ctrlp[i*2 + 1] = (tsReal) ((i*7) % 5);
+    }
+}
+
+/* Compares \tess with a tessellation of \spline created from scratch. */
+void tessellation_tests_compare(CuTest *tc, tsTessellation *tess,
+    tsBSpline *spline)
+{
+    tsTessellation fresh;
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(spline, tess->n_segments, &fresh));
+    CuAssertIntEquals(tc, (int) fresh.n_points, (int) tess->n_points);
+    for (i = 0; i < fresh.n_points*2; i++) {
+        CuAssertDblEquals(tc, fresh.points[i], tess->points[i],
+            tessellation_tests_delta);
+    }
+    ts_tessellation_free(&fresh);
+}
+
+void tessellation_test_new(CuTest *tc)
+{
+    tsBSpline spline;
+    tsTessellation tess;
+    tsReal u, point[2];
+    size_t i, j;
+
+    tessellation_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 4, &tess));
+    CuAssertIntEquals(tc, 9, (int) tess.n_spans);
+    CuAssertIntEquals(tc, 37, (int) tess.n_points);
+    for (i = 0; i < tess.n_spans; i++) {
+        CuAssertIntEquals(tc, (int) i+3, (int) tess.spans[i]);
+        for (j = 0; j < 4; j++) {
+            u = (i + j/4.f) / 9.f;
+            ts_bspline_evaluate_many(&spline, &u, 1, point);
+            CuAssertDblEquals(tc, point[0], tess.points[(i*4 + j)*2],
+                tessellation_tests_delta);
+            CuAssertDblEquals(tc, point[1], tess.points[(i*4 + j)*2 + 1],
+                tessellation_tests_delta);
+        }
+    }
+    CuAssertDblEquals(tc, 11, tess.points[36*2], tessellation_tests_delta);
+    CuAssertDblEquals(tc, 2, tess.points[36*2 + 1],
+        tessellation_tests_delta);
+    ts_tessellation_free(&tess);
+    CuAssertPtrEquals(tc, NULL, tess.points);
+    ts_bspline_free(&spline);
+}
+
+void tessellation_test_ctrlp_changed(CuTest *tc)
+{
+    tsBSpline spline;
+    tsTessellation tess;
+    size_t from, count;
+
+    tessellation_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 4, &tess));
+
+    /* control point 6 affects the spans 3..6 */
+    spline.ctrlp[6*2 + 1] += 3.f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_tessellation_ctrlp_changed(
+        &tess, &spline, 6, 1, &from, &count));
+    CuAssertIntEquals(tc, 3*4, (int) from);
+    CuAssertIntEquals(tc, 4*4, (int) count);
+    tessellation_tests_compare(tc, &tess, &spline);
+
+    /* the last control point affects the end of the polyline */
+    spline.ctrlp[11*2] += 1.f;
+    spline.ctrlp[10*2] -= 1.f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_tessellation_ctrlp_changed(
+        &tess, &spline, 10, 5, &from, &count));
+    CuAssertIntEquals(tc, 7*4, (int) from);
+    CuAssertIntEquals(tc, 2*4 + 1, (int) count);
+    tessellation_tests_compare(tc, &tess, &spline);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_tessellation_ctrlp_changed(
+        &tess, &spline, 12, 1, &from, &count));
+    CuAssertIntEquals(tc, 0, (int) count);
+    ts_tessellation_free(&tess);
+    ts_bspline_free(&spline);
+}
+
+void tessellation_test_knots_changed(CuTest *tc)
+{
+    tsBSpline spline, other;
+    tsTessellation tess;
+    size_t from, count;
+
+    tessellation_tests_init(tc, &spline);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_tessellation_new(&spline, 3, &tess));
+
+    /* moving a knot keeps the spans */
+    spline.knots[7] += 0.05f;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_tessellation_knots_changed(
+        &tess, &spline, 7, 1, &from, &count));
+    CuAssertIntEquals(tc, 0, (int) from);
+    CuAssertIntEquals(tc, 8*3, (int) count);
+    tessellation_tests_compare(tc, &tess, &spline);
+
+    /* an empty span requires a new tessellation */
+    spline.knots[8] = spline.knots[7];
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_tessellation_knots_changed(
+        &tess, &spline, 8, 1, &from, &count));
+    CuAssertIntEquals(tc, 8, (int) tess.n_spans);
+    CuAssertIntEquals(tc, 0, (int) from);
+    CuAssertIntEquals(tc, 8*3 + 1, (int) count);
+    tessellation_tests_compare(tc, &tess, &spline);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(11, 2, 3, TS_CLAMPED, &other));
+    CuAssertIntEquals(tc, TS_INCOMPATIBLE, ts_tessellation_knots_changed(
+        &tess, &other, 0, 1, &from, &count));
+    CuAssertIntEquals(tc, TS_INCOMPATIBLE, ts_tessellation_ctrlp_changed(
+        &tess, &other, 0, 1, &from, &count));
+    ts_bspline_free(&other);
+    ts_tessellation_free(&tess);
+    ts_bspline_free(&spline);
+}
+
+CuSuite* get_tessellation_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, tessellation_test_new);
+    SUITE_ADD_TEST(suite, tessellation_test_ctrlp_changed);
+    SUITE_ADD_TEST(suite, tessellation_test_knots_changed);
+
+    return suite;
+}
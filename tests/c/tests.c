@@ -8,6 +8,26 @@ CuSuite* get_default_suite();
 CuSuite* get_free_suite();
 CuSuite* get_new_suite();
 CuSuite* get_move_suite();
+CuSuite* get_batch_suite();
+CuSuite* get_surface_suite();
+CuSuite* get_volume_suite();
+CuSuite* get_sweep_suite();
+CuSuite* get_frenet_suite();
+CuSuite* get_integrate_suite();
+CuSuite* get_lookup_suite();
+CuSuite* get_function_suite();
+CuSuite* get_arithmetic_suite();
+CuSuite* get_transform_suite();
+CuSuite* get_offset_suite();
+CuSuite* get_intersect_suite();
+CuSuite* get_field_suite();
+CuSuite* get_raster_suite();
+CuSuite* get_simplify_suite();
+CuSuite* get_lod_suite();
+CuSuite* get_tessellation_suite();
+CuSuite* get_mutate_suite();
+CuSuite* get_seal_suite();
+CuSuite* get_group_suite();
 
 int main()
 {
@@ -21,6 +41,26 @@ int main()
     CuSuiteAddSuite(suite, get_free_suite());
     CuSuiteAddSuite(suite, get_new_suite());
     CuSuiteAddSuite(suite, get_move_suite());
+    CuSuiteAddSuite(suite, get_batch_suite());
+    CuSuiteAddSuite(suite, get_surface_suite());
+    CuSuiteAddSuite(suite, get_volume_suite());
+    CuSuiteAddSuite(suite, get_sweep_suite());
+    CuSuiteAddSuite(suite, get_frenet_suite());
+    CuSuiteAddSuite(suite, get_integrate_suite());
+    CuSuiteAddSuite(suite, get_lookup_suite());
+    CuSuiteAddSuite(suite, get_function_suite());
+    CuSuiteAddSuite(suite, get_arithmetic_suite());
+    CuSuiteAddSuite(suite, get_transform_suite());
+    CuSuiteAddSuite(suite, get_offset_suite());
+    CuSuiteAddSuite(suite, get_intersect_suite());
+    CuSuiteAddSuite(suite, get_field_suite());
+    CuSuiteAddSuite(suite, get_raster_suite());
+    CuSuiteAddSuite(suite, get_simplify_suite());
+    CuSuiteAddSuite(suite, get_lod_suite());
+    CuSuiteAddSuite(suite, get_tessellation_suite());
+    CuSuiteAddSuite(suite, get_mutate_suite());
+    CuSuiteAddSuite(suite, get_seal_suite());
+    CuSuiteAddSuite(suite, get_group_suite());
 
     CuSuiteRun(suite);
     CuSuiteSummary(suite, output);
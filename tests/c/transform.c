@@ -0,0 +1,217 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double transform_tests_delta = 0.0001;
+
+void transform_tests_init(CuTest *tc, tsBSpline *spline, size_t dim)
+{
+    size_t i;
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(6, dim, 3, TS_CLAMPED, spline));
+    for (i = 0; i < 6*dim; i++)
+        spline->ctrlp[i] = (tsReal) ((i*5) % 7) - 2.f;
+    /* positive weights */
+    if (dim == 4) {
+        for (i = 0; i < 6; i++)
+            spline->ctrlp[i*4 + 3] = 1.f + (tsReal) i / 4.f;
+    }
+}
+
+/* Asserts that matrix * C(u) == T(u), with C(u) extended by 1 if affine. */
+void transform_tests_check(CuTest *tc, const tsBSpline *original,
+    const tsReal *matrix, tsTransformType type, const tsBSpline *transformed)
+{
+    const size_t dim = original->dim;
+    const size_t k = type == TS_AFFINE ? dim+1 : dim;
+    tsDeBoorNet a, b;
+    tsReal p[5], expected;
+    size_t i, r, c;
+
+    for (i = 0; i <= 10; i++) {
+        ts_bspline_evaluate(original, i / 10.f, &a);
+        CuAssertIntEquals(tc, TS_SUCCESS,
+            ts_bspline_evaluate(transformed, i / 10.f, &b));
+        for (c = 0; c < dim; c++)
+            p[c] = a.result[c];
+        p[dim] = 1.f;
+        for (r = 0; r < dim; r++) {
+            expected = 0.f;
+            for (c = 0; c < k; c++)
+                expected += matrix[r*k + c] * p[c];
+            CuAssertDblEquals(tc, expected, b.result[r],
+                transform_tests_delta);
+        }
+        ts_deboornet_free(&a);
+        ts_deboornet_free(&b);
+    }
+}
+
+void transform_test_affine(CuTest *tc)
+{
+    tsBSpline spline, transformed;
+    /* rotation by 90 degrees and translation by (3, -1) */
+    tsReal m2[9] = { 0.f, -1.f, 3.f,
+                     1.f,  0.f, -1.f,
+                     0.f,  0.f, 1.f };
+    tsReal m3[16] = { 2.f, 0.f, 1.f, 0.5f,
+                      0.f, 1.f, 0.f, -2.f,
+                      1.f, 0.f, 3.f, 1.f,
+                      0.f, 0.f, 0.f, 1.f };
+
+    transform_tests_init(tc, &spline, 2);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_transform(&spline, m2, TS_AFFINE, &transformed));
+    transform_tests_check(tc, &spline, m2, TS_AFFINE, &transformed);
+    ts_bspline_free(&transformed);
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_transform(&spline, m2, TS_AFFINE, &spline));
+    CuAssertDblEquals(tc, -(((1*5) % 7) - 2.f) + 3.f, spline.ctrlp[0], 0);
+    ts_bspline_free(&spline);
+
+    transform_tests_init(tc, &spline, 3);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_transform(&spline, m3, TS_AFFINE, &transformed));
+    transform_tests_check(tc, &spline, m3, TS_AFFINE, &transformed);
+    ts_bspline_free(&transformed);
+    ts_bspline_free(&spline);
+}
+
+void transform_test_projective(CuTest *tc)
+{
+    tsBSpline spline, transformed;
+    /* perspective projection onto the plane z = 1 */
+    tsReal m[16] = { 1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 0.f,
+                     0.f, 0.f, 1.f, 0.f,
+                     0.f, 0.f, 0.5f, 1.f };
+
+    transform_tests_init(tc, &spline, 4);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_transform(&spline, m, TS_PROJECTIVE, &transformed));
+    transform_tests_check(tc, &spline, m, TS_PROJECTIVE, &transformed);
+    ts_bspline_free(&transformed);
+
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_transform(&spline, m, TS_AFFINE, &transformed));
+    CuAssertPtrEquals(tc, NULL, transformed.ctrlp);
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_transform(&spline, m, TS_AFFINE, &spline));
+    CuAssertIntEquals(tc, 4, (int) spline.dim);
+    /* unknown transformation types are rejected */
+    CuAssertIntEquals(tc, TS_DIM_UNSUPPORTED,
+        ts_bspline_transform(&spline, m, (tsTransformType) 2, &transformed));
+    CuAssertPtrEquals(tc, NULL, transformed.ctrlp);
+    ts_bspline_free(&spline);
+}
+
+void transform_test_many(CuTest *tc)
+{
+    tsBSpline splines[3], originals[3];
+    tsReal m[9] = { 1.f, 0.f, 2.f,
+                    0.f, 1.f, 3.f,
+                    0.f, 0.f, 1.f };
+    size_t i;
+
+    for (i = 0; i < 3; i++) {
+        transform_tests_init(tc, &splines[i], i == 1 ? 3 : 2);
+        ts_bspline_copy(&splines[i], &originals[i]);
+    }
+    /* the matrix of a 2D spline is too small for a 3D spline */
+    CuAssertIntEquals(tc, TS_INCOMPATIBLE,
+        ts_bspline_transform_many(splines, 3, m, TS_AFFINE, splines));
+    for (i = 0; i < 3; i++) {
+        CuAssertDblEquals(tc, originals[i].ctrlp[0], splines[i].ctrlp[0],
+            0);
+    }
+    ts_bspline_free(&splines[1]);
+    ts_bspline_free(&originals[1]);
+
+    splines[1] = splines[2];
+    originals[1] = originals[2];
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_transform_many(splines, 2, m, TS_AFFINE, splines));
+    for (i = 0; i < 2; i++)
+        transform_tests_check(tc, &originals[i], m, TS_AFFINE, &splines[i]);
+
+    for (i = 0; i < 2; i++) {
+        ts_bspline_free(&splines[i]);
+        ts_bspline_free(&originals[i]);
+    }
+}
+
+void transform_test_buckle(CuTest *tc)
+{
+    tsBSpline spline, buckled;
+    tsReal p0, pn;
+    size_t i;
+
+    transform_tests_init(tc, &spline, 2);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_buckle(&spline, 0.25f, &buckled));
+    for (i = 0; i < 12; i++) {
+        p0 = spline.ctrlp[i % 2];
+        pn = spline.ctrlp[10 + i % 2];
+        CuAssertDblEquals(tc, 0.25f * spline.ctrlp[i] + 0.75f *
+            (p0 + (i/2) / 5.f * (pn-p0)), buckled.ctrlp[i],
+            transform_tests_delta);
+    }
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_buckle(&spline, 0.25f, &spline));
+    for (i = 0; i < 12; i++)
+        CuAssertDblEquals(tc, buckled.ctrlp[i], spline.ctrlp[i], 0);
+    ts_bspline_free(&buckled);
+    ts_bspline_free(&spline);
+}
+
+void transform_test_lerp(CuTest *tc)
+{
+    tsBSpline a, b, lerped;
+    size_t i;
+
+    transform_tests_init(tc, &a, 3);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bspline_new(6, 3, 3, TS_CLAMPED, &b));
+    for (i = 0; i < 18; i++)
+        b.ctrlp[i] = (tsReal) i;
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_lerp(&a, &b, 0.4f,
+        &lerped));
+    for (i = 0; i < 18; i++) {
+        CuAssertDblEquals(tc, 0.6f * a.ctrlp[i] + 0.4f * b.ctrlp[i],
+            lerped.ctrlp[i], transform_tests_delta);
+    }
+
+    /* in place */
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bspline_lerp(&a, &b, 0.4f, &b));
+    for (i = 0; i < 18; i++)
+        CuAssertDblEquals(tc, lerped.ctrlp[i], b.ctrlp[i], 0);
+    ts_bspline_free(&lerped);
+
+    /* close knots are not equal */
+    b.knots[5] += 5e-6f;
+    CuAssertIntEquals(tc, TS_INCOMPATIBLE, ts_bspline_lerp(&a, &b, 0.4f,
+        &lerped));
+    b.knots[5] = 0.9f;
+    CuAssertIntEquals(tc, TS_INCOMPATIBLE, ts_bspline_lerp(&a, &b, 0.4f,
+        &lerped));
+    CuAssertPtrEquals(tc, NULL, lerped.ctrlp);
+    ts_bspline_free(&a);
+    ts_bspline_free(&b);
+}
+
+CuSuite* get_transform_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, transform_test_affine);
+    SUITE_ADD_TEST(suite, transform_test_projective);
+    SUITE_ADD_TEST(suite, transform_test_many);
+    SUITE_ADD_TEST(suite, transform_test_buckle);
+    SUITE_ADD_TEST(suite, transform_test_lerp);
+
+    return suite;
+}
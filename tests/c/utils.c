@@ -11,6 +11,7 @@ void ctests_init_non_default_bspline(tsBSpline *bspline)
     bspline->n_knots = 5;
     bspline->ctrlp = (tsReal*) &bspline->deg;
     bspline->knots = (tsReal*) &bspline->dim;
+    bspline->flags = TS_ALIGNED;
 }
 
 /* See default tests */
@@ -23,4 +24,5 @@ void ctests_assert_default_bspline(CuTest *tc, tsBSpline *bspline)
     CuAssertTrue(tc, bspline->n_knots == 0);
     CuAssertPtrEquals(tc, bspline->ctrlp, NULL);
     CuAssertPtrEquals(tc, bspline->knots, NULL);
+    CuAssertIntEquals(tc, TS_PACKED, bspline->flags);
 }
@@ -0,0 +1,114 @@
+#include "tinyspline.h"
+#include "CuTest.h"
+
+const double volume_tests_delta = 0.0001;
+
+void volume_tests_sample(size_t i, size_t j, size_t k, tsReal *sample)
+{
+    sample[0] = (tsReal) (i + 2*j) - (tsReal) k;
+    sample[1] = (tsReal) ((i*j + k) % 3);
+}
+
+void volume_test_interpolate_cubic(CuTest *tc)
+{
+    tsBSplineVolume volume;
+    tsReal samples[4*3*5*2], point[2], expected[2];
+    size_t i, j, k;
+
+    for (i = 0; i < 4; i++)
+        for (j = 0; j < 3; j++)
+            for (k = 0; k < 5; k++)
+                volume_tests_sample(i, j, k, samples + ((i*3 + j)*5 + k)*2);
+
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinevolume_interpolate_cubic(samples, 4, 3, 5, 2, &volume));
+    CuAssertIntEquals(tc, 6, (int) volume.n_ctrlp_u);
+    CuAssertIntEquals(tc, 5, (int) volume.n_ctrlp_v);
+    CuAssertIntEquals(tc, 7, (int) volume.n_ctrlp_w);
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 3; j++) {
+            for (k = 0; k < 5; k++) {
+                CuAssertIntEquals(tc, TS_SUCCESS, ts_bsplinevolume_evaluate(
+                    &volume, i/3.f, j/2.f, k/4.f, point));
+                volume_tests_sample(i, j, k, expected);
+                CuAssertDblEquals(tc, expected[0], point[0],
+                    volume_tests_delta);
+                CuAssertDblEquals(tc, expected[1], point[1],
+                    volume_tests_delta);
+            }
+        }
+    }
+
+    /* natural cubic splines reproduce linear functions */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinevolume_evaluate(&volume, 0.5f, 0.25f, 0.3f, point));
+    CuAssertDblEquals(tc, 1.5f + 1.f - 1.2f, point[0], volume_tests_delta);
+    ts_bsplinevolume_free(&volume);
+
+    CuAssertIntEquals(tc, TS_DEG_GE_NCTRLP,
+        ts_bsplinevolume_interpolate_cubic(samples, 4, 1, 5, 2, &volume));
+    CuAssertPtrEquals(tc, NULL, volume.ctrlp);
+}
+
+void volume_tests_evaluate_many(CuTest *tc, tsBSplineVolume *volume)
+{
+    tsReal uvw[11*3], points[11*2], point[2];
+    size_t i;
+
+    for (i = 0; i < 11; i++) {
+        uvw[i*3] = i / 10.f;
+        uvw[i*3 + 1] = (i*7 % 11) / 10.f;
+        uvw[i*3 + 2] = 1.f - i / 10.f;
+    }
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinevolume_evaluate_many(volume, uvw, 11, points));
+    for (i = 0; i < 11; i++) {
+        CuAssertIntEquals(tc, TS_SUCCESS, ts_bsplinevolume_evaluate(
+            volume, uvw[i*3], uvw[i*3 + 1], uvw[i*3 + 2], point));
+        CuAssertDblEquals(tc, point[0], points[i*2], volume_tests_delta);
+        CuAssertDblEquals(tc, point[1], points[i*2 + 1], volume_tests_delta);
+    }
+
+    uvw[9*3 + 1] = 1.5f;
+    CuAssertIntEquals(tc, TS_U_UNDEFINED,
+        ts_bsplinevolume_evaluate_many(volume, uvw, 11, points));
+    CuAssertIntEquals(tc, TS_U_UNDEFINED,
+        ts_bsplinevolume_evaluate(volume, 0.5f, -0.5f, 0.5f, point));
+}
+
+void volume_test_evaluate_many(CuTest *tc)
+{
+    tsBSplineVolume volume, copy;
+    tsReal samples[3*4*3*2];
+    size_t i;
+
+    /* generic path (clamped knots) */
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinevolume_new(4, 5, 3, 2, 2, 3, 1, TS_CLAMPED, &volume));
+    for (i = 0; i < 4*5*3*2; i++)
+        volume.ctrlp[i] = (tsReal) ((i*5) % 7);
+    volume_tests_evaluate_many(tc, &volume);
+
+    CuAssertIntEquals(tc, TS_SUCCESS, ts_bsplinevolume_copy(&volume, &copy));
+    ts_bsplinevolume_free(&volume);
+    volume_tests_evaluate_many(tc, &copy);
+    ts_bsplinevolume_free(&copy);
+
+    /* uniform cubic path */
+    for (i = 0; i < 3*4*3*2; i++)
+        samples[i] = (tsReal) ((i*3) % 5);
+    CuAssertIntEquals(tc, TS_SUCCESS,
+        ts_bsplinevolume_interpolate_cubic(samples, 3, 4, 3, 2, &volume));
+    volume_tests_evaluate_many(tc, &volume);
+    ts_bsplinevolume_free(&volume);
+}
+
+CuSuite* get_volume_suite()
+{
+    CuSuite* suite = CuSuiteNew();
+
+    SUITE_ADD_TEST(suite, volume_test_interpolate_cubic);
+    SUITE_ADD_TEST(suite, volume_test_evaluate_many);
+
+    return suite;
+}